@@ -19,10 +19,13 @@ HEADERS += \
     src/bminidefs.h \
     src/clicklabel.h \
     src/configstate.h \
+    src/consolehistorydialog.h \
+    src/consolesink.h \
     src/customcombomodel.h \
     src/customheader.h \
     src/customsplashscreen.h \
     src/dbghelper.h \
+    src/dirscanner.h \
     src/defs.h \
     src/dlinidefs.h \
     src/dlinidialog.h \
@@ -35,15 +38,27 @@ HEADERS += \
     src/ecinidefs.h \
     src/ecproject.h \
     src/ecprojectstate.h \
+    src/engineoutput.h \
+    src/engineprogress.h \
+    src/enginerunprogress.h \
+    src/enginescheduler.h \
+    src/etcestimator.h \
     src/faderwidget.h \
+    src/filediscovery.h \
+    src/filenameprototype.h \
     src/fileutils.h \
+    src/headlessrunner.h \
+    src/incrementalrun.h \
     src/infomessage.h \
+    src/inifile.h \
     src/irga_delegate.h \
     src/irga_desc.h \
     src/irga_model.h \
     src/irga_tableview.h \
     src/irga_view.h \
     src/mainwindow.h \
+    src/metadatacheckdialog.h \
+    src/metadatascanner.h \
     src/mymenu.h \
     src/mystyle.h \
     src/mytabwidget.h \
@@ -52,13 +67,20 @@ HEADERS += \
     src/process.h \
     src/proxystyle.h \
     src/QProgressIndicator.h \
+    src/rawfilefilter.h \
+    src/rawfileindex.h \
     src/rawfilenamedialog.h \
     src/rawfilesettingsdialog.h \
+    src/resultcache.h \
+    src/runcatalog.h \
+    src/runchecks.h \
     src/runpage.h \
+    src/shardedrun.h \
     src/slowmeasuretab.h \
     src/specgroup.h \
     src/splitter.h \
     src/splitterhandle.h \
+    src/stageprofiler.h \
     src/stringutils.h \
     src/timelagsettingsdialog.h \
     src/tooltipfilter.h \
@@ -68,11 +90,14 @@ HEADERS += \
     src/variable_tableview.h \
     src/variable_view.h \
     src/wheeleventfilter.h \
+    src/ziparchivecache.h \
     src/smartfluxbar.h \
     src/mainwidget.h \
     src/welcomepage.h \
     src/projectpage.h \
     src/basicsettingspage.h \
+    src/batchqueue.h \
+    src/batchqueuepanel.h \
     src/advancedsettingspage.h \
     src/advstatisticaloptions.h \
     src/advprocessingoptions.h \
@@ -128,10 +153,13 @@ SOURCES +=  \
     src/binarysettingsdialog.cpp \
     src/biommetadatareader.cpp \
     src/clicklabel.cpp \
+    src/consolehistorydialog.cpp \
+    src/consolesink.cpp \
     src/customcombomodel.cpp \
     src/customheader.cpp \
     src/customsplashscreen.cpp \
     src/dbghelper.cpp \
+    src/dirscanner.cpp \
     src/dlinidialog.cpp \
     src/dlinstrtab.cpp \
     src/dlproject.cpp \
@@ -139,9 +167,19 @@ SOURCES +=  \
     src/dlsitetab.cpp \
     src/docchooser.cpp \
     src/ecproject.cpp \
+    src/engineoutput.cpp \
+    src/engineprogress.cpp \
+    src/enginerunprogress.cpp \
+    src/enginescheduler.cpp \
+    src/etcestimator.cpp \
     src/faderwidget.cpp \
+    src/filediscovery.cpp \
+    src/filenameprototype.cpp \
     src/fileutils.cpp \
+    src/headlessrunner.cpp \
+    src/incrementalrun.cpp \
     src/infomessage.cpp \
+    src/inifile.cpp \
     src/irga_delegate.cpp \
     src/irga_desc.cpp \
     src/irga_model.cpp \
@@ -149,19 +187,30 @@ SOURCES +=  \
     src/irga_view.cpp \
     src/main.cpp \
     src/mainwindow.cpp \
+    src/metadatacheckdialog.cpp \
+    src/metadatascanner.cpp \
     src/nonzerodoublespinbox.cpp \
     src/planarfitsettingsdialog.cpp \
     src/basicsettingspage.cpp \
+    src/batchqueue.cpp \
+    src/batchqueuepanel.cpp \
     src/process.cpp \
     src/proxystyle.cpp \
     src/QProgressIndicator.cpp \
+    src/rawfilefilter.cpp \
+    src/rawfileindex.cpp \
     src/rawfilenamedialog.cpp \
     src/rawfilesettingsdialog.cpp \
+    src/resultcache.cpp \
+    src/runcatalog.cpp \
+    src/runchecks.cpp \
     src/runpage.cpp \
+    src/shardedrun.cpp \
     src/slowmeasuretab.cpp \
     src/specgroup.cpp \
     src/splitter.cpp \
     src/splitterhandle.cpp \
+    src/stageprofiler.cpp \
     src/stringutils.cpp \
     src/timelagsettingsdialog.cpp \
     src/tooltipfilter.cpp \
@@ -171,6 +220,7 @@ SOURCES +=  \
     src/variable_tableview.cpp \
     src/variable_view.cpp \
     src/wheeleventfilter.cpp \
+    src/ziparchivecache.cpp \
     src/smartfluxbar.cpp \
     src/mainwidget.cpp \
     src/welcomepage.cpp \
@@ -74,14 +74,19 @@
 #include "dirbrowsewidget.h"
 #include "dlproject.h"
 #include "ecproject.h"
+#include "filediscovery.h"
 #include "fileformatwidget.h"
 #include "globalsettings.h"
 #include "infomessage.h"
+#include "metadatacheckdialog.h"
 #include "process.h"
+#include "rawfilefilter.h"
+#include "rawfileindex.h"
 #include "rawfilenamedialog.h"
 #include "smartfluxbar.h"
 #include "splitter.h"
 #include "widget_utils.h"
+#include "ziparchivecache.h"
 
 // for the qobject_cast in handleCrossWindAndAngleOfAttackUpdate()
 #include "mainwidget.h"
@@ -103,6 +108,8 @@ BasicSettingsPage::BasicSettingsPage(QWidget *parent, DlProject *dlProject, EcPr
     progressWidget_3(nullptr),
     currentRawDataList_(QStringList()),
     currentFilteredRawDataList_(QStringList()),
+    fileDiscovery_(nullptr),
+    metadataCheckDialog_(nullptr),
     biomList_(QList<BiomItem>())
 {
     DEBUG_FUNC_NAME
@@ -284,6 +291,12 @@ BasicSettingsPage::BasicSettingsPage(QWidget *parent, DlProject *dlProject, EcPr
     dateRangeDetectButton->setMaximumWidth(dateRangeDetectButton->sizeHint().width());
     dateRangeDetectButton->setToolTip(tr("<b>Detect Dataset Dates:</b> Click this button to ask EddyPro to retrieve the starting and ending date of the raw dataset contained in the <i>Raw data directory</i>. You can override this automatic setting by using the <i>Select a different period</i> option."));
 
+    metadataCheckButton = new QPushButton(tr("Check Metadata Consistency"));
+    metadataCheckButton->setProperty("mdButton", true);
+    metadataCheckButton->setMinimumWidth(metadataCheckButton->sizeHint().width());
+    metadataCheckButton->setMaximumWidth(metadataCheckButton->sizeHint().width());
+    metadataCheckButton->setToolTip(tr("<b>Check Metadata Consistency:</b> Click this button to read the metadata embedded in all the GHG files of the <i>Raw data directory</i> and to list the periods with identical metadata, so that changes of the instrument configuration during the campaign can be detected. Only applicable to raw files in LI-COR GHG format."));
+
     crossWindCheckBox = new QCheckBox(tr("Cross wind correction of sonic temperature applied by the anemometer firmware"));
     crossWindCheckBox->setToolTip(tr("<b>Cross-wind correction for sonic temperature:</b> Check this box if the crosswind correction is applied internally by the anemometer firmware before outputting sonic temperature. Be aware that some anemometers do apply the correction internally, others not, and others provide it as an option.<br />"
                                      "Users of Gill WindMaster and WindMaster Pro: the crosswind correction is not applied internally in anemometer units of type 1352, while it is available in the firmware of later types 1561 and 1590."));
@@ -367,6 +380,7 @@ BasicSettingsPage::BasicSettingsPage(QWidget *parent, DlProject *dlProject, EcPr
     filesInfoLayout->addWidget(previousDatapathLabel, 9, 0, Qt::AlignRight);
     filesInfoLayout->addWidget(questionMark_2, 9, 1, Qt::AlignLeft);
     filesInfoLayout->addWidget(previousDatapathBrowse, 9, 2, 1, 3);
+    filesInfoLayout->addWidget(metadataCheckButton, 10, 2, 1, 1, Qt::AlignLeft);
 
     filesInfoLayout->addWidget(maxLackLabel, 1, 5, Qt::AlignRight);
     filesInfoLayout->addWidget(maxLackSpin, 1, 7, 1, 1);
@@ -967,6 +981,14 @@ BasicSettingsPage::BasicSettingsPage(QWidget *parent, DlProject *dlProject, EcPr
     connect(datapathBrowse, &DirBrowseWidget::pathSelected,
             this, &BasicSettingsPage::datapathSelected);
 
+    fileDiscovery_ = new FileDiscovery(this);
+    connect(fileDiscovery_, &FileDiscovery::countChanged,
+            this, &BasicSettingsPage::updateFilesFoundLabel);
+    connect(fileDiscovery_, &FileDiscovery::finished,
+            this, &BasicSettingsPage::filesDiscoveryFinished);
+    connect(fileDiscovery_, &FileDiscovery::cancelled,
+            findFileProgressWidget, &QProgressIndicator::stopAnimation);
+
     connect(recursionCheckBox, &QCheckBox::toggled,
             this, &BasicSettingsPage::updateRecursion);
 
@@ -1015,6 +1037,8 @@ BasicSettingsPage::BasicSettingsPage(QWidget *parent, DlProject *dlProject, EcPr
 
     connect(dateRangeDetectButton, &QPushButton::clicked,
             this, &BasicSettingsPage::dateRangeDetect);
+    connect(metadataCheckButton, &QPushButton::clicked,
+            this, &BasicSettingsPage::checkMetadataConsistency);
 
     connect(startDateLabel, &ClickLabel::clicked,
             this, &BasicSettingsPage::onStartDateLabelClicked);
@@ -1302,6 +1326,13 @@ void BasicSettingsPage::datapathSelected(const QString& dir_path)
     // warning dialog
     if (handleVariableReset() == QMessageBox::Cancel) { return; }
 
+    // drop the search in the previous data path
+    fileDiscovery_->cancel();
+
+    // a selection lists the data path again in full, also the files
+    // modified in place
+    RawFileIndex::invalidate(configState_->general.env, dir_path);
+
     qDebug() << currentRawDataList_;
     currentRawDataList_.clear();
     qDebug() << currentRawDataList_;
@@ -1316,13 +1347,17 @@ void BasicSettingsPage::datapathSelected(const QString& dir_path)
     GlobalSettings::updateLastDatapath(canonicalDataDir);
 
     updateMetadataRead(true);
-    qDebug() << currentRawDataList_;
 
-    if (!currentRawDataList_.isEmpty()
-        || ecProject_->generalFileType() != Defs::RawFileType::GHG)
+    runWhenFilesFound([this]()
     {
-        setPrototype();
-    }
+        qDebug() << currentRawDataList_;
+
+        if (!currentRawDataList_.isEmpty()
+            || ecProject_->generalFileType() != Defs::RawFileType::GHG)
+        {
+            setPrototype();
+        }
+    });
 }
 
 void BasicSettingsPage::showSetPrototype()
@@ -1339,8 +1374,6 @@ void BasicSettingsPage::setPrototype(bool showDialog)
     // GHG case
     if (ecProject_->generalFileType() == Defs::RawFileType::GHG)
     {
-        // test if the raw data folder contains different file prototypes
-
         // get the ghg suffixes in case of raw data path selection
         // or empty raw data list
         if (currentRawDataList_.isEmpty())
@@ -1348,36 +1381,43 @@ void BasicSettingsPage::setPrototype(bool showDialog)
             updateFilesFound(ecProject_->screenRecurse());
         }
 
-        suffixList_ = getAvailableGhgSuffixes();
-        qDebug() << "suffixList_" << suffixList_;
+        runWhenFilesFound([this, showDialog]() { setGhgPrototype(showDialog); });
+        return;
+    }
 
-        // case 1: suffixes all identical
-        // then define the prototype using the std GHG timestamp
-        if (suffixList_.size() == 1)
-        {
-            qDebug() << "GHG case 1";
-            updateFilePrototypeEdit(Defs::GHG_TIMESTAMP_FORMAT + suffixList_.first());
+    // non GHG cases
+    askRawFilenamePrototype();
+    updateFilesFound(ecProject_->screenRecurse());
+}
 
-            if (showDialog)
-            {
-                askRawFilenamePrototype();
-            }
-            updateFilesFound(ecProject_->screenRecurse());
-            return;
-        }
-        // case 2: at least 2 different suffixes or no files found
-        else
+// test if the raw data folder contains different file prototypes
+void BasicSettingsPage::setGhgPrototype(bool showDialog)
+{
+    DEBUG_FUNC_NAME
+
+    suffixList_ = getAvailableGhgSuffixes();
+    qDebug() << "suffixList_" << suffixList_;
+
+    // case 1: suffixes all identical
+    // then define the prototype using the std GHG timestamp
+    if (suffixList_.size() == 1)
+    {
+        qDebug() << "GHG case 1";
+        updateFilePrototypeEdit(Defs::GHG_TIMESTAMP_FORMAT + suffixList_.first());
+
+        if (showDialog)
         {
-            qDebug() << "GHG case 2";
             askRawFilenamePrototype();
-            updateFilesFound(ecProject_->screenRecurse());
-            return;
         }
+        updateFilesFound(ecProject_->screenRecurse());
+    }
+    // case 2: at least 2 different suffixes or no files found
+    else
+    {
+        qDebug() << "GHG case 2";
+        askRawFilenamePrototype();
+        updateFilesFound(ecProject_->screenRecurse());
     }
-
-    // non GHG cases
-    askRawFilenamePrototype();
-    updateFilesFound(ecProject_->screenRecurse());
 }
 
 QStringList BasicSettingsPage::getAvailableGhgSuffixes()
@@ -1385,12 +1425,8 @@ QStringList BasicSettingsPage::getAvailableGhgSuffixes()
     DEBUG_FUNC_NAME
     // progressWidget_4->startAnimation();
     QFuture<QStringList> future = QtConcurrent::run(&FileUtils::getGhgFileSuffixList, currentRawDataList_);
-    while (!future.isFinished())
-    {
-        QCoreApplication::processEvents();
-    }
     // progressWidget_4->stopAnimation();
-    return future.result();
+    return FileUtils::waitForFuture(future);
 }
 
 void BasicSettingsPage::previousDatapathSelected(const QString& dir_path)
@@ -1407,25 +1443,17 @@ void BasicSettingsPage::previousDatapathSelected(const QString& dir_path)
 
 // search and open at least one zip file, extract and read the metadata files
 // inside it. with that information populate the group of combobox
-// with correct values and update the processing project
+// with correct values and update the processing project. the zip files
+// are the GHG files found by the search of updateMetadataRead()
 void BasicSettingsPage::captureEmbeddedMetadata(EmbeddedFileFlags type)
 {
     DEBUG_FUNC_NAME
 
-    QString ghgFormat = QStringLiteral("*.") + Defs::GHG_NATIVE_DATA_FILE_EXT;
     QString mdFormat = QStringLiteral("*.") + Defs::METADATA_FILE_EXT;
     QString biometMdFormat = QStringLiteral("*%1.%2")
                             .arg(Defs::DEFAULT_BIOMET_SUFFIX)
                             .arg(Defs::METADATA_FILE_EXT);
 
-    findFileProgressWidget->startAnimation();
-    currentRawDataList_ = FileUtils::getFiles(datapathBrowse->path(), ghgFormat, ecProject_->screenRecurse());
-    findFileProgressWidget->stopAnimation();
-
-    auto filesCount = currentRawDataList_.count();
-    updateFilesFoundLabel(filesCount);
-    updateProjectFilesFound(filesCount);
-
     QString mdFile;
     QString biometMdFile;
     bool hasMd = false;
@@ -1436,7 +1464,9 @@ void BasicSettingsPage::captureEmbeddedMetadata(EmbeddedFileFlags type)
 
         if (!hasMd && (type & rawEmbeddedFile))
         {
-            hasMd = FileUtils::zipContainsFiletype(zipFile, mdFormat);
+            hasMd = ZipArchiveCache::containsFiletype(configState_->general.env,
+                                                      zipFile,
+                                                      mdFormat);
             qDebug() << "hasMd" << hasMd;
             if (hasMd)
             {
@@ -1446,7 +1476,9 @@ void BasicSettingsPage::captureEmbeddedMetadata(EmbeddedFileFlags type)
 
         if (!hasBiometMd && (type & biometEmbeddedFile))
         {
-            hasBiometMd = FileUtils::zipContainsFiletype(zipFile, biometMdFormat);
+            hasBiometMd = ZipArchiveCache::containsFiletype(configState_->general.env,
+                                                            zipFile,
+                                                            biometMdFormat);
             qDebug() << "hasBiometMd" << hasBiometMd;
             if (hasBiometMd)
             {
@@ -1477,16 +1509,16 @@ void BasicSettingsPage::captureEmbeddedMetadata(EmbeddedFileFlags type)
         }
     }
 
+    // the next captures only list the archives added or modified
+    ZipArchiveCache::flush(configState_->general.env);
+
     // lastEmbeddedMdFileRead_ is a caching variable
     lastEmbeddedMdFileRead_ = mdFile;
     qDebug() << "lastEmbeddedMdFileRead_ 2" << lastEmbeddedMdFileRead_;
 
-    QString homePath;
-    homePath = configState_->general.env;
-
-    // dir from where we recover extracted metadata file
-    QString smfDir = homePath + QLatin1Char('/') + Defs::SMF_FILE_DIR;
-    QDir mdDir(smfDir);
+    // the metadata entries are read in memory, without extracting
+    // the archives and decompressing their data stream
+    const QString mdSuffix = QStringLiteral(".") + Defs::METADATA_FILE_EXT;
 
     if (type & rawEmbeddedFile)
     {
@@ -1509,43 +1541,23 @@ void BasicSettingsPage::captureEmbeddedMetadata(EmbeddedFileFlags type)
         }
         else
         {
-            FileUtils::zipExtract(mdFile, smfDir);
-
-            QStringList mdFilters;
-            mdFilters << QStringLiteral("*.") + Defs::METADATA_FILE_EXT;
-            mdDir.setNameFilters(mdFilters);
-            mdDir.setFilter(QDir::Files | QDir::NoSymLinks | QDir::NoDotAndDotDot);
-            mdDir.setSorting(QDir::Name | QDir::DirsLast);
+            auto mdEntryList = ZipArchiveCache::getFileList(configState_->general.env, mdFile);
+            mdEntryList.sort();
 
-            QStringList mdFileList = mdDir.entryList();
-
-            if (!mdFileList.isEmpty())
+            foreach (const QString& entry, mdEntryList)
             {
-                foreach (const QString& str, mdFileList)
+                // raw embedded metadata
+                if (entry.endsWith(mdSuffix)
+                    && !entry.contains(Defs::DEFAULT_BIOMET_SUFFIX))
                 {
-                    // raw embedded metadata
-                    if (!str.contains(Defs::DEFAULT_BIOMET_SUFFIX))
+                    QByteArray mdData;
+                    if (FileUtils::zipReadEntry(mdFile, entry, &mdData))
                     {
-                        if (type & rawEmbeddedFile)
-                        {
-                            mdFile = smfDir + QLatin1Char('/') + str;
-                            qDebug() << "mdFile" << mdFile;
-
-                            // skip reading in case of identical metadata file
-//                          if (!dlProject_->matchProjectFile(mdFile))
-//                          {
-//                              readEmbeddedMetadata(mdFile);
-//                          }
-
-                            readEmbeddedMetadata(mdFile);
-                        }
+                        qDebug() << "mdFile" << mdFile << entry;
+                        readEmbeddedMetadata(mdData, mdFile);
                     }
                 }
             }
-            else
-            {
-                // NOTE: discard silently
-            }
         }
     }
 
@@ -1573,48 +1585,32 @@ void BasicSettingsPage::captureEmbeddedMetadata(EmbeddedFileFlags type)
         }
         else
         {
-            FileUtils::zipExtract(biometMdFile, smfDir);
-
-            QStringList mdFilters;
-            mdFilters << QStringLiteral("*.") + Defs::METADATA_FILE_EXT;
-            mdDir.setNameFilters(mdFilters);
-            mdDir.setFilter(QDir::Files | QDir::NoSymLinks | QDir::NoDotAndDotDot);
-            mdDir.setSorting(QDir::Name | QDir::DirsLast);
-            QStringList mdFileList = mdDir.entryList();
+            auto mdEntryList = ZipArchiveCache::getFileList(configState_->general.env, biometMdFile);
+            mdEntryList.sort();
 
-            if (!mdFileList.isEmpty())
+            foreach (const QString& entry, mdEntryList)
             {
-                foreach (const QString& str, mdFileList)
+                if (entry.endsWith(mdSuffix)
+                    && entry.contains(Defs::DEFAULT_BIOMET_SUFFIX))
                 {
-                    if (str.contains(Defs::DEFAULT_BIOMET_SUFFIX))
+                    QByteArray mdData;
+                    if (FileUtils::zipReadEntry(biometMdFile, entry, &mdData))
                     {
-                        if (type & biometEmbeddedFile)
-                        {
-                            if (!mdFileList.filter(Defs::DEFAULT_BIOMET_SUFFIX).isEmpty())
-                            {
-                                biometMdFile = smfDir + QLatin1Char('/') + str;
-                                qDebug() << "biometMdFile" << biometMdFile;
-
-                                readBiomEmbMetadata(biometMdFile);
-                            }
-                        }
+                        qDebug() << "biometMdFile" << biometMdFile << entry;
+                        readBiomEmbMetadata(mdData);
                     }
                 }
             }
-            else
-            {
-                // NOTE: discard silently
-            }
         }
     }
 }
 
-void BasicSettingsPage::readEmbeddedMetadata(const QString& mdFile)
+void BasicSettingsPage::readEmbeddedMetadata(const QByteArray& mdData, const QString& mdFile)
 {
     DEBUG_FUNC_NAME
 
     bool modified = false;
-    if (dlProject_->loadProject(mdFile, false, &modified))
+    if (dlProject_->loadProjectData(mdData, mdFile, false, &modified))
     {
         parseMetadataProject(true);
     }
@@ -1647,7 +1643,7 @@ void BasicSettingsPage::readAlternativeMetadata(const QString& mdFile, bool firs
     }
 }
 
-void BasicSettingsPage::readBiomEmbMetadata(const QString& mdFile)
+void BasicSettingsPage::readBiomEmbMetadata(const QByteArray& mdData)
 {
     DEBUG_FUNC_NAME
 
@@ -1659,7 +1655,7 @@ void BasicSettingsPage::readBiomEmbMetadata(const QString& mdFile)
 
     BiomMetadataReader reader(&biomList_);
 
-    if (reader.readEmbMetadata(mdFile))
+    if (reader.readEmbMetadataData(mdData))
     {
         parseBiomMetadata();
     }
@@ -3829,6 +3825,27 @@ void BasicSettingsPage::updateMetadataRead(bool firstReading)
 {
     DEBUG_FUNC_NAME
 
+    // the embedded metadata are captured from the GHG files found.
+    // the files found label is updated while searching
+    const auto hasGhgData = !datapathBrowse->path().isEmpty()
+                            && ecProject_->generalFileType() == Defs::RawFileType::GHG
+                            && QDir(datapathBrowse->path()).exists();
+    if (hasGhgData
+        && (!ecProject_->generalUseAltMdFile() || ecProject_->generalUseBiomet() == 1))
+    {
+        startFilesDiscovery(QStringLiteral("*.") + Defs::GHG_NATIVE_DATA_FILE_EXT,
+                            ecProject_->screenRecurse());
+        runWhenFilesFound([this, firstReading]() { readMetadata(firstReading); });
+        return;
+    }
+
+    readMetadata(firstReading);
+}
+
+void BasicSettingsPage::readMetadata(bool firstReading)
+{
+    DEBUG_FUNC_NAME
+
     // save the modified flag to prevent side effects of setting widgets
     bool oldmod = ecProject_->modified();
     ecProject_->blockSignals(true);
@@ -3944,6 +3961,8 @@ void BasicSettingsPage::updateMetadataRead(bool firstReading)
     // restore modified flag
     ecProject_->setModified(oldmod);
     ecProject_->blockSignals(false);
+
+    emit metadataReadFinished();
 }
 
 void BasicSettingsPage::reloadSelectedItems_1()
@@ -4719,48 +4738,10 @@ void BasicSettingsPage::runUpdateFilesFound()
     updateFilesFound(ecProject_->screenRecurse());
 }
 
-// transform prototype p to a regular expression pattern
-QString BasicSettingsPage::prototypeToRegExp(const QString& p)
-{
-    auto pattern = p;
-
-    pattern.replace(QLatin1String("."), QLatin1String("[.]"));  // dot
-    pattern.replace(QLatin1String("?"), QLatin1String("."));    // single char
-    pattern.replace(QLatin1String("yyyy"), QLatin1String("(19[89][0-9]|20[0-9][0-9]|2100)")); // year 4 digits
-    pattern.replace(QLatin1String("yy"), QLatin1String("([0-9][0-9])"));         // year 2 digits
-    pattern.replace(QLatin1String("mm"), QLatin1String("(0[1-9]|1[012])"));    // month 2 digits
-    pattern.replace(QLatin1String("ddd"), QLatin1String("(00[1-9]|0[1-9][0-9]|[12][0-9][0-9]|3[0-5][0-9]|36[0-6])"));      // day of year 3 digits
-    pattern.replace(QLatin1String("dd"), QLatin1String("(0[1-9]|[1-2][0-9]|3[01])")); // day 2 digits
-    pattern.replace(QLatin1String("HH"), QLatin1String("([01][0-9]|2[0-4])")); // hours 2 digits
-    pattern.replace(QLatin1String("MM"), QLatin1String("([0-5][0-9])"));       // minutes 2 digits
-
-    return pattern;
-}
-
+// linear in the number of files, only the base names are matched
 QStringList BasicSettingsPage::filterRawDataWithPrototype(const QString& p)
 {
-    auto rePattern = prototypeToRegExp(p);
-    qDebug() << p << "rePattern" << rePattern;
-
-    QRegularExpression re;
-    re.setPattern(rePattern);
-    qDebug() << "re valid? " << re.isValid();
-
-    if (re.isValid())
-    {
-        currentFilteredRawDataList_ = currentRawDataList_;
-
-        foreach (const auto &filename, currentFilteredRawDataList_)
-        {
-            qDebug() << "filename" << filename;
-            if (!filename.contains(re))
-            {
-                qDebug() << "filtering";
-                currentFilteredRawDataList_.removeAll(filename);
-            }
-        }
-    }
-
+    currentFilteredRawDataList_ = RawFileFilter::filterWithPrototype(currentRawDataList_, p);
     return currentFilteredRawDataList_;
 }
 
@@ -4777,26 +4758,48 @@ void BasicSettingsPage::updateFilesFound(bool recursionToggled)
         return;
     }
 
-    auto fileCount = 0;
-
-    findFileProgressWidget->startAnimation();
-
     // first pass, filter by extension on the file system
+    QString extension;
     if (filePrototypeEdit->text().isEmpty())
     {
         if (ecProject_->generalFileType() == Defs::RawFileType::GHG)
         {
-            QString extension = QStringLiteral("*.") + Defs::GHG_NATIVE_DATA_FILE_EXT;
-            currentRawDataList_ = FileUtils::getFiles(datapathBrowse->path(), extension, recursionToggled);
+            extension = QStringLiteral("*.") + Defs::GHG_NATIVE_DATA_FILE_EXT;
         }
     }
     else
     {
         int extensionIndex = ecProject_->generalFilePrototype().lastIndexOf(QLatin1String(".")) + 1;
-        QString extension = QStringLiteral("*.") + ecProject_->generalFilePrototype().mid(extensionIndex);
-        currentRawDataList_ = FileUtils::getFiles(datapathBrowse->path(), extension, recursionToggled);
+        extension = QStringLiteral("*.") + ecProject_->generalFilePrototype().mid(extensionIndex);
+    }
+
+    if (extension.isEmpty())
+    {
+        filesDiscoveryFinished(currentRawDataList_);
+        return;
     }
 
+    startFilesDiscovery(extension, recursionToggled);
+}
+
+// the results arrive in filesDiscoveryFinished()
+void BasicSettingsPage::startFilesDiscovery(const QString& extension, bool recurse)
+{
+    fileDiscovery_->start(configState_->general.env,
+                          datapathBrowse->path(),
+                          extension,
+                          recurse);
+    findFileProgressWidget->startAnimation();
+}
+
+void BasicSettingsPage::filesDiscoveryFinished(const QStringList& files)
+{
+    DEBUG_FUNC_NAME
+
+    findFileProgressWidget->stopAnimation();
+
+    currentRawDataList_ = files;
+
     // second pass, filter the file list with a regexp
     if (filePrototypeEdit->text().isEmpty())
     {
@@ -4807,13 +4810,32 @@ void BasicSettingsPage::updateFilesFound(bool recursionToggled)
         currentFilteredRawDataList_ = filterRawDataWithPrototype(filePrototypeEdit->text());
     }
 
-    findFileProgressWidget->stopAnimation();
-
-    fileCount = currentFilteredRawDataList_.count();
+    auto fileCount = currentFilteredRawDataList_.count();
     qDebug() << "fileCount" << fileCount;
 
     updateFilesFoundLabel(fileCount);
     updateProjectFilesFound(fileCount);
+
+    // an action may start a new search, the next ones wait for it
+    while (!filesFoundActions_.isEmpty() && !fileDiscovery_->isRunning())
+    {
+        const auto action = filesFoundActions_.takeFirst();
+        action();
+    }
+}
+
+// in place of waiting in the GUI slots, the actions needing the complete
+// list of files run at the end of the current search, in order. a search
+// replaced by a new one passes them on to the latter
+void BasicSettingsPage::runWhenFilesFound(const std::function<void ()>& action)
+{
+    if (!fileDiscovery_->isRunning())
+    {
+        action();
+        return;
+    }
+
+    filesFoundActions_.append(action);
 }
 
 // called by:
@@ -4842,11 +4864,15 @@ void BasicSettingsPage::askRawFilenamePrototype()
                 this, &BasicSettingsPage::updateFilePrototypeEdit);
     }
 
-    rawFilenameDialog->refresh();
+    // the dialog shows the filtered files
+    runWhenFilesFound([this]()
+    {
+        rawFilenameDialog->refresh();
 
-    rawFilenameDialog->show();
-    rawFilenameDialog->raise();
-    rawFilenameDialog->activateWindow();
+        rawFilenameDialog->show();
+        rawFilenameDialog->raise();
+        rawFilenameDialog->activateWindow();
+    });
 }
 
 void BasicSettingsPage::fetchMagneticDeclination()
@@ -5206,6 +5232,9 @@ void BasicSettingsPage::clearDataSelection()
     int ret_code = acceptVariableReset();
     if (ret_code != QMessageBox::Ok) { return; }
 
+    fileDiscovery_->cancel();
+    filesFoundActions_.clear();
+
     datapathBrowse->clear();
     clearFilesFound();
     subsetCheckBox->setChecked(false);
@@ -5322,9 +5351,53 @@ void BasicSettingsPage::clearSelectedItems()
     ecProject_->setScreenFlag10Col(-1);
 }
 
+// group the GHG files by embedded metadata, to detect configuration
+// changes within the dataset
+void BasicSettingsPage::checkMetadataConsistency()
+{
+    DEBUG_FUNC_NAME
+
+    // the whole dataset, once found
+    if (fileDiscovery_->isRunning())
+    {
+        runWhenFilesFound([this]() { checkMetadataConsistency(); });
+        return;
+    }
+
+    if (ecProject_->generalFileType() != Defs::RawFileType::GHG
+        || currentFilteredRawDataList_.isEmpty())
+    {
+        WidgetUtils::warning(this,
+                             tr("Raw Data Missing"),
+                             tr("The selected directory doesn't "
+                                "contain any valid LI-COR GHG data."));
+        return;
+    }
+
+    if (!metadataCheckDialog_)
+    {
+        metadataCheckDialog_ = new MetadataCheckDialog(this);
+    }
+
+    metadataCheckDialog_->scan(configState_->general.env,
+                               currentFilteredRawDataList_,
+                               ecProject_->generalFilePrototype());
+    metadataCheckDialog_->show();
+    metadataCheckDialog_->raise();
+    metadataCheckDialog_->activateWindow();
+}
+
 void BasicSettingsPage::dateRangeDetect()
 {
     DEBUG_FUNC_NAME
+
+    // the whole dataset, once found
+    if (fileDiscovery_->isRunning())
+    {
+        runWhenFilesFound([this]() { dateRangeDetect(); });
+        return;
+    }
+
     qDebug() << "currentRawDataList_.isEmpty():" << currentRawDataList_.isEmpty();
 
     if (!currentRawDataList_.isEmpty())
@@ -5334,11 +5407,7 @@ void BasicSettingsPage::dateRangeDetect()
         FileUtils::DateRange dates;
 
         QFuture<FileUtils::DateRange> future = QtConcurrent::run(&FileUtils::getDateRangeFromFileList, currentRawDataList_, ecProject_->generalFilePrototype());
-        while (!future.isFinished())
-        {
-            QCoreApplication::processEvents();
-        }
-        dates = future.result();
+        dates = FileUtils::waitForFuture(future);
 
         progressWidget_2->stopAnimation();
 
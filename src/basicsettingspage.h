@@ -27,6 +27,7 @@
 #include <QDateTime>
 #include <QWidget>
 
+#include <functional>
 #include <vector>
 
 #include "fileutils.h"
@@ -70,8 +71,10 @@ class CustomClearLineEdit;
 class DirBrowseWidget;
 class DlProject;
 class EcProject;
+class FileDiscovery;
 class FileFormatWidget;
 class IrgaDesc;
+class MetadataCheckDialog;
 class RawFilenameDialog;
 class SmartFluxBar;
 class VariableDesc;
@@ -152,6 +155,7 @@ private:
 
     QCheckBox *subsetCheckBox;
     QPushButton* dateRangeDetectButton;
+    QPushButton* metadataCheckButton;
     QWidget* moreSubsetContainer;
     ClickLabel *startDateLabel;
     ClickLabel *endDateLabel;
@@ -286,6 +290,9 @@ private:
 
     QStringList currentRawDataList_;
     QStringList currentFilteredRawDataList_;
+    FileDiscovery* fileDiscovery_;
+    QList<std::function<void ()>> filesFoundActions_;
+    MetadataCheckDialog* metadataCheckDialog_;
 
     QList<BiomItem> biomList_;
 
@@ -307,10 +314,10 @@ private:
 
     void createQuestionMark();
 
-    void readEmbeddedMetadata(const QString& mdFile);
+    void readEmbeddedMetadata(const QByteArray& mdData, const QString& mdFile);
     void readAlternativeMetadata(const QString &mdFile, bool firstReading = false);
 
-    void readBiomEmbMetadata(const QString& mdFile);
+    void readBiomEmbMetadata(const QByteArray& mdData);
     bool readBiomAltMetadata(const QString& mdFile);
 
     void reloadSelectedItems_1();
@@ -330,12 +337,13 @@ private:
 
     void setSmartfluxUI(bool on);
     void setPrototype(bool showDialog = false);
+    void setGhgPrototype(bool showDialog);
+    void readMetadata(bool firstReading);
+    void runWhenFilesFound(const std::function<void ()>& action);
 
     QStringList getAvailableGhgSuffixes();
     QStringList filterRawDataWithPrototype(const QString &p);
 
-    QString prototypeToRegExp(const QString &p);
-
 private slots:
     void updateDataPath(const QString& dp);
     void updateRecursion(bool b);
@@ -449,6 +457,8 @@ private slots:
 
     void updateFilesFound(bool recursionToggled);
     void runUpdateFilesFound();
+    void startFilesDiscovery(const QString& extension, bool recurse);
+    void filesDiscoveryFinished(const QStringList& files);
 
     void fetchMagneticDeclination();
     void replyFinished(QNetworkReply* reply);
@@ -468,10 +478,12 @@ private slots:
     int handleVariableReset();
     int acceptVariableReset();
     void dateRangeDetect();
+    void checkMetadataConsistency();
     void clearFilePrototype();
 
 signals:
     void updateMetadataReadResult(bool b);
+    void metadataReadFinished();
     void setDateRangeRequest(FileUtils::DateRange);
     void saveSilentlyRequest();
 };
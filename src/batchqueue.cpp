@@ -0,0 +1,524 @@
+/***************************************************************************
+  batchqueue.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "batchqueue.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+
+#include "dbghelper.h"
+#include "defs.h"
+#include "ecproject.h"
+#include "enginescheduler.h"
+#include "runchecks.h"
+
+QDataStream& operator<<(QDataStream& out, const BatchQueue::Item& item)
+{
+    out << item.projectFile << static_cast<qint32>(item.status)
+        << item.spectralStep << item.periodIndex << item.periodCount
+        << item.started << item.finished;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, BatchQueue::Item& item)
+{
+    qint32 status = 0;
+    in >> item.projectFile >> status
+       >> item.spectralStep >> item.periodIndex >> item.periodCount
+       >> item.started >> item.finished;
+    item.status = static_cast<BatchQueue::Status>(status);
+    return in;
+}
+
+namespace
+{
+const quint32 QUEUE_MAGIC = 0x45504251; // "EPBQ"
+const quint16 QUEUE_VERSION = 1;
+
+QString queueFilePath(const QString& appEnvPath)
+{
+    return appEnvPath
+           + QLatin1Char('/')
+           + Defs::INI_FILE_DIR
+           + QStringLiteral("/batch_queue.dat");
+}
+
+QString engineWorkingDir()
+{
+    return qApp->applicationDirPath() + QLatin1Char('/') + Defs::BIN_FILE_DIR;
+}
+} // namespace
+
+BatchQueue::BatchQueue(const QString& appEnvPath,
+                       const ProjConfigState& projectConfig,
+                       QObject* parent) :
+    QObject(parent),
+    appEnvPath_(appEnvPath),
+    projectConfig_(projectConfig),
+    scheduler_(new EngineScheduler(this)),
+    active_(false)
+{
+    QStringList env = QProcess::systemEnvironment();
+    env << QStringLiteral("GFORTRAN_UNBUFFERED_PRECONNECTED=y");
+    env << QStringLiteral("GFORTRAN_SHOW_LOCUS=n");
+    scheduler_->setEnv(env);
+
+    // the projects of a batch are independent
+    scheduler_->setStopOnFailure(false);
+
+    connect(scheduler_, &EngineScheduler::jobStarted,
+            this, &BatchQueue::jobStarted);
+    connect(scheduler_, &EngineScheduler::jobOutput,
+            this, &BatchQueue::jobOutput);
+    connect(scheduler_, &EngineScheduler::jobFinished,
+            this, &BatchQueue::jobFinished);
+    connect(scheduler_, &EngineScheduler::paused,
+            this, &BatchQueue::paused);
+
+    load();
+}
+
+BatchQueue::~BatchQueue()
+{
+    DEBUG_FUNC_NAME
+
+    // keep the queue active, it restarts with the next session
+    scheduler_->stop();
+}
+
+QStringList BatchQueue::addProjects(const QStringList& files)
+{
+    DEBUG_FUNC_NAME
+
+    QStringList unreadableFiles;
+    foreach (const QString& file, files)
+    {
+        const auto projectFile = QFileInfo(file).absoluteFilePath();
+
+        auto queued = false;
+        foreach (const Item& item, items_)
+        {
+            if (item.projectFile == projectFile
+                && (item.status == Status::Waiting || item.status == Status::Running))
+            {
+                queued = true;
+                break;
+            }
+        }
+        if (queued)
+        {
+            continue;
+        }
+
+        EcProject project(nullptr, projectConfig_);
+        if (!project.loadEcProject(projectFile, false))
+        {
+            unreadableFiles << file;
+            continue;
+        }
+
+        Item item;
+        item.projectFile = projectFile;
+        item.spectralStep = (project.generalRunMode() == Defs::CurrRunMode::Advanced
+                             && project.isEngineStep2Needed());
+        items_.append(item);
+    }
+
+    save();
+    emit itemsChanged();
+
+    if (active_)
+    {
+        queueWaitingItems();
+    }
+    return unreadableFiles;
+}
+
+void BatchQueue::removeItem(int index)
+{
+    if (index < 0 || index >= items_.size() || items_.at(index).job >= 0)
+    {
+        return;
+    }
+
+    items_.remove(index);
+    save();
+    emit itemsChanged();
+}
+
+void BatchQueue::clearFinished()
+{
+    auto isFinished = [](const Item& item) {
+        return item.job < 0 && item.status != Status::Waiting;
+    };
+    items_.erase(std::remove_if(items_.begin(), items_.end(), isFinished), items_.end());
+
+    save();
+    emit itemsChanged();
+}
+
+void BatchQueue::start(int maxParallel)
+{
+    DEBUG_FUNC_NAME
+
+    if (!scheduler_->isRunning())
+    {
+        QStringList args;
+        args << QStringLiteral("-c");
+        args << QStringLiteral("gui");
+        args << QStringLiteral("-s");
+        args << Defs::HOST_OS;
+        args << QStringLiteral("-e");
+        args << appEnvPath_;
+
+        scheduler_->start(engineWorkingDir() + QLatin1Char('/') + Defs::ENGINE_RP,
+                          engineWorkingDir(),
+                          args,
+                          QStringList());
+    }
+    scheduler_->setMaxParallel(maxParallel);
+
+    setActive(true);
+    queueWaitingItems();
+}
+
+void BatchQueue::stop()
+{
+    DEBUG_FUNC_NAME
+
+    resume();
+    scheduler_->stop();
+
+    for (auto i = 0; i < items_.size(); ++i)
+    {
+        auto& item = items_[i];
+        if (item.job < 0)
+        {
+            continue;
+        }
+
+        item.job = -1;
+        if (item.status == Status::Running)
+        {
+            item.status = Status::Stopped;
+            item.finished = QDateTime::currentDateTime();
+            item.etcMSec = -1;
+        }
+        emit itemChanged(i);
+    }
+
+    setActive(false);
+}
+
+void BatchQueue::pause()
+{
+    DEBUG_FUNC_NAME
+
+    if (!active_ || scheduler_->isPaused())
+    {
+        return;
+    }
+    scheduler_->pause(Defs::CurrRunStatus::Express);
+}
+
+void BatchQueue::resume()
+{
+    DEBUG_FUNC_NAME
+
+    if (scheduler_->isPaused())
+    {
+        scheduler_->resume(Defs::CurrRunStatus::Express);
+    }
+}
+
+bool BatchQueue::isPaused() const
+{
+    return scheduler_->isPaused();
+}
+
+QString BatchQueue::statusString(Status status)
+{
+    switch (status)
+    {
+        case Status::Waiting:
+            return tr("Waiting");
+        case Status::Running:
+            return tr("Running");
+        case Status::Done:
+            return tr("Done");
+        case Status::Failed:
+            return tr("Failed");
+        case Status::Stopped:
+            return tr("Stopped");
+    }
+    return QString();
+}
+
+// give the waiting items to the scheduler, up to its free engines
+void BatchQueue::queueWaitingItems()
+{
+    auto queued = 0;
+    foreach (const Item& item, items_)
+    {
+        if (item.job >= 0)
+        {
+            ++queued;
+        }
+    }
+
+    for (auto i = 0; i < items_.size() && queued < scheduler_->maxParallel(); ++i)
+    {
+        if (items_.at(i).status != Status::Waiting || items_.at(i).job >= 0)
+        {
+            continue;
+        }
+
+        // the job may start and end at once, see jobFinished()
+        items_[i].inSpectralStep = false;
+        items_[i].job = scheduler_->jobCount();
+        scheduler_->addJob(items_.at(i).projectFile);
+        ++queued;
+    }
+
+    auto pending = false;
+    foreach (const Item& item, items_)
+    {
+        if (item.job >= 0 || item.status == Status::Waiting)
+        {
+            pending = true;
+            break;
+        }
+    }
+    if (!pending)
+    {
+        setActive(false);
+    }
+}
+
+void BatchQueue::jobStarted(int job)
+{
+    for (auto i = 0; i < items_.size(); ++i)
+    {
+        auto& item = items_[i];
+        if (item.job != job)
+        {
+            continue;
+        }
+
+        if (!item.inSpectralStep)
+        {
+            item.started = QDateTime::currentDateTime();
+            item.finished = QDateTime();
+        }
+        item.status = Status::Running;
+        item.periodIndex = 0;
+        item.periodCount = 0;
+        item.etcMSec = -1;
+        item.progress.reset();
+
+        save();
+        emit itemChanged(i);
+        return;
+    }
+}
+
+// progress of the item from the engine messages
+void BatchQueue::jobOutput(int job, const QByteArray& lines)
+{
+    for (auto i = 0; i < items_.size(); ++i)
+    {
+        auto& item = items_[i];
+        if (item.job != job)
+        {
+            continue;
+        }
+
+        auto changed = false;
+        foreach (const QByteArray& line, lines.split('\n'))
+        {
+            switch (item.progress.addLine(line))
+            {
+            case EngineRunProgress::Update::PhaseStarted:
+            case EngineRunProgress::Update::Totals:
+            case EngineRunProgress::Update::PeriodStarted:
+            case EngineRunProgress::Update::PeriodEnded:
+                item.periodIndex = item.progress.periodIndex();
+                item.periodCount = item.progress.periodCount();
+                item.etcMSec = item.progress.etcMSec();
+                changed = true;
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (changed)
+        {
+            emit itemChanged(i);
+        }
+        return;
+    }
+}
+
+void BatchQueue::jobFinished(int job, Process::ExitStatus status)
+{
+    DEBUG_FUNC_NAME
+
+    for (auto i = 0; i < items_.size(); ++i)
+    {
+        auto& item = items_[i];
+        if (item.job != job)
+        {
+            continue;
+        }
+
+        qDebug() << item.projectFile << static_cast<int>(status);
+
+        // the spectral corrections follow the raw processing
+        if (status == Process::ExitStatus::Success
+            && item.spectralStep
+            && !item.inSpectralStep
+            && prepareSpectralStep(item.projectFile))
+        {
+            item.inSpectralStep = true;
+            item.job = scheduler_->jobCount();
+            scheduler_->addJob(item.projectFile,
+                               engineWorkingDir() + QLatin1Char('/') + Defs::ENGINE_FCC);
+            return;
+        }
+
+        item.job = -1;
+        item.etcMSec = -1;
+        item.finished = QDateTime::currentDateTime();
+        switch (status)
+        {
+            case Process::ExitStatus::Success:
+                item.status = Status::Done;
+                break;
+            case Process::ExitStatus::Stopped:
+                item.status = Status::Stopped;
+                break;
+            default:
+                item.status = Status::Failed;
+                break;
+        }
+
+        save();
+        emit itemChanged(i);
+        break;
+    }
+
+    if (active_)
+    {
+        queueWaitingItems();
+    }
+}
+
+// same paths set by the GUI before the second step of an advanced run
+bool BatchQueue::prepareSpectralStep(const QString& projectFile)
+{
+    EcProject project(nullptr, projectConfig_);
+    if (!project.loadEcProject(projectFile, false))
+    {
+        return false;
+    }
+
+    RunChecks::useRawProcessingSpectra(&project);
+    return project.saveEcProject(projectFile);
+}
+
+void BatchQueue::setActive(bool active)
+{
+    if (active_ != active)
+    {
+        active_ = active;
+        emit activeChanged(active_);
+    }
+    save();
+}
+
+void BatchQueue::load()
+{
+    QFile file(queueFilePath(appEnvPath_));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_2);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != QUEUE_MAGIC || version != QUEUE_VERSION)
+    {
+        qDebug() << "Discarding batch queue" << file.fileName();
+        return;
+    }
+
+    bool active = false;
+    QVector<Item> items;
+    in >> active >> items;
+    if (in.status() != QDataStream::Ok)
+    {
+        return;
+    }
+
+    // the projects interrupted by the end of the session run again
+    for (auto& item : items)
+    {
+        if (item.status == Status::Running)
+        {
+            item.status = Status::Waiting;
+        }
+    }
+
+    items_ = items;
+    active_ = active;
+}
+
+bool BatchQueue::save() const
+{
+    const auto fileName = queueFilePath(appEnvPath_);
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Error: Cannot write batch queue" << fileName << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_2);
+    out << QUEUE_MAGIC << QUEUE_VERSION;
+    out << active_ << items_;
+
+    return file.commit();
+}
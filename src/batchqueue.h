@@ -0,0 +1,143 @@
+/***************************************************************************
+  batchqueue.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef BATCHQUEUE_H
+#define BATCHQUEUE_H
+
+#include <QDateTime>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include "configstate.h"
+#include "enginerunprogress.h"
+#include "process.h"
+
+class EngineScheduler;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/batchqueue.h
+/// \brief Queue of project files processed in batch
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note The projects of the queue are processed in order by a pool of
+/// engine processes, each one with the run mode saved in its file. The
+/// projects in advanced mode needing the spectral corrections run the
+/// second engine as soon as the first one ends. The queue is saved in the
+/// 'ini' subdirectory of the application environment at each change, so an
+/// active queue restarts with the GUI from the projects not completed.
+/// \sa EngineScheduler, BatchQueuePanel
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \class BatchQueue
+/// \brief Run many projects with a bounded pool of engines
+class BatchQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Status {
+        Waiting,
+        Running,
+        Done,
+        Failed,
+        Stopped
+    };
+
+    struct Item
+    {
+        QString projectFile;
+        Status status = Status::Waiting;
+        bool spectralStep = false;   // run the spectral corrections engine too
+        int periodIndex = 0;
+        int periodCount = 0;
+        QDateTime started;
+        QDateTime finished;
+
+        // state of the current run, not saved
+        int job = -1;               // scheduler job, -1 if not queued
+        qint64 etcMSec = -1;
+        EngineRunProgress progress;
+        bool inSpectralStep = false;
+    };
+
+    BatchQueue(const QString& appEnvPath,
+               const ProjConfigState& projectConfig,
+               QObject* parent = nullptr);
+    ~BatchQueue();
+
+    inline const QVector<Item>& items() const { return items_; }
+
+    // true if the queue was running, also in a previous session
+    inline bool isActive() const { return active_; }
+
+    // append the project files not already waiting. return the files that
+    // cannot be read
+    QStringList addProjects(const QStringList& files);
+    void removeItem(int index);
+    void clearFinished();
+
+    void start(int maxParallel);
+    void stop();
+
+    // pause or resume all the running projects at once. paused() follows
+    // pause() with the time to have all the engines stopped
+    void pause();
+    void resume();
+    bool isPaused() const;
+
+    static QString statusString(Status status);
+
+signals:
+    void itemsChanged();
+    void itemChanged(int index);
+    void activeChanged(bool active);
+    // latency in microseconds, -1 if unknown
+    void paused(qint64 latency);
+
+private slots:
+    void jobStarted(int job);
+    void jobOutput(int job, const QByteArray& lines);
+    void jobFinished(int job, Process::ExitStatus status);
+
+private:
+    void queueWaitingItems();
+    bool prepareSpectralStep(const QString& projectFile);
+    void setActive(bool active);
+    void load();
+    bool save() const;
+
+    QString appEnvPath_;
+    ProjConfigState projectConfig_;
+    EngineScheduler* scheduler_;
+    QVector<Item> items_;
+    QHash<int, int> jobItems_;  // scheduler job -> item
+    bool active_;
+};
+
+#endif // BATCHQUEUE_H
@@ -0,0 +1,290 @@
+/***************************************************************************
+  batchqueuepanel.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "batchqueuepanel.h"
+
+#include <QDebug>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QThread>
+#include <QTime>
+
+#include <algorithm>
+
+#include "batchqueue.h"
+#include "dbghelper.h"
+#include "defs.h"
+#include "globalsettings.h"
+#include "widget_utils.h"
+
+namespace
+{
+enum Column {
+    ProjectColumn,
+    StatusColumn,
+    ProgressColumn,
+    EtcColumn,
+    ColumnCount
+};
+} // namespace
+
+BatchQueuePanel::BatchQueuePanel(BatchQueue* queue, QWidget* parent) :
+    QWidget(parent),
+    queue_(queue)
+{
+    table_ = new QTableWidget(0, ColumnCount);
+    table_->setHorizontalHeaderLabels(QStringList()
+                                      << tr("Project")
+                                      << tr("Status")
+                                      << tr("Progress")
+                                      << tr("Time to Completion"));
+    table_->horizontalHeader()->setSectionResizeMode(ProjectColumn, QHeaderView::Stretch);
+    table_->verticalHeader()->setVisible(false);
+    table_->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+
+    addButton_ = new QPushButton(tr("Add..."));
+    addButton_->setProperty("mdButton", true);
+    removeButton_ = new QPushButton(tr("Remove"));
+    removeButton_->setProperty("mdButton", true);
+    clearButton_ = new QPushButton(tr("Clear Completed"));
+    clearButton_->setProperty("mdButton", true);
+    startButton_ = new QPushButton(tr("Start"));
+    startButton_->setProperty("mdButton", true);
+    pauseButton_ = new QPushButton(tr("Pause"));
+    pauseButton_->setProperty("mdButton", true);
+    stopButton_ = new QPushButton(tr("Stop"));
+    stopButton_->setProperty("mdButton", true);
+
+    auto parallelLabel = new QLabel(tr("Engines:"));
+    parallelSpin_ = new QSpinBox;
+    parallelSpin_->setRange(1, qMax(1, QThread::idealThreadCount()));
+    parallelSpin_->setValue(GlobalSettings::getAppPersistentSettings(
+                                Defs::CONFGROUP_PROJECT,
+                                Defs::CONF_PROJ_BATCH_PARALLELISM,
+                                1).toInt());
+    parallelSpin_->setToolTip(tr("Number of projects processed at the same time."));
+
+    pauseLabel_ = new QLabel;
+
+    auto buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(addButton_);
+    buttonLayout->addWidget(removeButton_);
+    buttonLayout->addWidget(clearButton_);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(pauseLabel_);
+    buttonLayout->addWidget(parallelLabel);
+    buttonLayout->addWidget(parallelSpin_);
+    buttonLayout->addWidget(startButton_);
+    buttonLayout->addWidget(pauseButton_);
+    buttonLayout->addWidget(stopButton_);
+
+    auto layout = new QVBoxLayout;
+    layout->addWidget(table_);
+    layout->addLayout(buttonLayout);
+    setLayout(layout);
+
+    connect(addButton_, &QPushButton::clicked,
+            this, &BatchQueuePanel::addProjects);
+    connect(removeButton_, &QPushButton::clicked,
+            this, &BatchQueuePanel::removeProjects);
+    connect(clearButton_, &QPushButton::clicked,
+            queue_, &BatchQueue::clearFinished);
+    connect(startButton_, &QPushButton::clicked,
+            this, &BatchQueuePanel::startQueue);
+    connect(pauseButton_, &QPushButton::clicked,
+            this, &BatchQueuePanel::pauseQueue);
+    connect(stopButton_, &QPushButton::clicked,
+            queue_, &BatchQueue::stop);
+    connect(table_, &QTableWidget::itemSelectionChanged,
+            this, &BatchQueuePanel::refreshButtons);
+
+    connect(queue_, &BatchQueue::itemsChanged,
+            this, &BatchQueuePanel::refreshTable);
+    connect(queue_, &BatchQueue::itemChanged,
+            this, &BatchQueuePanel::refreshRow);
+    connect(queue_, &BatchQueue::activeChanged,
+            this, &BatchQueuePanel::refreshButtons);
+    connect(queue_, &BatchQueue::paused,
+            this, &BatchQueuePanel::showPaused);
+
+    refreshTable();
+}
+
+void BatchQueuePanel::addProjects()
+{
+    const auto files = QFileDialog::getOpenFileNames(this,
+                        tr("Add %1 Project Files to the Batch").arg(Defs::APP_NAME),
+                        WidgetUtils::getSearchPathHint(),
+                        tr("%1 Project Files (*.%2);;All Files (*.*)").arg(Defs::APP_NAME, Defs::PROJECT_FILE_EXT));
+    if (files.isEmpty()) { return; }
+
+    const auto unreadableFiles = queue_->addProjects(files);
+    if (!unreadableFiles.isEmpty())
+    {
+        WidgetUtils::warning(this,
+                             tr("Batch Processing"),
+                             tr("Unable to read some project files. "
+                                "They are not added to the batch."),
+                             unreadableFiles.join(QLatin1Char('\n')));
+    }
+}
+
+void BatchQueuePanel::removeProjects()
+{
+    QList<int> rows;
+    foreach (const QModelIndex& index, table_->selectionModel()->selectedRows())
+    {
+        rows << index.row();
+    }
+
+    // from the last, so the other indexes stay valid
+    std::sort(rows.begin(), rows.end());
+    for (auto it = rows.crbegin(); it != rows.crend(); ++it)
+    {
+        queue_->removeItem(*it);
+    }
+}
+
+void BatchQueuePanel::startQueue()
+{
+    GlobalSettings::setAppPersistentSettings(Defs::CONFGROUP_PROJECT,
+                                             Defs::CONF_PROJ_BATCH_PARALLELISM,
+                                             parallelSpin_->value());
+    queue_->start(parallelSpin_->value());
+}
+
+void BatchQueuePanel::pauseQueue()
+{
+    if (queue_->isPaused())
+    {
+        queue_->resume();
+    }
+    else
+    {
+        queue_->pause();
+    }
+    refreshButtons();
+}
+
+void BatchQueuePanel::showPaused(qint64 latency)
+{
+    pauseLabel_->setText((latency < 0) ? tr("Paused")
+                                       : tr("Paused in %1 ms").arg(latency / 1000.0, 0, 'f', 1));
+}
+
+void BatchQueuePanel::refreshTable()
+{
+    const auto count = queue_->items().size();
+    table_->setRowCount(count);
+    for (auto row = 0; row < count; ++row)
+    {
+        for (auto column = 0; column < ColumnCount; ++column)
+        {
+            if (!table_->item(row, column))
+            {
+                table_->setItem(row, column, new QTableWidgetItem);
+            }
+        }
+        refreshRow(row);
+    }
+    refreshButtons();
+}
+
+void BatchQueuePanel::refreshRow(int index)
+{
+    if (index < 0 || index >= table_->rowCount())
+    {
+        return;
+    }
+
+    const auto& item = queue_->items().at(index);
+
+    table_->item(index, ProjectColumn)->setText(QFileInfo(item.projectFile).fileName());
+    table_->item(index, ProjectColumn)->setToolTip(item.projectFile);
+
+    auto status = BatchQueue::statusString(item.status);
+    if (item.status == BatchQueue::Status::Running && item.inSpectralStep)
+    {
+        status = tr("Spectral corrections");
+    }
+    table_->item(index, StatusColumn)->setText(status);
+    if (item.finished.isValid())
+    {
+        table_->item(index, StatusColumn)->setToolTip(tr("Ended at %1")
+                                                      .arg(item.finished.toString(Qt::ISODate)));
+    }
+
+    QString progress;
+    if (item.periodCount > 0)
+    {
+        progress = tr("%1 of %2 periods").arg(qMin(item.periodIndex, item.periodCount))
+                                         .arg(item.periodCount);
+    }
+    table_->item(index, ProgressColumn)->setText(progress);
+
+    QString etc;
+    if (item.status == BatchQueue::Status::Running && item.etcMSec >= 0)
+    {
+        etc = QTime(0, 0).addMSecs(static_cast<int>(item.etcMSec % (24 * 3600 * 1000)))
+                         .toString(QStringLiteral("hh:mm:ss"));
+        const auto days = item.etcMSec / (24 * 3600 * 1000);
+        if (days > 0)
+        {
+            etc.prepend(tr("%1 d ").arg(days));
+        }
+    }
+    table_->item(index, EtcColumn)->setText(etc);
+
+    refreshButtons();
+}
+
+void BatchQueuePanel::refreshButtons()
+{
+    const auto active = queue_->isActive();
+
+    auto removable = !table_->selectionModel()->selectedRows().isEmpty();
+    foreach (const QModelIndex& index, table_->selectionModel()->selectedRows())
+    {
+        if (queue_->items().at(index.row()).job >= 0)
+        {
+            removable = false;
+        }
+    }
+
+    removeButton_->setEnabled(removable);
+    startButton_->setEnabled(!active && !queue_->items().isEmpty());
+    pauseButton_->setEnabled(active);
+    pauseButton_->setText(queue_->isPaused() ? tr("Resume") : tr("Pause"));
+    stopButton_->setEnabled(active);
+    if (!queue_->isPaused())
+    {
+        pauseLabel_->clear();
+    }
+    parallelSpin_->setEnabled(!active);
+}
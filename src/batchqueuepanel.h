@@ -0,0 +1,66 @@
+/***************************************************************************
+  batchqueuepanel.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef BATCHQUEUEPANEL_H
+#define BATCHQUEUEPANEL_H
+
+#include <QWidget>
+
+class QLabel;
+class QPushButton;
+class QSpinBox;
+class QTableWidget;
+
+class BatchQueue;
+
+/// \class BatchQueuePanel
+/// \brief Table of the batch queue with the buttons to edit and run it
+class BatchQueuePanel : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit BatchQueuePanel(BatchQueue* queue, QWidget* parent = nullptr);
+
+private slots:
+    void addProjects();
+    void removeProjects();
+    void startQueue();
+    void pauseQueue();
+    void showPaused(qint64 latency);
+    void refreshTable();
+    void refreshRow(int index);
+    void refreshButtons();
+
+private:
+    BatchQueue* queue_;
+    QTableWidget* table_;
+    QSpinBox* parallelSpin_;
+    QPushButton* addButton_;
+    QPushButton* removeButton_;
+    QPushButton* clearButton_;
+    QPushButton* startButton_;
+    QPushButton* pauseButton_;
+    QPushButton* stopButton_;
+    QLabel* pauseLabel_;
+};
+
+#endif // BATCHQUEUEPANEL_H
@@ -24,10 +24,10 @@
 
 #include <QDebug>
 #include <QFile>
-#include <QSettings>
 
 #include "bminidefs.h"
 #include "dbghelper.h"
+#include "inifile.h"
 
 const QString BiomMetadataReader::getVAR_TA()
 {
@@ -83,8 +83,15 @@ bool BiomMetadataReader::readEmbMetadata(const QString& fileName)
         return false;
     }
 
+    return readEmbMetadataData(dataFile.readAll());
+}
+
+bool BiomMetadataReader::readEmbMetadataData(const QByteArray& data)
+{
+    DEBUG_FUNC_NAME
+
     // read file
-    QSettings settings(fileName, QSettings::IniFormat);
+    IniFile settings(data);
 
     // try old format first
     settings.beginGroup(BmIni::INIGROUP_VARS_OLD);
@@ -160,7 +167,6 @@ bool BiomMetadataReader::readEmbMetadata(const QString& fileName)
         biomMetadata_->append(BiomItem(var, id, k + 1));
     }
     settings.endGroup();
-    dataFile.close();
 
     return true;
 }
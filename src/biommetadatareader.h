@@ -23,6 +23,7 @@
 #ifndef BIOMMETADATAREADER_H
 #define BIOMMETADATAREADER_H
 
+#include <QByteArray>
 #include <QList>
 #include <QStringList>
 
@@ -34,6 +35,8 @@ public:
     explicit BiomMetadataReader(QList<BiomItem>* biomMetadata);
 
     bool readEmbMetadata(const QString& fileName);
+    // metadata file content already in memory (e.g. from a GHG archive)
+    bool readEmbMetadataData(const QByteArray& data);
     bool readAltMetadata(const QString& fileName);
 
     static const QString getVAR_TA();
@@ -0,0 +1,164 @@
+/***************************************************************************
+  consolehistorydialog.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "consolehistorydialog.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QGridLayout>
+#include <QLabel>
+#include <QPlainTextEdit>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QTextCursor>
+
+#include "widget_utils.h"
+
+namespace
+{
+const qint64 CHUNK_SIZE = 256 * 1024;
+} // namespace
+
+ConsoleHistoryDialog::ConsoleHistoryDialog(const QStringList& logFiles, QWidget* parent) :
+    QDialog(parent),
+    files_(logFiles),
+    totalSize_(0),
+    loadedFrom_(0)
+{
+    setWindowTitle(tr("Console History"));
+    WidgetUtils::removeContextHelpButton(this);
+
+    // the sizes at opening, the lines logged later are not shown
+    foreach (const auto& file, files_)
+    {
+        fileSizes_.append(QFileInfo(file).size());
+        totalSize_ += fileSizes_.last();
+    }
+    loadedFrom_ = totalSize_;
+
+    view_ = new QPlainTextEdit;
+    view_->setObjectName(QStringLiteral("consoleDockEdit"));
+    view_->setReadOnly(true);
+    view_->setLineWrapMode(QPlainTextEdit::NoWrap);
+    view_->setUndoRedoEnabled(false);
+    view_->setMinimumSize(640, 400);
+
+    sizeLabel_ = new QLabel;
+
+    loadButton_ = new QPushButton(tr("Load Earlier"));
+    loadButton_->setProperty("mdButton", true);
+    loadButton_->setMaximumWidth(loadButton_->sizeHint().width());
+
+    auto closeButton = WidgetUtils::createCommonButton(this, tr("Close"));
+
+    auto dialogLayout = new QGridLayout(this);
+    dialogLayout->addWidget(view_, 0, 0, 1, -1);
+    dialogLayout->addWidget(sizeLabel_, 1, 0);
+    dialogLayout->addWidget(loadButton_, 1, 1, Qt::AlignRight);
+    dialogLayout->addWidget(closeButton, 2, 0, 1, -1, Qt::AlignCenter);
+    setLayout(dialogLayout);
+
+    connect(loadButton_, &QPushButton::clicked,
+            this, &ConsoleHistoryDialog::loadEarlier);
+    connect(view_->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &ConsoleHistoryDialog::scrolled);
+    connect(closeButton, &QPushButton::clicked,
+            this, &ConsoleHistoryDialog::accept);
+
+    loadEarlier();
+    view_->moveCursor(QTextCursor::End);
+}
+
+void ConsoleHistoryDialog::scrolled(int value)
+{
+    if (value == view_->verticalScrollBar()->minimum() && loadedFrom_ > 0)
+    {
+        loadEarlier();
+    }
+}
+
+// prepend the chunk before the lines shown, from a line start
+void ConsoleHistoryDialog::loadEarlier()
+{
+    if (loadedFrom_ <= 0)
+    {
+        return;
+    }
+
+    auto from = qMax(Q_INT64_C(0), loadedFrom_ - CHUNK_SIZE);
+    auto chunk = readRange(from, loadedFrom_);
+    if (from > 0)
+    {
+        // the partial first line comes with the next chunk
+        const auto lineStart = chunk.indexOf('\n') + 1;
+        if (lineStart > 0)
+        {
+            chunk.remove(0, lineStart);
+            from += lineStart;
+        }
+    }
+    loadedFrom_ = from;
+
+    // keep the lines in view where they are
+    auto scrollBar = view_->verticalScrollBar();
+    const auto previousMaximum = scrollBar->maximum();
+    const auto previousValue = scrollBar->value();
+
+    QTextCursor cursor(view_->document());
+    cursor.movePosition(QTextCursor::Start);
+    cursor.insertText(QString::fromUtf8(chunk));
+
+    scrollBar->setValue(previousValue + scrollBar->maximum() - previousMaximum);
+    updateLabel();
+}
+
+QByteArray ConsoleHistoryDialog::readRange(qint64 from, qint64 to) const
+{
+    QByteArray data;
+    qint64 fileStart = 0;
+    for (auto i = 0; i < files_.size() && fileStart < to; ++i)
+    {
+        const auto fileEnd = fileStart + fileSizes_.at(i);
+        if (fileEnd > from)
+        {
+            QFile file(files_.at(i));
+            if (file.open(QIODevice::ReadOnly))
+            {
+                const auto start = qMax(from, fileStart) - fileStart;
+                file.seek(start);
+                data += file.read(qMin(to, fileEnd) - fileStart - start);
+            }
+        }
+        fileStart = fileEnd;
+    }
+    return data;
+}
+
+void ConsoleHistoryDialog::updateLabel()
+{
+    const auto toMiB = [](qint64 bytes) { return QString::number(bytes / 1048576.0, 'f', 1); };
+
+    sizeLabel_->setText(tr("Showing the last %1 MB of %2 MB")
+                        .arg(toMiB(totalSize_ - loadedFrom_))
+                        .arg(toMiB(totalSize_)));
+    loadButton_->setEnabled(loadedFrom_ > 0);
+}
@@ -0,0 +1,78 @@
+/***************************************************************************
+  consolehistorydialog.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef CONSOLEHISTORYDIALOG_H
+#define CONSOLEHISTORYDIALOG_H
+
+#include <QDialog>
+#include <QStringList>
+#include <QVector>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/consolehistorydialog.h
+/// \brief Viewer of the console log files
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note The log files are read as one stream, from the end backwards, a
+/// chunk at a time when the view is scrolled to the top, so that the
+/// history of long runs opens at once whatever its size.
+/// \sa ConsoleSink
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+class QLabel;
+class QPlainTextEdit;
+class QPushButton;
+
+/// \class ConsoleHistoryDialog
+/// \brief Show the console history from its log files, loaded lazily
+class ConsoleHistoryDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // the log files, the oldest first
+    ConsoleHistoryDialog(const QStringList& logFiles, QWidget* parent = nullptr);
+
+private slots:
+    void loadEarlier();
+    void scrolled(int value);
+
+private:
+    QByteArray readRange(qint64 from, qint64 to) const;
+    void updateLabel();
+
+    QStringList files_;
+    QVector<qint64> fileSizes_;
+    qint64 totalSize_;
+    qint64 loadedFrom_;    // stream offset of the first line shown
+
+    QPlainTextEdit* view_;
+    QLabel* sizeLabel_;
+    QPushButton* loadButton_;
+};
+
+#endif // CONSOLEHISTORYDIALOG_H
@@ -0,0 +1,180 @@
+/***************************************************************************
+  consolesink.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "consolesink.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QPlainTextEdit>
+#include <QTimer>
+
+namespace
+{
+// about a frame, so the console repaints once for all the lines received
+const int FLUSH_INTERVAL_MSEC = 33;
+} // namespace
+
+ConsoleSink::ConsoleSink(QPlainTextEdit* console, const QString& logFilePath, QObject* parent) :
+    QObject(parent),
+    console_(console),
+    flushTimer_(new QTimer(this)),
+    maxLines_(10000),
+    logFile_(logFilePath),
+    maxLogSize_(8 * 1024 * 1024),
+    maxLogFiles_(4)
+{
+    flushTimer_->setSingleShot(true);
+    flushTimer_->setInterval(FLUSH_INTERVAL_MSEC);
+    connect(flushTimer_, &QTimer::timeout,
+            this, &ConsoleSink::flush);
+
+    console_->setMaximumBlockCount(maxLines_);
+}
+
+ConsoleSink::~ConsoleSink()
+{
+    // the console may be gone already, the log only
+    if (!pendingLines_.isEmpty())
+    {
+        writeLog(pendingLines_.join(QLatin1Char('\n')) + QLatin1Char('\n'));
+    }
+    logFile_.close();
+}
+
+void ConsoleSink::setMaxLines(int lines)
+{
+    maxLines_ = qMax(100, lines);
+    console_->setMaximumBlockCount(maxLines_);
+}
+
+void ConsoleSink::setLogLimits(qint64 fileSize, int fileCount)
+{
+    maxLogSize_ = fileSize;
+    maxLogFiles_ = qMax(0, fileCount);
+}
+
+QStringList ConsoleSink::logFiles() const
+{
+    QStringList files;
+    for (auto i = maxLogFiles_; i > 0; --i)
+    {
+        if (QFileInfo::exists(rotatedLogPath(i)))
+        {
+            files << rotatedLogPath(i);
+        }
+    }
+    if (QFileInfo::exists(logFile_.fileName()))
+    {
+        files << logFile_.fileName();
+    }
+    return files;
+}
+
+void ConsoleSink::appendLine(const QString& line)
+{
+    pendingLines_.append(line);
+
+    // the lines beyond the console capacity would be dropped at once
+    if (pendingLines_.size() > maxLines_)
+    {
+        writeLog(pendingLines_.takeFirst() + QLatin1Char('\n'));
+    }
+
+    if (!flushTimer_->isActive())
+    {
+        flushTimer_->start();
+    }
+}
+
+void ConsoleSink::flush()
+{
+    flushTimer_->stop();
+    if (pendingLines_.isEmpty())
+    {
+        return;
+    }
+
+    const auto text = pendingLines_.join(QLatin1Char('\n'));
+    pendingLines_.clear();
+
+    // one layout and repaint for the whole batch
+    console_->appendPlainText(text);
+    writeLog(text + QLatin1Char('\n'));
+}
+
+void ConsoleSink::clear()
+{
+    flush();
+    console_->clear();
+}
+
+void ConsoleSink::writeLog(const QString& text)
+{
+    if (!logFile_.isOpen())
+    {
+        if (!logFile_.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        {
+            return;
+        }
+    }
+
+    logFile_.write(text.toUtf8());
+    logFile_.flush();
+
+    if (maxLogSize_ > 0 && logFile_.size() > maxLogSize_)
+    {
+        rotateLog();
+    }
+}
+
+// console.log -> console.1.log -> console.2.log ..., the oldest removed
+void ConsoleSink::rotateLog()
+{
+    logFile_.close();
+
+    QFile::remove(rotatedLogPath(maxLogFiles_));
+    for (auto i = maxLogFiles_ - 1; i > 0; --i)
+    {
+        QFile::rename(rotatedLogPath(i), rotatedLogPath(i + 1));
+    }
+
+    if (maxLogFiles_ > 0)
+    {
+        if (!QFile::rename(logFile_.fileName(), rotatedLogPath(1)))
+        {
+            qWarning() << "Unable to rotate" << logFile_.fileName();
+        }
+    }
+    else
+    {
+        logFile_.remove();
+    }
+}
+
+QString ConsoleSink::rotatedLogPath(int index) const
+{
+    QFileInfo info(logFile_.fileName());
+    return info.absolutePath() + QLatin1Char('/')
+           + info.completeBaseName() + QLatin1Char('.')
+           + QString::number(index) + QLatin1Char('.')
+           + info.suffix();
+}
@@ -0,0 +1,92 @@
+/***************************************************************************
+  consolesink.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef CONSOLESINK_H
+#define CONSOLESINK_H
+
+#include <QFile>
+#include <QObject>
+#include <QStringList>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/consolesink.h
+/// \brief Bounded, batched output of the engine lines to the console
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note The lines received in a frame are appended to the console at once
+/// and to a log file rotated by size. The console keeps the last lines
+/// only, the log files keep the full history for ConsoleHistoryDialog.
+/// \sa MainWindow, ConsoleHistoryDialog
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+class QPlainTextEdit;
+class QTimer;
+
+/// \class ConsoleSink
+/// \brief Feed a console widget and a rotating log file with output lines
+class ConsoleSink : public QObject
+{
+    Q_OBJECT
+
+public:
+    ConsoleSink(QPlainTextEdit* console, const QString& logFilePath, QObject* parent = nullptr);
+    ~ConsoleSink();
+
+    // lines kept by the console, the older ones are dropped
+    void setMaxLines(int lines);
+    int maxLines() const { return maxLines_; }
+
+    // size in bytes of a log file before rotation, and number of the
+    // rotated files kept besides the current one
+    void setLogLimits(qint64 fileSize, int fileCount);
+
+    // the log files, the oldest first
+    QStringList logFiles() const;
+
+public slots:
+    void appendLine(const QString& line);
+    void flush();
+
+    // the console only, the log keeps the history
+    void clear();
+
+private:
+    void writeLog(const QString& text);
+    void rotateLog();
+    QString rotatedLogPath(int index) const;
+
+    QPlainTextEdit* console_;
+    QTimer* flushTimer_;
+    QStringList pendingLines_;
+    int maxLines_;
+
+    QFile logFile_;
+    qint64 maxLogSize_;
+    int maxLogFiles_;
+};
+
+#endif // CONSOLESINK_H
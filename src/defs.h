@@ -212,6 +212,7 @@ namespace Defs
     const auto TMP_FILE_DIR         = QStringLiteral("tmp");
     const auto SMF_FILE_DIR         = QStringLiteral("smf");
     const auto CAL_FILE_DIR         = QStringLiteral("cal");
+    const auto IDX_FILE_DIR         = QStringLiteral("idx");
     const auto TRANSLATION_FILE_DIR = QStringLiteral("tra");
     const auto DOC_DIR              = QStringLiteral("docs");
     const auto TEMPLATE_FILE_DIR    = QStringLiteral("file-templates/");
@@ -292,11 +293,18 @@ namespace Defs
     const auto CONF_PROJ_SMARTFLUX      = QStringLiteral("/smartflux");
     const auto CONF_PROJ_SMARTFLUX_FILENAME = QStringLiteral("/smartflux_filename");
     const auto CONF_PROJ_SMARTFLUX_FILEPATH = QStringLiteral("/smartflux_filepath");
+    const auto CONF_PROJ_RESULT_CACHE   = QStringLiteral("/result_cache");
+    const auto CONF_PROJ_APPEND_RUN     = QStringLiteral("/append_new_data");
+    const auto CONF_PROJ_ENGINE_PARALLELISM = QStringLiteral("/engine_parallelism");
+    const auto CONF_PROJ_BATCH_PARALLELISM = QStringLiteral("/batch_parallelism");
+    const auto CONF_PROJ_ENGINE_MEMORY_BUDGET = QStringLiteral("/engine_memory_budget");
+    const auto CONF_PROJ_ENGINE_IO_BUDGET = QStringLiteral("/engine_io_budget");
 
     const auto CONFGROUP_WINDOW          = QStringLiteral("/window");
     const auto CONF_WIN_STATUSBAR        = QStringLiteral("/status_bar");
     const auto CONF_WIN_FULLSCREEN       = QStringLiteral("/full_screen");
     const auto CONF_WIN_CONSOLEDOCK      = QStringLiteral("/console_dock");
+    const auto CONF_WIN_CONSOLE_LINES    = QStringLiteral("/console_lines");
     const auto CONF_WIN_TOOLTIPS         = QStringLiteral("/tooltips");
     const auto CONF_WIN_INFODOCK         = QStringLiteral("/info_dock");
     const auto CONF_WIN_MAINWIN_STATE    = QStringLiteral("/mainwin_state");
@@ -30,11 +30,14 @@
 #include <QGridLayout>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QPainter>
 #include <QPushButton>
 #include <QTimeEdit>
 #include <QTimer>
 #include <QtConcurrent>
 
+#include <algorithm>
+
 #include "clicklabel.h"
 #include "dbghelper.h"
 #include "defs.h"
@@ -492,9 +495,79 @@ void DetectDateRangeDialog::createCurrentRange()
     gridLayout->setColumnStretch(6, 1);
     gridLayout->setVerticalSpacing(3);
 
+    if (!availability_.dailyFiles.isEmpty())
+    {
+        auto summaryLabel = new QLabel;
+        auto summary = tr("%1 files in %2 days").arg(availability_.fileCount)
+                                                .arg(availability_.dailyFiles.size());
+        if (availability_.gapCount > 0)
+        {
+            summary += tr(", %1 days without data in %2 gaps, longest %3 days from %4")
+                           .arg(availability_.emptyDays)
+                           .arg(availability_.gapCount)
+                           .arg(availability_.longestGapDays)
+                           .arg(availability_.longestGapStart.toString(Qt::ISODate));
+        }
+        summaryLabel->setText(summary);
+
+        gridLayout->addWidget(createAvailabilityHistogram(), 3, 0, 1, -1);
+        gridLayout->addWidget(summaryLabel, 4, 0, 1, -1);
+    }
+
     dialogLayout->addLayout(gridLayout, 2, 0);
 }
 
+// files per day between the first and the last day with data,
+// binned when there are more days than pixels
+QLabel* DetectDateRangeDialog::createAvailabilityHistogram()
+{
+    const auto width = 400;
+    const auto height = 36;
+
+    const auto& dailyFiles = availability_.dailyFiles;
+    const auto firstDay = dailyFiles.firstKey();
+    const auto dayCount = firstDay.daysTo(dailyFiles.lastKey()) + 1;
+    const auto daysPerColumn = qMax<qint64>(1, (dayCount + width - 1) / width);
+    const auto columnCount = static_cast<int>((dayCount + daysPerColumn - 1) / daysPerColumn);
+
+    QVector<int> columns(columnCount, 0);
+    for (auto it = dailyFiles.constBegin(); it != dailyFiles.constEnd(); ++it)
+    {
+        columns[static_cast<int>(firstDay.daysTo(it.key()) / daysPerColumn)] += it.value();
+    }
+    const auto maxFiles = *std::max_element(columns.constBegin(), columns.constEnd());
+
+    QPixmap pixmap(width, height);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    const auto columnWidth = static_cast<qreal>(width) / columnCount;
+    for (auto i = 0; i < columnCount; ++i)
+    {
+        const auto x = i * columnWidth;
+        if (columns.at(i) == 0)
+        {
+            // mark the missing data at the baseline
+            painter.fillRect(QRectF(x, height - 2, qMax(columnWidth, 1.0), 2),
+                             QColor(QStringLiteral("#FF3300")));
+            continue;
+        }
+        const auto barHeight = qMax(1.0, static_cast<qreal>(height) * columns.at(i) / maxFiles);
+        painter.fillRect(QRectF(x, height - barHeight, qMax(columnWidth, 1.0), barHeight),
+                         QColor(QStringLiteral("#67c2ee")));
+    }
+    painter.end();
+
+    auto histogramLabel = new QLabel;
+    histogramLabel->setPixmap(pixmap);
+    histogramLabel->setToolTip(tr("<b>Data availability:</b> Number of raw files per day "
+                                  "from %1 to %2. Days without data are marked in red.")
+                                   .arg(firstDay.toString(Qt::ISODate))
+                                   .arg(dailyFiles.lastKey().toString(Qt::ISODate)));
+    histogramLabel->setStyleSheet(QStringLiteral("QLabel { margin-top: 10px; }"));
+    return histogramLabel;
+}
+
 void DetectDateRangeDialog::showDateRange(DateRangeType type)
 {
     switch (type) {
@@ -599,9 +672,11 @@ void DetectDateRangeDialog::showDateRange(DateRangeType type)
     }
 }
 
-void DetectDateRangeDialog::setCurrentRange(FileUtils::DateRange currentRange)
+void DetectDateRangeDialog::setCurrentRange(FileUtils::DateRange currentRange,
+                                            const FileUtils::DataAvailability& availability)
 {
     availableDataRange_ = currentRange;
+    availability_ = availability;
     createCurrentRange();
 }
 
@@ -674,11 +749,7 @@ FileUtils::DateRange DetectDateRangeDialog::getBinnedCospectraDateRange()
             = QtConcurrent::run(&FileUtils::getDateRangeFromFileList,
                                 binnedCospectraDataList,
                                 QStringLiteral("yyyymmdd-HHMM_binned_cospectra_2015-03-16T094426_adv.csv"));
-        while (!future.isFinished())
-        {
-            QCoreApplication::processEvents();
-        }
-        dates = future.result();
+        dates = FileUtils::waitForFuture(future);
 
         // correct the start/end date accounting for file duration
         if (dlProject_->timestampEnd() == 0)
@@ -45,7 +45,8 @@ public:
 
 //    void setLabel(const QString& label);
     void showDateRange(DateRangeType type);
-    void setCurrentRange(FileUtils::DateRange currentRange);
+    void setCurrentRange(FileUtils::DateRange currentRange,
+                         const FileUtils::DataAvailability& availability = FileUtils::DataAvailability());
 
 signals:
     void alignDeclinationRequest(const QDate& d);
@@ -80,9 +81,11 @@ private:
                             const QDate &end_date,
                             const QTime &end_time);
     void createCurrentRange();
+    QLabel* createAvailabilityHistogram();
     bool isSpectraSubsetPosssible();
 
     FileUtils::DateRange availableDataRange_;
+    FileUtils::DataAvailability availability_;
     QPushButton *setAsCurrentRangeButton;
     QPushButton *okButton;
 //    QLabel *msgLabel;
@@ -0,0 +1,391 @@
+/***************************************************************************
+  dirscanner.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "dirscanner.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+
+#if defined(Q_OS_UNIX)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+#include "dbghelper.h"
+
+DirScanner::DirScanner() :
+    pending_(0),
+    queued_(0),
+    cancelled_(0),
+    batchSize_(256)
+{
+    pool_.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+DirScanner::~DirScanner()
+{
+    cancel();
+    pool_.waitForDone();
+}
+
+void DirScanner::setBatchSize(int size)
+{
+    batchSize_ = qMax(1, size);
+}
+
+void DirScanner::cancel()
+{
+    cancelled_.storeRelease(1);
+}
+
+bool DirScanner::isCancelled() const
+{
+    return cancelled_.loadAcquire() != 0;
+}
+
+QStringList DirScanner::scan(const QString& dirPath,
+                             const QString& nameFilter,
+                             bool recurse,
+                             const BatchCallback& callback)
+{
+    DEBUG_FUNC_NAME
+
+    result_.clear();
+    batch_.clear();
+
+    if (dirPath.isEmpty() || nameFilter.isEmpty())
+    {
+        return result_;
+    }
+
+    nameFilter_ = nameFilter;
+    callback_ = callback;
+
+    // the usual "*.ext" filter is tested with a plain suffix comparison
+    suffix_.clear();
+    if (nameFilter.startsWith(QLatin1String("*."))
+        && nameFilter.indexOf(QLatin1Char('*'), 1) < 0
+        && !nameFilter.contains(QLatin1Char('?'))
+        && !nameFilter.contains(QLatin1Char('[')))
+    {
+        suffix_ = nameFilter.mid(1);
+    }
+
+    visit(dirPath, [this, recurse](const QString& dir) -> QStringList
+    {
+        Listing listing;
+        if (!listDir(dir, false, &listing))
+        {
+            qDebug() << "Cannot open dir" << dir;
+            return QStringList();
+        }
+
+        QStringList found;
+        for (const auto& file : listing.files)
+        {
+            if (matches(file.name))
+            {
+                found.append(dir + QLatin1Char('/') + file.name);
+            }
+        }
+        collect(found, false);
+
+        return recurse ? listing.subdirs : QStringList();
+    });
+    collect(QStringList(), true);
+    callback_ = BatchCallback();
+
+    // worker interleaving is not deterministic
+    result_.sort();
+    qDebug() << "files found" << result_.size();
+
+    return result_;
+}
+
+void DirScanner::visit(const QString& dirPath, const DirVisitor& visitor)
+{
+    cancelled_.storeRelease(0);
+
+    // the calling thread is worker 0
+    const auto workers = qMax(1, pool_.maxThreadCount());
+
+    queues_.clear();
+    for (auto i = 0; i < workers; ++i)
+    {
+        queues_.push_back(std::unique_ptr<WorkQueue>(new WorkQueue));
+    }
+
+    pending_.storeRelease(0);
+    queued_.storeRelease(0);
+    pushDir(0, QDir::cleanPath(QDir(dirPath).absolutePath()));
+
+    for (auto i = 1; i < workers; ++i)
+    {
+        QtConcurrent::run(&pool_, [this, i, &visitor]() { worker(i, visitor); });
+    }
+    worker(0, visitor);
+    pool_.waitForDone();
+
+    queues_.clear();
+}
+
+void DirScanner::worker(int index, const DirVisitor& visitor)
+{
+    QString dir;
+    while (true)
+    {
+        if (takeDir(index, &dir))
+        {
+            // a cancelled scan drains the queues without listing
+            if (!isCancelled())
+            {
+                const auto subdirs = visitor(dir);
+                for (const auto& sub : subdirs)
+                {
+                    pushDir(index, dir + QLatin1Char('/') + sub);
+                }
+            }
+            doneDir();
+            continue;
+        }
+
+        // wait for a dir to steal, or for the last one to be listed
+        QMutexLocker locker(&idleMutex_);
+        while (queued_.loadAcquire() == 0 && pending_.loadAcquire() > 0)
+        {
+            dirQueued_.wait(&idleMutex_);
+        }
+        if (pending_.loadAcquire() == 0)
+        {
+            break;
+        }
+    }
+}
+
+// pop from the back of the own queue, steal from the front of the others
+bool DirScanner::takeDir(int index, QString* dir)
+{
+    {
+        auto queue = queues_[index].get();
+        QMutexLocker locker(&queue->mutex);
+        if (!queue->dirs.isEmpty())
+        {
+            *dir = queue->dirs.takeLast();
+            queued_.deref();
+            return true;
+        }
+    }
+
+    const auto count = static_cast<int>(queues_.size());
+    for (auto i = 1; i < count; ++i)
+    {
+        auto victim = queues_[(index + i) % count].get();
+        QMutexLocker locker(&victim->mutex);
+        if (!victim->dirs.isEmpty())
+        {
+            *dir = victim->dirs.takeFirst();
+            queued_.deref();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void DirScanner::pushDir(int index, const QString& dir)
+{
+    // account the dir before it becomes visible to the other workers
+    pending_.ref();
+
+    {
+        auto queue = queues_[index].get();
+        QMutexLocker locker(&queue->mutex);
+        queue->dirs.append(dir);
+        queued_.ref();
+    }
+
+    QMutexLocker locker(&idleMutex_);
+    dirQueued_.wakeOne();
+}
+
+// the last dir listed releases all the idle workers
+void DirScanner::doneDir()
+{
+    if (!pending_.deref())
+    {
+        QMutexLocker locker(&idleMutex_);
+        dirQueued_.wakeAll();
+    }
+}
+
+bool DirScanner::matches(const QString& fileName) const
+{
+    if (!suffix_.isEmpty())
+    {
+        return fileName.endsWith(suffix_, Qt::CaseInsensitive);
+    }
+    return QDir::match(nameFilter_, fileName);
+}
+
+// add the files found to the result, and pass them to the callback in
+// batches. flush passes the last incomplete batch
+void DirScanner::collect(const QStringList& found, bool flush)
+{
+    QMutexLocker locker(&resultMutex_);
+    result_.append(found);
+
+    if (!callback_)
+    {
+        return;
+    }
+
+    batch_.append(found);
+    if ((flush && !batch_.isEmpty()) || batch_.size() >= batchSize_)
+    {
+        if (!isCancelled() && !callback_(batch_))
+        {
+            cancel();
+        }
+        batch_.clear();
+    }
+}
+
+// hidden entries and symlinks are skipped
+// as done by QDirIterator with QDir::Files | QDir::NoSymLinks
+bool DirScanner::listDir(const QString& dir, bool withStat, Listing* listing)
+{
+    listing->files.clear();
+    listing->subdirs.clear();
+
+#if defined(Q_OS_UNIX)
+    const auto encodedDir = QFile::encodeName(dir);
+    DIR* d = ::opendir(encodedDir.constData());
+    if (!d)
+    {
+        return false;
+    }
+    const auto fd = ::dirfd(d);
+
+    while (auto entry = ::readdir(d))
+    {
+        const char* name = entry->d_name;
+
+        // '.', '..' and hidden entries
+        if (name[0] == '.')
+        {
+            continue;
+        }
+
+        struct stat st;
+        auto statDone = false;
+        auto type = entry->d_type;
+        if (type == DT_UNKNOWN)
+        {
+            // the file system doesn't fill d_type
+            if (::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+            {
+                continue;
+            }
+            statDone = true;
+            if (S_ISDIR(st.st_mode))
+            {
+                type = DT_DIR;
+            }
+            else if (S_ISREG(st.st_mode))
+            {
+                type = DT_REG;
+            }
+        }
+
+        if (type == DT_DIR)
+        {
+            listing->subdirs.append(QFile::decodeName(name));
+        }
+        else if (type == DT_REG)
+        {
+            File file;
+            file.name = QFile::decodeName(name);
+            if (withStat
+                && (statDone || ::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0))
+            {
+                file.size = st.st_size;
+#if defined(Q_OS_MAC)
+                const auto& mtime = st.st_mtimespec;
+#else
+                const auto& mtime = st.st_mtim;
+#endif
+                file.modified = static_cast<qint64>(mtime.tv_sec) * 1000
+                                + mtime.tv_nsec / 1000000;
+            }
+            listing->files.append(file);
+        }
+    }
+
+    ::closedir(d);
+
+    const auto byName = [](const File& a, const File& b) { return a.name < b.name; };
+    std::sort(listing->files.begin(), listing->files.end(), byName);
+    listing->subdirs.sort();
+#else
+    const QDir d(dir);
+    if (!d.exists())
+    {
+        return false;
+    }
+
+    // the entries come with their size and time, no extra stat
+    const auto infoList = d.entryInfoList(QDir::Files
+                                          | QDir::Dirs
+                                          | QDir::NoSymLinks
+                                          | QDir::NoDotAndDotDot,
+                                          QDir::Name);
+    for (const auto& info : infoList)
+    {
+        if (info.isDir())
+        {
+            listing->subdirs.append(info.fileName());
+            continue;
+        }
+
+        File file;
+        file.name = info.fileName();
+        if (withStat)
+        {
+            file.size = info.size();
+            file.modified = info.lastModified().toMSecsSinceEpoch();
+        }
+        listing->files.append(file);
+    }
+#endif
+
+    return true;
+}
@@ -0,0 +1,146 @@
+/***************************************************************************
+  dirscanner.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef DIRSCANNER_H
+#define DIRSCANNER_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/dirscanner.h
+/// \brief Parallel directory scanner
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note Every worker owns a queue of directories to list: it pushes and
+/// pops subdirectories at the back of its own queue and, when empty, steals
+/// from the front of the other queues, or sleeps until a directory is
+/// queued. On POSIX systems the entries are read with readdir() and
+/// classified by d_type, so regular files are not stat'ed unless their size
+/// and time are requested. The matching files are streamed in batches while
+/// the scan goes on. RawFileIndex refreshes its directory trees through
+/// visit(), which lets the caller decide the subdirectories to enter.
+/// \sa FileUtils::getDirContent, RawFileIndex
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \class DirScanner
+/// \brief Multithreaded, work-stealing replacement of QDirIterator for
+/// file searches by extension
+class DirScanner
+{
+public:
+    struct File
+    {
+        QString name;
+        qint64 size = -1;       // -1 if not stat'ed
+        qint64 modified = -1;   // msec since epoch, -1 if not stat'ed
+    };
+
+    // regular files and subdirs of a directory, hidden entries and
+    // symlinks skipped, sorted by name
+    struct Listing
+    {
+        QVector<File> files;
+        QStringList subdirs;
+    };
+
+    // called with the matching files as they are found, one call at a time
+    // from the worker threads. return false to cancel the scan
+    using BatchCallback = std::function<bool (const QStringList& files)>;
+
+    // called concurrently from the worker threads with the absolute path of
+    // each visited directory. return the names of its subdirs to visit
+    using DirVisitor = std::function<QStringList (const QString& dir)>;
+
+    DirScanner();
+    ~DirScanner();
+
+    // files per call of the batch callback, 256 by default
+    void setBatchSize(int size);
+    inline int batchSize() const { return batchSize_; }
+
+    // nameFilter = "*.ext", same convention of FileUtils::getFiles().
+    // the result is sorted, partial if the callback cancelled the scan
+    QStringList scan(const QString& dirPath,
+                     const QString& nameFilter,
+                     bool recurse,
+                     const BatchCallback& callback = BatchCallback());
+
+    // visit dirPath and the subdirs returned by the visitor, in parallel
+    void visit(const QString& dirPath, const DirVisitor& visitor);
+
+    // safe to call from any thread, also from the callbacks. the directories
+    // queued are dropped, the ones being listed are completed
+    void cancel();
+    bool isCancelled() const;
+
+    // list a single directory, false if it cannot be opened. the files
+    // are stat'ed only if withStat is true
+    static bool listDir(const QString& dir, bool withStat, Listing* listing);
+
+private:
+    Q_DISABLE_COPY(DirScanner)
+
+    struct WorkQueue
+    {
+        QMutex mutex;
+        QStringList dirs;
+    };
+
+    void worker(int index, const DirVisitor& visitor);
+    bool takeDir(int index, QString* dir);
+    void pushDir(int index, const QString& dir);
+    void doneDir();
+    bool matches(const QString& fileName) const;
+    void collect(const QStringList& found, bool flush);
+
+    QThreadPool pool_;
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    QAtomicInt pending_;    // dirs queued or being listed
+    QAtomicInt queued_;     // dirs queued
+    QAtomicInt cancelled_;
+    QMutex idleMutex_;
+    QWaitCondition dirQueued_;
+
+    QMutex resultMutex_;
+    QStringList result_;
+    QStringList batch_;
+    BatchCallback callback_;
+    int batchSize_;
+    QString nameFilter_;
+    QString suffix_;
+};
+
+#endif // DIRSCANNER_H
@@ -25,11 +25,11 @@
 
 #include <QDebug>
 #include <QRegularExpression>
-#include <QSettings>
 
 #include "dbghelper.h"
 #include "dlinidefs.h"
 #include "fileutils.h"
+#include "inifile.h"
 #include "mainwindow.h"
 #include "stringutils.h"
 #include "widget_utils.h"
@@ -391,17 +391,6 @@ bool DlProject::loadProject(const QString& filename, bool checkVersion, bool *mo
 {
     DEBUG_FUNC_NAME
 
-    auto parent = static_cast<MainWindow*>(this->parent());
-    if (parent == nullptr) { return false; }
-
-    bool isVersionCompatible = true;
-    bool alreadyChecked = false;
-
-    qDebug() << "initial isVersionCompatible:" << isVersionCompatible;
-    qDebug() << "initial modified:" << *modified;
-    qDebug() << "checkVersion:" << checkVersion;
-    qDebug() << "firstReading:" << firstReading;
-
     // open file
     QFile datafile(filename);
     if (!datafile.open(QIODevice::ReadOnly | QIODevice::Text))
@@ -416,10 +405,29 @@ bool DlProject::loadProject(const QString& filename, bool checkVersion, bool *mo
         return false;
     }
 
+    return loadProjectData(datafile.readAll(), filename, checkVersion, modified, firstReading);
+}
+
+// filename is the origin of data, used when the project has no valid file name
+bool DlProject::loadProjectData(const QByteArray& data, const QString& filename, bool checkVersion, bool *modified, bool firstReading)
+{
+    DEBUG_FUNC_NAME
+
+    auto parent = static_cast<MainWindow*>(this->parent());
+    if (parent == nullptr) { return false; }
+
+    bool isVersionCompatible = true;
+    bool alreadyChecked = false;
+
+    qDebug() << "initial isVersionCompatible:" << isVersionCompatible;
+    qDebug() << "initial modified:" << *modified;
+    qDebug() << "checkVersion:" << checkVersion;
+    qDebug() << "firstReading:" << firstReading;
+
     QDateTime now = QDateTime::currentDateTime();
     QString now_str = now.toString(Qt::ISODate);
 
-    QSettings project_ini(filename, QSettings::IniFormat);
+    IniFile project_ini(data);
 
     // in case of old non existing file name, use the current existing
     QString projectFilename = project_ini.value(DlIni::INI_GENE_FILE_NAME, QString()).toString();
@@ -900,8 +908,6 @@ bool DlProject::loadProject(const QString& filename, bool checkVersion, bool *mo
         }
     project_ini.endGroup();
 
-    datafile.close();
-
     hasGoodWindComponentsAndTemperature();
 
     // just loaded projects are not modified
@@ -966,36 +972,6 @@ bool DlProject::nativeFormat(const QString& filename)
     return true;
 }
 
-// insert tag for native file identification
-bool DlProject::tagProject(const QString& filename)
-{
-    QFile datafile(filename);
-    if (!datafile.open(QIODevice::ReadWrite | QIODevice::Text))
-    {
-        // error opening file
-        qWarning() << "Error: Cannot tag file" << filename;
-        WidgetUtils::warning(nullptr,
-                             tr("Write Metadata Error"),
-                             tr("Cannot write file <p>%1:</p>\n<b>%2</b>")
-                             .arg(filename)
-                             .arg(datafile.errorString()));
-        datafile.close();
-        return false;
-    }
-
-    QString app_tag(Defs::GHG_MD_INI_TAG);
-    app_tag += QLatin1String("\n");
-
-    QTextStream out(&datafile);
-    QString textfile = out.readAll();
-    textfile.prepend(app_tag);
-    datafile.resize(0);
-    out << textfile;
-    datafile.close();
-
-    return true;
-}
-
 // Save a project
 bool DlProject::saveProject(const QString& filename)
 {
@@ -1005,7 +981,12 @@ bool DlProject::saveProject(const QString& filename)
     QString now_str = now.toString(Qt::ISODate);
     QFileInfo fileinfo = QFileInfo(filename);
 
-    QSettings project_ini(filename, QSettings::IniFormat);
+    // keep the keys of an existing file not written below
+    IniFile project_ini;
+    if (fileinfo.exists())
+    {
+        project_ini.load(filename);
+    }
 
     // general section
     project_ini.beginGroup(DlIni::INIGROUP_PROJECT);
@@ -1258,16 +1239,17 @@ bool DlProject::saveProject(const QString& filename)
         }
     project_ini.endGroup();
 
-    // sync and close the ini file
-    project_ini.sync();
-
-    // native file tag insertion
-    bool result = tagProject(filename);
-    if (!result)
+    // tagged file written in a single pass, replacing the previous one
+    // only when complete
+    if (!project_ini.save(filename, Defs::GHG_MD_INI_TAG))
     {
+        qWarning() << "Error: Cannot write file" << filename;
         WidgetUtils::warning(nullptr,
                              tr("Write Metadata Error"),
-                             tr("Unable to tag project file!"));
+                             tr("Cannot write file <p>%1:</p>\n<b>%2</b>")
+                             .arg(filename)
+                             .arg(project_ini.errorString()));
+        return false;
     }
 
     hasGoodWindComponentsAndTemperature();
@@ -2261,7 +2243,7 @@ int DlProject::countInstruments(const QStringList& list)
     return i;
 }
 
-DlProject::InstrumentType DlProject::getInstrumentType(const QSettings& iniGroup, const QString& prefix)
+DlProject::InstrumentType DlProject::getInstrumentType(const IniFile& iniGroup, const QString& prefix)
 {
     if (iniGroup.contains(prefix + DlIni::INI_ANEM_6))
     {
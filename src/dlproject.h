@@ -33,7 +33,7 @@
 #include "irga_desc.h"      // NOTE: for IrgaDescList, maybe to fix
 #include "variable_desc.h"  // NOTE: for VariableDescList, maybe to fix
 
-class QSettings;
+class IniFile;
 
 using AnemComponents = QMultiHash<QString, int>;
 
@@ -63,10 +63,10 @@ public:
     void newProject(const ProjConfigState &project_config);
     // load a project
     bool loadProject(const QString& filename, bool checkVersion = true, bool *modified = nullptr, bool firstReading = false);
+    // load a project already read in memory (e.g. from a GHG archive)
+    bool loadProjectData(const QByteArray& data, const QString& filename, bool checkVersion = true, bool *modified = nullptr, bool firstReading = false);
     // save the current project
     bool saveProject(const QString& filename);
-    // insert tag for native format files
-    bool tagProject(const QString& filename);
     // is the file in native format?
     bool nativeFormat(const QString& filename);
 
@@ -214,7 +214,7 @@ private:
     QString fromIniVariableInstrument(const QString& s);
 
     int countInstruments(const QStringList& list);
-    InstrumentType getInstrumentType(const QSettings& iniGroup, const QString& prefix);
+    InstrumentType getInstrumentType(const IniFile& iniGroup, const QString& prefix);
     InstrumentType getInstrumentTypeFromModel(const QString& model);
 
     QString fromIniIrgaManufacturer(const QString& s);
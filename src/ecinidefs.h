@@ -101,6 +101,7 @@ namespace EcIni
     const auto INI_PROJECT_67   = QStringLiteral("hf_correct_ghg_zoh");
     const auto INI_PROJECT_68   = QStringLiteral("sonic_output_rate");
     const auto INI_PROJECT_69   = QStringLiteral("col_diag_anem");
+    const auto INI_PROJECT_70   = QStringLiteral("settings_fingerprint");
 
     const auto INIGROUP_SPEC_SETTINGS = QStringLiteral("FluxCorrection_SpectralAnalysis_General");
     const auto INI_SPEC_SETTINGS_0    = QStringLiteral("sa_start_date");
@@ -23,22 +23,125 @@
 
 #include "ecproject.h"
 
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDebug>
-#include <QSettings>
+
+#include <algorithm>
+#include <iterator>
 
 #include "dbghelper.h"
 #include "ecinidefs.h"
 #include "fileutils.h"
+#include "inifile.h"
 #include "mainwindow.h"
 #include "stringutils.h"
 #include "widget_utils.h"
 
+namespace
+{
+// bump when the canonical form of the settings changes
+// 2: software major.minor version included
+const auto FINGERPRINT_VERSION = QStringLiteral("2");
+
+// project identity, run control and location of previous results,
+// which do not change the processing results
+bool isFingerprintExcluded(const QString& key)
+{
+    static const QStringList excludedKeys
+    {
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_0,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_1,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_2,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_3,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_5,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_6,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_40,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_51,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_62,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_63,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_70,
+        EcIni::INIGROUP_SPEC_SETTINGS + QLatin1Char('/') + EcIni::INI_SPEC_SETTINGS_29,
+        EcIni::INIGROUP_SPEC_SETTINGS + QLatin1Char('/') + EcIni::INI_SPEC_SETTINGS_30,
+        EcIni::INIGROUP_SPEC_SETTINGS + QLatin1Char('/') + EcIni::INI_SPEC_SETTINGS_31,
+        EcIni::INIGROUP_SPEC_SETTINGS + QLatin1Char('/') + EcIni::INI_SPEC_SETTINGS_32
+    };
+    return excludedKeys.contains(key);
+}
+
+// the version of the software that saved the project, and runs the engine.
+// its major.minor, a patch release does not change the results
+bool isVersionKey(const QString& key)
+{
+    static const QString versionKey = EcIni::INIGROUP_PROJECT
+                                      + QLatin1Char('/')
+                                      + EcIni::INI_PROJECT_4;
+    return key == versionKey;
+}
+
+// the processing date range and what depends on it
+bool isDateRangeKey(const QString& key)
+{
+    static const QStringList dateRangeKeys
+    {
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_42,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_43,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_44,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_45,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_54,
+        EcIni::INIGROUP_PROJECT + QLatin1Char('/') + EcIni::INI_PROJECT_64
+    };
+    return dateRangeKeys.contains(key);
+}
+
+// canonical form: the processing keys sorted, one "key=value" line each,
+// as written by EcProject::saveEcProject(), so a saved and a loaded
+// project agree
+QString hashSettings(const IniFile& projectIni, bool withDateRange)
+{
+    auto keys = projectIni.allKeys();
+    keys.sort();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(FINGERPRINT_VERSION.toUtf8());
+
+    foreach (const QString& key, keys)
+    {
+        if (isFingerprintExcluded(key)
+            || (!withDateRange && isDateRangeKey(key)))
+        {
+            continue;
+        }
+
+        const auto value = projectIni.value(key);
+        auto text = (value.type() == QVariant::StringList)
+                    ? value.toStringList().join(QLatin1Char('\x1f'))
+                    : value.toString();
+        if (isVersionKey(key))
+        {
+            text = text.section(QLatin1Char('.'), 0, 1);
+        }
+
+        hash.addData(QByteArray(1, '\n'));
+        hash.addData(key.toUtf8());
+        hash.addData(QByteArray(1, '='));
+        hash.addData(text.toUtf8());
+    }
+
+    return FINGERPRINT_VERSION
+           + QLatin1Char(':')
+           + QString::fromLatin1(hash.result().toHex());
+}
+} // namespace
+
 EcProject::EcProject(QObject *parent, const ProjConfigState& project_config) :
     QObject(parent),
     defaultSettings(EcProjectState()),
     modified_(false),
     ec_project_state_(EcProjectState()),
-    project_config_state_(project_config)
+    project_config_state_(project_config),
+    settings_fingerprint_(),
+    results_fingerprint_()
 {
     Defs::qt_registerCustomTypes();
 }
@@ -48,7 +151,9 @@ EcProject::EcProject(const EcProject& project) :
     defaultSettings(EcProjectState()),
     modified_(project.modified_),
     ec_project_state_(project.ec_project_state_),
-    project_config_state_(project.project_config_state_)
+    project_config_state_(project.project_config_state_),
+    settings_fingerprint_(project.settings_fingerprint_),
+    results_fingerprint_(project.results_fingerprint_)
 {
 }
 
@@ -60,6 +165,8 @@ EcProject& EcProject::operator=(const EcProject &project)
         modified_ = project.modified_;
         ec_project_state_ = project.ec_project_state_;
         project_config_state_ = project.project_config_state_;
+        settings_fingerprint_ = project.settings_fingerprint_;
+        results_fingerprint_ = project.results_fingerprint_;
     }
     return *this;
 }
@@ -825,6 +932,116 @@ bool EcProject::fuzzyCompare(const EcProject& previousProject)
     Q_ASSERT(false);
 }
 
+QByteArray EcProject::previousDataKey() const
+{
+    const auto& general = ec_project_state_.projectGeneral;
+    const auto& screen = ec_project_state_.screenGeneral;
+
+    QByteArray fields;
+    QDataStream out(&fields, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_2);
+
+    // col_diag_77 is left out, fuzzyCompare() matches it with col_diag_75
+    out << static_cast<int>(general.file_type)
+        << general.file_prototype
+        << general.col_ts
+        << general.col_co2
+        << general.col_h2o
+        << general.col_ch4
+        << general.col_int_t_1
+        << general.col_int_t_2
+        << general.col_int_p
+        << general.col_air_t
+        << general.col_air_p
+        << general.col_int_t_c
+        << general.col_diag_72
+        << general.col_diag_75
+        << general.col_diag_anem;
+
+    out << screen.flag1_col << screen.flag1_policy
+        << screen.flag2_col << screen.flag2_policy
+        << screen.flag3_col << screen.flag3_policy
+        << screen.flag4_col << screen.flag4_policy
+        << screen.flag5_col << screen.flag5_policy
+        << screen.flag6_col << screen.flag6_policy
+        << screen.flag7_col << screen.flag7_policy
+        << screen.flag8_col << screen.flag8_policy
+        << screen.flag9_col << screen.flag9_policy
+        << screen.flag10_col << screen.flag10_policy;
+
+    out << ec_project_state_.screenSetting.max_lack
+        << ec_project_state_.screenSetting.avrg_len;
+
+    return QCryptographicHash::hash(fields, QCryptographicHash::Sha1);
+}
+
+QString EcProject::settingsFingerprint(const IniFile& projectIni)
+{
+    auto withDateRange = true;
+    return hashSettings(projectIni, withDateRange);
+}
+
+QString EcProject::resultsFingerprint(const IniFile& projectIni)
+{
+    auto withDateRange = false;
+    return hashSettings(projectIni, withDateRange);
+}
+
+// results of each averaging period do not depend on the other periods
+// unless computed from the whole processed dataset
+bool EcProject::hasPeriodIndependentResults()
+{
+    // planar fit
+    if ((screenRotMethod() == 3 || screenRotMethod() == 4)
+        && !planarFitSubset())
+    {
+        return false;
+    }
+
+    // automatic time lag optimization
+    if (screenTlagMeth() == 4 && !timelagOptSubset())
+    {
+        return false;
+    }
+
+    // spectral assessment of the processed dataset
+    return !isEngineStep2Needed();
+}
+
+bool EcProject::hasFullOutputOnly() const
+{
+    const auto& general = ec_project_state_.projectGeneral;
+    if (!general.out_rich
+        || general.out_ghg_eu || general.out_amflux
+        || general.out_md || general.out_biomet
+        || general.out_mean_spectra || general.out_mean_cosp)
+    {
+        return false;
+    }
+
+    // qc details, statistics, raw time series and (co)spectra
+    const auto& screen = ec_project_state_.screenSetting;
+    const int outputs[] = {
+        screen.out_details,
+        screen.out_bin_sp, screen.out_bin_og,
+        screen.out_full_sp_u, screen.out_full_sp_v, screen.out_full_sp_w,
+        screen.out_full_sp_ts, screen.out_full_sp_co2, screen.out_full_sp_h2o,
+        screen.out_full_sp_ch4, screen.out_full_sp_n2o,
+        screen.out_full_cosp_u, screen.out_full_cosp_v, screen.out_full_cosp_ts,
+        screen.out_full_cosp_co2, screen.out_full_cosp_h2o,
+        screen.out_full_cosp_ch4, screen.out_full_cosp_n2o,
+        screen.out_st_1, screen.out_st_2, screen.out_st_3, screen.out_st_4,
+        screen.out_st_5, screen.out_st_6, screen.out_st_7,
+        screen.out_raw_1, screen.out_raw_2, screen.out_raw_3, screen.out_raw_4,
+        screen.out_raw_5, screen.out_raw_6, screen.out_raw_7,
+        screen.out_raw_u, screen.out_raw_v, screen.out_raw_w, screen.out_raw_ts,
+        screen.out_raw_co2, screen.out_raw_h2o, screen.out_raw_ch4,
+        screen.out_raw_gas4, screen.out_raw_tair, screen.out_raw_pair
+    };
+    return std::none_of(std::begin(outputs), std::end(outputs),
+                        [](int out) { return out != 0; });
+}
+
 // New project
 void EcProject::newEcProject(const ProjConfigState& project_config)
 {
@@ -836,6 +1053,8 @@ void EcProject::newEcProject(const ProjConfigState& project_config)
 
     // update project configuration
     project_config_state_ = project_config;
+    settings_fingerprint_.clear();
+    results_fingerprint_.clear();
 
     EcProjectState defaultEcProjectState;
     ec_project_state_.projectGeneral.sw_version = defaultEcProjectState.projectGeneral.sw_version;
@@ -1230,27 +1449,11 @@ bool EcProject::saveEcProject(const QString &filename)
 {
     DEBUG_FUNC_NAME
 
-    // try to open file just for checking
-    QFile datafile(filename);
-    if (!datafile.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        // error opening file
-        qWarning() << "Error: Cannot open file" << filename;
-        WidgetUtils::warning(nullptr,
-                             tr("Write Project Error"),
-                             tr("Cannot write file %1:\n%2")
-                             .arg(filename)
-                             .arg(datafile.errorString()));
-        datafile.close();
-        return false;
-    }
-    datafile.close();
-
     QDateTime now = QDateTime::currentDateTime();
     QString now_str = now.toString(Qt::ISODate);
     QFileInfo fileinfo = QFileInfo(filename);
 
-    QSettings project_ini(filename, QSettings::IniFormat);
+    IniFile project_ini;
 
     // general section
     project_ini.beginGroup(EcIni::INIGROUP_PROJECT);
@@ -1759,14 +1962,24 @@ bool EcProject::saveEcProject(const QString &filename)
         project_ini.setValue(EcIni::INI_DRIFT_44, ec_project_state_.driftCorr.h2o_WX);
         project_ini.setValue(EcIni::INI_DRIFT_45, ec_project_state_.driftCorr.h2o_WX_date);
     project_ini.endGroup();
-    project_ini.sync();
 
-    bool result = tagProject(filename);
-    if (!result)
+    settings_fingerprint_ = settingsFingerprint(project_ini);
+    results_fingerprint_ = resultsFingerprint(project_ini);
+    project_ini.beginGroup(EcIni::INIGROUP_PROJECT);
+        project_ini.setValue(EcIni::INI_PROJECT_70, settings_fingerprint_);
+    project_ini.endGroup();
+
+    // the tagged project is written in a single pass and replaces
+    // the previous file only when complete, so a crash leaves it intact
+    if (!project_ini.save(filename, Defs::APP_PD_INI_TAG))
     {
+        qWarning() << "Error: Cannot write file" << filename;
         WidgetUtils::warning(nullptr,
                              tr("Write Project Error"),
-                             tr("Unable to tag project file!"));
+                             tr("Cannot write file %1:\n%2")
+                             .arg(filename)
+                             .arg(project_ini.errorString()));
+        return false;
     }
 
     // project is saved, so set flags accordingly
@@ -1779,8 +1992,10 @@ bool EcProject::loadEcProject(const QString &filename, bool checkVersion, bool *
 {
     DEBUG_FUNC_NAME
 
-    auto parent = static_cast<MainWindow*>(this->parent());
-    if (parent == nullptr) { return false; }
+    // the import of old versions is confirmed in the main window, the
+    // projects without it are loaded without version check
+    auto parent = qobject_cast<MainWindow*>(this->parent());
+    if (parent == nullptr && checkVersion) { return false; }
 
     bool isVersionCompatible = true;
     QVariant v; // container for conversions
@@ -1798,7 +2013,10 @@ bool EcProject::loadEcProject(const QString &filename, bool checkVersion, bool *
         return false;
     }
 
-    QSettings project_ini(filename, QSettings::IniFormat);
+    datafile.close();
+
+    IniFile project_ini;
+    project_ini.load(filename);
 
     // in case of old non existing file name, use the current existing
     QString projectFilename = project_ini.value(EcIni::INI_PROJECT_2, QString()).toString();
@@ -3168,6 +3386,16 @@ bool EcProject::loadEcProject(const QString &filename, bool checkVersion, bool *
 
     datafile.close();
 
+    // recomputed, the file could be older or edited by hand
+    settings_fingerprint_ = settingsFingerprint(project_ini);
+    results_fingerprint_ = resultsFingerprint(project_ini);
+    project_ini.beginGroup(EcIni::INIGROUP_PROJECT);
+    if (project_ini.value(EcIni::INI_PROJECT_70).toString() != settings_fingerprint_)
+    {
+        qDebug() << "stale settings fingerprint" << filename;
+    }
+    project_ini.endGroup();
+
     // just loaded projects are not modified
     setModified(false);
     emit ecProjectChanged();
@@ -3232,15 +3460,6 @@ bool EcProject::nativeFormat(const QString &filename)
     return true;
 }
 
-// prepend a known tag to the project file
-bool EcProject::tagProject(const QString &filename)
-{
-    QString app_tag(Defs::APP_PD_INI_TAG);
-    app_tag += QLatin1String("\n");
-
-    return FileUtils::prependToFile(app_tag, filename);
-}
-
 void EcProject::setModified(bool mod)
 {
     modified_ = mod;
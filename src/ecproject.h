@@ -30,6 +30,8 @@
 #include "defs.h"
 #include "ecprojectstate.h"
 
+class IniFile;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \file src/ecproject.h
 /// \brief
@@ -74,6 +76,24 @@ public:
     // field comparison for previous data assessment
     bool fuzzyCompare(const EcProject& previousProject);
 
+    // hash of the fields that fuzzyCompare() requires to be equal in any
+    // run mode: projects with different keys never compare equal
+    QByteArray previousDataKey() const;
+
+    // versioned hash of the processing settings, as saved or loaded.
+    // projects with the same fingerprint produce the same results. the
+    // fingerprint includes the major.minor version of the software
+    inline QString settingsFingerprint() const { return settings_fingerprint_; }
+    static QString settingsFingerprint(const IniFile& projectIni);
+
+    // as settingsFingerprint(), without the processing date range.
+    // same fingerprint and raw files produce the same averaging periods
+    inline QString resultsFingerprint() const { return results_fingerprint_; }
+    static QString resultsFingerprint(const IniFile& projectIni);
+    bool hasPeriodIndependentResults();
+    // the full output is the only file written for each averaging period
+    bool hasFullOutputOnly() const;
+
     // set project
     void setGeneralRunMode(Defs::CurrRunMode mode);
     void setGeneralRunFcc(bool yes);
@@ -864,9 +884,8 @@ private:
     bool modified_;
     EcProjectState ec_project_state_;
     ProjConfigState project_config_state_;
-
-    // insert tag for native format files
-    bool tagProject(const QString &filename);
+    QString settings_fingerprint_;
+    QString results_fingerprint_;
 
     bool previousFileNameCompare(const QString &currentPath, const QString &previousPath);
     bool previousSettingsCompare(bool current, bool previous);
@@ -0,0 +1,319 @@
+/***************************************************************************
+  engineoutput.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "engineoutput.h"
+
+#include <QQueue>
+#include <QVector>
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+using EngineOutput::Message;
+
+struct Pattern
+{
+    const char* text;
+    Message message;
+    quint32 flags;
+};
+
+// in order of precedence, the order of Message: a line containing more
+// messages gets the first one
+const Pattern PATTERNS[] = {
+    { "Executing EddyPro", Message::Executing, 0 },
+    { "Reading EddyPro project file", Message::ReadingProject, 0 },
+    { "Retrieving file", Message::RetrievingFile, 0 },
+    { "names from directory", Message::NamesFromDirectory, 0 },
+    { "Retrieving timestamps", Message::RetrievingTimestamps, 0 },
+    { "from file names", Message::FromFileNames, 0 },
+    { "Arranging raw files", Message::ArrangingRawFiles, 0 },
+    { "in chronological order", Message::ChronologicalOrder, 0 },
+    { "Creating master time series", Message::MasterTimeSeries, 0 },
+    { "Performing planar-fit assessment", Message::PlanarFitStart, 0 },
+    { "Maximum number of flux averaging periods available", Message::MaxAveragingPeriods, 0 },
+    { "Importing wind data for", Message::ImportingWindData, 0 },
+    { "another small step to the planar-fit", Message::PlanarFitStep, 0 },
+    { "Sorting wind data by sector", Message::SortingWindData, 0 },
+    { "Calculating planar fit rotation matrices", Message::PlanarFitMatrices, 0 },
+    { "Planar Fit session terminated", Message::PlanarFitEnd, 0 },
+    { "Performing time-lag optimization", Message::TimeLagStart, 0 },
+    { "Importing data for", Message::ImportingData, 0 },
+    { "another small step to the time-lag", Message::TimeLagStep, 0 },
+    { "Time lag optimization session terminated", Message::TimeLagEnd, 0 },
+    { "Start raw data processing", Message::RawProcessingStart, 0 },
+    { "From:", Message::From, 0 },
+    { "To:", Message::To, 0 },
+    { "Total number of flux averaging periods", Message::TotalAveragingPeriods, 0 },
+    { "processing new flux averaging period", Message::NewAveragingPeriod, 0 },
+    { "File(s): ..", Message::FileList, 0 },
+    { "Skipping to next averaging period", Message::SkippingPeriod, 0 },
+    { "..\\", Message::FileContinuation, 0 },
+    { "Number of samples", Message::NumberOfSamples, 0 },
+    { "Calculating statistics..", Message::Statistics, 0 },
+    { "Raw level statistical screening", Message::StatisticalScreening, 0 },
+    { "Spike detection/removal test", Message::SpikeTest, 0 },
+    { "Absolute limits test", Message::AbsoluteLimits, 0 },
+    { "Skewness & kurtosis test", Message::SkewnessKurtosis, 0 },
+    { "Despiking user set", Message::DespikingUserSet, 0 },
+    { "Cross-wind correction", Message::CrossWind, 0 },
+    { "Converting into mixing ratio", Message::MixingRatio, 0 },
+    { "Performing tilt correction", Message::TiltCorrection, 0 },
+    { "Compensating time lags", Message::TimeLags, 0 },
+    { "Compensating user variables", Message::UserVariables, 0 },
+    { "Performing stationarity test", Message::Stationarity, 0 },
+    { "Detrending", Message::Detrending, 0 },
+    { "Calculating (co)spectra", Message::Spectra, 0 },
+    { "Tapering timeseries", Message::Tapering, 0 },
+    { "FFT-ing", Message::Fft, 0 },
+    { "Cospectral densities", Message::CospectralDensities, 0 },
+    { "Calculating fluxes Level 0", Message::FluxesLevel0, 0 },
+    { "Calculating fluxes Level 1", Message::FluxesLevel1, 0 },
+    { "Calculating fluxes Level 2", Message::FluxesLevel2, 0 },
+    { "Estimating footprint", Message::Footprint, 0 },
+    { "Calculating quality flags", Message::QualityFlags, 0 },
+    { "Flux averaging period processing time", Message::PeriodProcessingTime, 0 },
+    { "Raw data processing terminated", Message::RawProcessingEnd, 0 },
+    { "Essentials file path:", Message::EssentialsFile, 0 },
+    { "Starting flux computation and correction", Message::FluxComputationStart, 0 },
+    { "Initializing retrieval of EddyPro-RP results", Message::RetrievingRpResults, 0 },
+    { "File found, importing content", Message::FileFound, 0 },
+    { "Starting Spectral Assessment", Message::SpectralAssessmentStart, 0 },
+    { "Importing binned (co)spectra for", Message::ImportingBinnedSpectra, 0 },
+    { "Fitting model", Message::FittingModel, 0 },
+    { "Sorting", Message::Sorting, 0 },
+    { "Spectral Assessment session terminated", Message::SpectralAssessmentEnd, 0 },
+    { "Calculating fluxes for:", Message::CalculatingFluxesFor, 0 },
+    { "Raw data processing terminated. Creating continuous datasets if necessary",
+      Message::FinalizingOutputs, 0 },
+    { "Creating Full Output dataset", Message::FullOutputDataset, 0 },
+    { "Creating GHG-EUROPE-style dataset", Message::GhgEuropeDataset, 0 },
+    { "Creating Metadata dataset", Message::MetadataDataset, 0 },
+    { "Creating Level", Message::LevelDataset, 0 },
+    { "Creating Biomet dataset", Message::BiometDataset, 0 },
+    { "Closing COMMON output files", Message::ClosingCommonFiles, 0 },
+    { "Closing RP output files", Message::ClosingRpFiles, 0 },
+    { "gracefully", Message::Gracefully, 0 },
+
+    // tokens flagged wherever they appear
+    { "Alert", Message::None, EngineOutput::Alert },
+    { "Warning", Message::None, EngineOutput::Warning },
+    { "Error", Message::None, EngineOutput::Error },
+    { "Critical", Message::None, EngineOutput::Critical },
+    { "Fatal error", Message::None, EngineOutput::FatalError },
+    { "Fatal", Message::None, EngineOutput::Fatal },
+    { "aborted", Message::None, EngineOutput::Aborted },
+    { "At line", Message::None, EngineOutput::AtLine },
+    { "Fortran runtime error", Message::None, EngineOutput::FortranRuntimeError },
+    { "(80)", Message::None, EngineOutput::SuppressedWarning },
+    { "(81)", Message::None, EngineOutput::SuppressedWarning },
+    { "(82)", Message::None, EngineOutput::SuppressedWarning },
+    { "(83)", Message::None, EngineOutput::SuppressedWarning },
+    { "(84)", Message::None, EngineOutput::SuppressedWarning },
+    { "(85)", Message::None, EngineOutput::SuppressedWarning },
+    { "another small step", Message::None, EngineOutput::SmallStep },
+    { "STOP", Message::None, EngineOutput::Stop },
+    { "Note: The following floating-point exceptions", Message::None, EngineOutput::FpExceptions },
+    { "of file Z:", Message::None, EngineOutput::WindowsSourcePath }
+};
+
+const int NO_MESSAGE = std::numeric_limits<int>::max();
+
+/// \class Matcher
+/// \brief Aho-Corasick automaton of PATTERNS, as a complete transition
+/// table over the bytes used by the patterns
+class Matcher
+{
+public:
+    Matcher();
+
+    EngineOutput::Line classify(const QByteArray& line) const;
+
+private:
+    int addState();
+
+    quint8 byteClass_[256];
+    int classCount_;
+    QVector<int> next_;         // state * classCount_ + class -> state
+    QVector<int> message_;      // first message recognized in each state
+    QVector<quint32> flags_;    // flags recognized in each state
+};
+
+Matcher::Matcher() :
+    classCount_(1)
+{
+    // the bytes of no pattern share class 0
+    std::fill(byteClass_, byteClass_ + 256, 0);
+    for (const auto& pattern : PATTERNS)
+    {
+        for (auto p = pattern.text; *p; ++p)
+        {
+            auto& byteClass = byteClass_[static_cast<quint8>(*p)];
+            if (byteClass == 0)
+            {
+                byteClass = static_cast<quint8>(classCount_++);
+            }
+        }
+    }
+
+    // trie
+    addState();
+    for (const auto& pattern : PATTERNS)
+    {
+        auto state = 0;
+        for (auto p = pattern.text; *p; ++p)
+        {
+            const auto index = state * classCount_ + byteClass_[static_cast<quint8>(*p)];
+            if (next_.at(index) < 0)
+            {
+                const auto newState = addState();
+                next_[index] = newState;
+            }
+            state = next_.at(index);
+        }
+
+        if (pattern.message != Message::None)
+        {
+            message_[state] = qMin(message_.at(state), static_cast<int>(pattern.message));
+        }
+        flags_[state] |= pattern.flags;
+    }
+
+    // failure links, breadth first, folded into the transitions
+    QVector<int> fail(message_.size(), 0);
+    QQueue<int> queue;
+    for (auto c = 0; c < classCount_; ++c)
+    {
+        auto& target = next_[c];
+        if (target < 0)
+        {
+            target = 0;
+        }
+        else
+        {
+            queue.enqueue(target);
+        }
+    }
+
+    while (!queue.isEmpty())
+    {
+        const auto state = queue.dequeue();
+        message_[state] = qMin(message_.at(state), message_.at(fail.at(state)));
+        flags_[state] |= flags_.at(fail.at(state));
+
+        for (auto c = 0; c < classCount_; ++c)
+        {
+            const auto index = state * classCount_ + c;
+            const auto fallback = next_.at(fail.at(state) * classCount_ + c);
+            if (next_.at(index) < 0)
+            {
+                next_[index] = fallback;
+            }
+            else
+            {
+                fail[next_.at(index)] = fallback;
+                queue.enqueue(next_.at(index));
+            }
+        }
+    }
+}
+
+int Matcher::addState()
+{
+    next_.insert(next_.size(), classCount_, -1);
+    message_.append(NO_MESSAGE);
+    flags_.append(0);
+    return message_.size() - 1;
+}
+
+EngineOutput::Line Matcher::classify(const QByteArray& line) const
+{
+    const auto next = next_.constData();
+    const auto message = message_.constData();
+    const auto flags = flags_.constData();
+
+    auto state = 0;
+    auto first = NO_MESSAGE;
+    quint32 lineFlags = 0;
+    for (auto p = line.constBegin(); p != line.constEnd(); ++p)
+    {
+        state = next[state * classCount_ + byteClass_[static_cast<quint8>(*p)]];
+        first = qMin(first, message[state]);
+        lineFlags |= flags[state];
+    }
+
+    EngineOutput::Line result;
+    result.message = (first == NO_MESSAGE) ? Message::None : static_cast<Message>(first);
+    result.flags = lineFlags;
+    return result;
+}
+} // namespace
+
+EngineOutput::Line EngineOutput::classify(const QByteArray& line)
+{
+    // built once, at the first use
+    static const Matcher matcher;
+    return matcher.classify(line);
+}
+
+void EngineOutput::LineSplitter::append(const QByteArray& data)
+{
+    // drop the consumed bytes when they outweigh the unread ones
+    if (readPos_ > 0 && readPos_ >= buffer_.size() - readPos_)
+    {
+        buffer_.remove(0, readPos_);
+        readPos_ = 0;
+    }
+    buffer_.append(data);
+}
+
+bool EngineOutput::LineSplitter::readLine(QByteArray* line)
+{
+    const auto eol = buffer_.indexOf('\n', readPos_);
+    if (eol < 0)
+    {
+        return false;
+    }
+
+    *line = buffer_.mid(readPos_, eol - readPos_);
+    readPos_ = eol + 1;
+
+    if (readPos_ == buffer_.size())
+    {
+        clear();
+    }
+    return true;
+}
+
+QByteArray EngineOutput::LineSplitter::remainder() const
+{
+    return buffer_.mid(readPos_);
+}
+
+void EngineOutput::LineSplitter::clear()
+{
+    // keep the capacity for the next reads
+    buffer_.resize(0);
+    readPos_ = 0;
+}
@@ -0,0 +1,188 @@
+/***************************************************************************
+  engineoutput.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef ENGINEOUTPUT_H
+#define ENGINEOUTPUT_H
+
+#include <QByteArray>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/engineoutput.h
+/// \brief Classification of the engine output lines
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note The engine messages are declared once, in a table in the source
+/// file, and compiled at the first use into a single automaton
+/// (Aho-Corasick) that finds all of them in one pass over a line. A line
+/// gets the first message of the table it contains, as did the former
+/// sequence of contains() tests, and the flags of all the severity tokens
+/// it contains.
+/// \sa RunPage, BatchQueue, HeadlessRunner
+/// \bug
+/// \deprecated
+/// \test tst_engineoutput.cpp
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \namespace EngineOutput
+/// \brief Engine messages and line splitting
+namespace EngineOutput
+{
+    enum class Message {
+        None,
+        // preamble
+        Executing,
+        ReadingProject,
+        RetrievingFile,
+        NamesFromDirectory,
+        RetrievingTimestamps,
+        FromFileNames,
+        ArrangingRawFiles,
+        ChronologicalOrder,
+        MasterTimeSeries,
+        // planar fit
+        PlanarFitStart,
+        MaxAveragingPeriods,
+        ImportingWindData,
+        PlanarFitStep,
+        SortingWindData,
+        PlanarFitMatrices,
+        PlanarFitEnd,
+        // time lag
+        TimeLagStart,
+        ImportingData,
+        TimeLagStep,
+        TimeLagEnd,
+        // raw data processing
+        RawProcessingStart,
+        From,
+        To,
+        TotalAveragingPeriods,
+        NewAveragingPeriod,
+        FileList,
+        SkippingPeriod,
+        FileContinuation,
+        NumberOfSamples,
+        Statistics,
+        StatisticalScreening,
+        SpikeTest,
+        AbsoluteLimits,
+        SkewnessKurtosis,
+        DespikingUserSet,
+        CrossWind,
+        MixingRatio,
+        TiltCorrection,
+        TimeLags,
+        UserVariables,
+        Stationarity,
+        Detrending,
+        Spectra,
+        Tapering,
+        Fft,
+        CospectralDensities,
+        FluxesLevel0,
+        FluxesLevel1,
+        FluxesLevel2,
+        Footprint,
+        QualityFlags,
+        PeriodProcessingTime,
+        RawProcessingEnd,
+        EssentialsFile,
+        // flux computation
+        FluxComputationStart,
+        RetrievingRpResults,
+        FileFound,
+        // spectral corrections
+        SpectralAssessmentStart,
+        ImportingBinnedSpectra,
+        FittingModel,
+        Sorting,
+        SpectralAssessmentEnd,
+        CalculatingFluxesFor,
+        // output files
+        FinalizingOutputs,
+        FullOutputDataset,
+        GhgEuropeDataset,
+        MetadataDataset,
+        LevelDataset,
+        BiometDataset,
+        ClosingCommonFiles,
+        ClosingRpFiles,
+        // end of the run
+        Gracefully
+    };
+
+    enum Flag : quint32 {
+        Alert               = 1 << 0,
+        Warning             = 1 << 1,
+        Error               = 1 << 2,
+        Critical            = 1 << 3,
+        FatalError          = 1 << 4,
+        Fatal               = 1 << 5,
+        Aborted             = 1 << 6,
+        AtLine              = 1 << 7,
+        FortranRuntimeError = 1 << 8,
+        SuppressedWarning   = 1 << 9,   // warnings (80) to (85)
+        SmallStep           = 1 << 10,  // planar fit and time lag steps
+        Stop                = 1 << 11,
+        FpExceptions        = 1 << 12,
+        WindowsSourcePath   = 1 << 13   // "of file Z:" of runtime errors
+    };
+
+    struct Line
+    {
+        Message message = Message::None;
+        quint32 flags = 0;
+    };
+
+    // one pass over line, thread safe
+    Line classify(const QByteArray& line);
+
+    /// \class LineSplitter
+    /// \brief Split a stream of bytes in complete lines
+    ///
+    /// The bytes are appended after the unread ones and the lines are read
+    /// from a moving offset, so the consumed bytes are never copied again.
+    /// The buffer is compacted only when the consumed part exceeds the
+    /// unread one, which keeps the cost linear in the input.
+    class LineSplitter
+    {
+    public:
+        void append(const QByteArray& data);
+
+        // next complete line, without the line feed. false if none
+        bool readLine(QByteArray* line);
+
+        // the bytes following the last line feed
+        QByteArray remainder() const;
+
+        void clear();
+
+    private:
+        QByteArray buffer_;
+        int readPos_ = 0;
+    };
+
+} // EngineOutput
+
+#endif // ENGINEOUTPUT_H
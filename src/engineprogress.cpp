@@ -0,0 +1,82 @@
+/***************************************************************************
+  engineprogress.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "engineprogress.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+bool EngineProgress::parse(const QByteArray& line, Event* event)
+{
+    // cheap rejection of anything else sharing the channel
+    const auto trimmed = line.trimmed();
+    if (!trimmed.startsWith('{'))
+    {
+        return false;
+    }
+
+    QJsonParseError error;
+    const auto document = QJsonDocument::fromJson(trimmed, &error);
+    if (error.error != QJsonParseError::NoError || !document.isObject())
+    {
+        return false;
+    }
+
+    const auto object = document.object();
+    const auto name = object.value(QStringLiteral("event")).toString();
+
+    *event = Event();
+    event->index = object.value(QStringLiteral("index")).toInt();
+    event->msec = object.value(QStringLiteral("msec")).toInt(-1);
+
+    if (name == QLatin1String("totals"))
+    {
+        event->type = Type::Totals;
+        event->total = object.value(QStringLiteral("periods")).toInt();
+    }
+    else if (name == QLatin1String("period"))
+    {
+        event->type = Type::Period;
+        event->from = object.value(QStringLiteral("from")).toString();
+        event->to = object.value(QStringLiteral("to")).toString();
+        foreach (const auto& file, object.value(QStringLiteral("files")).toArray())
+        {
+            event->files.append(file.toString());
+        }
+    }
+    else if (name == QLatin1String("stage"))
+    {
+        event->type = Type::Stage;
+        event->stage = object.value(QStringLiteral("stage")).toString();
+    }
+    else if (name == QLatin1String("period_end"))
+    {
+        event->type = Type::PeriodEnd;
+        event->skipped = object.value(QStringLiteral("skipped")).toBool();
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,89 @@
+/***************************************************************************
+  engineprogress.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef ENGINEPROGRESS_H
+#define ENGINEPROGRESS_H
+
+#include <QString>
+#include <QStringList>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/engineprogress.h
+/// \brief Structured progress events of the engine
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note Where the engine finds the CHANNEL_ENV variable, it writes one
+/// JSON object per line on the file descriptor it names, e.g.
+///
+///     {"event":"totals","periods":17520}
+///     {"event":"period","index":1,"from":"2016-03-01 00:00",
+///      "to":"2016-03-01 00:30","files":["2016-03-01T0000_AIU-0001.ghg"]}
+///     {"event":"stage","index":1,"stage":"despiking","msec":12}
+///     {"event":"period_end","index":1,"msec":412,"skipped":false}
+///
+/// Each event updates the progress in constant time, whatever the wording
+/// of the console messages. Without the channel (older engines, Windows)
+/// the progress is still scraped from the console text.
+/// \sa Process, RunPage, EngineOutput
+/// \bug
+/// \deprecated
+/// \test tst_engineoutput.cpp
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+class QByteArray;
+
+/// \namespace EngineProgress
+/// \brief Progress protocol between the engine and the gui
+namespace EngineProgress
+{
+    // descriptor of the channel in the engine and the variable naming it
+    const int CHANNEL_FD = 3;
+    const auto CHANNEL_ENV = QStringLiteral("EDDYPRO_PROGRESS_FD");
+
+    enum class Type {
+        Invalid,
+        Totals,     // number of averaging periods of the current phase
+        Period,     // start of an averaging period
+        Stage,      // start of a processing stage of the current period
+        PeriodEnd   // end of the current period
+    };
+
+    struct Event
+    {
+        Type type = Type::Invalid;
+        int index = 0;      // 1-based index of the averaging period
+        int total = 0;
+        QString from;
+        QString to;
+        QStringList files;
+        QString stage;
+        int msec = -1;      // duration, -1 if not given
+        bool skipped = false;
+    };
+
+    // false if the line is not a known event
+    bool parse(const QByteArray& line, Event* event);
+} // namespace EngineProgress
+
+#endif // ENGINEPROGRESS_H
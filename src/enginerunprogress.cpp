@@ -0,0 +1,143 @@
+/***************************************************************************
+  enginerunprogress.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "enginerunprogress.h"
+
+#include <QTime>
+
+#include "engineoutput.h"
+
+namespace
+{
+const quint32 MESSAGE_FLAGS = EngineOutput::Warning
+                              | EngineOutput::Error
+                              | EngineOutput::Critical
+                              | EngineOutput::FatalError
+                              | EngineOutput::Fatal;
+
+// the value after the last colon, e.g. "Total number of ...: 480"
+int countValue(const QByteArray& line)
+{
+    return line.trimmed().split(':').last().trimmed().toInt();
+}
+} // namespace
+
+EngineRunProgress::EngineRunProgress() :
+    previousStepMSec_(0),
+    periodStartMSec_(0),
+    periodIndex_(0),
+    periodCount_(0)
+{
+    reset();
+}
+
+void EngineRunProgress::reset()
+{
+    clock_.start();
+    startPhase(EtcEstimator::Phase::RawProcessing);
+}
+
+void EngineRunProgress::startPhase(EtcEstimator::Phase phase)
+{
+    etc_.start(phase);
+    previousStepMSec_ = clock_.elapsed();
+    periodStartMSec_ = previousStepMSec_;
+    periodIndex_ = 0;
+    periodCount_ = 0;
+}
+
+EngineRunProgress::Update EngineRunProgress::addLine(const QByteArray& line)
+{
+    using EngineOutput::Message;
+
+    const auto classified = EngineOutput::classify(line);
+    switch (classified.message)
+    {
+    case Message::Executing:
+        reset();
+        return Update::PhaseStarted;
+    case Message::PlanarFitStart:
+        startPhase(EtcEstimator::Phase::PlanarFit);
+        return Update::PhaseStarted;
+    case Message::TimeLagStart:
+        startPhase(EtcEstimator::Phase::TimeLag);
+        return Update::PhaseStarted;
+    case Message::RawProcessingStart:
+        startPhase(EtcEstimator::Phase::RawProcessing);
+        return Update::PhaseStarted;
+    // valid for the planar fit, the time lag and the raw data processing
+    case Message::MaxAveragingPeriods:
+    case Message::TotalAveragingPeriods:
+        periodCount_ = countValue(line);
+        etc_.setTotal(periodCount_);
+        return Update::Totals;
+    // a step of the planar fit or of the time lag ends one period
+    case Message::PlanarFitStep:
+    case Message::TimeLagStep:
+    {
+        const auto now = clock_.elapsed();
+        etc_.addPeriod(now - previousStepMSec_);
+        previousStepMSec_ = now;
+        ++periodIndex_;
+        return Update::PeriodStarted;
+    }
+    case Message::NewAveragingPeriod:
+        periodStartMSec_ = clock_.elapsed();
+        ++periodIndex_;
+        return Update::PeriodStarted;
+    case Message::SkippingPeriod:
+        etc_.skipPeriod(clock_.elapsed() - periodStartMSec_);
+        return Update::PeriodEnded;
+    case Message::PeriodProcessingTime:
+    {
+        const auto timeStr = QString::fromLatin1(line.trimmed().split(' ').last().trimmed());
+        const auto time = QTime::fromString(timeStr, QStringLiteral("h:mm:ss.zzz"));
+        etc_.addPeriod(time.isValid() ? QTime(0, 0).msecsTo(time)
+                                      : clock_.elapsed() - periodStartMSec_);
+        return Update::PeriodEnded;
+    }
+    default:
+        break;
+    }
+
+    return (classified.flags & MESSAGE_FLAGS) ? Update::Message : Update::None;
+}
+
+qint64 EngineRunProgress::etcMSec() const
+{
+    const auto estimate = etc_.estimate();
+    return estimate.valid ? estimate.msec : -1;
+}
+
+QString EngineRunProgress::phaseName(EtcEstimator::Phase phase)
+{
+    switch (phase)
+    {
+    case EtcEstimator::Phase::PlanarFit:
+        return QStringLiteral("planar_fit");
+    case EtcEstimator::Phase::TimeLag:
+        return QStringLiteral("time_lag");
+    case EtcEstimator::Phase::RawProcessing:
+        return QStringLiteral("raw_processing");
+    }
+    return QString();
+}
@@ -0,0 +1,92 @@
+/***************************************************************************
+  enginerunprogress.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef ENGINERUNPROGRESS_H
+#define ENGINERUNPROGRESS_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QString>
+
+#include "etcestimator.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/enginerunprogress.h
+/// \brief Progress of an engine run followed from its console output
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note The lines are classified with EngineOutput::classify() and the
+/// time to completion of the current phase is estimated by EtcEstimator,
+/// with the phases and the periods the run page counts. It serves the
+/// runs without a run page: the batch queue and the headless runs.
+/// \sa RunPage, BatchQueue, HeadlessRunner
+/// \bug
+/// \deprecated
+/// \test tst_etcestimator.cpp
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \class EngineRunProgress
+/// \brief Periods and time to completion of an engine run
+class EngineRunProgress
+{
+public:
+    enum class Update {
+        None,
+        PhaseStarted,
+        Totals,
+        PeriodStarted,
+        PeriodEnded,
+        Message         // a warning or an error
+    };
+
+    EngineRunProgress();
+
+    // back to the start of a run
+    void reset();
+
+    // one complete line of the engine output
+    Update addLine(const QByteArray& line);
+
+    inline EtcEstimator::Phase phase() const { return etc_.phase(); }
+    inline int periodIndex() const { return periodIndex_; }
+    inline int periodCount() const { return periodCount_; }
+
+    // time to completion of the current phase, -1 if unknown
+    qint64 etcMSec() const;
+
+    // e.g. "raw_processing"
+    static QString phaseName(EtcEstimator::Phase phase);
+
+private:
+    void startPhase(EtcEstimator::Phase phase);
+
+    EtcEstimator etc_;
+    QElapsedTimer clock_;
+    qint64 previousStepMSec_;
+    qint64 periodStartMSec_;
+    int periodIndex_;
+    int periodCount_;
+};
+
+#endif // ENGINERUNPROGRESS_H
@@ -0,0 +1,544 @@
+/***************************************************************************
+  enginescheduler.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "enginescheduler.h"
+
+#include <QDebug>
+#include <QTimer>
+
+#include "dbghelper.h"
+#include "globalsettings.h"
+
+EngineScheduler::EngineScheduler(QObject* parent) :
+    QObject(parent),
+    maxParallel_(1),
+    leadJob_(-1),
+    stopped_(false),
+    paused_(false),
+    stopOnFailure_(true),
+    memoryBudget_(0),
+    ioBudget_(0),
+    memoryUsage_(-1),
+    ioRate_(-1),
+    jobMemoryEstimate_(0),
+    sampledJobs_(0),
+    sampleTimer_(new QTimer(this)),
+    pauseTimer_(new QTimer(this))
+{
+    sampleTimer_->setInterval(2000);
+    connect(sampleTimer_, &QTimer::timeout,
+            this, &EngineScheduler::sampleResources);
+
+    pauseTimer_->setTimerType(Qt::PreciseTimer);
+    pauseTimer_->setInterval(1);
+    connect(pauseTimer_, &QTimer::timeout,
+            this, &EngineScheduler::pollPause);
+}
+
+EngineScheduler::~EngineScheduler()
+{
+    DEBUG_FUNC_NAME
+    stop();
+}
+
+void EngineScheduler::setEnv(const QStringList& envList)
+{
+    env_ = envList;
+}
+
+void EngineScheduler::setMaxParallel(int n)
+{
+    maxParallel_ = qMax(1, n);
+}
+
+void EngineScheduler::setResourceBudget(qint64 memoryBytes, qint64 ioBytesPerSec)
+{
+    memoryBudget_ = qMax(Q_INT64_C(0), memoryBytes);
+    ioBudget_ = qMax(Q_INT64_C(0), ioBytesPerSec);
+}
+
+void EngineScheduler::start(const QString& enginePath,
+                            const QString& workingDir,
+                            const QStringList& args,
+                            const QStringList& projectFiles)
+{
+    DEBUG_FUNC_NAME
+
+    stop();
+    foreach (const Job& job, jobs_)
+    {
+        // the lambdas hold the job index, a new job takes it
+        job.process->disconnect(this);
+        job.process->deleteLater();
+    }
+    jobs_.clear();
+    leadLines_.clear();
+    otherLines_.clear();
+    leadJob_ = -1;
+    stopped_ = false;
+    paused_ = false;
+    memoryUsage_ = -1;
+    ioRate_ = -1;
+    jobMemoryEstimate_ = 0;
+    sampledJobs_ = 0;
+
+    enginePath_ = enginePath;
+    workingDir_ = workingDir;
+    args_ = args;
+
+    jobs_.reserve(projectFiles.size());
+    foreach (const QString& projectFile, projectFiles)
+    {
+        addJob(projectFile);
+    }
+}
+
+int EngineScheduler::addJob(const QString& projectFile, const QString& enginePath)
+{
+    loadResourceBudget();
+
+    Job job;
+    job.projectFile = projectFile;
+    job.enginePath = enginePath.isEmpty() ? enginePath_ : enginePath;
+    job.process = new Process;
+    job.process->setParent(this);
+    job.process->setChannelsMode(QProcess::MergedChannels);
+    job.process->setReadChannels(QProcess::StandardOutput);
+    job.process->setEnv(env_);
+
+    const auto index = jobs_.size();
+    connect(job.process, &Process::readyReadStdOut, this, [=]() { readJobOutput(index); });
+    connect(job.process, &Process::processSuccess, this, [=]() { finishJob(index); });
+    connect(job.process, &Process::processFailure, this, [=]() { finishJob(index); });
+
+    jobs_.append(job);
+
+    startWaitingJobs();
+    return index;
+}
+
+void EngineScheduler::startWaitingJobs()
+{
+    if (stopped_ || paused_)
+    {
+        return;
+    }
+
+    auto running = 0;
+    qint64 committedMemory = 0;
+    foreach (const Job& job, jobs_)
+    {
+        if (job.started && !job.finished)
+        {
+            ++running;
+            committedMemory += qMax(job.rss, jobMemoryEstimate_);
+        }
+    }
+
+    for (auto i = 0; i < jobs_.size() && running < maxParallel_; ++i)
+    {
+        // finished without starting, after a failure
+        if (jobs_.at(i).started || jobs_.at(i).finished)
+        {
+            continue;
+        }
+
+        // the jobs keep their order, the next one waits for resources
+        if (running > 0 && !canAfford(running, committedMemory))
+        {
+            qDebug() << "engine job" << i << "waiting for resources";
+            break;
+        }
+
+        // a failure to start finishes the job, and may add others, here
+        jobs_[i].started = true;
+        const auto job = jobs_.at(i);
+        qDebug() << "engine job" << i << "started" << job.projectFile;
+
+        job.process->engineProcessStart(job.enginePath,
+                                        workingDir_,
+                                        QStringList(args_) << job.projectFile);
+
+        // block until the process truly start, as for the single engine
+        job.process->process()->waitForStarted();
+        ++running;
+        committedMemory += jobMemoryEstimate_;
+
+        emit jobStarted(i);
+    }
+
+    updateLeadJob();
+
+    if ((memoryBudget_ > 0 || ioBudget_ > 0) && running > 0 && !sampleTimer_->isActive())
+    {
+        sampleClock_.start();
+        sampleTimer_->start();
+    }
+}
+
+// whether the budgets allow one more job besides the running ones
+bool EngineScheduler::canAfford(int running, qint64 committedMemory) const
+{
+    if (memoryBudget_ > 0)
+    {
+        // nothing measured yet, wait for the first sample
+        if (jobMemoryEstimate_ <= 0)
+        {
+            return false;
+        }
+
+        if (committedMemory + jobMemoryEstimate_ > memoryBudget_)
+        {
+            return false;
+        }
+
+        // never start a job the system cannot hold without swapping
+        const auto available = Process::availableMemory();
+        if (available >= 0 && jobMemoryEstimate_ > available)
+        {
+            return false;
+        }
+    }
+
+    if (ioBudget_ > 0)
+    {
+        if (ioRate_ < 0 || sampledJobs_ <= 0)
+        {
+            return false;
+        }
+
+        // one more job adds the mean rate of the sampled ones
+        const auto jobRate = ioRate_ / sampledJobs_;
+        if (jobRate * (running + 1) > ioBudget_)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void EngineScheduler::sampleResources()
+{
+    const auto elapsedMSec = sampleClock_.restart();
+
+    qint64 memory = 0;
+    qint64 ioBytes = 0;
+    auto measured = 0;
+    auto ioMeasured = 0;
+    for (auto& job : jobs_)
+    {
+        if (!job.started || job.finished)
+        {
+            continue;
+        }
+
+        qint64 jobRss = 0;
+        qint64 jobIoBytes = 0;
+        if (!job.process->resourceUsage(&jobRss, &jobIoBytes))
+        {
+            continue;
+        }
+
+        job.rss = jobRss;
+        memory += jobRss;
+        jobMemoryEstimate_ = qMax(jobMemoryEstimate_, jobRss);
+        ++measured;
+
+        if (jobIoBytes >= 0 && job.ioBytes >= 0)
+        {
+            ioBytes += jobIoBytes - job.ioBytes;
+            ++ioMeasured;
+        }
+        job.ioBytes = jobIoBytes;
+    }
+
+    memoryUsage_ = (measured > 0) ? memory : -1;
+    ioRate_ = (ioMeasured > 0 && elapsedMSec > 0) ? ioBytes * 1000 / elapsedMSec : -1;
+    sampledJobs_ = ioMeasured;
+
+    qDebug() << "engine jobs memory" << memoryUsage_
+             << "io rate" << ioRate_
+             << "job memory estimate" << jobMemoryEstimate_;
+
+    // follow the changes of the global settings during the run
+    loadResourceBudget();
+
+    if (!isRunning())
+    {
+        sampleTimer_->stop();
+        return;
+    }
+
+    startWaitingJobs();
+}
+
+void EngineScheduler::loadResourceBudget()
+{
+    // without /proc the usage is unknown, run as without budgets
+    if (Process::availableMemory() < 0)
+    {
+        setResourceBudget(0, 0);
+        return;
+    }
+
+    setResourceBudget(qint64(GlobalSettings::engineMemoryBudget()) * 1024 * 1024,
+                      qint64(GlobalSettings::engineIoBudget()) * 1024 * 1024);
+}
+
+void EngineScheduler::pause(Defs::CurrRunStatus mode)
+{
+    paused_ = true;
+    pauseClock_.start();
+
+    // signal all the jobs first, then poll them together
+    foreach (const Job& job, jobs_)
+    {
+        if (job.started && !job.finished)
+        {
+            job.process->processPause(mode);
+        }
+    }
+
+    pauseTimer_->start();
+    pollPause();
+}
+
+// one pass over the running jobs, until all of them are stopped or the
+// deadline of all the jobs expires
+void EngineScheduler::pollPause()
+{
+    const auto deadlineMSec = 1000;
+
+    auto confirmed = Process::canConfirmPause();
+    foreach (const Job& job, jobs_)
+    {
+        if (!confirmed)
+        {
+            break;
+        }
+        if (job.started && !job.finished && job.process->pauseLatency() < 0)
+        {
+            confirmed = false;
+        }
+    }
+
+    if (!confirmed && Process::canConfirmPause() && pauseClock_.elapsed() < deadlineMSec)
+    {
+        return;
+    }
+
+    pauseTimer_->stop();
+    const auto latency = confirmed ? pauseClock_.nsecsElapsed() / 1000 : -1;
+    qDebug() << "engine jobs paused in" << latency << "us";
+    emit paused(latency);
+}
+
+void EngineScheduler::resume(Defs::CurrRunStatus mode)
+{
+    paused_ = false;
+    pauseTimer_->stop();
+
+    foreach (const Job& job, jobs_)
+    {
+        if (job.started && !job.finished)
+        {
+            job.process->processResume(mode);
+        }
+    }
+
+    startWaitingJobs();
+}
+
+void EngineScheduler::stop()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+
+    stopped_ = true;
+    sampleTimer_->stop();
+    pauseTimer_->stop();
+    for (auto& job : jobs_)
+    {
+        if (job.started && !job.finished)
+        {
+            job.process->processStop();
+        }
+        job.finished = true;
+    }
+    leadJob_ = -1;
+}
+
+bool EngineScheduler::isRunning() const
+{
+    foreach (const Job& job, jobs_)
+    {
+        if (!job.finished)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+int EngineScheduler::finishedCount() const
+{
+    auto count = 0;
+    foreach (const Job& job, jobs_)
+    {
+        if (job.finished)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+Process::ExitStatus EngineScheduler::exitStatus() const
+{
+    if (stopped_)
+    {
+        return Process::ExitStatus::Stopped;
+    }
+
+    foreach (const Job& job, jobs_)
+    {
+        if (job.process->processExit() != Process::ExitStatus::Success)
+        {
+            return job.process->processExit();
+        }
+    }
+    return Process::ExitStatus::Success;
+}
+
+Process::ExitStatus EngineScheduler::jobExitStatus(int index) const
+{
+    return jobs_.at(index).process->processExit();
+}
+
+QByteArray EngineScheduler::readLeadLines()
+{
+    QByteArray lines;
+    lines.swap(leadLines_);
+    return lines;
+}
+
+QByteArray EngineScheduler::readOtherLines()
+{
+    QByteArray lines;
+    lines.swap(otherLines_);
+    return lines;
+}
+
+void EngineScheduler::readJobOutput(int index)
+{
+    auto& job = jobs_[index];
+    job.partialLine.append(job.process->readAllStdOut());
+
+    const auto lastEol = job.partialLine.lastIndexOf('\n');
+    if (lastEol < 0)
+    {
+        return;
+    }
+
+    appendJobLines(index, job.partialLine.left(lastEol + 1));
+    job.partialLine.remove(0, lastEol + 1);
+
+    emit readyReadStdOut();
+}
+
+// the lines of the other jobs are tagged with the job number, e.g. "[2] "
+void EngineScheduler::appendJobLines(int index, const QByteArray& lines)
+{
+    emit jobOutput(index, lines);
+
+    if (index == leadJob_)
+    {
+        leadLines_.append(lines);
+        return;
+    }
+
+    const QByteArray tag = '[' + QByteArray::number(index + 1) + "] ";
+    foreach (const QByteArray& line, lines.split('\n'))
+    {
+        if (!line.isEmpty())
+        {
+            otherLines_.append(tag + line + '\n');
+        }
+    }
+}
+
+void EngineScheduler::finishJob(int index)
+{
+    auto& job = jobs_[index];
+    if (job.finished)
+    {
+        return;
+    }
+
+    readJobOutput(index);
+    if (!job.partialLine.isEmpty())
+    {
+        appendJobLines(index, job.partialLine + '\n');
+        job.partialLine.clear();
+    }
+    job.finished = true;
+
+    const auto status = job.process->processExit();
+    qDebug() << "engine job" << index << "finished" << static_cast<int>(status);
+    emit jobFinished(index, status);
+
+    // a failed job fails the whole run, do not start the others
+    if (stopOnFailure_ && status != Process::ExitStatus::Success)
+    {
+        for (auto& other : jobs_)
+        {
+            if (!other.started)
+            {
+                other.finished = true;
+            }
+        }
+    }
+
+    startWaitingJobs();
+
+    if (!isRunning())
+    {
+        sampleTimer_->stop();
+        emit finished();
+    }
+}
+
+void EngineScheduler::updateLeadJob()
+{
+    leadJob_ = -1;
+    for (auto i = 0; i < jobs_.size(); ++i)
+    {
+        if (jobs_.at(i).started && !jobs_.at(i).finished)
+        {
+            leadJob_ = i;
+            return;
+        }
+    }
+}
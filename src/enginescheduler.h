@@ -0,0 +1,182 @@
+/***************************************************************************
+  enginescheduler.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef ENGINESCHEDULER_H
+#define ENGINESCHEDULER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include "defs.h"
+#include "process.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/enginescheduler.h
+/// \brief Pool of concurrent engine processes
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note Each job is one run of the engine on a project file. At most
+/// maxParallel() jobs run at the same time, the others wait in order and
+/// start as soon as a running job ends. The output of each job is split in
+/// complete lines, so the lines of concurrent jobs are never mixed.
+/// The lead job, the first one still running, feeds the run page.
+/// Jobs can be added while the others run, each one with its own engine.
+/// With a memory or disk budget in the global settings, the resident
+/// memory and the disk traffic of the running jobs are sampled from /proc
+/// and a waiting job starts only if the budgets can afford one more job,
+/// estimated from the peak usage of the jobs seen so far. One job always
+/// runs, whatever its usage.
+/// \sa Process
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \class EngineScheduler
+/// \brief Run several engine processes with a parallelism limit
+class QTimer;
+
+class EngineScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EngineScheduler(QObject* parent = nullptr);
+    ~EngineScheduler();
+
+    void setEnv(const QStringList& envList);
+
+    void setMaxParallel(int n);
+    inline int maxParallel() const { return maxParallel_; }
+
+    // limits to the memory, in bytes, and to the disk reads and writes,
+    // in bytes per second, of the running jobs. 0 for no limit.
+    // addJob() and each sample of the usage set them from the global
+    // settings
+    void setResourceBudget(qint64 memoryBytes, qint64 ioBytesPerSec);
+
+    // usage of the running jobs at the last sample, -1 if unknown
+    inline qint64 memoryUsage() const { return memoryUsage_; }
+    inline qint64 ioRate() const { return ioRate_; }
+
+    // when a job fails, do not start the waiting ones. true by default
+    inline void setStopOnFailure(bool b) { stopOnFailure_ = b; }
+
+    // run the engine once for each project file, appended to args
+    void start(const QString& enginePath,
+               const QString& workingDir,
+               const QStringList& args,
+               const QStringList& projectFiles);
+
+    // add a job running enginePath, or the engine of start(), on
+    // projectFile. return its index
+    int addJob(const QString& projectFile, const QString& enginePath = QString());
+
+    // pause all the running jobs at once, no job starts until resume().
+    // paused() follows, without blocking
+    void pause(Defs::CurrRunStatus mode);
+    void resume(Defs::CurrRunStatus mode);
+    inline bool isPaused() const { return paused_; }
+    void stop();
+
+    // true while a job is running or waiting
+    bool isRunning() const;
+    inline int jobCount() const { return jobs_.size(); }
+    int finishedCount() const;
+    inline int leadJob() const { return leadJob_; }
+
+    // Success if all the jobs succeeded, otherwise the status of the first
+    // failed job
+    Process::ExitStatus exitStatus() const;
+    Process::ExitStatus jobExitStatus(int index) const;
+
+    // complete lines received from the lead job since the last call
+    QByteArray readLeadLines();
+
+    // complete lines received from the other jobs since the last call,
+    // each one starting with the job number in brackets
+    QByteArray readOtherLines();
+
+signals:
+    void jobStarted(int index);
+    void jobFinished(int index, Process::ExitStatus status);
+    void readyReadStdOut();
+    void jobOutput(int index, const QByteArray& lines);
+    void finished();
+    // all the running jobs stopped after pause(), latency in microseconds
+    // since the request, -1 if unknown
+    void paused(qint64 latency);
+
+private slots:
+    void startWaitingJobs();
+    void sampleResources();
+    void pollPause();
+
+private:
+    struct Job
+    {
+        QString projectFile;
+        QString enginePath;
+        Process* process = nullptr;
+        QByteArray partialLine;
+        bool started = false;
+        bool finished = false;
+        qint64 rss = -1;
+        qint64 ioBytes = -1;
+    };
+
+    void readJobOutput(int index);
+    void appendJobLines(int index, const QByteArray& lines);
+    void finishJob(int index);
+    void updateLeadJob();
+    void loadResourceBudget();
+    bool canAfford(int running, qint64 committedMemory) const;
+
+    QVector<Job> jobs_;
+    QStringList env_;
+    QString enginePath_;
+    QString workingDir_;
+    QStringList args_;
+    int maxParallel_;
+    int leadJob_;
+    bool stopped_;
+    bool paused_;
+    bool stopOnFailure_;
+    qint64 memoryBudget_;
+    qint64 ioBudget_;
+    qint64 memoryUsage_;
+    qint64 ioRate_;
+    qint64 jobMemoryEstimate_;
+    int sampledJobs_;
+    QTimer* sampleTimer_;
+    QElapsedTimer sampleClock_;
+    QTimer* pauseTimer_;
+    QElapsedTimer pauseClock_;
+    QByteArray leadLines_;
+    QByteArray otherLines_;
+};
+
+#endif // ENGINESCHEDULER_H
@@ -0,0 +1,209 @@
+/***************************************************************************
+  etcestimator.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "etcestimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+// scale of the median absolute deviation to the standard deviation
+const double MAD_TO_SIGMA = 1.4826;
+// standard error of the median relative to the one of the mean
+const double MEDIAN_EFFICIENCY = 1.2533;
+// 95% two-sided band
+const double Z_95 = 1.96;
+// durations beyond this many deviations from the median are clipped
+const double CLIP_SIGMAS = 5.0;
+// the local rates hold for this many times the memory of the smoothing,
+// the mean of the phase beyond
+const double HORIZON = 3.0;
+} // namespace
+
+EtcEstimator::EtcEstimator(int window, double smoothing) :
+    window_(qMax(3, window)),
+    smoothing_(qBound(0.001, smoothing, 1.0)),
+    phase_(Phase::RawProcessing),
+    models_(3)
+{
+}
+
+void EtcEstimator::start(Phase phase)
+{
+    phase_ = phase;
+    current() = Model();
+}
+
+EtcEstimator::Model& EtcEstimator::current()
+{
+    return models_[static_cast<int>(phase_)];
+}
+
+const EtcEstimator::Model& EtcEstimator::model(Phase phase) const
+{
+    return models_.at(static_cast<int>(phase));
+}
+
+void EtcEstimator::setTotal(int periods)
+{
+    current().total = qMax(0, periods);
+}
+
+int EtcEstimator::periodsDone() const
+{
+    const auto& m = model(phase_);
+    return m.processed + m.skipped;
+}
+
+void EtcEstimator::medianSpread(const QVector<double>& values, double* median, double* mad)
+{
+    auto sorted = values;
+    const auto middle = sorted.begin() + sorted.size() / 2;
+    std::nth_element(sorted.begin(), middle, sorted.end());
+    *median = *middle;
+
+    for (auto& value : sorted)
+    {
+        value = std::fabs(value - *median);
+    }
+    std::nth_element(sorted.begin(), middle, sorted.end());
+    *mad = *middle;
+}
+
+void EtcEstimator::addPeriod(qint64 msec)
+{
+    auto& m = current();
+    auto duration = static_cast<double>(qMax(Q_INT64_C(0), msec));
+
+    // clip the outliers before smoothing, the window keeps them
+    auto clipped = duration;
+    if (m.recent.size() >= 3)
+    {
+        double median = 0.0;
+        double mad = 0.0;
+        medianSpread(m.recent, &median, &mad);
+        const auto limit = qMax(CLIP_SIGMAS * MAD_TO_SIGMA * mad, 0.25 * median);
+        clipped = qBound(median - limit, duration, median + limit);
+    }
+
+    m.clippedSum += clipped;
+    m.smoothed = (m.smoothed < 0.0) ? clipped
+                                    : m.smoothed + smoothing_ * (clipped - m.smoothed);
+
+    if (m.recent.size() < window_)
+    {
+        m.recent.append(duration);
+    }
+    else
+    {
+        m.recent[m.recentPos] = duration;
+        m.recentPos = (m.recentPos + 1) % window_;
+    }
+
+    m.skipShare -= smoothing_ * m.skipShare;
+    ++m.processed;
+}
+
+void EtcEstimator::skipPeriod(qint64 msec)
+{
+    auto& m = current();
+    const auto duration = static_cast<double>(qMax(Q_INT64_C(0), msec));
+
+    m.skipSmoothed = (m.skipped == 0) ? duration
+                                      : m.skipSmoothed + smoothing_ * (duration - m.skipSmoothed);
+    m.skipShare += smoothing_ * (1.0 - m.skipShare);
+    ++m.skipped;
+    if (m.processed > 0)
+    {
+        ++m.gaps;
+    }
+}
+
+EtcEstimator::Estimate EtcEstimator::estimate() const
+{
+    const auto& m = model(phase_);
+    Estimate estimate;
+
+    const auto remaining = qMax(0, m.total - m.processed - m.skipped);
+    if (remaining == 0 && m.total > 0)
+    {
+        estimate.valid = true;
+        return estimate;
+    }
+    if (m.processed == 0)
+    {
+        return estimate;
+    }
+
+    // the mean cost of the periods to come, the skips before the first
+    // processed period are a dataset starting before the data
+    const auto horizon = HORIZON / smoothing_;
+    const auto weight = horizon / (horizon + remaining);
+    const auto meanRate = m.clippedSum / m.processed;
+    const auto skipShare = weight * m.skipShare
+                           + (1.0 - weight) * m.gaps / (m.processed + m.gaps);
+    const auto perPeriod = [&](double rate)
+    {
+        rate = qMax(0.0, rate + (1.0 - weight) * (meanRate - m.smoothed));
+        return (1.0 - skipShare) * rate + skipShare * m.skipSmoothed;
+    };
+
+    estimate.valid = true;
+    estimate.msec = static_cast<qint64>(remaining * perPeriod(m.smoothed));
+
+    auto lowRate = m.smoothed;
+    auto highRate = m.smoothed;
+    if (m.recent.size() >= 3)
+    {
+        double median = 0.0;
+        double mad = 0.0;
+        medianSpread(m.recent, &median, &mad);
+
+        const auto error = Z_95 * MEDIAN_EFFICIENCY * MAD_TO_SIGMA * mad
+                           / std::sqrt(static_cast<double>(m.recent.size()));
+        lowRate = qMin(m.smoothed, median) - error;
+        highRate = qMax(m.smoothed, median) + error;
+    }
+    estimate.lowMSec = static_cast<qint64>(remaining * perPeriod(lowRate));
+    estimate.highMSec = static_cast<qint64>(remaining * perPeriod(highRate));
+    return estimate;
+}
+
+double EtcEstimator::smoothedRate(Phase phase) const
+{
+    return model(phase).smoothed;
+}
+
+double EtcEstimator::medianRate(Phase phase) const
+{
+    const auto& m = model(phase);
+    if (m.recent.isEmpty())
+    {
+        return -1.0;
+    }
+
+    double median = 0.0;
+    double mad = 0.0;
+    medianSpread(m.recent, &median, &mad);
+    return median;
+}
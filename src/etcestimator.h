@@ -0,0 +1,111 @@
+/***************************************************************************
+  etcestimator.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef ETCESTIMATOR_H
+#define ETCESTIMATOR_H
+
+#include <QVector>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/etcestimator.h
+/// \brief Estimated time to completion of the engine phases
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note Each phase (planar fit, time lag, raw data processing) has its own
+/// model, so that the steps of the pre-processing never bias the rate of
+/// the main loop. The rate of a period is the exponentially weighted mean
+/// of the durations, each clipped around the median of the recent ones
+/// so that a stall does not move it much. The periods close ahead take
+/// this rate, the farther ones the mean of the phase. Skipped periods
+/// have their own cost and share, the skips before the first processed
+/// period left out. The band spans the smoothed and the median rates,
+/// widened by the standard error of the median.
+/// \sa RunPage
+/// \bug
+/// \deprecated
+/// \test tst_etcestimator.cpp
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \class EtcEstimator
+/// \brief Time to completion of the averaging periods left in a phase
+class EtcEstimator
+{
+public:
+    enum class Phase { PlanarFit, TimeLag, RawProcessing };
+
+    struct Estimate
+    {
+        bool valid = false;
+        qint64 msec = 0;
+        qint64 lowMSec = 0;
+        qint64 highMSec = 0;
+    };
+
+    explicit EtcEstimator(int window = 64, double smoothing = 0.1);
+
+    // start the phase afresh, then feed it
+    void start(Phase phase);
+    Phase phase() const { return phase_; }
+
+    void setTotal(int periods);
+    void addPeriod(qint64 msec);
+    void skipPeriod(qint64 msec = 0);
+
+    // periods processed and skipped in the current phase
+    int periodsDone() const;
+
+    Estimate estimate() const;
+
+    // per-period rates of a phase, in ms, -1 if unknown
+    double smoothedRate(Phase phase) const;
+    double medianRate(Phase phase) const;
+
+private:
+    struct Model
+    {
+        int total = 0;
+        int processed = 0;
+        int skipped = 0;
+        int gaps = 0;               // skipped after the first processed
+        double smoothed = -1.0;
+        double clippedSum = 0.0;    // of the clipped durations
+        double skipSmoothed = 0.0;
+        double skipShare = 0.0;
+        QVector<double> recent;     // ring of the last durations
+        int recentPos = 0;
+    };
+
+    // median and median absolute deviation of the recent durations
+    static void medianSpread(const QVector<double>& values, double* median, double* mad);
+
+    const Model& model(Phase phase) const;
+    Model& current();
+
+    int window_;
+    double smoothing_;
+    Phase phase_;
+    QVector<Model> models_;
+};
+
+#endif // ETCESTIMATOR_H
@@ -0,0 +1,166 @@
+/***************************************************************************
+  filediscovery.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "filediscovery.h"
+
+#include <QDebug>
+#include <QPointer>
+#include <QtConcurrentRun>
+
+#include "dbghelper.h"
+
+FileDiscovery::FileDiscovery(QObject* parent) :
+    QObject(parent),
+    watcher_(nullptr),
+    searchId_(0),
+    count_(0),
+    running_(false)
+{
+}
+
+FileDiscovery::~FileDiscovery()
+{
+    cancel();
+
+    // the worker may still post batches to this object
+    future_.waitForFinished();
+}
+
+void FileDiscovery::start(const QString& appEnvPath,
+                          const QString& dir,
+                          const QString& extension,
+                          bool recurse)
+{
+    DEBUG_FUNC_NAME
+
+    cancel();
+
+    ++searchId_;
+    count_ = 0;
+    files_.clear();
+    running_ = true;
+
+    auto cancelFlag = QSharedPointer<QAtomicInt>::create(0);
+    cancelFlag_ = cancelFlag;
+
+    const auto searchId = searchId_;
+    QPointer<FileDiscovery> self(this);
+
+    // runs in the worker thread, the batches are queued to the owner thread
+    auto callback = [self, searchId, cancelFlag](const QStringList& batch)
+    {
+        if (cancelFlag->loadAcquire())
+        {
+            return false;
+        }
+        if (!batch.isEmpty() && self)
+        {
+            QMetaObject::invokeMethod(self.data(), "handleBatch",
+                                      Qt::QueuedConnection,
+                                      Q_ARG(int, searchId),
+                                      Q_ARG(QStringList, batch));
+        }
+        return true;
+    };
+
+    future_ = QtConcurrent::run([=]() {
+        const auto entries = RawFileIndex::queryEntries(appEnvPath,
+                                                        dir,
+                                                        extension,
+                                                        recurse,
+                                                        QString(),
+                                                        callback);
+        QStringList fileList;
+        fileList.reserve(entries.size());
+        for (const auto& entry : entries)
+        {
+            fileList.append(entry.path);
+        }
+        return fileList;
+    });
+
+    watcher_ = new QFutureWatcher<QStringList>(this);
+    connect(watcher_, &QFutureWatcher<QStringList>::finished,
+            this, &FileDiscovery::handleFinished);
+    watcher_->setFuture(future_);
+
+    emit started();
+    emit countChanged(0);
+}
+
+void FileDiscovery::cancel()
+{
+    if (!running_)
+    {
+        return;
+    }
+
+    DEBUG_FUNC_NAME
+
+    if (cancelFlag_)
+    {
+        cancelFlag_->storeRelease(1);
+    }
+
+    // the worker notices the flag at the next directory,
+    // its late results are dropped
+    if (watcher_)
+    {
+        watcher_->disconnect(this);
+        connect(watcher_, &QFutureWatcher<QStringList>::finished,
+                watcher_, &QObject::deleteLater);
+        watcher_ = nullptr;
+    }
+
+    ++searchId_;
+    running_ = false;
+    emit cancelled();
+}
+
+void FileDiscovery::handleBatch(int searchId, const QStringList& files)
+{
+    if (searchId != searchId_ || !running_)
+    {
+        return;
+    }
+
+    count_ += files.size();
+    emit batchFound(files);
+    emit countChanged(count_);
+}
+
+void FileDiscovery::handleFinished()
+{
+    auto watcher = watcher_;
+    watcher_ = nullptr;
+
+    files_ = watcher->result();
+    watcher->deleteLater();
+
+    running_ = false;
+    count_ = files_.size();
+
+    qDebug() << "files found" << count_;
+
+    emit countChanged(count_);
+    emit finished(files_);
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+  filediscovery.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef FILEDISCOVERY_H
+#define FILEDISCOVERY_H
+
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QSharedPointer>
+#include <QStringList>
+
+#include "rawfileindex.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/filediscovery.h
+/// \brief Asynchronous and cancellable file search
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note The search runs on the raw file index in a worker thread. Partial
+/// results are delivered to the owner thread through queued signals, so the
+/// GUI keeps its event loop instead of spinning on processEvents().
+/// \sa RawFileIndex
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \class FileDiscovery
+/// \brief Service streaming the files found in a directory tree
+class FileDiscovery : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FileDiscovery(QObject* parent = nullptr);
+    ~FileDiscovery();
+
+    // extension = "*.ext", same convention of FileUtils::getFiles().
+    // a search still running is cancelled first
+    void start(const QString& appEnvPath,
+               const QString& dir,
+               const QString& extension,
+               bool recurse);
+
+    inline bool isRunning() const { return running_; }
+    inline QStringList files() const { return files_; }
+
+public slots:
+    void cancel();
+
+signals:
+    void started();
+    void batchFound(const QStringList& files);
+    void countChanged(int count);
+    void finished(const QStringList& files);
+    void cancelled();
+
+private slots:
+    void handleBatch(int searchId, const QStringList& files);
+    void handleFinished();
+
+private:
+    QFutureWatcher<QStringList>* watcher_;
+    QFuture<QStringList> future_;
+    QSharedPointer<QAtomicInt> cancelFlag_;
+    QStringList files_;
+    int searchId_;
+    int count_;
+    bool running_;
+};
+
+#endif // FILEDISCOVERY_H
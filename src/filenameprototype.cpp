@@ -0,0 +1,151 @@
+/***************************************************************************
+  filenameprototype.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "filenameprototype.h"
+
+namespace
+{
+const qint64 MINUTES_PER_DAY = 1440;
+
+// same number of items and order of FilenamePrototype::Field
+const char* const FIELD_TOKENS[] = { "yy", "yyyy", "mm", "dd", "ddd", "HH", "MM" };
+const int FIELD_LENGTHS[] = { 2, 4, 2, 2, 3, 2, 2 };
+
+// value of the digits in [offset, offset + length), as QString::toInt()
+// on the same substring would return: 0 if any char is not a digit,
+// the available digits if the name is too short
+int readField(const QChar* filename, int size, int offset, int length)
+{
+    if (offset < 0 || offset >= size)
+    {
+        return 0;
+    }
+
+    const auto end = qMin(offset + length, size);
+    auto value = 0;
+    for (auto i = offset; i < end; ++i)
+    {
+        const auto c = filename[i].unicode();
+        if (c < '0' || c > '9')
+        {
+            return 0;
+        }
+        value = value * 10 + (c - '0');
+    }
+    return value;
+}
+} // namespace
+
+FilenamePrototype::FilenamePrototype(const QString& prototype) :
+    prototype_(prototype)
+{
+    for (auto i = 0; i < FieldCount; ++i)
+    {
+        offset_[i] = prototype.indexOf(QLatin1String(FIELD_TOKENS[i]));
+    }
+}
+
+bool FilenamePrototype::hasDate() const
+{
+    return (offset_[Year2] >= 0 || offset_[Year4] >= 0);
+}
+
+qint64 FilenamePrototype::timestampKey(const QChar* filename, int size) const
+{
+    int value[FieldCount];
+    for (auto i = 0; i < FieldCount; ++i)
+    {
+        value[i] = readField(filename, size, offset_[i], FIELD_LENGTHS[i]);
+    }
+
+    auto year = value[Year4];
+    if (offset_[Year2] >= 0 && offset_[Year4] < 0)
+    {
+        if (value[Year2] > 70)
+            year = 1900 + value[Year2];
+        else
+            year = 2000 + value[Year2];
+    }
+
+    QDate date;
+    if (offset_[DayOfYear] >= 0 && offset_[Month] < 0)
+    {
+        date = QDate(year, 1, 1);
+        if (date.isValid())
+        {
+            date = date.addDays(value[DayOfYear] - 1);
+        }
+    }
+    else
+    {
+        date = QDate(year, value[Month], value[Day]);
+    }
+
+    if (!date.isValid())
+    {
+        return -1;
+    }
+
+    // as QDateTime does, an invalid time means midnight
+    auto minutes = 0;
+    if (QTime::isValid(value[Hour], value[Minute], 0))
+    {
+        minutes = value[Hour] * 60 + value[Minute];
+    }
+
+    return date.toJulianDay() * MINUTES_PER_DAY + minutes;
+}
+
+qint64 FilenamePrototype::timestampKey(const QString& filename) const
+{
+    return timestampKey(filename.constData(), filename.size());
+}
+
+QDateTime FilenamePrototype::timestamp(const QString& filename) const
+{
+    return keyToDateTime(timestampKey(filename));
+}
+
+QDateTime FilenamePrototype::keyToDateTime(qint64 key)
+{
+    if (key < 0)
+    {
+        return QDateTime();
+    }
+
+    const auto minutes = static_cast<int>(key % MINUTES_PER_DAY);
+    return QDateTime(QDate::fromJulianDay(key / MINUTES_PER_DAY),
+                     QTime(minutes / 60, minutes % 60));
+}
+
+qint64 FilenamePrototype::dateTimeToKey(const QDateTime& dateTime)
+{
+    if (!dateTime.isValid())
+    {
+        return -1;
+    }
+
+    const auto time = dateTime.time();
+    return dateTime.date().toJulianDay() * MINUTES_PER_DAY
+           + time.hour() * 60
+           + time.minute();
+}
@@ -0,0 +1,85 @@
+/***************************************************************************
+  filenameprototype.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef FILENAMEPROTOTYPE_H
+#define FILENAMEPROTOTYPE_H
+
+#include <QDateTime>
+#include <QString>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/filenameprototype.h
+/// \brief Compiled raw file name prototype
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note The prototype (e.g. "yyyy-mm-ddTHHMM_xxx.ghg") is translated once
+/// into the fixed offsets of its date and time fields, then each file name
+/// is parsed reading the digits in place, without temporary strings.
+/// The field rules are the ones of FileUtils::getDateTimeFromFilename().
+/// \sa FileUtils::getDateTimeFromFilename
+/// \bug
+/// \deprecated
+/// \test tests/unit_tests/tst_filenameprototype.cpp
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \class FilenamePrototype
+/// \brief Timestamp extraction plan of a file name prototype
+class FilenamePrototype
+{
+public:
+    explicit FilenamePrototype(const QString& prototype = QString());
+
+    inline QString prototype() const { return prototype_; }
+
+    // true if the prototype contains at least a date field
+    bool hasDate() const;
+
+    // minutes since the julian day 0 in local time, -1 if not parsable.
+    // keys sort as the corresponding timestamps
+    qint64 timestampKey(const QChar* filename, int size) const;
+    qint64 timestampKey(const QString& filename) const;
+
+    QDateTime timestamp(const QString& filename) const;
+
+    static QDateTime keyToDateTime(qint64 key);
+    static qint64 dateTimeToKey(const QDateTime& dateTime);
+
+private:
+    enum Field
+    {
+        Year2,
+        Year4,
+        Month,
+        Day,
+        DayOfYear,
+        Hour,
+        Minute,
+        FieldCount
+    };
+
+    QString prototype_;
+    int offset_[FieldCount];
+};
+
+#endif // FILENAMEPROTOTYPE_H
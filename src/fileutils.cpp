@@ -25,14 +25,22 @@
 #include <QApplication>
 #include <QCoreApplication>
 #include <QDebug>
+#include <QHash>
 #include <QProcessEnvironment>
+#include <QThread>
+#include <QtConcurrentMap>
 #include <QtConcurrentRun>
 
 #include "JlCompress.h"
+#include "quazip.h"
+#include "quazipfile.h"
 
 #include "dbghelper.h"
 #include "defs.h"
+#include "dirscanner.h"
+#include "filenameprototype.h"
 #include "widget_utils.h"
+#include "ziparchivecache.h"
 
 // NOTE: never used
 bool FileUtils::isFileEmpty(const QString& fileName)
@@ -239,11 +247,7 @@ const QStringList FileUtils::getFiles(const QString& dir, const QString& extensi
     }
 
     QFuture<QStringList> future = QtConcurrent::run(&getDirContent, dir, filters, recursionFlag);
-    while (!future.isFinished())
-    {
-        QCoreApplication::processEvents();
-    }
-    fileList = future.result();
+    fileList = waitForFuture(future);
 
     return fileList;
 }
@@ -257,32 +261,11 @@ QStringList FileUtils::getDirContent(const QString& dirPath,
     // test empty filter list
     if (nameFilter.isEmpty()) return QStringList();
 
-    QString extension = nameFilter.first();
-
-    // remove "*."
-    extension.remove(0, 2);
-
-    // append the filtered files to this list
-    QStringList list;
-
-    // set dir iterator
-    QDirIterator dirIterator(dirPath,
-                             nameFilter,
-                             QDir::Files | QDir::NoSymLinks | QDir::NoDotAndDotDot,
-                             flag);
-
-    while (dirIterator.hasNext())
-    {
-        dirIterator.next();
-
-        // found required file type
-        if (dirIterator.fileInfo().completeSuffix().contains(extension, Qt::CaseInsensitive))
-        {
-            list.append(dirIterator.fileInfo().absoluteFilePath());
-        }
-    }
-
-    return list;
+    // subdirectories are listed in parallel
+    DirScanner scanner;
+    return scanner.scan(dirPath,
+                        nameFilter.first(),
+                        flag == QDirIterator::Subdirectories);
 }
 
 QDate FileUtils::getDateFromDoY(int doy, int year)
@@ -291,140 +274,208 @@ QDate FileUtils::getDateFromDoY(int doy, int year)
     return date.addDays(doy - 1);
 }
 
+// for many files, compile the prototype once with FilenamePrototype
 QDateTime FileUtils::getDateTimeFromFilename(const QString& filename, const QString& filenameFormat)
 {
-    QHash<QString, int> hash;
-
-    QString yyStr(QStringLiteral("yy"));
-    QString yyyyStr(QStringLiteral("yyyy"));
-    QString mmStr(QStringLiteral("mm"));
-    QString ddStr(QStringLiteral("dd"));
-    QString dddStr(QStringLiteral("ddd"));
-    QString HHStr(QStringLiteral("HH"));
-    QString MMStr(QStringLiteral("MM"));
-
-    int yy = 0;
-    int yyyy = 0;
-    int mm = 0;
-    int dd = 0;
-    int ddd = 0;
-    int HH = 0;
-    int MM = 0;
-
-    hash.insert(yyStr, filenameFormat.indexOf(yyStr));
-    hash.insert(yyyyStr, filenameFormat.indexOf(yyyyStr));
-    hash.insert(mmStr, filenameFormat.indexOf(mmStr));
-    hash.insert(ddStr, filenameFormat.indexOf(ddStr));
-    hash.insert(dddStr, filenameFormat.indexOf(dddStr));
-    hash.insert(HHStr, filenameFormat.indexOf(HHStr));
-    hash.insert(MMStr, filenameFormat.indexOf(MMStr));
-
-    QHashIterator<QString, int> i(hash);
-    while (i.hasNext())
-    {
-        i.next();
+    return FilenamePrototype(filenameFormat).timestamp(filename);
+}
 
-        qDebug() << "key" << i.key() << "value" << i.value();
+namespace
+{
+const qint64 MINUTES_PER_DAY = 1440;
 
-        if (i.value() >= 0)
-        {
-            if (i.key() == yyStr)
-            {
-                yy = filename.mid(i.value(), yyStr.length()).toInt();
-            }
-            else if (i.key() == yyyyStr)
-            {
-                yyyy = filename.mid(i.value(), yyyyStr.length()).toInt();
-            }
-            else if (i.key() == mmStr)
-            {
-                mm = filename.mid(i.value(), mmStr.length()).toInt();
-            }
-            else if (i.key() == ddStr)
-            {
-                dd = filename.mid(i.value(), ddStr.length()).toInt();
-            }
-            else if (i.key() == dddStr)
-            {
-                ddd = filename.mid(i.value(), dddStr.length()).toInt();
-            }
-            else if (i.key() == HHStr)
-            {
-                HH = filename.mid(i.value(), HHStr.length()).toInt();
-            }
-            else if (i.key() == MMStr)
-            {
-                MM = filename.mid(i.value(), MMStr.length()).toInt();
-            }
-        }
+// below this size the thread pool overhead is not worth it
+const int MIN_CHUNK_SIZE = 4096;
+
+// partial result of one chunk of timestamps
+struct KeyRangeStats
+{
+    qint64 min = -1;
+    qint64 max = -1;
+    int count = 0;
+    QHash<qint64, int> dailyFiles;   // julian day -> number of files
+};
+
+inline void addKey(KeyRangeStats& stats, qint64 key)
+{
+    if (key < 0)
+    {
+        return;
     }
 
-    qDebug() << "yy" << yy;
-    qDebug() << "yyyy" << yyyy;
-    qDebug() << "mm" << mm;
-    qDebug() << "dd" << dd;
-    qDebug() << "ddd" << ddd;
-    qDebug() << "HH" << HH;
-    qDebug() << "MM" << MM;
+    if (stats.min < 0 || key < stats.min)
+    {
+        stats.min = key;
+    }
+    if (key > stats.max)
+    {
+        stats.max = key;
+    }
+    ++stats.count;
+    ++stats.dailyFiles[key / MINUTES_PER_DAY];
+}
 
-    if (hash.value(yyStr) >= 0 && hash.value(yyyyStr) < 0)
+void mergeKeyRangeStats(KeyRangeStats& result, const KeyRangeStats& chunk)
+{
+    if (chunk.count == 0)
     {
-        if (yy > 70)
-            yyyy = 1970 + yy;
-        else
-            yyyy = 2000 + yy;
+        return;
     }
-    qDebug() << "yyyy" << yyyy;
 
-    QDate date;
-    if (hash.value(dddStr) >= 0 && hash.value(mmStr) < 0)
+    if (result.min < 0 || chunk.min < result.min)
     {
-        date = getDateFromDoY(ddd, yyyy);
+        result.min = chunk.min;
     }
-    else
+    if (chunk.max > result.max)
     {
-        date = QDate(yyyy, mm, dd);
+        result.max = chunk.max;
     }
-    qDebug() << "date" << date;
+    result.count += chunk.count;
 
-    QTime time(HH, MM);
-    qDebug() << "time" << time;
+    for (auto it = chunk.dailyFiles.constBegin(); it != chunk.dailyFiles.constEnd(); ++it)
+    {
+        result.dailyFiles[it.key()] += it.value();
+    }
+}
 
-    return QDateTime(date, time);
+// [begin, end) index ranges covering size items, about one per thread
+QVector<QPair<int, int>> makeChunks(int size)
+{
+    const auto threads = qMax(1, QThread::idealThreadCount());
+    const auto chunkSize = qMax(MIN_CHUNK_SIZE, (size + threads - 1) / threads);
+
+    QVector<QPair<int, int>> chunks;
+    for (auto begin = 0; begin < size; begin += chunkSize)
+    {
+        chunks.append(qMakePair(begin, qMin(begin + chunkSize, size)));
+    }
+    return chunks;
 }
 
-FileUtils::DateRange FileUtils::getDateRangeFromFileList(const QStringList& fileList,
-                                                                const QString& filenameProtoype)
+// map functors for QtConcurrent, the result_type typedef is required
+struct FileListChunkStats
 {
-    QDateTime dateStart;
-    QDateTime dateEnd;
-    QList<QDateTime> dateList;
+    typedef KeyRangeStats result_type;
 
-    foreach (const QString& s, fileList)
+    const QStringList* fileList;
+    const FilenamePrototype* prototype;
+
+    KeyRangeStats operator()(const QPair<int, int>& chunk) const
     {
-        QString filename = s.mid(s.lastIndexOf(QLatin1Char('/')) + 1);
-        qDebug() << filename;
-        QDateTime d = getDateTimeFromFilename(filename, filenameProtoype);
-        qDebug() << "d" << d;
-        if (d != QDateTime())
+        KeyRangeStats stats;
+        for (auto i = chunk.first; i < chunk.second; ++i)
+        {
+            // parse the file name in place, without extracting it
+            const auto& s = fileList->at(i);
+            const auto nameStart = s.lastIndexOf(QLatin1Char('/')) + 1;
+            addKey(stats, prototype->timestampKey(s.constData() + nameStart,
+                                                  s.size() - nameStart));
+        }
+        return stats;
+    }
+};
+
+struct KeyListChunkStats
+{
+    typedef KeyRangeStats result_type;
+
+    const QVector<qint64>* keyList;
+
+    KeyRangeStats operator()(const QPair<int, int>& chunk) const
+    {
+        KeyRangeStats stats;
+        for (auto i = chunk.first; i < chunk.second; ++i)
         {
-            dateList.append(d);
+            addKey(stats, keyList->at(i));
         }
+        return stats;
     }
+};
 
-    qSort(dateList.begin(), dateList.end());
+template <typename ChunkStats>
+KeyRangeStats reduceChunks(int size, const ChunkStats& chunkStats)
+{
+    const auto chunks = makeChunks(size);
+    if (chunks.size() <= 1)
+    {
+        return chunkStats(qMakePair(0, size));
+    }
+
+    return QtConcurrent::blockingMappedReduced<KeyRangeStats>(chunks,
+                                                              chunkStats,
+                                                              mergeKeyRangeStats,
+                                                              QtConcurrent::UnorderedReduce);
+}
 
-    if (!dateList.isEmpty())
+FileUtils::DataAvailability toDataAvailability(const KeyRangeStats& stats)
+{
+    FileUtils::DataAvailability availability;
+    if (stats.count == 0)
     {
-        dateStart = dateList.first();
-        dateEnd = dateList.last();
+        return availability;
+    }
+
+    availability.range = FileUtils::DateRange(FilenamePrototype::keyToDateTime(stats.min),
+                                              FilenamePrototype::keyToDateTime(stats.max));
+    availability.fileCount = stats.count;
 
-        return DateRange(dateStart, dateEnd);
+    for (auto it = stats.dailyFiles.constBegin(); it != stats.dailyFiles.constEnd(); ++it)
+    {
+        availability.dailyFiles.insert(QDate::fromJulianDay(it.key()), it.value());
     }
-    else
+
+    // the gaps are the holes between consecutive days with files
+    QDate previousDay;
+    for (auto it = availability.dailyFiles.constBegin();
+         it != availability.dailyFiles.constEnd();
+         ++it)
     {
-        return DateRange();
+        if (previousDay.isValid())
+        {
+            const auto gapDays = static_cast<int>(previousDay.daysTo(it.key())) - 1;
+            if (gapDays > 0)
+            {
+                ++availability.gapCount;
+                availability.emptyDays += gapDays;
+                if (gapDays > availability.longestGapDays)
+                {
+                    availability.longestGapDays = gapDays;
+                    availability.longestGapStart = previousDay.addDays(1);
+                }
+            }
+        }
+        previousDay = it.key();
     }
+
+    return availability;
+}
+} // namespace
+
+FileUtils::DateRange FileUtils::getDateRangeFromFileList(const QStringList& fileList,
+                                                                const QString& filenameProtoype)
+{
+    return getDataAvailabilityFromFileList(fileList, filenameProtoype).range;
+}
+
+// single pass over the list, split in chunks reduced in parallel
+FileUtils::DataAvailability FileUtils::getDataAvailabilityFromFileList(const QStringList& fileList,
+                                                                       const QString& filenameProtoype)
+{
+    const FilenamePrototype prototype(filenameProtoype);
+
+    FileListChunkStats chunkStats;
+    chunkStats.fileList = &fileList;
+    chunkStats.prototype = &prototype;
+
+    return toDataAvailability(reduceChunks(fileList.size(), chunkStats));
+}
+
+FileUtils::DataAvailability FileUtils::getDataAvailabilityFromKeys(const QVector<qint64>& keyList)
+{
+    KeyListChunkStats chunkStats;
+    chunkStats.keyList = &keyList;
+
+    return toDataAvailability(reduceChunks(keyList.size(), chunkStats));
 }
 
 // extract everything from the first underscore to the end
@@ -517,6 +568,7 @@ QString FileUtils::setupEnv()
     FileUtils::createDir(Defs::TMP_FILE_DIR, appVerDir);
     FileUtils::createDir(Defs::SMF_FILE_DIR, appVerDir);
     FileUtils::createDir(Defs::CAL_FILE_DIR, appVerDir);
+    FileUtils::createDir(Defs::IDX_FILE_DIR, appVerDir);
 
     return appVerDir;
 }
@@ -527,15 +579,8 @@ bool FileUtils::zipContainsFiletype(const QString& fileName, const QString& file
 
     qDebug() << "filePattern" << filePattern;
 
-    QStringList entries = JlCompress::getFileList(fileName);
-    qDebug() << "entries" << entries;
-
-    foreach (const QString& item, entries) {
-        if (item.contains(filePattern.mid(1)))
-            return true;
-    }
-
-    return false;
+    // the entry list is read once per archive version
+    return ZipArchiveCache::containsFiletype(QString(), fileName, filePattern);
 }
 
 bool FileUtils::zipExtract(const QString& fileName, const QString& outDir)
@@ -543,6 +588,37 @@ bool FileUtils::zipExtract(const QString& fileName, const QString& outDir)
     return (!JlCompress::extractDir(fileName, outDir).isEmpty());
 }
 
+bool FileUtils::zipReadEntry(const QString& fileName,
+                             const QString& entryName,
+                             QByteArray* data)
+{
+    QuaZip zip(fileName);
+    if (!zip.open(QuaZip::mdUnzip))
+    {
+        qWarning() << "Error: Cannot open archive" << fileName << zip.getZipError();
+        return false;
+    }
+
+    // located through the central directory, the other entries are skipped
+    if (!zip.setCurrentFile(entryName))
+    {
+        qWarning() << "Error: Cannot find" << entryName << "in" << fileName;
+        return false;
+    }
+
+    QuaZipFile entry(&zip);
+    if (!entry.open(QIODevice::ReadOnly))
+    {
+        qWarning() << "Error: Cannot read" << entryName << "in" << fileName << entry.getZipError();
+        return false;
+    }
+
+    *data = entry.readAll();
+    entry.close();
+
+    return (entry.getZipError() == UNZ_OK);
+}
+
 void FileUtils::cleanSmfDirRecursively(const QString& appEnvPath)
 {
     // cleanup smf dir
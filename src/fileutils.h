@@ -25,13 +25,30 @@
 
 #include <QDateTime>
 #include <QDirIterator>
+#include <QEventLoop>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QMap>
 #include <QPair>
 #include <QString>
+#include <QVector>
 
 namespace FileUtils
 {
     using DateRange = QPair<QDateTime, QDateTime>;
 
+    // summary of the timestamps of a set of files
+    struct DataAvailability
+    {
+        DateRange range;
+        QMap<QDate, int> dailyFiles;   // days without files are not listed
+        int fileCount = 0;
+        int emptyDays = 0;             // days without files within range
+        int gapCount = 0;              // runs of consecutive empty days
+        int longestGapDays = 0;
+        QDate longestGapStart;
+    };
+
     bool existsPath(const QString& p);
 
     bool isFileEmpty(const QString& fileName);
@@ -64,6 +81,10 @@ namespace FileUtils
                                       const QString& filenameFormat);
     DateRange getDateRangeFromFileList(const QStringList& fileList,
                                        const QString& filenameProtoype);
+    DataAvailability getDataAvailabilityFromFileList(const QStringList& fileList,
+                                                     const QString& filenameProtoype);
+    // keys as returned by FilenamePrototype::timestampKey(), negatives skipped
+    DataAvailability getDataAvailabilityFromKeys(const QVector<qint64>& keyList);
     bool dateRangesOverlap(DateRange range_1, DateRange range_2);
 
     QString getGhgSuffixFromFilename(const QString& filename);
@@ -76,10 +97,32 @@ namespace FileUtils
                              const QString& filePattern);
     bool zipExtract(const QString& fileName,
                     const QString& outDir);
+    // decompress only the entry entryName of the archive, in memory
+    bool zipReadEntry(const QString& fileName,
+                      const QString& entryName,
+                      QByteArray* data);
 
     bool prependToFile(const QString& str, const QString& filename);
     bool appendToFile(const QString& str, const QString& filename);
 
+    // wait for the future in a local event loop, sleeping instead of
+    // spinning on processEvents() until the result is ready
+    template <typename T>
+    T waitForFuture(const QFuture<T>& future)
+    {
+        QFutureWatcher<T> watcher;
+        QEventLoop loop;
+        QObject::connect(&watcher, &QFutureWatcher<T>::finished,
+                         &loop, &QEventLoop::quit);
+        watcher.setFuture(future);
+
+        if (!watcher.isFinished())
+        {
+            loop.exec();
+        }
+        return future.result();
+    }
+
 } // FileUtils
 
 #endif // FILEUTILS_H
@@ -96,4 +96,46 @@ void GlobalSettings::setCustomVariableList(const QStringList& varList)
                              varList.join(QStringLiteral(",")));
 }
 
+int GlobalSettings::engineMemoryBudget()
+{
+    return qMax(0, getAppPersistentSettings(Defs::CONFGROUP_PROJECT,
+                                            Defs::CONF_PROJ_ENGINE_MEMORY_BUDGET,
+                                            0).toInt());
+}
+
+void GlobalSettings::setEngineMemoryBudget(int mib)
+{
+    setAppPersistentSettings(Defs::CONFGROUP_PROJECT,
+                             Defs::CONF_PROJ_ENGINE_MEMORY_BUDGET,
+                             qMax(0, mib));
+}
+
+int GlobalSettings::engineIoBudget()
+{
+    return qMax(0, getAppPersistentSettings(Defs::CONFGROUP_PROJECT,
+                                            Defs::CONF_PROJ_ENGINE_IO_BUDGET,
+                                            0).toInt());
+}
+
+void GlobalSettings::setEngineIoBudget(int mibPerSec)
+{
+    setAppPersistentSettings(Defs::CONFGROUP_PROJECT,
+                             Defs::CONF_PROJ_ENGINE_IO_BUDGET,
+                             qMax(0, mibPerSec));
+}
+
+int GlobalSettings::consoleMaxLines()
+{
+    return qMax(100, getAppPersistentSettings(Defs::CONFGROUP_WINDOW,
+                                              Defs::CONF_WIN_CONSOLE_LINES,
+                                              10000).toInt());
+}
+
+void GlobalSettings::setConsoleMaxLines(int lines)
+{
+    setAppPersistentSettings(Defs::CONFGROUP_WINDOW,
+                             Defs::CONF_WIN_CONSOLE_LINES,
+                             qMax(100, lines));
+}
+
 //  NOTE: add error management using QSettings::status()
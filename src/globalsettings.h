@@ -46,6 +46,17 @@ QVariant getFirstAppPersistentSettings(const QString& group,
     void getCustomVariableList(QStringList* varList);
     void setCustomVariableList(const QStringList& varList);
 
+    // resources the concurrent engine processes may use, in MiB and
+    // MiB/s of disk reads and writes. 0 for no limit
+    int engineMemoryBudget();
+    void setEngineMemoryBudget(int mib);
+    int engineIoBudget();
+    void setEngineIoBudget(int mibPerSec);
+
+    // lines kept by the output console
+    int consoleMaxLines();
+    void setConsoleMaxLines(int lines);
+
 }  // namespace GlobalSettings
 
 #endif  // GLOBALSETTINGS_H
@@ -0,0 +1,354 @@
+/***************************************************************************
+  headlessrunner.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+
+#include "headlessrunner.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QJsonDocument>
+
+#include "dbghelper.h"
+#include "defs.h"
+#include "ecproject.h"
+#include "enginescheduler.h"
+#include "runchecks.h"
+
+namespace
+{
+QString engineWorkingDir()
+{
+    return QCoreApplication::applicationDirPath() + QLatin1Char('/') + Defs::BIN_FILE_DIR;
+}
+
+QString engineName(const QString& enginePath)
+{
+    return enginePath.endsWith(Defs::ENGINE_FCC) ? QStringLiteral("fcc")
+                                                 : QStringLiteral("rp");
+}
+
+QString statusName(Process::ExitStatus status)
+{
+    switch (status)
+    {
+        case Process::ExitStatus::Success:
+            return QStringLiteral("success");
+        case Process::ExitStatus::FailureToStart:
+            return QStringLiteral("failure_to_start");
+        case Process::ExitStatus::Failure:
+            return QStringLiteral("failure");
+        case Process::ExitStatus::Error:
+            return QStringLiteral("error");
+        case Process::ExitStatus::Stopped:
+            return QStringLiteral("stopped");
+    }
+    return QString();
+}
+} // namespace
+
+HeadlessRunner::HeadlessRunner(const QString& appEnvPath, QObject* parent) :
+    QObject(parent),
+    appEnvPath_(appEnvPath),
+    scheduler_(new EngineScheduler(this)),
+    out_(stdout),
+    loop_(nullptr),
+    interrupted_(false)
+{
+    QStringList env = QProcess::systemEnvironment();
+    env << QStringLiteral("GFORTRAN_UNBUFFERED_PRECONNECTED=y");
+    env << QStringLiteral("GFORTRAN_SHOW_LOCUS=n");
+    scheduler_->setEnv(env);
+
+    // the projects are independent, as in the batch queue
+    scheduler_->setStopOnFailure(false);
+
+    connect(scheduler_, &EngineScheduler::jobStarted,
+            this, &HeadlessRunner::jobStarted);
+    connect(scheduler_, &EngineScheduler::jobOutput,
+            this, &HeadlessRunner::jobOutput);
+    connect(scheduler_, &EngineScheduler::jobFinished,
+            this, &HeadlessRunner::jobFinished);
+}
+
+int HeadlessRunner::exec(const QStringList& projectFiles, int maxParallel)
+{
+    DEBUG_FUNC_NAME
+
+    QStringList args;
+    args << QStringLiteral("-c");
+    args << QStringLiteral("gui");
+    args << QStringLiteral("-s");
+    args << Defs::HOST_OS;
+    args << QStringLiteral("-e");
+    args << appEnvPath_;
+
+    scheduler_->start(engineWorkingDir() + QLatin1Char('/') + Defs::ENGINE_RP,
+                      engineWorkingDir(),
+                      args,
+                      QStringList());
+    scheduler_->setMaxParallel(maxParallel);
+
+    projects_.clear();
+    foreach (const QString& file, projectFiles)
+    {
+        Project project;
+        project.file = QFileInfo(file).absoluteFilePath();
+        projects_.append(project);
+    }
+
+    for (auto i = 0; i < projects_.size(); ++i)
+    {
+        if (!prepare(&projects_[i]))
+        {
+            projects_[i].failed = true;
+            continue;
+        }
+        addJob(i, projects_.at(i).rawProcessing ? Defs::ENGINE_RP : Defs::ENGINE_FCC);
+    }
+
+    // the jobs may have finished already, e.g. failing to start
+    if (scheduler_->isRunning())
+    {
+        QEventLoop loop;
+        connect(scheduler_, &EngineScheduler::finished, &loop, &QEventLoop::quit);
+        loop_ = &loop;
+        loop.exec();
+        loop_ = nullptr;
+    }
+
+    auto failed = 0;
+    foreach (const Project& project, projects_)
+    {
+        if (project.failed)
+        {
+            ++failed;
+        }
+    }
+
+    QJsonObject summary;
+    summary[QStringLiteral("projects")] = projects_.size();
+    summary[QStringLiteral("failed")] = failed;
+    if (interrupted_)
+    {
+        summary[QStringLiteral("interrupted")] = true;
+    }
+    writeEvent(QStringLiteral("summary"), Project(), summary);
+
+    return (failed == 0 && !interrupted_) ? 0 : 1;
+}
+
+void HeadlessRunner::stop()
+{
+    DEBUG_FUNC_NAME
+
+    interrupted_ = true;
+
+    // the stopped jobs do not report their end, nor the scheduler its own
+    scheduler_->stop();
+    if (loop_)
+    {
+        loop_->quit();
+    }
+}
+
+// the checks of MainWindow::testBeforeRunningPassed, with the default
+// answers to its questions
+bool HeadlessRunner::prepare(Project* project)
+{
+    QJsonObject check;
+    auto fail = [&](const QString& error) {
+        check[QStringLiteral("result")] = QStringLiteral("failed");
+        check[QStringLiteral("error")] = error;
+        writeEvent(QStringLiteral("check"), *project, check);
+        return false;
+    };
+
+    if (!QFileInfo(project->file).isReadable())
+    {
+        return fail(QStringLiteral("project file not readable"));
+    }
+
+    EcProject ecProject(nullptr, ProjConfigState());
+    if (!ecProject.nativeFormat(project->file)
+        || !ecProject.loadEcProject(project->file, false))
+    {
+        return fail(QStringLiteral("not a valid project file"));
+    }
+
+    if (ecProject.generalOutPath().isEmpty()
+        || !QDir().mkpath(ecProject.generalOutPath()))
+    {
+        return fail(QStringLiteral("output directory not available"));
+    }
+
+    if (ecProject.generalRunMode() != Defs::CurrRunMode::Retriever
+        && !QDir(ecProject.screenDataPath()).exists())
+    {
+        return fail(QStringLiteral("raw data directory not available"));
+    }
+
+    const auto advanced = (ecProject.generalRunMode() == Defs::CurrRunMode::Advanced);
+    project->rawProcessing = true;
+    project->spectralStep = advanced && ecProject.isEngineStep2Needed();
+
+    if (!ecProject.spectraExDir().isEmpty())
+    {
+        const auto essentialsFile = RunChecks::findPreviousRun(appEnvPath_, ecProject);
+        check[QStringLiteral("previous_results")] = !essentialsFile.isEmpty();
+
+        if (!essentialsFile.isEmpty())
+        {
+            RunChecks::usePreviousRun(&ecProject, essentialsFile);
+
+            // "Do you want to proceed using results from a previous run?"
+            if (advanced)
+            {
+                project->rawProcessing = false;
+                project->spectralStep = true;
+            }
+        }
+    }
+
+    if (!ecProject.saveEcProject(project->file))
+    {
+        return fail(QStringLiteral("project file not writable"));
+    }
+
+    check[QStringLiteral("result")] = QStringLiteral("passed");
+    writeEvent(QStringLiteral("check"), *project, check);
+    return true;
+}
+
+void HeadlessRunner::addJob(int project, const QString& engine)
+{
+    // the job may start and end at once, see jobFinished()
+    const auto job = scheduler_->jobCount();
+    jobProjects_.insert(job, project);
+    jobEngines_.insert(job, engineName(engine));
+    scheduler_->addJob(projects_.at(project).file,
+                       engineWorkingDir() + QLatin1Char('/') + engine);
+}
+
+void HeadlessRunner::jobStarted(int job)
+{
+    auto& project = projects_[jobProjects_.value(job)];
+    project.progress.reset();
+
+    QJsonObject start;
+    start[QStringLiteral("engine")] = jobEngines_.value(job);
+    writeEvent(QStringLiteral("start"), project, start);
+}
+
+// progress from the engine messages, as the run page and the batch queue
+void HeadlessRunner::jobOutput(int job, const QByteArray& lines)
+{
+    auto& project = projects_[jobProjects_.value(job)];
+
+    foreach (const QByteArray& line, lines.split('\n'))
+    {
+        const auto update = project.progress.addLine(line);
+        if (update != EngineRunProgress::Update::PeriodStarted
+            && update != EngineRunProgress::Update::Message)
+        {
+            continue;
+        }
+
+        QJsonObject fields;
+        fields[QStringLiteral("engine")] = jobEngines_.value(job);
+
+        if (update == EngineRunProgress::Update::PeriodStarted)
+        {
+            const auto& progress = project.progress;
+            fields[QStringLiteral("phase")] = EngineRunProgress::phaseName(progress.phase());
+            fields[QStringLiteral("period")] = progress.periodIndex();
+            fields[QStringLiteral("periods")] = progress.periodCount();
+            const auto etc = progress.etcMSec();
+            if (etc >= 0)
+            {
+                fields[QStringLiteral("etc_ms")] = etc;
+            }
+            writeEvent(QStringLiteral("progress"), project, fields);
+        }
+        else
+        {
+            fields[QStringLiteral("text")] = QString::fromLatin1(line.trimmed());
+            writeEvent(QStringLiteral("message"), project, fields);
+        }
+    }
+}
+
+void HeadlessRunner::jobFinished(int job, Process::ExitStatus status)
+{
+    const auto index = jobProjects_.value(job);
+    auto& project = projects_[index];
+
+    QJsonObject end;
+    end[QStringLiteral("engine")] = jobEngines_.value(job);
+    end[QStringLiteral("status")] = statusName(status);
+    writeEvent(QStringLiteral("end"), project, end);
+
+    if (status != Process::ExitStatus::Success)
+    {
+        project.failed = true;
+        return;
+    }
+
+    // the spectral corrections follow the raw processing
+    if (jobEngines_.value(job) == QLatin1String("rp") && project.spectralStep)
+    {
+        EcProject ecProject(nullptr, ProjConfigState());
+        if (!ecProject.loadEcProject(project.file, false))
+        {
+            project.failed = true;
+            return;
+        }
+
+        RunChecks::useRawProcessingSpectra(&ecProject);
+        if (!ecProject.saveEcProject(project.file))
+        {
+            project.failed = true;
+            return;
+        }
+        addJob(index, Defs::ENGINE_FCC);
+    }
+}
+
+// one JSON object per line
+void HeadlessRunner::writeEvent(const QString& event,
+                                const Project& project,
+                                QJsonObject fields)
+{
+    fields[QStringLiteral("event")] = event;
+    if (!project.file.isEmpty())
+    {
+        fields[QStringLiteral("project")] = project.file;
+    }
+    fields[QStringLiteral("time")] = QDateTime::currentDateTime().toString(Qt::ISODate);
+
+    out_ << QString::fromUtf8(QJsonDocument(fields).toJson(QJsonDocument::Compact))
+         << QLatin1Char('\n');
+    out_.flush();
+}
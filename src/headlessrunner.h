@@ -0,0 +1,107 @@
+/***************************************************************************
+  headlessrunner.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QObject>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+#include "enginerunprogress.h"
+#include "process.h"
+
+class EngineScheduler;
+class QEventLoop;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/headlessrunner.h
+/// \brief Run of project files from the command line, without widgets
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note Started by the --run option with a QCoreApplication only. Each
+/// project gets the checks of a run started from the main window, taking
+/// the default answer where the GUI asks: an advanced run with previous
+/// results available uses them and runs the spectral corrections only.
+/// The progress is written to stdout as one JSON object per line, e.g.
+/// {"event":"progress","project":"site.eddypro","engine":"rp",
+/// "phase":"raw_processing","period":12,"periods":480,"etc_ms":5280000,
+/// "time":"2016-03-01T12:00:00"}
+/// with the events check, start, progress, message, end and summary.
+/// \sa RunChecks, EngineScheduler
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \class HeadlessRunner
+/// \brief Check and run projects with machine readable progress
+class HeadlessRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HeadlessRunner(const QString& appEnvPath, QObject* parent = nullptr);
+
+    // process the projects with at most maxParallel engines at the same
+    // time. return 0 if all of them succeeded, 1 otherwise or if stopped
+    int exec(const QStringList& projectFiles, int maxParallel);
+
+public slots:
+    // kill the running engines and make exec() return 1, e.g. on SIGINT
+    void stop();
+
+private slots:
+    void jobStarted(int job);
+    void jobOutput(int job, const QByteArray& lines);
+    void jobFinished(int job, Process::ExitStatus status);
+
+private:
+    struct Project
+    {
+        QString file;
+        bool rawProcessing = true;
+        bool spectralStep = false;
+        bool failed = false;
+        EngineRunProgress progress;
+    };
+
+    bool prepare(Project* project);
+    void addJob(int project, const QString& engine);
+    void writeEvent(const QString& event, const Project& project, QJsonObject fields);
+
+    QString appEnvPath_;
+    EngineScheduler* scheduler_;
+    QVector<Project> projects_;
+    QHash<int, int> jobProjects_;   // scheduler job -> project
+    QHash<int, QString> jobEngines_;
+    QTextStream out_;
+    QEventLoop* loop_;
+    bool interrupted_;
+};
+
+#endif // HEADLESSRUNNER_H
@@ -0,0 +1,261 @@
+/***************************************************************************
+  incrementalrun.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "incrementalrun.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+
+#include <algorithm>
+
+#include "defs.h"
+#include "resultcache.h"
+
+namespace
+{
+// the last rows are searched in the tail of the file only
+const qint64 TAIL_SIZE = 64 * 1024;
+
+QList<QByteArray> splitLines(const QByteArray& data)
+{
+    auto lines = data.split('\n');
+    if (!lines.isEmpty() && lines.last().isEmpty())
+    {
+        lines.removeLast();
+    }
+    for (auto& line : lines)
+    {
+        if (line.endsWith('\r'))
+        {
+            line.chop(1);
+        }
+    }
+    return lines;
+}
+
+// the header lines precede the first row with a valid period end
+int headerLineCount(const QList<QByteArray>& lines)
+{
+    auto count = 0;
+    while (count < lines.size() && !ResultCache::rowPeriodEnd(lines.at(count)).isValid())
+    {
+        ++count;
+    }
+    return count;
+}
+
+// period end of the last row, invalid if there is none
+QDateTime lastPeriodEnd(const QList<QByteArray>& lines)
+{
+    QDateTime lastEnd;
+    for (auto it = lines.crbegin(); it != lines.crend() && !lastEnd.isValid(); ++it)
+    {
+        lastEnd = ResultCache::rowPeriodEnd(*it);
+    }
+    return lastEnd;
+}
+} // namespace
+
+// run timestamp in the output file names, e.g. 2016-03-01T120000
+QString IncrementalRun::outputNamePattern(const QString& fileName)
+{
+    static const QRegularExpression runTimestamp(QStringLiteral("\\d{4}-\\d{2}-\\d{2}T\\d{6}"));
+
+    auto pattern = fileName;
+    return pattern.replace(runTimestamp, QStringLiteral("*"));
+}
+
+bool IncrementalRun::appendOutputRows(const QString& runningFile, const QString& newFile)
+{
+    QFile file(newFile);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    const auto lines = splitLines(file.readAll());
+    file.close();
+
+    QFile running(runningFile);
+    if (!running.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    // a changed column layout changes the header, the whole of it must
+    // match. the line following it, if any, must be a row
+    const auto headerLines = headerLineCount(lines);
+    QByteArray head;
+    for (auto i = 0; i <= headerLines && !running.atEnd(); ++i)
+    {
+        head.append(running.readLine());
+    }
+
+    // keep the end of line of the running file
+    const QByteArray eol = head.contains("\r\n") ? QByteArrayLiteral("\r\n")
+                                                 : QByteArrayLiteral("\n");
+    const auto runningHeader = splitLines(head);
+    if (headerLines == 0
+        || headerLineCount(runningHeader) != headerLines
+        || !std::equal(lines.cbegin(), lines.cbegin() + headerLines, runningHeader.cbegin()))
+    {
+        qWarning() << "Output header changed, not appended" << newFile << "to" << runningFile;
+        return false;
+    }
+
+    // the rows already in the running file are not appended twice
+    const auto size = running.size();
+    running.seek(qMax(Q_INT64_C(0), size - TAIL_SIZE));
+    const auto tail = running.readAll();
+    const auto lastEnd = lastPeriodEnd(splitLines(tail));
+    running.close();
+
+    QByteArray data;
+    if (!tail.isEmpty() && !tail.endsWith('\n'))
+    {
+        data.append(eol);
+    }
+    auto skipped = 0;
+    for (auto i = headerLines; i < lines.size(); ++i)
+    {
+        const auto periodEnd = ResultCache::rowPeriodEnd(lines.at(i));
+        if (lastEnd.isValid() && periodEnd.isValid() && periodEnd <= lastEnd)
+        {
+            ++skipped;
+            continue;
+        }
+        data.append(lines.at(i));
+        data.append(eol);
+    }
+    if (skipped > 0)
+    {
+        qDebug() << "skipped" << skipped << "rows up to" << lastEnd << "of" << newFile;
+    }
+
+    // only the new rows are written. on error, the running file is cut
+    // back to its previous size
+    if (!running.open(QIODevice::WriteOnly | QIODevice::Append))
+    {
+        qWarning() << "Error: Cannot write" << runningFile << running.errorString();
+        return false;
+    }
+    if (running.write(data) != data.size()
+        || !running.flush())
+    {
+        qWarning() << "Error: Cannot write" << runningFile << running.errorString();
+        running.resize(size);
+        return false;
+    }
+    return true;
+}
+
+QDateTime IncrementalRun::lastProcessedPeriod(const QString& outPath)
+{
+    const QStringList nameFilter(QStringLiteral("*full_output*.")
+                                 + Defs::CSV_NATIVE_DATA_FILE_EXT);
+    const auto outputs = QDir(outPath).entryInfoList(nameFilter, QDir::Files, QDir::Time);
+    if (outputs.isEmpty())
+    {
+        return QDateTime();
+    }
+
+    QFile file(outputs.first().absoluteFilePath());
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QDateTime();
+    }
+
+    file.seek(qMax(Q_INT64_C(0), file.size() - TAIL_SIZE));
+    const auto lastEnd = lastPeriodEnd(splitLines(file.readAll()));
+
+    qDebug() << "last processed period" << file.fileName() << lastEnd;
+    return lastEnd;
+}
+
+QStringList IncrementalRun::appendNewOutputs(const QString& outPath,
+                                             const QDateTime& runStart,
+                                             QString* errorString)
+{
+    const QStringList nameFilter(QStringLiteral("*.") + Defs::CSV_NATIVE_DATA_FILE_EXT);
+    const auto outputs = QDir(outPath).entryInfoList(nameFilter, QDir::Files, QDir::Time);
+
+    QFileInfoList newFiles;
+    QFileInfoList oldFiles;
+    foreach (const QFileInfo& info, outputs)
+    {
+        if (info.lastModified() >= runStart)
+        {
+            newFiles.append(info);
+        }
+        else
+        {
+            oldFiles.append(info);
+        }
+    }
+
+    QStringList extendedFiles;
+    QStringList failedFiles;
+    foreach (const QFileInfo& newFile, newFiles)
+    {
+        const auto pattern = outputNamePattern(newFile.fileName());
+        if (pattern == newFile.fileName())
+        {
+            continue;
+        }
+
+        // the newest previous file of the same kind, oldFiles is sorted by time
+        QString runningFile;
+        foreach (const QFileInfo& oldFile, oldFiles)
+        {
+            if (outputNamePattern(oldFile.fileName()) == pattern)
+            {
+                runningFile = oldFile.absoluteFilePath();
+                break;
+            }
+        }
+
+        // the first run, the new file starts the series
+        if (runningFile.isEmpty())
+        {
+            continue;
+        }
+
+        if (!appendOutputRows(runningFile, newFile.absoluteFilePath()))
+        {
+            failedFiles.append(newFile.fileName());
+            continue;
+        }
+
+        QFile::remove(newFile.absoluteFilePath());
+        extendedFiles.append(runningFile);
+    }
+
+    qDebug() << "appended" << extendedFiles << "failed" << failedFiles;
+
+    if (errorString)
+    {
+        *errorString = failedFiles.join(QStringLiteral(", "));
+    }
+    return extendedFiles;
+}
@@ -0,0 +1,77 @@
+/***************************************************************************
+  incrementalrun.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef INCREMENTALRUN_H
+#define INCREMENTALRUN_H
+
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/incrementalrun.h
+/// \brief Output handling of the runs appending new data
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note An incremental run processes only the raw data following the last
+/// averaging period of the full output already in the output directory.
+/// At the end, the rows of each new output file are appended to the
+/// running file with the same name but an older run timestamp, and the
+/// new file is removed. Only the files directly in the output directory
+/// are appended, the subdirectories are left untouched.
+/// \sa ResultCache
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \namespace IncrementalRun
+/// \brief Append the output of a run to the previous output files
+namespace IncrementalRun
+{
+    // end of the last averaging period of the newest full output in outPath,
+    // invalid if there is none
+    QDateTime lastProcessedPeriod(const QString& outPath);
+
+    // append the CSV files of outPath written since runStart to the older
+    // running files with the same name pattern. return the running files
+    // extended, errorString lists the files that could not be appended
+    QStringList appendNewOutputs(const QString& outPath,
+                                 const QDateTime& runStart,
+                                 QString* errorString = nullptr);
+
+    // file name with the run timestamp replaced by '*', e.g.
+    // eddypro_site_full_output_*_adv.csv. same as fileName if it has none
+    QString outputNamePattern(const QString& fileName);
+
+    // append to runningFile the rows of newFile following its header, the
+    // lines before the first row with a valid period end. the rows ending
+    // up to the last period of runningFile are skipped. false, and the
+    // running file untouched, if the two headers differ or it cannot be
+    // written
+    bool appendOutputRows(const QString& runningFile, const QString& newFile);
+
+} // IncrementalRun
+
+#endif // INCREMENTALRUN_H
@@ -0,0 +1,911 @@
+/***************************************************************************
+  inifile.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "inifile.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+
+#include <limits>
+
+namespace
+{
+#ifdef Q_OS_WIN
+const char EOL[] = "\r\n";
+#else
+const char EOL[] = "\n";
+#endif
+
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+inline bool isSpace(char ch)
+{
+    return (ch == ' ' || ch == '\t');
+}
+
+inline int hexValue(char ch)
+{
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+// as QSettings, "%XX" and "%UXXXX" are escaped chars, '\' is '/'
+QString unescapedKey(const char* data, int from, int to)
+{
+    // common case, plain ascii key
+    auto plain = true;
+    for (auto i = from; i < to && plain; ++i)
+    {
+        const auto ch = static_cast<uchar>(data[i]);
+        plain = (ch != '\\' && ch != '%' && ch < 0x80);
+    }
+    if (plain)
+    {
+        return QString::fromLatin1(data + from, to - from);
+    }
+
+    QString key;
+    key.reserve(to - from);
+
+    auto i = from;
+    while (i < to)
+    {
+        const auto ch = data[i];
+        if (ch == '\\')
+        {
+            key += QLatin1Char('/');
+            ++i;
+        }
+        else if (ch == '%' && i + 2 < to)
+        {
+            auto ok = false;
+            if (data[i + 1] == 'U' && i + 6 <= to)
+            {
+                const auto code = QByteArray(data + i + 2, 4).toUShort(&ok, 16);
+                if (ok)
+                {
+                    key += QChar(code);
+                    i += 6;
+                    continue;
+                }
+            }
+            const auto code = QByteArray(data + i + 1, 2).toUShort(&ok, 16);
+            if (ok)
+            {
+                key += QChar(code);
+                i += 3;
+            }
+            else
+            {
+                key += QLatin1Char('%');
+                ++i;
+            }
+        }
+        else
+        {
+            // keys are plain text, decode the UTF-8 runs
+            auto j = i;
+            while (j < to && data[j] != '\\' && data[j] != '%')
+            {
+                ++j;
+            }
+            key += QString::fromUtf8(data + i, j - i);
+            i = j;
+        }
+    }
+    return key;
+}
+
+// as QSettings, "@@" escapes a leading '@' and "@Invalid()" is a null value
+QVariant stringToVariant(const QString& str)
+{
+    if (!str.startsWith(QLatin1Char('@')))
+    {
+        return str;
+    }
+    if (str.startsWith(QLatin1String("@@")))
+    {
+        return str.mid(1);
+    }
+    if (str == QLatin1String("@Invalid()"))
+    {
+        return QVariant();
+    }
+    if (str.startsWith(QLatin1String("@ByteArray(")) && str.endsWith(QLatin1Char(')')))
+    {
+        return str.mid(11, str.size() - 12).toLatin1();
+    }
+    return str;
+}
+
+// as QSettings, a value is a comma separated list of items, each one
+// either plain (trimmed) or double quoted, with C-like escapes.
+// one item is a string, more items are a string list
+QVariant unescapedValue(const char* data, int from, int to)
+{
+    while (from < to && isSpace(data[from]))
+    {
+        ++from;
+    }
+
+    // common case, nothing to unescape
+    auto plain = (from == to || data[from] != '@');
+    for (auto i = from; i < to && plain; ++i)
+    {
+        const auto ch = data[i];
+        plain = (ch != '"' && ch != '\\' && ch != ',');
+    }
+    if (plain)
+    {
+        return QString::fromUtf8(data + from, to - from);
+    }
+
+    QStringList items;
+    QString item;
+    QByteArray utf8;    // raw bytes of the item still to decode
+    auto inQuotes = false;
+    auto pendingSpaces = 0;
+    auto itemStarted = false;
+
+    auto flush = [&]()
+    {
+        if (!utf8.isEmpty())
+        {
+            item += QString::fromUtf8(utf8);
+            utf8.clear();
+        }
+    };
+    auto startItem = [&]()
+    {
+        utf8.append(pendingSpaces, ' ');
+        pendingSpaces = 0;
+        itemStarted = true;
+    };
+
+    for (auto i = from; i < to; ++i)
+    {
+        const auto ch = data[i];
+
+        if (ch == '\\' && i + 1 < to)
+        {
+            startItem();
+
+            const auto next = data[++i];
+            switch (next)
+            {
+                case 'a': utf8 += '\a'; break;
+                case 'b': utf8 += '\b'; break;
+                case 'f': utf8 += '\f'; break;
+                case 'n': utf8 += '\n'; break;
+                case 'r': utf8 += '\r'; break;
+                case 't': utf8 += '\t'; break;
+                case 'v': utf8 += '\v'; break;
+                case 'x':
+                {
+                    // the writer escapes a hex digit following a "\x" sequence
+                    ushort code = 0;
+                    auto digits = 0;
+                    while (i + 1 < to && hexValue(data[i + 1]) >= 0)
+                    {
+                        code = static_cast<ushort>(code * 16 + hexValue(data[++i]));
+                        ++digits;
+                    }
+                    if (digits)
+                    {
+                        flush();
+                        item += QChar(code);
+                    }
+                    else
+                    {
+                        utf8 += next;
+                    }
+                    break;
+                }
+                default:
+                    if (next >= '0' && next <= '7')
+                    {
+                        ushort code = static_cast<ushort>(next - '0');
+                        while (i + 1 < to && data[i + 1] >= '0' && data[i + 1] <= '7')
+                        {
+                            code = static_cast<ushort>(code * 8 + (data[++i] - '0'));
+                        }
+                        flush();
+                        item += QChar(code);
+                    }
+                    else
+                    {
+                        utf8 += next;
+                    }
+                    break;
+            }
+            continue;
+        }
+
+        if (inQuotes)
+        {
+            if (ch == '"')
+            {
+                inQuotes = false;
+            }
+            else
+            {
+                utf8 += ch;
+            }
+            continue;
+        }
+
+        if (ch == ',')
+        {
+            flush();
+            items.append(item);
+            item.clear();
+            pendingSpaces = 0;
+            itemStarted = false;
+        }
+        else if (ch == '"')
+        {
+            inQuotes = true;
+            startItem();
+        }
+        else if (isSpace(ch))
+        {
+            // inner spaces are kept, leading and trailing ones dropped
+            if (itemStarted)
+            {
+                ++pendingSpaces;
+            }
+        }
+        else
+        {
+            startItem();
+            utf8 += ch;
+        }
+    }
+    flush();
+    items.append(item);
+
+    if (items.size() == 1)
+    {
+        return stringToVariant(items.first());
+    }
+
+    for (auto& listItem : items)
+    {
+        if (listItem.startsWith(QLatin1String("@@")))
+        {
+            listItem.remove(0, 1);
+        }
+    }
+    return items;
+}
+
+// as QSettings, '/' is '\' and the chars other than [A-Za-z0-9_-.]
+// are "%XX" or "%UXXXX"
+void appendEscapedKey(const QString& key, int from, QByteArray& result)
+{
+    for (auto i = from; i < key.size(); ++i)
+    {
+        const auto ch = key.at(i).unicode();
+        if (ch == '/')
+        {
+            result += '\\';
+        }
+        else if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z')
+                 || (ch >= '0' && ch <= '9')
+                 || ch == '_' || ch == '-' || ch == '.')
+        {
+            result += static_cast<char>(ch);
+        }
+        else if (ch <= 0xFF)
+        {
+            result += '%';
+            result += HEX_DIGITS[ch / 16];
+            result += HEX_DIGITS[ch % 16];
+        }
+        else
+        {
+            result += "%U";
+            result += HEX_DIGITS[(ch >> 12) & 0xF];
+            result += HEX_DIGITS[(ch >> 8) & 0xF];
+            result += HEX_DIGITS[(ch >> 4) & 0xF];
+            result += HEX_DIGITS[ch & 0xF];
+        }
+    }
+}
+
+// as QSettings, C-like escapes, the chars outside of the printable
+// ascii range as "\xHHHH", quotes if the value is ambiguous
+void appendEscapedString(const QString& str, QByteArray& result)
+{
+    const auto start = result.size();
+    auto needsQuotes = false;
+    auto escapeNextIfDigit = false;
+
+    for (auto i = 0; i < str.size(); ++i)
+    {
+        const auto ch = str.at(i).unicode();
+        if (ch == ';' || ch == ',' || ch == '=')
+        {
+            needsQuotes = true;
+        }
+
+        if (escapeNextIfDigit && ch < 0x80 && hexValue(static_cast<char>(ch)) >= 0)
+        {
+            result += "\\x";
+            result += QByteArray::number(ch, 16);
+            continue;
+        }
+        escapeNextIfDigit = false;
+
+        switch (ch)
+        {
+            case '\0':
+                result += "\\0";
+                escapeNextIfDigit = true;
+                break;
+            case '\a': result += "\\a"; break;
+            case '\b': result += "\\b"; break;
+            case '\f': result += "\\f"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            case '\v': result += "\\v"; break;
+            case '"':
+            case '\\':
+                result += '\\';
+                result += static_cast<char>(ch);
+                break;
+            default:
+                if (ch <= 0x1F || ch >= 0x7F)
+                {
+                    result += "\\x";
+                    result += QByteArray::number(ch, 16);
+                    escapeNextIfDigit = true;
+                }
+                else
+                {
+                    result += static_cast<char>(ch);
+                }
+                break;
+        }
+    }
+
+    if (needsQuotes
+        || (start < result.size()
+            && (result.at(start) == ' ' || result.at(result.size() - 1) == ' ')))
+    {
+        result.insert(start, '"');
+        result += '"';
+    }
+}
+
+void appendEscapedValue(const QVariant& value, QByteArray& result)
+{
+    switch (value.type())
+    {
+        case QVariant::Invalid:
+            result += "@Invalid()";
+            break;
+        case QVariant::StringList:
+        case QVariant::List:
+        {
+            const auto list = value.toStringList();
+            if (list.isEmpty())
+            {
+                result += "@Invalid()";
+                break;
+            }
+            for (auto i = 0; i < list.size(); ++i)
+            {
+                if (i)
+                {
+                    result += ", ";
+                }
+                const auto& item = list.at(i);
+                appendEscapedString(item.startsWith(QLatin1Char('@'))
+                                    ? QString(QLatin1Char('@') + item)
+                                    : item,
+                                    result);
+            }
+            break;
+        }
+        case QVariant::ByteArray:
+            appendEscapedString(QLatin1String("@ByteArray(")
+                                + QString::fromLatin1(value.toByteArray())
+                                + QLatin1Char(')'),
+                                result);
+            break;
+        default:
+        {
+            const auto str = value.toString();
+            appendEscapedString(str.startsWith(QLatin1Char('@'))
+                                ? QString(QLatin1Char('@') + str)
+                                : str,
+                                result);
+            break;
+        }
+    }
+}
+} // namespace
+
+IniFile::IniFile()
+{
+}
+
+IniFile::IniFile(const QByteArray& data)
+{
+    setData(data);
+}
+
+IniFile::~IniFile()
+{
+    unmap();
+}
+
+bool IniFile::setData(const QByteArray& data)
+{
+    clear();
+    data_ = data;
+    parse();
+    return !data_.isEmpty();
+}
+
+bool IniFile::load(const QString& fileName)
+{
+    clear();
+
+    QScopedPointer<QFile> file(new QFile(fileName));
+    if (!file->open(QIODevice::ReadOnly))
+    {
+        qDebug() << "Error: Cannot open" << fileName << file->errorString();
+        return false;
+    }
+
+    const auto size = file->size();
+    if (size > 0 && size < std::numeric_limits<int>::max())
+    {
+        const auto bytes = file->map(0, size);
+        if (bytes)
+        {
+            data_ = QByteArray::fromRawData(reinterpret_cast<const char*>(bytes),
+                                            static_cast<int>(size));
+            mappedFile_.swap(file);
+        }
+    }
+
+    if (!mappedFile_)
+    {
+        data_ = file->readAll();
+    }
+
+    parse();
+    return !data_.isEmpty();
+}
+
+void IniFile::parse()
+{
+    const auto data = data_.constData();
+    const auto size = data_.size();
+
+    // at most a key per line
+    const auto lineCount = data_.count('\n') + 1;
+    entries_.reserve(lineCount);
+    index_.reserve(lineCount);
+
+    QString sectionPrefix;
+    auto lineStart = 0;
+
+    while (lineStart < size)
+    {
+        auto lineEnd = data_.indexOf('\n', lineStart);
+        if (lineEnd < 0)
+        {
+            lineEnd = size;
+        }
+
+        // as QSettings, a ';' out of quotes starts a comment
+        auto from = lineStart;
+        auto to = lineEnd;
+        auto inQuotes = false;
+        for (auto i = from; i < to; ++i)
+        {
+            if (data[i] == '\\')
+            {
+                ++i;
+            }
+            else if (data[i] == '"')
+            {
+                inQuotes = !inQuotes;
+            }
+            else if (data[i] == ';' && !inQuotes)
+            {
+                to = i;
+            }
+        }
+
+        // trim the line in place
+        while (from < to && isSpace(data[from]))
+        {
+            ++from;
+        }
+        while (to > from && (data[to - 1] == '\r' || isSpace(data[to - 1])))
+        {
+            --to;
+        }
+        lineStart = lineEnd + 1;
+
+        if (from == to)
+        {
+            continue;
+        }
+
+        if (data[from] == '[')
+        {
+            auto close = to - 1;
+            while (close > from && data[close] != ']')
+            {
+                --close;
+            }
+            if (close == from)
+            {
+                close = to;
+            }
+
+            auto section = unescapedKey(data, from + 1, close);
+            if (section.compare(QLatin1String("General"), Qt::CaseInsensitive) == 0)
+            {
+                section.clear();
+            }
+            else if (section.startsWith(QLatin1String("%General")))
+            {
+                section.remove(0, 1);
+            }
+            sectionPrefix = section;
+            if (!sectionPrefix.isEmpty())
+            {
+                sectionPrefix += QLatin1Char('/');
+            }
+            continue;
+        }
+
+        auto equal = from;
+        while (equal < to && data[equal] != '=')
+        {
+            ++equal;
+        }
+        if (equal == to)
+        {
+            continue;
+        }
+
+        auto keyEnd = equal;
+        while (keyEnd > from && isSpace(data[keyEnd - 1]))
+        {
+            --keyEnd;
+        }
+        if (keyEnd == from)
+        {
+            continue;
+        }
+
+        const QString key = sectionPrefix + unescapedKey(data, from, keyEnd);
+
+        // as QSettings, the last occurrence wins
+        const auto it = index_.constFind(key);
+        if (it != index_.constEnd())
+        {
+            auto& entry = entries_[it.value()];
+            entry.valueFrom = equal + 1;
+            entry.valueTo = to;
+        }
+        else
+        {
+            index_.insert(key, entries_.size());
+            entries_.append({ key, equal + 1, to, QVariant(), false });
+        }
+    }
+}
+
+void IniFile::unmap()
+{
+    // drop the raw view before the mapping
+    data_.clear();
+    mappedFile_.reset();
+}
+
+QByteArray IniFile::toByteArray() const
+{
+    // entries of each section, sections in order of first appearance.
+    // as QSettings, a group emptied and written again keeps its place
+    QStringList sections;
+    QHash<QString, QVector<int>> sectionEntries;
+    for (auto i = 0; i < entries_.size(); ++i)
+    {
+        const auto& entry = entries_.at(i);
+        const auto slash = entry.key.indexOf(QLatin1Char('/'));
+        const auto section = (slash < 0) ? QString() : entry.key.left(slash);
+
+        auto it = sectionEntries.find(section);
+        if (it == sectionEntries.end())
+        {
+            sections.append(section);
+            it = sectionEntries.insert(section, QVector<int>());
+        }
+        if (!entry.removed)
+        {
+            it->append(i);
+        }
+    }
+
+    QByteArray result;
+    result.reserve(data_.size() + entries_.size() * 48);
+
+    foreach (const QString& section, sections)
+    {
+        const auto indexes = sectionEntries.value(section);
+        if (indexes.isEmpty())
+        {
+            continue;
+        }
+
+        if (!result.isEmpty())
+        {
+            result += EOL;
+        }
+
+        result += '[';
+        if (section.isEmpty())
+        {
+            result += "General";
+        }
+        else
+        {
+            if (section.compare(QLatin1String("General"), Qt::CaseInsensitive) == 0)
+            {
+                result += '%';
+            }
+            appendEscapedKey(section, 0, result);
+        }
+        result += ']';
+        result += EOL;
+
+        const auto keyStart = section.isEmpty() ? 0 : section.size() + 1;
+        foreach (int i, indexes)
+        {
+            const auto& entry = entries_.at(i);
+            appendEscapedKey(entry.key, keyStart, result);
+            result += '=';
+            if (entry.valueFrom < 0)
+            {
+                appendEscapedValue(entry.value, result);
+            }
+            else
+            {
+                // untouched values are copied as they were read
+                auto from = entry.valueFrom;
+                while (from < entry.valueTo && isSpace(data_.at(from)))
+                {
+                    ++from;
+                }
+                result.append(data_.constData() + from, entry.valueTo - from);
+            }
+            result += EOL;
+        }
+    }
+
+    return result;
+}
+
+bool IniFile::save(const QString& fileName, const QString& headerComment)
+{
+    errorString_.clear();
+
+    // the mapped file could be the one to replace
+    if (mappedFile_)
+    {
+        const QByteArray data(data_.constData(), data_.size());
+        data_ = data;
+        mappedFile_.reset();
+    }
+
+    QByteArray bytes;
+    if (!headerComment.isEmpty())
+    {
+        bytes = headerComment.toUtf8();
+        bytes += EOL;
+    }
+    bytes += toByteArray();
+
+    // the whole content goes in a temporary file in the same directory,
+    // flushed to disk and renamed over the old file only when complete
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        errorString_ = file.errorString();
+        qWarning() << "Error: Cannot write" << fileName << errorString_;
+        return false;
+    }
+
+    if (file.write(bytes) != bytes.size() || !file.commit())
+    {
+        errorString_ = file.errorString();
+        qWarning() << "Error: Cannot write" << fileName << errorString_;
+        return false;
+    }
+    return true;
+}
+
+void IniFile::clear()
+{
+    unmap();
+    entries_.clear();
+    index_.clear();
+    groupStack_.clear();
+}
+
+void IniFile::beginGroup(const QString& prefix)
+{
+    groupStack_.append(fullKey(prefix));
+}
+
+void IniFile::endGroup()
+{
+    if (!groupStack_.isEmpty())
+    {
+        groupStack_.removeLast();
+    }
+}
+
+QString IniFile::fullKey(const QString& key) const
+{
+    if (groupStack_.isEmpty())
+    {
+        return key;
+    }
+
+    const auto& currentGroup = groupStack_.last();
+    if (key.isEmpty() || currentGroup.isEmpty())
+    {
+        return key.isEmpty() ? currentGroup : key;
+    }
+    return currentGroup + QLatin1Char('/') + key;
+}
+
+QVariant IniFile::value(const QString& key, const QVariant& defaultValue) const
+{
+    const auto it = index_.constFind(fullKey(key));
+    if (it == index_.constEnd())
+    {
+        return defaultValue;
+    }
+
+    const auto& entry = entries_.at(it.value());
+    if (entry.valueFrom < 0)
+    {
+        return entry.value;
+    }
+    return unescapedValue(data_.constData(), entry.valueFrom, entry.valueTo);
+}
+
+bool IniFile::contains(const QString& key) const
+{
+    return index_.contains(fullKey(key));
+}
+
+void IniFile::setValue(const QString& key, const QVariant& value)
+{
+    const auto k = fullKey(key);
+    if (k.isEmpty())
+    {
+        return;
+    }
+
+    const auto it = index_.constFind(k);
+    if (it != index_.constEnd())
+    {
+        auto& entry = entries_[it.value()];
+        entry.valueFrom = -1;
+        entry.valueTo = -1;
+        entry.value = value;
+    }
+    else
+    {
+        index_.insert(k, entries_.size());
+        entries_.append({ k, -1, -1, value, false });
+    }
+}
+
+void IniFile::remove(const QString& key)
+{
+    const auto k = fullKey(key);
+    if (k.isEmpty())
+    {
+        entries_.clear();
+        index_.clear();
+        return;
+    }
+
+    const QString subkeyPrefix = k + QLatin1Char('/');
+    for (auto& entry : entries_)
+    {
+        if (!entry.removed && (entry.key == k || entry.key.startsWith(subkeyPrefix)))
+        {
+            index_.remove(entry.key);
+            entry.removed = true;
+            entry.value = QVariant();
+        }
+    }
+}
+
+QStringList IniFile::allKeys() const
+{
+    auto prefix = group();
+    if (!prefix.isEmpty())
+    {
+        prefix += QLatin1Char('/');
+    }
+
+    QStringList keys;
+    for (auto it = index_.constBegin(); it != index_.constEnd(); ++it)
+    {
+        if (it.key().startsWith(prefix))
+        {
+            keys.append(it.key().mid(prefix.size()));
+        }
+    }
+    keys.sort();
+    return keys;
+}
+
+QStringList IniFile::childGroups() const
+{
+    QStringList groups;
+    foreach (const QString& key, allKeys())
+    {
+        const auto slash = key.indexOf(QLatin1Char('/'));
+        if (slash > 0)
+        {
+            const auto childGroup = key.left(slash);
+            if (groups.isEmpty() || groups.last() != childGroup)
+            {
+                groups.append(childGroup);
+            }
+        }
+    }
+    return groups;
+}
+
+QStringList IniFile::childKeys() const
+{
+    QStringList keys;
+    foreach (const QString& key, allKeys())
+    {
+        if (!key.contains(QLatin1Char('/')))
+        {
+            keys.append(key);
+        }
+    }
+    return keys;
+}
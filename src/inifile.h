@@ -0,0 +1,132 @@
+/***************************************************************************
+  inifile.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef INIFILE_H
+#define INIFILE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QScopedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+class QFile;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/inifile.h
+/// \brief INI document read from a file or a memory buffer and written back
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note Reads and writes the files of QSettings::IniFormat with the same
+/// rules: sections as groups, escaped keys, quoted and comma separated
+/// values as strings and string lists, comments from a ';' out of quotes
+/// to the end of the line. The API mirrors the QSettings one,
+/// so the project and metadata parsers did not change.
+/// Unlike QSettings, the file is memory-mapped and parsed once in a flat
+/// table of keys pointing into the mapped bytes, the values are decoded
+/// only when requested, and the whole document is written with a single
+/// buffered write when save() is called, replacing the file atomically.
+/// \sa QSettings
+/// \bug Quoted values and escaped line ends do not continue a value on the
+/// next line, as they do in QSettings.
+/// \deprecated
+/// \test tst_inifile.cpp
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \class IniFile
+/// \brief QSettings-like INI reader and writer
+class IniFile
+{
+public:
+    IniFile();
+    explicit IniFile(const QByteArray& data);
+    ~IniFile();
+
+    // replace the content, return false if the data are empty
+    bool setData(const QByteArray& data);
+
+    // map the whole file, or read it with a single read if it cannot
+    // be mapped. the mapping lasts until the content is replaced
+    bool load(const QString& fileName);
+
+    // serialise the document, root keys in the [General] section
+    // and the other sections in order of first appearance
+    QByteArray toByteArray() const;
+
+    // write the header comment line and the document with a single write
+    // through QSaveFile, synced and renamed over fileName on commit, so
+    // that the file is never left half written. a mapped content is
+    // copied first, the file may be the loaded one
+    bool save(const QString& fileName, const QString& headerComment = QString());
+    inline QString errorString() const { return errorString_; }
+
+    void clear();
+
+    void beginGroup(const QString& prefix);
+    void endGroup();
+    inline QString group() const { return groupStack_.isEmpty() ? QString() : groupStack_.last(); }
+
+    QVariant value(const QString& key, const QVariant& defaultValue = QVariant()) const;
+    bool contains(const QString& key) const;
+
+    void setValue(const QString& key, const QVariant& value);
+
+    // as QSettings, remove the key and its subkeys,
+    // an empty key removes the current group
+    void remove(const QString& key);
+
+    // keys of the current group, subgroups included, sorted as QSettings does
+    QStringList allKeys() const;
+    QStringList childGroups() const;
+    QStringList childKeys() const;
+
+private:
+    Q_DISABLE_COPY(IniFile)
+
+    struct Entry
+    {
+        QString key;        // full key, "group/key"
+        int valueFrom;      // raw value bytes in data_, -1 if set
+        int valueTo;
+        QVariant value;     // value set after the parsing
+        bool removed;
+    };
+
+    void parse();
+    void unmap();
+    QString fullKey(const QString& key) const;
+
+    // the mapped file must outlive the raw view of data_
+    QScopedPointer<QFile> mappedFile_;
+    QByteArray data_;
+
+    QVector<Entry> entries_;
+    QHash<QString, int> index_;
+    QStringList groupStack_;
+    QString errorString_;
+};
+
+#endif // INIFILE_H
@@ -29,6 +29,7 @@
 #include <QDesktopWidget>
 #include <QFile>
 #include <QFontDatabase>
+#include <QSocketNotifier>
 #include <QtGlobal>
 #include <QTextCodec>
 #include <QTextStream>
@@ -39,6 +40,7 @@
 #include "defs.h"
 #include "fileutils.h"
 #include "globalsettings.h"
+#include "headlessrunner.h"
 #include "JlCompress.h"
 #include "mainwindow.h"
 #include "mystyle.h"
@@ -47,6 +49,13 @@
 #include "stringutils.h"
 #include "widget_utils.h"
 
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 // in debug mode
 //#ifndef QT_NO_DEBUG_OUTPUT
 //#ifdef QT_DEBUG
@@ -78,6 +87,28 @@ void doVersion(QTextStream &stream);
 /// \return A file name string
 QString doArgs(const QStringList& arguments, QTextStream &stream, bool *getLogFile = nullptr);
 
+/// \fn bool isHeadlessRun(int argc, char *argv[])
+/// \brief Check for the --run option, before any application object exists
+/// \param[in] argc
+/// \param[in] argv
+/// \return True if the projects are to be run without widgets
+bool isHeadlessRun(int argc, char *argv[]);
+
+/// \fn int doHeadlessRun(int argc, char *argv[])
+/// \brief Run the project files of the command line with a QCoreApplication
+/// \param[in] argc
+/// \param[in] argv
+/// \return The exit code: 0 if all the runs succeeded, 1 if any failed or
+/// the run was interrupted, 2 for invalid arguments
+int doHeadlessRun(int argc, char *argv[]);
+
+/// \fn void stopOnTerminationSignals(HeadlessRunner* runner)
+/// \brief Stop the engines of the headless run on SIGINT and SIGTERM.
+/// \brief The engines run in process groups of their own and would
+/// \brief survive the runner otherwise
+/// \param[in] runner
+void stopOnTerminationSignals(HeadlessRunner* runner);
+
 ///
 /// \brief Extract docs.zip shipped inside the Mac bundle.
 /// \brief Necessary because digital signature on Mac fails if docs
@@ -114,6 +145,12 @@ int main(int argc, char *argv[])
     Q_INIT_RESOURCE(eddypro_lin);
 #endif
 
+    // command line runs, without widgets nor display
+    if (isHeadlessRun(argc, argv))
+    {
+        return doHeadlessRun(argc, argv);
+    }
+
     qApp->setAttribute(Qt::AA_UseHighDpiPixmaps);
 
 #if defined(Q_OS_MAC)
@@ -448,6 +485,13 @@ void doHelp(QTextStream &stream)
     stream << endl;
     stream << QObject::tr("    --version             Print the application version.");
     stream << endl;
+    stream << QObject::tr("    --run file...         Run the project files without the graphical\n"
+                          "                          interface, printing the progress as one JSON\n"
+                          "                          object per line.");
+    stream << endl;
+    stream << QObject::tr("    --parallel n          With --run, number of engines running at the\n"
+                          "                          same time (default 1).");
+    stream << endl;
 }
 
 ///////////////////////
@@ -516,6 +560,149 @@ QString doArgs(const QStringList& arguments, QTextStream &stream, bool *getLogFi
     return Defs::DEFAULT_PROJECT_FILENAME;
 }
 
+//////////////////////////
+/// \brief isHeadlessRun
+/// \param argc
+/// \param argv
+/// \return
+///
+bool isHeadlessRun(int argc, char *argv[])
+{
+    for (int n = 1; n < argc; ++n)
+    {
+        if (qstrcmp(argv[n], "--run") == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//////////////////////////
+/// \brief doHeadlessRun
+/// \param argc
+/// \param argv
+/// \return
+///
+int doHeadlessRun(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName(Defs::APP_NAME);
+    app.setOrganizationName(Defs::ORG_NAME);
+    app.setOrganizationDomain(Defs::ORG_DOMAIN);
+
+    QLocale::setDefault(QLocale::C);
+
+    QTextStream stream(stderr);
+
+    QStringList projectFiles;
+    int parallel = 1;
+    const auto arguments = app.arguments();
+    for (int n = 1; n < arguments.count(); ++n)
+    {
+        const auto arg = arguments.at(n);
+        if (arg == QLatin1String("--run"))
+        {
+            continue;
+        }
+        else if (arg == QLatin1String("--parallel") && n + 1 < arguments.count())
+        {
+            bool ok = false;
+            parallel = arguments.at(++n).toInt(&ok);
+            if (!ok || parallel < 1)
+            {
+                stream << QObject::tr("Invalid number of engines \"%1\"\n").arg(arguments.at(n));
+                return 2;
+            }
+        }
+        else if (arg == QLatin1String("-d")
+                 || arg == QLatin1String("-debug")
+                 || arg == QLatin1String("--debug"))
+        {
+            // the debug output already goes to stderr
+        }
+        else if (arg.startsWith(QLatin1Char('-')))
+        {
+            stream << QObject::tr("Invalid parameter \"%1\"\n").arg(arg);
+            doHelp(stream);
+            return 2;
+        }
+        else
+        {
+            projectFiles << arg;
+        }
+    }
+
+    if (projectFiles.isEmpty())
+    {
+        stream << QObject::tr("No project file to run\n");
+        doHelp(stream);
+        return 2;
+    }
+
+    const auto appEnvPath = FileUtils::setupEnv();
+    if (appEnvPath.isEmpty())
+    {
+        stream << QObject::tr("Home Path not available.\n");
+        return 1;
+    }
+
+    HeadlessRunner runner(appEnvPath);
+    stopOnTerminationSignals(&runner);
+    return runner.exec(projectFiles, parallel);
+}
+
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+namespace
+{
+// self-pipe, the handler only writes to it and the event loop reads it
+int signalPipe[2] = { -1, -1 };
+
+void terminationSignalHandler(int)
+{
+    const char byte = 1;
+    const auto written = ::write(signalPipe[1], &byte, 1);
+    Q_UNUSED(written)
+}
+} // namespace
+#endif
+
+void stopOnTerminationSignals(HeadlessRunner* runner)
+{
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+    if (::pipe(signalPipe) != 0)
+    {
+        qWarning() << "Error: Cannot watch the termination signals" << qt_error_string(errno);
+        return;
+    }
+    for (auto fd : signalPipe)
+    {
+        ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+
+    auto notifier = new QSocketNotifier(signalPipe[0], QSocketNotifier::Read, runner);
+    QObject::connect(notifier, &QSocketNotifier::activated, runner, [runner, notifier]()
+    {
+        char byte = 0;
+        while (::read(signalPipe[0], &byte, 1) > 0)
+        {
+        }
+        notifier->setEnabled(false);
+        runner->stop();
+    });
+
+    struct sigaction action = {};
+    action.sa_handler = terminationSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+#else
+    Q_UNUSED(runner)
+#endif
+}
+
 #if 0
 //#ifdef QT_DEBUG
 
@@ -113,6 +113,8 @@ MainWidget::MainWidget(QWidget *parent, DlProject *dlProject, EcProject *ecProje
 
     connect(basicSettingsPage_, &BasicSettingsPage::saveSilentlyRequest,
             this, &MainWidget::saveSilentlyRequest);
+    connect(basicSettingsPage_, &BasicSettingsPage::metadataReadFinished,
+            this, &MainWidget::metadataReadFinished);
 
     connect(welcomePage_, &WelcomePage::openProjectRequest,
             this, &MainWidget::openProjectRequest);
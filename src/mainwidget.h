@@ -121,6 +121,7 @@ signals:
     void openProjectRequest(QString);
     void newProjectRequest();
     void updateMetadataReadResult(bool);
+    void metadataReadFinished();
     void recentUpdated();
     void checkUpdatesRequest();
     void showSmartfluxBarRequest(bool on);
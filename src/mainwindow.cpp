@@ -41,11 +41,14 @@
 #include <QScrollBar>
 #include <QStatusBar>
 #include <QTextDocumentFragment>
+#include <QThread>
 #include <QTimer>
 #include <QToolBar>
 #include <QUrl>
 #include <QWhatsThis>
 
+#include <algorithm>
+
 #include "aboutdialog.h"
 #include "network_helpers.h"
 #include "advancedsettingspage.h"
@@ -53,21 +56,30 @@
 #include "advspectraloptions.h"
 #include "advsettingscontainer.h"
 #include "basicsettingspage.h"
+#include "batchqueue.h"
+#include "batchqueuepanel.h"
 #include "binarysettingsdialog.h"
 #include "clicklabel.h"
+#include "consolehistorydialog.h"
+#include "consolesink.h"
 #include "customsplashscreen.h"
 #include "detectdaterangedialog.h"
 #include "dbghelper.h"
 #include "dlproject.h"
 #include "ecproject.h"
+#include "enginescheduler.h"
 #include "globalsettings.h"
+#include "incrementalrun.h"
 #include "infomessage.h"
 #include "mainwidget.h"
 #include "mymenu.h"
 #include "planarfitsettingsdialog.h"
 #include "projectpage.h"
+#include "rawfileindex.h"
+#include "resultcache.h"
+#include "runchecks.h"
 #include "runpage.h"
-#include "stringutils.h"
+#include "shardedrun.h"
 #include "timelagsettingsdialog.h"
 #include "tooltipfilter.h"
 #include "updatedialog.h"
@@ -96,6 +108,7 @@ MainWindow::MainWindow(const QString& filename,
     engineResumableFlag_(false),
     metadataReadFlag_(false),
     neededEngineStep2_(false),
+    appendRun_(false),
     guidedModeOn_(true),
     basicSettingsPageAvailable_(false),
     runExpressAvailable_(false),
@@ -109,6 +122,8 @@ MainWindow::MainWindow(const QString& filename,
     advancedClicked_(false),
     retrieverClicked_(false),
     engineProcess_(nullptr),
+    engineScheduler_(nullptr),
+    batchQueue_(nullptr),
     updateDialog(nullptr),
     argFilename_(false),
     scheduledSilentMdCleanup_(false)
@@ -150,6 +165,7 @@ MainWindow::MainWindow(const QString& filename,
     setDockOptions(QMainWindow::ForceTabbedDocks);
     createInfoDockWin();
     createConsoleDockWin();
+    createBatchDockWin();
 
     installEventFilter(this);
 
@@ -190,6 +206,18 @@ MainWindow::MainWindow(const QString& filename,
 
     createEngineProcess();
 
+    // resume the batch of the previous session
+    if (batchQueue_->isActive())
+    {
+        batchDock->setVisible(true);
+        QTimer::singleShot(0, [=]() {
+            batchQueue_->start(GlobalSettings::getAppPersistentSettings(
+                                   Defs::CONFGROUP_PROJECT,
+                                   Defs::CONF_PROJ_BATCH_PARALLELISM,
+                                   1).toInt());
+        });
+    }
+
     // connections
     connect(ecProject_, &EcProject::ecProjectNew,
             this, &MainWindow::updateInfoMessages);
@@ -216,6 +244,8 @@ MainWindow::MainWindow(const QString& filename,
             this, &MainWindow::updateConsoleChar);
     connect(mainWidget_->runPage(), &RunPage::pauseRequest,
             this, &MainWindow::pauseResumeComputations);
+    connect(mainWidget_->runPage(), &RunPage::essentialsFileReported,
+            this, &MainWindow::setRunEssentialsFile);
     connect(mainWidget_, &MainWidget::showSmartfluxBarRequest,
             this, &MainWindow::setSmartfluxMode);
     connect(mainWidget_, &MainWidget::saveSilentlyRequest,
@@ -232,6 +262,8 @@ MainWindow::MainWindow(const QString& filename,
     // from BasicSettingsPage
     connect(mainWidget_, &MainWidget::updateMetadataReadResult,
             this, &MainWindow::setMetadataRead);
+    connect(mainWidget_, &MainWidget::metadataReadFinished,
+            this, &MainWindow::runMetadataReadAction);
 
     connect(this, &MainWindow::recentUpdated,
             mainWidget_, &MainWidget::recentUpdated);
@@ -519,7 +551,7 @@ void MainWindow::fileOpen(const QString &fileName)
     if (openFile(fileStr))
     {
         showStatusTip(tr("Project loaded"));
-        consoleOutput->clear();
+        consoleSink_->clear();
 
         if (currentPage() != Defs::CurrPage::ProjectCreation)
         {
@@ -647,7 +679,7 @@ void MainWindow::fileRecent()
         if (openFile(fname))
         {
             showStatusTip(tr("Recent project loaded"));
-            consoleOutput->clear();
+            consoleSink_->clear();
 
             if (currentPage() != Defs::CurrPage::ProjectCreation)
             {
@@ -1180,6 +1212,76 @@ void MainWindow::createActions()
     stopAction->setToolTip(tr("Stop processing. (%1)")
                            .arg((stopAction->shortcut().toString())));
 
+    appendRunAction = new QAction(this);
+    appendRunAction->setText(tr("Append New Data Only"));
+    appendRunAction->setCheckable(true);
+    appendRunAction->setChecked(GlobalSettings::getAppPersistentSettings(
+                                    Defs::CONFGROUP_PROJECT,
+                                    Defs::CONF_PROJ_APPEND_RUN,
+                                    false).toBool());
+    appendRunAction->setStatusTip(tr("Process only the raw data following "
+                                     "the last averaging period in the "
+                                     "output directory and append the "
+                                     "results to the previous output files"));
+
+    resultCacheAction = new QAction(this);
+    resultCacheAction->setText(tr("Reuse Cached Results"));
+    resultCacheAction->setCheckable(true);
+    resultCacheAction->setChecked(GlobalSettings::getAppPersistentSettings(
+                                      Defs::CONFGROUP_PROJECT,
+                                      Defs::CONF_PROJ_RESULT_CACHE,
+                                      false).toBool());
+    resultCacheAction->setStatusTip(tr("Process only the averaging periods "
+                                       "whose raw data or settings changed "
+                                       "since the last run and reuse the "
+                                       "other results. Only for projects "
+                                       "whose only output is the full output"));
+
+    // one action for each number of engines running at the same time
+    const auto parallelism = engineParallelism();
+    parallelismActionGroup = new QActionGroup(this);
+    for (auto n = 1; n <= qMax(1, QThread::idealThreadCount()); ++n)
+    {
+        auto action = parallelismActionGroup->addAction(QString::number(n));
+        action->setCheckable(true);
+        action->setChecked(n == parallelism);
+        action->setData(n);
+    }
+
+    // limits to the resources of the engines running at the same time,
+    // 0 for no limit
+    const auto memoryBudget = GlobalSettings::engineMemoryBudget();
+    memoryBudgetActionGroup = new QActionGroup(this);
+    foreach (int gib, QList<int>() << 0 << 1 << 2 << 4 << 8 << 16 << 32 << 64 << 128)
+    {
+        auto action = memoryBudgetActionGroup->addAction(
+                    (gib == 0) ? tr("No Memory Limit") : tr("%1 GB of Memory").arg(gib));
+        action->setCheckable(true);
+        action->setChecked(gib * 1024 == memoryBudget);
+        action->setData(gib * 1024);
+    }
+
+    const auto consoleLines = GlobalSettings::consoleMaxLines();
+    consoleLinesActionGroup = new QActionGroup(this);
+    foreach (int lines, QList<int>() << 1000 << 10000 << 100000 << 1000000)
+    {
+        auto action = consoleLinesActionGroup->addAction(tr("Last %L1 Lines").arg(lines));
+        action->setCheckable(true);
+        action->setChecked(lines == consoleLines);
+        action->setData(lines);
+    }
+
+    const auto ioBudget = GlobalSettings::engineIoBudget();
+    ioBudgetActionGroup = new QActionGroup(this);
+    foreach (int mib, QList<int>() << 0 << 25 << 50 << 100 << 200 << 400 << 800)
+    {
+        auto action = ioBudgetActionGroup->addAction(
+                    (mib == 0) ? tr("No Disk Limit") : tr("%1 MB/s of Disk Traffic").arg(mib));
+        action->setCheckable(true);
+        action->setChecked(mib == ioBudget);
+        action->setData(mib);
+    }
+
 //#if !defined(Q_OS_MAC)
     // Full Screen Action
     toggleFullScreenAction = new QAction(this);
@@ -1208,6 +1310,10 @@ void MainWindow::createActions()
     toggleConsoleOutputAct = consoleDock->toggleViewAction();
     toggleConsoleOutputAct->setCheckable(true);
 
+    toggleBatchQueueAct = batchDock->toggleViewAction();
+    toggleBatchQueueAct->setText(tr("&Batch Processing"));
+    toggleBatchQueueAct->setCheckable(true);
+
     helpAction = new QAction(this);
     helpAction->setText(tr("%1 Help").arg(Defs::APP_NAME));
     helpAction->setIcon(QIcon(QStringLiteral(":/icons/img/menu-help.png")));
@@ -1277,6 +1383,18 @@ void MainWindow::connectActions()
             this, &MainWindow::getRunRetriever);
     connect(stopAction, &QAction::triggered,
             this, &MainWindow::stopEngine);
+    connect(appendRunAction, &QAction::triggered,
+            this, &MainWindow::setAppendRun);
+    connect(resultCacheAction, &QAction::triggered,
+            this, &MainWindow::setResultCache);
+    connect(parallelismActionGroup, &QActionGroup::triggered,
+            this, &MainWindow::setEngineParallelism);
+    connect(memoryBudgetActionGroup, &QActionGroup::triggered,
+            this, &MainWindow::setEngineResourceBudget);
+    connect(ioBudgetActionGroup, &QActionGroup::triggered,
+            this, &MainWindow::setEngineResourceBudget);
+    connect(consoleLinesActionGroup, &QActionGroup::triggered,
+            this, &MainWindow::setConsoleMaxLines);
 
 //#if !defined(Q_OS_MAC)
     connect(toggleFullScreenAction, &QAction::toggled,
@@ -1355,6 +1473,11 @@ void MainWindow::createMenus()
 
     viewMenu->addSeparator();
     viewMenu->addAction(toggleConsoleOutputAct);
+    consoleLinesMenu = viewMenu->addMenu(tr("Console Lines"));
+    consoleLinesMenu->setStatusTip(tr("Lines kept by the output console, "
+                                      "the older ones stay in the console history"));
+    consoleLinesMenu->addActions(consoleLinesActionGroup->actions());
+    viewMenu->addAction(toggleBatchQueueAct);
     viewMenu->addAction(toggleInfoOutputAct);
     viewMenu->addAction(toggleTooltipOutputAct);
     viewMenu->addAction(toggleStatusbarAct);
@@ -1368,6 +1491,19 @@ void MainWindow::createMenus()
     toolsMenu->addAction(runExpressAction);
     toolsMenu->addAction(runAdvancedAction);
     toolsMenu->addAction(stopAction);
+    toolsMenu->addAction(appendRunAction);
+    toolsMenu->addAction(resultCacheAction);
+    parallelismMenu = toolsMenu->addMenu(tr("Parallel Engine Processes"));
+    parallelismMenu->setStatusTip(tr("Split the processing date range in "
+                                     "shards processed at the same time"));
+    parallelismMenu->addActions(parallelismActionGroup->actions());
+    resourceBudgetMenu = toolsMenu->addMenu(tr("Engine Resource Limits"));
+    resourceBudgetMenu->setStatusTip(tr("Start a parallel engine process or a "
+                                        "batch project only while the running "
+                                        "engines stay within these limits"));
+    resourceBudgetMenu->addActions(memoryBudgetActionGroup->actions());
+    resourceBudgetMenu->addSeparator();
+    resourceBudgetMenu->addActions(ioBudgetActionGroup->actions());
     toolsMenu->addSeparator();
     toolsMenu->addAction(runRetrieverAction);
 
@@ -1494,21 +1630,45 @@ void MainWindow::createConsoleDockWin()
     consoleOutput->setObjectName(QStringLiteral("consoleDockEdit"));
     consoleOutput->setReadOnly(true);
     consoleOutput->setLineWrapMode(QPlainTextEdit::NoWrap);
-    consoleOutput->setMaximumBlockCount(10000);
     consoleOutput->setUndoRedoEnabled(false);
     consoleOutput->setMinimumWidth(this->width() / 2);
 
+    // batched and bounded, the full output goes to the log files
+    consoleSink_ = new ConsoleSink(consoleOutput,
+                                   appEnvPath_
+                                   + QLatin1Char('/')
+                                   + Defs::LOG_FILE_DIR
+                                   + QLatin1Char('/')
+                                   + Defs::APP_NAME_LCASE
+                                   + QStringLiteral("_console.")
+                                   + Defs::LOG_FILE_EXT,
+                                   this);
+    consoleSink_->setMaxLines(GlobalSettings::consoleMaxLines());
+
     auto clearConsoleButton = new QPushButton(tr("Clear"));
     clearConsoleButton->setProperty("mdButton", true);
     clearConsoleButton->setStyleSheet(QStringLiteral("QPushButton { margin-right: 4px; }"));
     clearConsoleButton->setMaximumWidth(clearConsoleButton->sizeHint().width());
 
     connect(clearConsoleButton, &QPushButton::clicked,
-            consoleOutput, &QPlainTextEdit::clear);
+            consoleSink_, &ConsoleSink::clear);
+
+    auto historyButton = new QPushButton(tr("History..."));
+    historyButton->setProperty("mdButton", true);
+    historyButton->setStyleSheet(QStringLiteral("QPushButton { margin-right: 4px; }"));
+    historyButton->setMaximumWidth(historyButton->sizeHint().width());
+
+    connect(historyButton, &QPushButton::clicked,
+            this, &MainWindow::showConsoleHistory);
+
+    auto buttonLayout = new QHBoxLayout;
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(historyButton);
+    buttonLayout->addWidget(clearConsoleButton);
 
     auto consoleLayout = new QVBoxLayout;
     consoleLayout->addWidget(consoleOutput);
-    consoleLayout->addWidget(clearConsoleButton, 0, Qt::AlignBottom | Qt::AlignRight);
+    consoleLayout->addLayout(buttonLayout);
 
     auto consoleFrame = new QWidget(this);
     consoleFrame->setLayout(consoleLayout);
@@ -1521,6 +1681,19 @@ void MainWindow::createConsoleDockWin()
     addDockWidget(Qt::RightDockWidgetArea, consoleDock, Qt::Horizontal);
 }
 
+void MainWindow::createBatchDockWin()
+{
+    DEBUG_FUNC_NAME
+    batchQueue_ = new BatchQueue(appEnvPath_, configState_.project, this);
+
+    batchDock = new QDockWidget(tr("Batch Processing"), this);
+    batchDock->setObjectName(QStringLiteral("batchDock"));
+    batchDock->setWidget(new BatchQueuePanel(batchQueue_, this));
+    batchDock->setVisible(false);
+
+    addDockWidget(Qt::BottomDockWidgetArea, batchDock, Qt::Horizontal);
+}
+
 void MainWindow::createInfoDockWin()
 {
     infoOutput = new QPlainTextEdit;
@@ -1769,6 +1942,89 @@ void MainWindow::setOfflineHelp(bool yes)
     toggleOfflineHelpAct->setChecked(yes);
 }
 
+void MainWindow::setAppendRun(bool on)
+{
+    GlobalSettings::setAppPersistentSettings(Defs::CONFGROUP_PROJECT,
+                                             Defs::CONF_PROJ_APPEND_RUN,
+                                             on);
+    appendRunAction->setChecked(on);
+}
+
+void MainWindow::setResultCache(bool on)
+{
+    GlobalSettings::setAppPersistentSettings(Defs::CONFGROUP_PROJECT,
+                                             Defs::CONF_PROJ_RESULT_CACHE,
+                                             on);
+    resultCacheAction->setChecked(on);
+}
+
+// the essentials file written by the running engine, for the spectral
+// corrections and the result cache
+void MainWindow::setRunEssentialsFile(const QString& path)
+{
+    auto essentialsFile = path;
+
+    // in a parallel run, the file of the lead shard as merged at the end
+    const auto cleanPath = QDir::cleanPath(QDir::fromNativeSeparators(path));
+    foreach (const QString& dir, shardDirs_)
+    {
+        const QString shardDir = QDir::cleanPath(dir) + QLatin1Char('/');
+        if (cleanPath.startsWith(shardDir))
+        {
+            essentialsFile = ecProject_->generalOutPath()
+                             + QLatin1Char('/')
+                             + cleanPath.mid(shardDir.size());
+            break;
+        }
+    }
+
+    runEssentialsFile_ = essentialsFile;
+    ecProject_->setSpectraExFile(essentialsFile);
+}
+
+void MainWindow::setEngineParallelism(QAction* action)
+{
+    GlobalSettings::setAppPersistentSettings(Defs::CONFGROUP_PROJECT,
+                                             Defs::CONF_PROJ_ENGINE_PARALLELISM,
+                                             action->data().toInt());
+}
+
+// the running schedulers read the limits at their next usage sample
+void MainWindow::setEngineResourceBudget(QAction* action)
+{
+    if (action->actionGroup() == memoryBudgetActionGroup)
+    {
+        GlobalSettings::setEngineMemoryBudget(action->data().toInt());
+    }
+    else
+    {
+        GlobalSettings::setEngineIoBudget(action->data().toInt());
+    }
+}
+
+void MainWindow::setConsoleMaxLines(QAction* action)
+{
+    GlobalSettings::setConsoleMaxLines(action->data().toInt());
+    consoleSink_->setMaxLines(action->data().toInt());
+}
+
+void MainWindow::showConsoleHistory()
+{
+    consoleSink_->flush();
+
+    ConsoleHistoryDialog historyDialog(consoleSink_->logFiles(), this);
+    historyDialog.exec();
+}
+
+int MainWindow::engineParallelism() const
+{
+    const auto n = GlobalSettings::getAppPersistentSettings(
+                                        Defs::CONFGROUP_PROJECT,
+                                        Defs::CONF_PROJ_ENGINE_PARALLELISM,
+                                        1).toInt();
+    return qBound(1, n, qMax(1, QThread::idealThreadCount()));
+}
+
 void MainWindow::requestSmartFluxMode(bool on)
 {
     // ask for closing in case of smartflux mode previously on
@@ -3028,6 +3284,9 @@ void MainWindow::updateRunButtonsAvailability()
                     == Defs::CurrRunStatus::Retriever)));
         stopAction->setEnabled(basicSettingsPageAvailable_
             && (runExpressAvailable_ || runAdvancedAvailable_));
+        appendRunAction->setEnabled(status == Defs::CurrStatus::Ready);
+        resultCacheAction->setEnabled(status == Defs::CurrStatus::Ready);
+        parallelismMenu->setEnabled(status == Defs::CurrStatus::Ready);
     }
 }
 
@@ -3241,6 +3500,7 @@ void MainWindow::createEngineProcess()
     engineProcess_ = new Process(this);
     engineProcess_->setChannelsMode(QProcess::MergedChannels);
     engineProcess_->setReadChannels(QProcess::StandardOutput);
+    engineProcess_->setProgressChannel(true);
 
     // add useful GFortran environment variables
     QStringList env = QProcess::systemEnvironment();
@@ -3262,6 +3522,23 @@ void MainWindow::createEngineProcess()
             this, &MainWindow::updateConsoleReceived);
     connect(engineProcess_, &Process::readyReadStdErr,
             this, &MainWindow::updateConsoleError);
+    connect(engineProcess_, &Process::readyReadProgress,
+            this, &MainWindow::updateProgressReceived);
+    connect(engineProcess_, &Process::processPaused,
+            this, &MainWindow::showPauseLatency);
+
+    // the engines of the date shards of a run
+    engineScheduler_ = new EngineScheduler(this);
+    engineScheduler_->setEnv(env);
+
+    connect(engineScheduler_, &EngineScheduler::finished,
+            this, &MainWindow::displayExitDialog);
+    connect(engineScheduler_, &EngineScheduler::finished,
+            mainWidget_->runPage(), &RunPage::resetBuffer);
+    connect(engineScheduler_, &EngineScheduler::readyReadStdOut,
+            this, &MainWindow::updateConsoleReceived);
+    connect(engineScheduler_, &EngineScheduler::paused,
+            this, &MainWindow::showPauseLatency);
 }
 
 void MainWindow::setMetadataRead(bool b)
@@ -3269,6 +3546,26 @@ void MainWindow::setMetadataRead(bool b)
     metadataReadFlag_ = b;
 }
 
+// the metadata are read once the raw files are found, then action runs.
+// a later request replaces an action still waiting
+void MainWindow::updateMetadataReadThen(const std::function<void ()>& action)
+{
+    metadataReadAction_ = action;
+    emit updateMetadataReadRequest();
+}
+
+void MainWindow::runMetadataReadAction()
+{
+    if (!metadataReadAction_)
+    {
+        return;
+    }
+
+    const auto action = metadataReadAction_;
+    metadataReadAction_ = nullptr;
+    action();
+}
+
 int MainWindow::testBeforeRunningPassed(int step)
 {
     DEBUG_FUNC_NAME
@@ -3407,35 +3704,34 @@ void MainWindow::closeOpenDialogs()
 //    DEBUG_FUNC_MSG(QString())
 }
 
-FileUtils::DateRange MainWindow::getCurrentDateRange()
+// "*.ext" of the raw files, as FileUtils::getFiles() expects
+QString MainWindow::rawFileExtension() const
 {
-    auto recursion = ecProject_->screenRecurse();
-    auto ghgFormat = QStringLiteral("*.") + Defs::GHG_NATIVE_DATA_FILE_EXT;
-    auto currentRawDataList = QStringList();
-    FileUtils::DateRange dates = qMakePair(QDateTime(), QDateTime());
+    QString extension = QStringLiteral("*.") + Defs::GHG_NATIVE_DATA_FILE_EXT;
 
-    if (ecProject_->generalFileType() == Defs::RawFileType::GHG)
-    {
-        currentRawDataList = FileUtils::getFiles(ecProject_->screenDataPath(), ghgFormat, recursion);
-    }
-    else
+    if (ecProject_->generalFileType() != Defs::RawFileType::GHG)
     {
         auto extensionIndex = ecProject_->generalFilePrototype().lastIndexOf(QLatin1String(".")) + 1;
-        auto extension = QStringLiteral("*.") + ecProject_->generalFilePrototype().mid(extensionIndex);
-        currentRawDataList = FileUtils::getFiles(ecProject_->screenDataPath(), extension, recursion);
+        extension = QStringLiteral("*.") + ecProject_->generalFilePrototype().mid(extensionIndex);
     }
+    return extension;
+}
 
-    if (!currentRawDataList.isEmpty())
-    {
-        QFuture<FileUtils::DateRange> future = QtConcurrent::run(&FileUtils::getDateRangeFromFileList,
-                                                                        currentRawDataList,
-                                                                        ecProject_->generalFilePrototype());
-        while (!future.isFinished())
-        {
-            QCoreApplication::processEvents();
-        }
-        dates = future.result();
+FileUtils::DataAvailability MainWindow::getCurrentDataAvailability()
+{
+    auto recursion = ecProject_->screenRecurse();
+    const auto extension = rawFileExtension();
+
+    // timestamps come from the raw data index, parsed once per file and prototype
+    auto availability = RawFileIndex::getDataAvailability(configState_.general.env,
+                                                          ecProject_->screenDataPath(),
+                                                          extension,
+                                                          recursion,
+                                                          ecProject_->generalFilePrototype());
 
+    auto& dates = availability.range;
+    if (dates.first.isValid())
+    {
         // correct the start/end date accounting for file duration
         if (dlProject_->timestampEnd() == 0)
         {
@@ -3446,7 +3742,7 @@ FileUtils::DateRange MainWindow::getCurrentDateRange()
             dates.first = dates.first.addSecs(-dlProject_->fileDuration() * 60);
         }
     }
-    return dates;
+    return availability;
 }
 
 bool MainWindow::showDatesRangeDialog(Defs::CurrRunMode mode)
@@ -3472,7 +3768,8 @@ bool MainWindow::showDatesRangeDialog(Defs::CurrRunMode mode)
             mainWidget_->spectralOptions(), &AdvSpectralOptions::partialRefresh);
 
     // detect the actual range and compare with the subsets
-    detectDateRangeDialog.setCurrentRange(getCurrentDateRange());
+    const auto availability = getCurrentDataAvailability();
+    detectDateRangeDialog.setCurrentRange(availability.range, availability);
 
     if (mode == Defs::CurrRunMode::Express)
     {
@@ -3564,12 +3861,13 @@ void MainWindow::getRunExpress()
 
         if (runExpressDialog.exec() == QMessageBox::Cancel) { return; }
     }
-    emit updateMetadataReadRequest();
-
-    // detect date range and verify date subset intersection
-    if (!getDatesRangeDialog(Defs::CurrRunMode::Express)) return;
+    updateMetadataReadThen([this]()
+    {
+        // detect date range and verify date subset intersection
+        if (!getDatesRangeDialog(Defs::CurrRunMode::Express)) return;
 
-    runExpress();
+        runExpress();
+    });
 }
 
 void MainWindow::runExpress()
@@ -3590,6 +3888,9 @@ void MainWindow::runExpress()
         ecProject_->setGeneralRunMode(Defs::CurrRunMode::Express);
         if (!fileSaveSilently()) { return; }
 
+        const auto projectFiles = engineProjectFiles();
+        if (projectFiles.isEmpty()) { return; }
+
         QStringList args;
 
         args << QStringLiteral("-c");
@@ -3598,19 +3899,14 @@ void MainWindow::runExpress()
         args << Defs::HOST_OS;
         args << QStringLiteral("-e");
         args << appEnvPath_;
-        args << ecProject_->generalFileName();
 
         qDebug() << "engineFilePath" << engineFilePath;
         qDebug() << "workingDir" << workingDir;
-        qDebug() << "args" << args;
+        qDebug() << "args" << args << projectFiles;
 
-        engineProcess_->engineProcessStart(engineFilePath, workingDir, args);
-
-        // block until the process truly start to ensure reliable behavior
-        // of the gui
-        engineProcess_->process()->waitForStarted();
+        startEngine(engineFilePath, workingDir, args, projectFiles);
 
-        if (engineProcess_->isRunning())
+        if (isEngineRunning())
         {
             setCurrentStatus(Defs::CurrStatus::Run);
             setCurrentRunStatus(Defs::CurrRunStatus::Express);
@@ -3660,12 +3956,13 @@ void MainWindow::getRunAdvanced()
             return;
         }
     }
-    emit updateMetadataReadRequest();
-
-    // detect date range and verify date subset intersection
-    if (!getDatesRangeDialog(Defs::CurrRunMode::Advanced)) return;
+    updateMetadataReadThen([this]()
+    {
+        // detect date range and verify date subset intersection
+        if (!getDatesRangeDialog(Defs::CurrRunMode::Advanced)) return;
 
-    runAdvancedStep_1();
+        runAdvancedStep_1();
+    });
 }
 
 void MainWindow::runAdvancedStep_1()
@@ -3692,6 +3989,9 @@ void MainWindow::runAdvancedStep_1()
             ecProject_->setGeneralRunMode(Defs::CurrRunMode::Advanced);
             if (!fileSaveSilently()) { return; }
 
+            const auto projectFiles = engineProjectFiles();
+            if (projectFiles.isEmpty()) { return; }
+
             QStringList args;
             args << QStringLiteral("-c");
             args << QStringLiteral("gui");
@@ -3699,15 +3999,10 @@ void MainWindow::runAdvancedStep_1()
             args << Defs::HOST_OS;
             args << QStringLiteral("-e");
             args << appEnvPath_;
-            args << ecProject_->generalFileName();
-            engineProcess_->engineProcessStart(engine1FilePath, workingDir, args);
-
-            // block until the process truly start to ensure reliable behavior
-            // of the gui
-            engineProcess_->process()->waitForStarted();
+            startEngine(engine1FilePath, workingDir, args, projectFiles);
 
             qDebug() << "engineFilePath" << engine1FilePath;
-            if (engineProcess_->isRunning())
+            if (isEngineRunning())
             {
                 setCurrentStatus(Defs::CurrStatus::Run);
                 setCurrentRunStatus(Defs::CurrRunStatus::Advanced_RP);
@@ -3814,7 +4109,8 @@ void MainWindow::getRunRetriever()
         runRetrieverDialog.refresh();
 
         if (runRetrieverDialog.exec() == QMessageBox::Cancel) { return; }
-        emit updateMetadataReadRequest();
+        updateMetadataReadThen([this]() { runRetriever(); });
+        return;
     }
     runRetriever();
 }
@@ -3923,18 +4219,43 @@ bool MainWindow::pauseEngine(Defs::CurrRunStatus mode)
     DEBUG_FUNC_NAME
     if (mainWidget_->runPage()->pauseRun(mode))
     {
-        engineProcess_->processPause(mode);
+        // the latency is shown by showPauseLatency() once confirmed
+        if (shardDirs_.isEmpty())
+        {
+            engineProcess_->processPause(mode);
+            engineProcess_->confirmPause();
+        }
+        else
+        {
+            engineScheduler_->pause(mode);
+        }
         return true;
     }
     return false;
 }
 
+void MainWindow::showPauseLatency(qint64 latency)
+{
+    qDebug() << "pause latency (us)" << latency;
+    if (latency >= 0)
+    {
+        showStatusTip(tr("Engine paused in %1 ms").arg(latency / 1000.0, 0, 'f', 1));
+    }
+}
+
 bool MainWindow::resumeEngine(Defs::CurrRunStatus mode)
 {
     DEBUG_FUNC_NAME
     if (mainWidget_->runPage()->resumeRun(mode))
     {
-        engineProcess_->processResume(mode);
+        if (shardDirs_.isEmpty())
+        {
+            engineProcess_->processResume(mode);
+        }
+        else
+        {
+            engineScheduler_->resume(mode);
+        }
         return true;
     }
     return false;
@@ -3943,7 +4264,7 @@ bool MainWindow::resumeEngine(Defs::CurrRunStatus mode)
 void MainWindow::stopEngine()
 {
     DEBUG_FUNC_NAME
-    if (engineProcess_->isRunning())
+    if (isEngineRunning())
     {
         if (okToStopRun())
         {
@@ -3955,7 +4276,14 @@ void MainWindow::stopEngine()
 void MainWindow::stopEngineProcess()
 {
     DEBUG_FUNC_NAME
-    engineProcess_->processStop();
+    if (shardDirs_.isEmpty())
+    {
+        engineProcess_->processStop();
+    }
+    else
+    {
+        engineScheduler_->stop();
+    }
 
     // return to default running mode
     ecProject_->setGeneralRunMode(Defs::CurrRunMode::Advanced);
@@ -4053,17 +4381,46 @@ void MainWindow::displayExitDialog()
     setCurrentRunStatus(Defs::CurrRunStatus::Express);
     mainWidget_->runPage()->stopRun();
 
+    const auto exitStatus = engineExit();
+
+    // a stopped or failed run would leave a hole in the merged date range
+    if (!shardDirs_.isEmpty())
+    {
+        if (exitStatus == Process::ExitStatus::Success)
+        {
+            mergeShardOutputs();
+        }
+        else
+        {
+            keepShardOutputs();
+        }
+    }
+
+    // record the new run for the next previous data assessments
+    if (exitStatus == Process::ExitStatus::Success)
+    {
+        updateRunCatalog(ecProject_->generalOutPath());
+
+        if (appendRun_)
+        {
+            appendRunOutputs();
+        }
+        else if (!neededEngineStep2_)
+        {
+            updateResultCache();
+        }
+    }
+
     if (!neededEngineStep2_)
     {
         resetRunIcons();
         updateMenuActionStatus(currentPage());
-        qDebug() << "engineProcess_->processExit()" <<
-                    static_cast<int>(engineProcess_->processExit());
-        displayExitMsg(engineProcess_->processExit());
+        qDebug() << "engineExit()" << static_cast<int>(exitStatus);
+        displayExitMsg(exitStatus);
     }
     else
     {
-        displayExitMsg2(engineProcess_->processExit());
+        displayExitMsg2(exitStatus);
     }
 }
 
@@ -4329,17 +4686,33 @@ void MainWindow::onlineHelpTrigger_1()
 // qt5
 void MainWindow::updateConsoleLine(QByteArray &data)
 {
-    consoleOutput->appendPlainText(QLatin1String(data.trimmed().constData()));
+    consoleSink_->appendLine(QLatin1String(data.trimmed().constData()));
 }
 
 void MainWindow::updateConsoleChar(QByteArray &data)
 {
+    consoleSink_->flush();
     consoleOutput->insertPlainText(QLatin1String(data.trimmed().constData()));
 }
 
 void MainWindow::updateConsoleReceived()
 {
-    QByteArray newData = engineProcess_->readAllStdOut();
+    if (!shardDirs_.isEmpty())
+    {
+        // only the errors and warnings of the shards following the lead one
+        const auto otherLines = engineScheduler_->readOtherLines();
+        foreach (QByteArray line, otherLines.split('\n'))
+        {
+            const auto lower = line.toLower();
+            if (lower.contains("error") || lower.contains("warning"))
+            {
+                updateConsoleLine(line);
+            }
+        }
+    }
+
+    QByteArray newData = shardDirs_.isEmpty() ? engineProcess_->readAllStdOut()
+                                              : engineScheduler_->readLeadLines();
 
     if (!newData.isEmpty())
     {
@@ -4347,6 +4720,16 @@ void MainWindow::updateConsoleReceived()
     }
 }
 
+void MainWindow::updateProgressReceived()
+{
+    QByteArray newData = engineProcess_->readAllProgress();
+
+    if (!newData.isEmpty())
+    {
+        mainWidget_->runPage()->bufferProgress(newData);
+    }
+}
+
 void MainWindow::updateConsoleError()
 {
     DEBUG_FUNC_NAME
@@ -4505,24 +4888,7 @@ void MainWindow::updateSpectraPaths()
     bool modified = false;
     if (ecProject_->loadEcProject(ecProject_->generalFileName(), false, &modified))
     {
-        if (ecProject_->generalBinSpectraAvail())
-        {
-            ecProject_->setSpectraBinSpectra(ecProject_->spectraBinSpectra());
-        }
-        else
-        {
-            ecProject_->setSpectraBinSpectra(ecProject_->generalOutPath() + Defs::OUT_BINNED_COSPECTRA_DIR);
-        }
-
-        if (ecProject_->generalFullSpectraAvail())
-        {
-            ecProject_->setSpectraFullSpectra(ecProject_->spectraFullSpectra());
-        }
-        else
-        {
-            ecProject_->setSpectraFullSpectra(ecProject_->generalOutPath() + QStringLiteral("/eddypro_full_cospectra"));
-        }
-
+        RunChecks::useRawProcessingSpectra(ecProject_);
         fileSaveSilently();
     }
 }
@@ -4530,27 +4896,7 @@ void MainWindow::updateSpectraPaths()
 void MainWindow::updateSpectraPathFromPreviousData(const QString& exFilePath)
 {
     DEBUG_FUNC_NAME
-
-    qDebug() << exFilePath;
-    ecProject_->setSpectraExFile(exFilePath);
-
-    if (ecProject_->generalHfMethod() == 2
-        || ecProject_->generalHfMethod() == 3
-        || ecProject_->generalHfMethod() == 4)
-    {
-        if (ecProject_->generalBinSpectraAvail())
-        {
-            ecProject_->setSpectraBinSpectra(ecProject_->spectraBinSpectra());
-        }
-
-        if (ecProject_->generalHfMethod() == 4)
-        {
-            if (ecProject_->generalFullSpectraAvail())
-            {
-                ecProject_->setSpectraFullSpectra(ecProject_->spectraFullSpectra());
-            }
-        }
-    }
+    RunChecks::usePreviousRun(ecProject_, exFilePath);
 }
 
 void MainWindow::showUpdateDialog()
@@ -4602,111 +4948,461 @@ bool MainWindow::testForPreviousData()
 {
     DEBUG_FUNC_NAME
 
-    bool test = false;
+    const auto essentialsFile = RunChecks::findPreviousRun(configState_.general.env,
+                                                           *ecProject_);
+    if (essentialsFile.isEmpty())
+    {
+        return false;
+    }
+
+    updateSpectraPathFromPreviousData(essentialsFile);
+    return true;
+}
+
+// add to the run catalog the processing projects of dir not catalogued yet,
+// each one is loaded only the first time it is seen
+void MainWindow::updateRunCatalog(const QString& dir)
+{
+    RunChecks::updateRunCatalog(configState_.general.env, dir);
+}
+
+// plan the run on the averaging periods missing from the result cache.
+// return the project file for the engine: the current one, or a copy
+// limited to the span of the missing periods when the cache has the others.
+// return an empty string if there is nothing to process
+QString MainWindow::planCachedRun()
+{
+    DEBUG_FUNC_NAME
+
+    resultCachePlan_ = ResultCache::Plan();
 
-    // first preliminary test
-    if ((ecProject_->generalHfMethod() == 2 || ecProject_->generalHfMethod() == 3)
-        && (ecProject_->spectraMode() == 1 && ecProject_->generalBinSpectraAvail() == 0))
+    const auto projectFile = ecProject_->generalFileName();
+
+    if (!resultCacheAction->isChecked()
+        || ecProject_->resultsFingerprint().isEmpty()
+        || !ecProject_->hasPeriodIndependentResults())
     {
-        qDebug() << "failed first preliminary test";
-        return test;
+        return projectFile;
     }
 
-    // second preliminary test
-    if (ecProject_->generalHfMethod() == 4
-        && ((ecProject_->spectraMode() == 1 && ecProject_->generalBinSpectraAvail() == 0)
-        || ecProject_->generalFullSpectraAvail() == 0))
+    // only the full output rows are cached, the other outputs of a partial
+    // run would cover the rerun span only
+    if (!ecProject_->hasFullOutputOnly())
     {
-        qDebug() << "second first preliminary test";
-        return test;
+        WidgetUtils::information(this,
+                                 tr("Reuse Cached Results"),
+                                 tr("The cached results are reused only "
+                                    "when the full output is the only "
+                                    "output selected."),
+                                 tr("All the data will be processed."));
+        return projectFile;
     }
 
-    QString epFormat = QStringLiteral("*.") + Defs::APP_NAME_LCASE;
-    QString csvFormat = QStringLiteral("*.") + Defs::CSV_NATIVE_DATA_FILE_EXT;
+    const auto env = configState_.general.env;
+    const auto fileDuration = dlProject_->fileDuration();
+    const auto avrgLen = (ecProject_->screenAvrgLen() > 0) ? ecProject_->screenAvrgLen()
+                                                           : fileDuration;
 
-    auto recurse = true;
-    QStringList previousRunList(FileUtils::getFiles(ecProject_->spectraExDir(),
-                                         epFormat,
-                                         recurse));
-    qDebug() << "previousRunList" << previousRunList << previousRunList.count();
+    const auto files = RawFileIndex::getEntries(env,
+                                                ecProject_->screenDataPath(),
+                                                rawFileExtension(),
+                                                ecProject_->screenRecurse(),
+                                                ecProject_->generalFilePrototype());
+    auto periods = ResultCache::inputPeriods(files,
+                                             fileDuration,
+                                             avrgLen,
+                                             dlProject_->timestampEnd());
 
-    QStringList previousEssentialList(FileUtils::getFiles(ecProject_->spectraExDir(),
-                                         csvFormat,
-                                         recurse));
-    qDebug() << previousEssentialList.count();
+    // only the periods of the processing subset
+    if (ecProject_->generalSubset())
+    {
+        const QDateTime from(QDate::fromString(ecProject_->generalStartDate(), Qt::ISODate),
+                             QTime::fromString(ecProject_->generalStartTime(), QStringLiteral("hh:mm")));
+        const QDateTime to(QDate::fromString(ecProject_->generalEndDate(), Qt::ISODate),
+                           QTime::fromString(ecProject_->generalEndTime(), QStringLiteral("hh:mm")));
 
-    previousEssentialList = previousEssentialList.filter(QStringLiteral("essentials"));
-    qDebug() << "previousEssentialList" << previousEssentialList << previousEssentialList.count();
+        auto outside = [&from, &to, avrgLen](const ResultCache::Period& period) {
+            return period.end.addSecs(-avrgLen * 60) < from || period.end > to;
+        };
+        periods.erase(std::remove_if(periods.begin(), periods.end(), outside), periods.end());
+    }
 
-    // prunes the previousRunList if there are no corresponding essential files
-    foreach (const QString& processingFile, previousRunList)
+    resultCachePlan_ = ResultCache::plan(env,
+                                         ecProject_->resultsFingerprint(),
+                                         avrgLen,
+                                         periods);
+    if (!resultCachePlan_.isValid() || resultCachePlan_.cachedCount == 0)
     {
-        QFileInfo info(processingFile);
-        QString filenameDate = info.fileName().mid(11, 17);
-
-        qDebug() << "info.fileName()" << info.fileName();
-        qDebug() << "filenameDate" << filenameDate;
+        return projectFile;
+    }
 
-        if (!StringUtils::isISODateTimeString(filenameDate)
-            || previousEssentialList.filter(filenameDate).isEmpty())
+    if (resultCachePlan_.isComplete())
+    {
+        const auto processAnyway = WidgetUtils::yesNoQuestion(this,
+                                 tr("Run"),
+                                 tr("All the %1 averaging periods are already "
+                                    "processed with the current settings.")
+                                 .arg(resultCachePlan_.periods.size()),
+                                 tr("Results: %1\n\nDo you want to process "
+                                    "them again?").arg(resultCachePlan_.outputFile),
+                                 QString(),
+                                 tr("&Process Anyway"),
+                                 tr("&Cancel"));
+        if (processAnyway)
         {
-            qDebug() << "essential fail";
-            qDebug() << "remove processingFile" << processingFile;
-            previousRunList.removeOne(processingFile);
+            // the new full output replaces the cached one
+            resultCachePlan_.cachedCount = 0;
+            resultCachePlan_.rerunFrom = resultCachePlan_.periods.first().end
+                                         .addSecs(-avrgLen * 60);
+            resultCachePlan_.rerunTo = resultCachePlan_.periods.last().end;
+            return projectFile;
         }
+        resultCachePlan_ = ResultCache::Plan();
+        return QString();
     }
-    qDebug() << "previousRunList" << previousRunList << previousRunList.count();
 
-    // load and compare each old project found with the current project
-    ConfigState currConfigState;
+    const auto rerunFile = writeRerunProject(resultCachePlan_.rerunFrom,
+                                             resultCachePlan_.rerunTo);
+    if (rerunFile.isEmpty())
+    {
+        resultCachePlan_ = ResultCache::Plan();
+        return projectFile;
+    }
+    runFrom_ = resultCachePlan_.rerunFrom;
+    runTo_ = resultCachePlan_.rerunTo;
+    return rerunFile;
+}
 
-    QScopedPointer<EcProject> currEcProject(new EcProject(this, currConfigState.project));
-    QScopedPointer<EcProject> prevEcProject(new EcProject(this, currConfigState.project));
-    int i = 0;
-    foreach (const QString& processingFile, previousRunList)
+// copy of the project in the env tmp dir, restricted to [from, to] and
+// optionally writing its results in outPath. suffix is added to the file
+// name. return its path, empty if it cannot be written
+QString MainWindow::writeRerunProject(const QDateTime& from,
+                                      const QDateTime& to,
+                                      const QString& outPath,
+                                      const QString& suffix)
+{
+    EcProject rerunProject(*ecProject_);
+    if (!outPath.isEmpty())
     {
-        bool modified; // not necessary in this case
+        rerunProject.setGeneralOutPath(outPath);
+    }
+    rerunProject.setGeneralSubset(1);
+    rerunProject.setGeneralStartDate(from.date().toString(Qt::ISODate));
+    rerunProject.setGeneralStartTime(from.time().toString(QStringLiteral("hh:mm")));
+    rerunProject.setGeneralEndDate(to.date().toString(Qt::ISODate));
+    rerunProject.setGeneralEndTime(to.time().toString(QStringLiteral("hh:mm")));
+
+    const QString rerunFile = appEnvPath_
+                              + QLatin1Char('/')
+                              + Defs::TMP_FILE_DIR
+                              + QLatin1Char('/')
+                              + QFileInfo(ecProject_->generalFileName()).completeBaseName()
+                              + suffix
+                              + QLatin1Char('.')
+                              + QFileInfo(ecProject_->generalFileName()).suffix();
+    QDir().mkpath(QFileInfo(rerunFile).absolutePath());
+    if (!rerunProject.saveEcProject(rerunFile))
+    {
+        return QString();
+    }
+
+    qDebug() << "rerun" << rerunFile << from << to;
+    return rerunFile;
+}
+
+// project files for the engines of the run about to start, one for each
+// date shard when the run is split. empty to cancel the run
+QStringList MainWindow::engineProjectFiles()
+{
+    appendRun_ = false;
+    runStartTime_ = QDateTime::currentDateTime();
+    runFrom_ = QDateTime();
+    runTo_ = QDateTime();
+    shardDirs_.clear();
+    runEssentialsFile_.clear();
+
+    const auto projectFile = appendRunAction->isChecked() ? planAppendRun()
+                                                          : planCachedRun();
+    if (projectFile.isEmpty())
+    {
+        return QStringList();
+    }
+
+    const auto shardFiles = writeShardProjects(projectFile);
+    if (shardFiles.size() > 1)
+    {
+        return shardFiles;
+    }
+    return QStringList(projectFile);
+}
+
+// split the run in date shards processed at the same time, if the
+// results of each averaging period do not depend on the others.
+// return the shard project files, empty if the run is not split
+QStringList MainWindow::writeShardProjects(const QString& projectFile)
+{
+    DEBUG_FUNC_NAME
+
+    const auto parallelism = engineParallelism();
+    if (parallelism < 2 || !ecProject_->hasPeriodIndependentResults())
+    {
+        return QStringList();
+    }
 
-        qDebug() << "begin iteration --------------------";
-        if (currEcProject->loadEcProject(ecProject_->generalFileName(), false, &modified)
-            && prevEcProject->loadEcProject(processingFile, false, &modified)
-            && prevEcProject->generalRunMode() == Defs::CurrRunMode::Advanced)
+    // the span planned by the cache or the append mode, otherwise the
+    // processing subset or the whole dataset
+    auto from = runFrom_;
+    auto to = runTo_;
+    if (!from.isValid() || !to.isValid())
+    {
+        if (ecProject_->generalSubset())
         {
-            qDebug() << "loading";
-            if (currEcProject->fuzzyCompare(*prevEcProject))
-            {
-                qDebug() << "fuzzyCompare: OK";
-                test = true;
-                QFileInfo info(processingFile);
-                qDebug() << "previousEssentialList.filter(info.fileName().mid(11, 17))"
-                         << previousEssentialList.filter(info.fileName().mid(11, 17));
-                qDebug() << "info.fileName().mid(11, 17)" << info.fileName().mid(11, 17);
-                QString exFilePath = previousEssentialList.filter(info.fileName().mid(11, 17)).first();
-
-                qDebug() << "exFilePath" << exFilePath;
-                updateSpectraPathFromPreviousData(exFilePath);
-                qDebug() << "end of the successful iteration --------------------";
-                break;
-            }
-            else
-            {
-                qDebug() << "fuzzyCompare: FAIL";
-            }
+            from = QDateTime(QDate::fromString(ecProject_->generalStartDate(), Qt::ISODate),
+                             QTime::fromString(ecProject_->generalStartTime(), QStringLiteral("hh:mm")));
+            to = QDateTime(QDate::fromString(ecProject_->generalEndDate(), Qt::ISODate),
+                           QTime::fromString(ecProject_->generalEndTime(), QStringLiteral("hh:mm")));
         }
         else
         {
-            // NOTE: for testing only
-//            qDebug() << "load_1:" << currEcProject->loadEcProject(ecProject_->generalFileName());
-//            qDebug() << "load_2:" << prevEcProject->loadEcProject(processingFile);
-//            qDebug() << "run mode:" << prevEcProject->generalRunMode();
-            qDebug() << "loading FAIL";
+            const auto range = getCurrentDataAvailability().range;
+            from = range.first;
+            to = range.second;
         }
+    }
+
+    const auto avrgLen = (ecProject_->screenAvrgLen() > 0) ? ecProject_->screenAvrgLen()
+                                                           : dlProject_->fileDuration();
+    const auto shards = ShardedRun::split(from, to, parallelism, avrgLen);
+    if (shards.size() < 2)
+    {
+        return QStringList();
+    }
+
+    const auto outPath = ecProject_->generalOutPath();
+    ShardedRun::removeShardDirs(outPath);
 
-        ++i;
-        qDebug() << "end iteration --------------------" << i;
+    QStringList shardFiles;
+    QStringList shardDirs;
+    for (auto i = 0; i < shards.size(); ++i)
+    {
+        const auto dir = ShardedRun::shardDir(outPath, i);
+        const auto shardFile = writeRerunProject(shards.at(i).first,
+                                                 shards.at(i).second,
+                                                 dir,
+                                                 QStringLiteral("_shard_") + QString::number(i));
+        if (shardFile.isEmpty() || !QDir().mkpath(dir))
+        {
+            qWarning() << "unable to write the shard" << i << "of" << projectFile;
+            ShardedRun::removeShardDirs(outPath);
+            return QStringList();
+        }
+        shardFiles << shardFile;
+        shardDirs << dir;
     }
 
-    return test;
+    shardDirs_ = shardDirs;
+    return shardFiles;
+}
+
+// start the engine on a project file, or one engine for each shard
+void MainWindow::startEngine(const QString& enginePath,
+                             const QString& workingDir,
+                             const QStringList& args,
+                             const QStringList& projectFiles)
+{
+    if (projectFiles.size() == 1)
+    {
+        engineProcess_->engineProcessStart(enginePath,
+                                           workingDir,
+                                           QStringList(args) << projectFiles.first());
+
+        // block until the process truly start to ensure reliable behavior
+        // of the gui
+        engineProcess_->process()->waitForStarted();
+        return;
+    }
+
+    engineScheduler_->setMaxParallel(engineParallelism());
+    engineScheduler_->start(enginePath, workingDir, args, projectFiles);
+}
+
+bool MainWindow::isEngineRunning() const
+{
+    if (shardDirs_.isEmpty())
+    {
+        return engineProcess_->isRunning();
+    }
+    return engineScheduler_->isRunning();
+}
+
+Process::ExitStatus MainWindow::engineExit() const
+{
+    if (shardDirs_.isEmpty())
+    {
+        return engineProcess_->processExit();
+    }
+    return engineScheduler_->exitStatus();
+}
+
+// move the outputs of the shards in the output directory
+void MainWindow::mergeShardOutputs()
+{
+    DEBUG_FUNC_NAME
+
+    const auto shardDirs = shardDirs_;
+    shardDirs_.clear();
+
+    QString errorString;
+    if (!ShardedRun::mergeOutputs(shardDirs, ecProject_->generalOutPath(), &errorString))
+    {
+        WidgetUtils::warning(this,
+                             tr("Parallel Engine Processes"),
+                             tr("Unable to merge some results of the date "
+                                "shards in the output directory."),
+                             errorString);
+    }
+}
+
+// leave the shards of an incomplete run in their directories, removed at
+// the start of the next parallel run
+void MainWindow::keepShardOutputs()
+{
+    DEBUG_FUNC_NAME
+
+    QStringList shardDirs;
+    foreach (const QString& dir, shardDirs_)
+    {
+        shardDirs << QDir::toNativeSeparators(dir);
+    }
+    shardDirs_.clear();
+
+    WidgetUtils::warning(this,
+                         tr("Parallel Engine Processes"),
+                         tr("The run did not complete. The results of the "
+                            "date shards are not merged in the output "
+                            "directory and are left in:"),
+                         shardDirs.join(QLatin1Char('\n')));
+}
+
+// restrict the run to the raw data following the last averaging period
+// already in the output directory. return the project file for the engine,
+// empty if there is no new data
+QString MainWindow::planAppendRun()
+{
+    DEBUG_FUNC_NAME
+
+    resultCachePlan_ = ResultCache::Plan();
+
+    const auto projectFile = ecProject_->generalFileName();
+
+    // the periods computed on the whole dataset would change
+    if (!ecProject_->hasPeriodIndependentResults())
+    {
+        WidgetUtils::information(this,
+                                 tr("Append New Data"),
+                                 tr("The current settings use the whole "
+                                    "dataset (planar fit, time lag "
+                                    "optimization or spectral corrections "
+                                    "without their own date range)."),
+                                 tr("All the data will be processed."));
+        return projectFile;
+    }
+
+    const auto lastEnd = IncrementalRun::lastProcessedPeriod(ecProject_->generalOutPath());
+    if (!lastEnd.isValid())
+    {
+        qDebug() << "no previous output, full run";
+        return projectFile;
+    }
+
+    auto from = lastEnd;
+    auto to = getCurrentDataAvailability().range.second;
+    if (ecProject_->generalSubset())
+    {
+        const QDateTime subsetFrom(QDate::fromString(ecProject_->generalStartDate(), Qt::ISODate),
+                                   QTime::fromString(ecProject_->generalStartTime(), QStringLiteral("hh:mm")));
+        const QDateTime subsetTo(QDate::fromString(ecProject_->generalEndDate(), Qt::ISODate),
+                                 QTime::fromString(ecProject_->generalEndTime(), QStringLiteral("hh:mm")));
+        from = qMax(from, subsetFrom);
+        to = qMin(to, subsetTo);
+    }
+
+    if (!to.isValid() || from >= to)
+    {
+        WidgetUtils::information(this,
+                                 tr("Append New Data"),
+                                 tr("No new raw data after %1.")
+                                 .arg(lastEnd.toString(QStringLiteral("yyyy-MM-dd hh:mm"))));
+        return QString();
+    }
+
+    const auto rerunFile = writeRerunProject(from, to);
+    if (rerunFile.isEmpty())
+    {
+        return projectFile;
+    }
+
+    appendRun_ = true;
+    runFrom_ = from;
+    runTo_ = to;
+    return rerunFile;
+}
+
+// append the outputs of the run just completed to the previous ones
+void MainWindow::appendRunOutputs()
+{
+    DEBUG_FUNC_NAME
+
+    appendRun_ = false;
+
+    QString errorString;
+    IncrementalRun::appendNewOutputs(ecProject_->generalOutPath(),
+                                     runStartTime_,
+                                     &errorString);
+    if (!errorString.isEmpty())
+    {
+        WidgetUtils::warning(this,
+                             tr("Append New Data"),
+                             tr("Unable to append some results to the "
+                                "previous output files. They are left in "
+                                "separate files."),
+                             errorString);
+    }
+}
+
+// merge the cached rows in the full output of the run just completed
+// and record it in the result cache
+void MainWindow::updateResultCache()
+{
+    DEBUG_FUNC_NAME
+
+    if (!resultCachePlan_.isValid())
+    {
+        return;
+    }
+
+    const auto plan = resultCachePlan_;
+    resultCachePlan_ = ResultCache::Plan();
+
+    const auto fullOutputFile = ResultCache::runFullOutputFile(runEssentialsFile_);
+    if (fullOutputFile.isEmpty())
+    {
+        qDebug() << "no full output of the run" << runEssentialsFile_;
+        return;
+    }
+
+    QString errorString;
+    if (!ResultCache::mergeFullOutput(configState_.general.env,
+                                      plan,
+                                      fullOutputFile,
+                                      &errorString))
+    {
+        WidgetUtils::warning(this,
+                             tr("Result Cache"),
+                             tr("Unable to add the previous results to %1.")
+                             .arg(QFileInfo(fullOutputFile).fileName()),
+                             errorString);
+    }
 }
 
 void MainWindow::openLicorSite() const
@@ -26,14 +26,20 @@
 
 #include <QMainWindow>
 
+#include <functional>
+
 #include "configstate.h"
 #include "defs.h"
 #include "fileutils.h"
 #include "process.h"
+#include "resultcache.h"
 
 class QPlainTextEdit;
 class QDockWidget;
 class QActionGroup;
+class BatchQueue;
+class ConsoleSink;
+class EngineScheduler;
 class QLabel;
 
 class AboutDialog;
@@ -103,6 +109,13 @@ private slots:
     void showPdfHelp();
     void showStarterPdfHelp();
     void setOfflineHelp(bool yes);
+    void setAppendRun(bool on);
+    void setResultCache(bool on);
+    void setRunEssentialsFile(const QString& path);
+    void setEngineParallelism(QAction* action);
+    void setEngineResourceBudget(QAction* action);
+    void setConsoleMaxLines(QAction* action);
+    void showConsoleHistory();
     void setSmartfluxMode(bool on);
     void about();
 
@@ -152,8 +165,11 @@ private slots:
     void updateConsoleChar(QByteArray& data);
     void updateConsoleReceived();
     void updateConsoleError();
+    void updateProgressReceived();
+    void showPauseLatency(qint64 latency);
 
     void setMetadataRead(bool b);
+    void runMetadataReadAction();
 
     void showAutoUpdateDialog();
     void showAutoUpdateResults();
@@ -193,6 +209,7 @@ private:
     void createStatusBar();
     void createInfoDockWin();
     void createConsoleDockWin();
+    void createBatchDockWin();
     bool continueBeforeClose();
     void saveEnvSettings(const QString& env);
 
@@ -217,6 +234,28 @@ private:
     bool okToStopRun();
     int testBeforeRunningPassed(int step);
     bool testForPreviousData();
+    void updateRunCatalog(const QString& dir);
+    QString rawFileExtension() const;
+    QStringList engineProjectFiles();
+    QStringList writeShardProjects(const QString& projectFile);
+    QString writeRerunProject(const QDateTime& from,
+                              const QDateTime& to,
+                              const QString& outPath = QString(),
+                              const QString& suffix = QString());
+    int engineParallelism() const;
+    void startEngine(const QString& enginePath,
+                     const QString& workingDir,
+                     const QStringList& args,
+                     const QStringList& projectFiles);
+    bool isEngineRunning() const;
+    Process::ExitStatus engineExit() const;
+    void mergeShardOutputs();
+    void keepShardOutputs();
+    void updateMetadataReadThen(const std::function<void ()>& action);
+    QString planCachedRun();
+    QString planAppendRun();
+    void updateResultCache();
+    void appendRunOutputs();
     bool alertChangesWhileRunning();
     void togglePageButton(Defs::CurrPage page);
     void changeViewToolbarSeparators(Defs::CurrPage page);
@@ -231,6 +270,9 @@ private:
     QMenu *editMenu;
     QMenu *viewMenu;
     QMenu *toolsMenu;
+    QMenu *parallelismMenu;
+    QMenu *resourceBudgetMenu;
+    QMenu *consoleLinesMenu;
     QMenu *optionsMenu;
     QMenu *helpMenu;
     QMenu *fileMenuOpenRecent;
@@ -262,6 +304,8 @@ private:
     QAction *runAdvancedAction;
     QAction *runRetrieverAction;
     QAction *stopAction;
+    QAction *appendRunAction;
+    QAction *resultCacheAction;
 //#if !defined(Q_OS_MAC)
     QAction *toggleFullScreenAction;
 //#endif
@@ -269,7 +313,12 @@ private:
     QAction* toggleInfoOutputAct;
     QAction *toggleTooltipOutputAct;
     QAction *toggleConsoleOutputAct;
+    QAction *toggleBatchQueueAct;
     QActionGroup *changeStyleAction;
+    QActionGroup *parallelismActionGroup;
+    QActionGroup *memoryBudgetActionGroup;
+    QActionGroup *ioBudgetActionGroup;
+    QActionGroup *consoleLinesActionGroup;
     QAction *helpAction;
     QAction *pdfHelpAction;
     QAction *starterPdfHelpAction;
@@ -283,7 +332,9 @@ private:
     QDockWidget *infoDock;
     QPlainTextEdit *infoOutput;
     QDockWidget *consoleDock;
+    QDockWidget *batchDock;
     QPlainTextEdit *consoleOutput;
+    ConsoleSink *consoleSink_;
 
     AboutDialog *aboutDialog;
     CustomSplashScreen *splash_screen_;
@@ -311,7 +362,15 @@ private:
     bool openingFlag_;
     bool engineResumableFlag_;
     bool metadataReadFlag_;
+    std::function<void ()> metadataReadAction_;
     bool neededEngineStep2_;
+    ResultCache::Plan resultCachePlan_;
+    bool appendRun_;
+    QDateTime runStartTime_;
+    QDateTime runFrom_;
+    QDateTime runTo_;
+    QStringList shardDirs_;
+    QString runEssentialsFile_;     // as reported by the engine
     bool guidedModeOn_;
     bool basicSettingsPageAvailable_;
     bool runExpressAvailable_;
@@ -336,6 +395,8 @@ private:
     void showStatusTip(const QString &text) const;
 
     Process* engineProcess_;
+    EngineScheduler* engineScheduler_;
+    BatchQueue* batchQueue_;
     int engineExit_;
 
     UpdateDialog* updateDialog;
@@ -353,7 +414,7 @@ private:
 
     bool getDatesRangeDialog(Defs::CurrRunMode mode);
     bool showDatesRangeDialog(Defs::CurrRunMode mode);
-    FileUtils::DateRange getCurrentDateRange();
+    FileUtils::DataAvailability getCurrentDataAvailability();
 
     void minimizeGui();
     void maximizeGui();
@@ -0,0 +1,196 @@
+/***************************************************************************
+  metadatacheckdialog.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "metadatacheckdialog.h"
+
+#include <QCloseEvent>
+#include <QDateTime>
+#include <QFileDialog>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QTableWidget>
+
+#include "dbghelper.h"
+#include "defs.h"
+#include "metadatascanner.h"
+#include "widget_utils.h"
+
+MetadataCheckDialog::MetadataCheckDialog(QWidget* parent) :
+    QDialog(parent),
+    scanner_(new MetadataScanner(this))
+{
+    setWindowModality(Qt::WindowModal);
+    setWindowTitle(tr("Check Metadata Consistency"));
+    WidgetUtils::removeContextHelpButton(this);
+
+    auto groupTitle = new QLabel;
+    groupTitle->setText(tr("Periods of identical metadata embedded in the GHG files"));
+
+    auto hrLabel = new QLabel;
+    hrLabel->setObjectName(QStringLiteral("hrLabel"));
+    hrLabel->setMinimumWidth(600);
+
+    summaryLabel = new QLabel;
+    summaryLabel->setWordWrap(true);
+
+    progressBar = new QProgressBar;
+    progressBar->setTextVisible(true);
+
+    periodTable = new QTableWidget(0, 5);
+    periodTable->setHorizontalHeaderLabels(QStringList()
+                                           << tr("Start")
+                                           << tr("End")
+                                           << tr("Files")
+                                           << tr("First file")
+                                           << tr("Changed fields"));
+    periodTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    periodTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    periodTable->horizontalHeader()->setStretchLastSection(true);
+    periodTable->verticalHeader()->setVisible(false);
+    periodTable->setMinimumHeight(250);
+
+    exportButton = new QPushButton(tr("Export..."));
+    exportButton->setProperty("commonButton2", true);
+    exportButton->setEnabled(false);
+
+    okButton = WidgetUtils::createCommonButton(this, tr("Ok"));
+
+    auto buttonLayout = new QHBoxLayout;
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(exportButton);
+    buttonLayout->addWidget(okButton);
+    buttonLayout->addStretch();
+
+    auto dialogLayout = new QGridLayout(this);
+    dialogLayout->addWidget(groupTitle, 0, 0);
+    dialogLayout->addWidget(hrLabel, 1, 0);
+    dialogLayout->addWidget(progressBar, 2, 0);
+    dialogLayout->addWidget(summaryLabel, 3, 0);
+    dialogLayout->addWidget(periodTable, 4, 0);
+    dialogLayout->addLayout(buttonLayout, 5, 0);
+    dialogLayout->setVerticalSpacing(10);
+    dialogLayout->setContentsMargins(30, 30, 30, 30);
+    setLayout(dialogLayout);
+
+    connect(scanner_, &MetadataScanner::progressChanged,
+            this, &MetadataCheckDialog::updateProgress);
+    connect(scanner_, &MetadataScanner::finished,
+            this, &MetadataCheckDialog::showPeriods);
+    connect(exportButton, &QPushButton::clicked,
+            this, &MetadataCheckDialog::exportTable);
+    connect(okButton, &QPushButton::clicked,
+            this, &MetadataCheckDialog::close);
+}
+
+void MetadataCheckDialog::scan(const QString& appEnvPath,
+                               const QStringList& fileList,
+                               const QString& filenamePrototype)
+{
+    DEBUG_FUNC_NAME
+
+    periodTable->setRowCount(0);
+    exportButton->setEnabled(false);
+    progressBar->setVisible(true);
+    summaryLabel->setText(tr("Reading the metadata of %1 files...").arg(fileList.size()));
+
+    scanner_->start(appEnvPath, fileList, filenamePrototype);
+}
+
+void MetadataCheckDialog::closeEvent(QCloseEvent* event)
+{
+    scanner_->cancel();
+    event->accept();
+}
+
+void MetadataCheckDialog::updateProgress(int done, int total)
+{
+    progressBar->setRange(0, total);
+    progressBar->setValue(done);
+}
+
+void MetadataCheckDialog::showPeriods()
+{
+    const auto periods = scanner_->periods();
+
+    progressBar->setVisible(false);
+
+    auto summary = QString();
+    if (periods.size() <= 1)
+    {
+        summary = tr("All the readable files share the same metadata.");
+    }
+    else
+    {
+        summary = tr("The metadata change %1 times in the dataset.").arg(periods.size() - 1);
+    }
+    if (scanner_->unreadableCount() > 0)
+    {
+        summary += QLatin1Char(' ')
+                   + tr("%1 files without readable metadata are not included.")
+                     .arg(scanner_->unreadableCount());
+    }
+    summaryLabel->setText(summary);
+
+    periodTable->setRowCount(periods.size());
+    for (auto i = 0; i < periods.size(); ++i)
+    {
+        const auto& period = periods.at(i);
+        periodTable->setItem(i, 0, new QTableWidgetItem(period.start.toString(Qt::ISODate)));
+        periodTable->setItem(i, 1, new QTableWidgetItem(period.end.toString(Qt::ISODate)));
+        periodTable->setItem(i, 2, new QTableWidgetItem(QString::number(period.fileCount)));
+        periodTable->setItem(i, 3, new QTableWidgetItem(period.firstFile.mid(period.firstFile.lastIndexOf(QLatin1Char('/')) + 1)));
+        periodTable->setItem(i, 4, new QTableWidgetItem(period.changedKeys.join(QStringLiteral(", "))));
+        periodTable->item(i, 3)->setToolTip(period.firstFile);
+        periodTable->item(i, 4)->setToolTip(period.changedKeys.join(QLatin1Char('\n')));
+    }
+    periodTable->resizeColumnsToContents();
+
+    exportButton->setEnabled(!periods.isEmpty());
+}
+
+void MetadataCheckDialog::exportTable()
+{
+    const QString filenameHint = WidgetUtils::getSearchPathHint()
+                                 + QStringLiteral("/metadata-periods-")
+                                 + QDateTime::currentDateTime().toString(QStringLiteral("yyyy-MM-ddThhmmss"))
+                                 + QStringLiteral(".")
+                                 + Defs::CSV_NATIVE_DATA_FILE_EXT;
+    auto filename = QFileDialog::getSaveFileName(this,
+                                                 tr("Save the metadata periods as..."),
+                                                 filenameHint,
+                                                 tr("Comma separated values (*.csv);;All files (*)"));
+    if (filename.isEmpty())
+    {
+        return;
+    }
+
+    if (!scanner_->exportTable(filename))
+    {
+        WidgetUtils::warning(this,
+                             tr("Write Error"),
+                             tr("Cannot write file <p>%1</p>").arg(filename));
+    }
+}
@@ -0,0 +1,77 @@
+/***************************************************************************
+  metadatacheckdialog.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef METADATACHECKDIALOG_H
+#define METADATACHECKDIALOG_H
+
+#include <QDialog>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/metadatacheckdialog.h
+/// \brief Report of the embedded metadata periods of a GHG dataset
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note
+/// \sa MetadataScanner
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QTableWidget;
+
+class MetadataScanner;
+
+class MetadataCheckDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit MetadataCheckDialog(QWidget* parent);
+
+    void scan(const QString& appEnvPath,
+              const QStringList& fileList,
+              const QString& filenamePrototype);
+
+protected:
+    void closeEvent(QCloseEvent* event) Q_DECL_OVERRIDE;
+
+private slots:
+    void updateProgress(int done, int total);
+    void showPeriods();
+    void exportTable();
+
+private:
+    MetadataScanner* scanner_;
+    QLabel* summaryLabel;
+    QProgressBar* progressBar;
+    QTableWidget* periodTable;
+    QPushButton* exportButton;
+    QPushButton* okButton;
+};
+
+#endif // METADATACHECKDIALOG_H
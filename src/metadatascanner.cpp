@@ -0,0 +1,339 @@
+/***************************************************************************
+  metadatascanner.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "metadatascanner.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QHash>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+
+#include "dbghelper.h"
+#include "defs.h"
+#include "dlinidefs.h"
+#include "filenameprototype.h"
+#include "fileutils.h"
+#include "inifile.h"
+#include "ziparchivecache.h"
+
+namespace
+{
+// the raw metadata entry of the archive, the biomet one is skipped
+bool readRawMetadata(const QString& appEnvPath, const QString& fileName, QByteArray* data)
+{
+    const QString mdSuffix = QStringLiteral(".") + Defs::METADATA_FILE_EXT;
+
+    foreach (const QString& entry, ZipArchiveCache::getFileList(appEnvPath, fileName))
+    {
+        if (entry.endsWith(mdSuffix)
+            && !entry.contains(Defs::DEFAULT_BIOMET_SUFFIX))
+        {
+            return FileUtils::zipReadEntry(fileName, entry, data);
+        }
+    }
+    return false;
+}
+
+// map functor for QtConcurrent, the result_type typedef is required
+struct FileMetadataReader
+{
+    typedef MetadataScanner::FileMetadata result_type;
+
+    QString appEnvPath;
+    FilenamePrototype prototype;
+
+    MetadataScanner::FileMetadata operator()(const QString& fileName) const
+    {
+        MetadataScanner::FileMetadata file;
+        file.path = fileName;
+
+        const auto nameStart = fileName.lastIndexOf(QLatin1Char('/')) + 1;
+        file.timestamp = prototype.timestampKey(fileName.constData() + nameStart,
+                                                fileName.size() - nameStart);
+
+        QByteArray data;
+        if (readRawMetadata(appEnvPath, fileName, &data))
+        {
+            file.hash = MetadataScanner::metadataHash(MetadataScanner::normalizedMetadata(data));
+        }
+        return file;
+    }
+};
+
+bool fileLessThan(const MetadataScanner::FileMetadata& a,
+                  const MetadataScanner::FileMetadata& b)
+{
+    if (a.timestamp != b.timestamp)
+    {
+        return a.timestamp < b.timestamp;
+    }
+    return a.path < b.path;
+}
+
+// keys with a different or missing value
+QStringList changedKeys(const QMap<QString, QString>& before,
+                        const QMap<QString, QString>& after)
+{
+    QStringList keys;
+    for (auto it = after.constBegin(); it != after.constEnd(); ++it)
+    {
+        if (!before.contains(it.key()) || before.value(it.key()) != it.value())
+        {
+            keys.append(it.key());
+        }
+    }
+    for (auto it = before.constBegin(); it != before.constEnd(); ++it)
+    {
+        if (!after.contains(it.key()))
+        {
+            keys.append(it.key());
+        }
+    }
+    keys.sort();
+    return keys;
+}
+
+QString csvField(const QString& s)
+{
+    if (s.contains(QLatin1Char(',')) || s.contains(QLatin1Char('"')))
+    {
+        QString quoted = s;
+        quoted.replace(QLatin1String("\""), QLatin1String("\"\""));
+        return QLatin1Char('"') + quoted + QLatin1Char('"');
+    }
+    return s;
+}
+} // namespace
+
+MetadataScanner::MetadataScanner(QObject* parent) :
+    QObject(parent),
+    watcher_(nullptr),
+    unreadableCount_(0),
+    running_(false)
+{
+}
+
+MetadataScanner::~MetadataScanner()
+{
+    if (watcher_)
+    {
+        watcher_->cancel();
+        watcher_->waitForFinished();
+    }
+}
+
+void MetadataScanner::start(const QString& appEnvPath,
+                            const QStringList& fileList,
+                            const QString& filenamePrototype)
+{
+    DEBUG_FUNC_NAME
+
+    cancel();
+
+    appEnvPath_ = appEnvPath;
+    periods_.clear();
+    unreadableCount_ = 0;
+    running_ = true;
+
+    FileMetadataReader reader;
+    reader.appEnvPath = appEnvPath;
+    reader.prototype = FilenamePrototype(filenamePrototype);
+
+    // runs in the global thread pool, shared with the other background jobs
+    watcher_ = new QFutureWatcher<FileMetadata>(this);
+    const auto total = fileList.size();
+    connect(watcher_, &QFutureWatcher<FileMetadata>::progressValueChanged,
+            this, [this, total](int done) { emit progressChanged(done, total); });
+    connect(watcher_, &QFutureWatcher<FileMetadata>::finished,
+            this, &MetadataScanner::handleFinished);
+    watcher_->setFuture(QtConcurrent::mapped(fileList, reader));
+
+    emit progressChanged(0, fileList.size());
+}
+
+void MetadataScanner::cancel()
+{
+    if (!running_)
+    {
+        return;
+    }
+
+    DEBUG_FUNC_NAME
+
+    if (watcher_)
+    {
+        watcher_->disconnect(this);
+        watcher_->cancel();
+        connect(watcher_, &QFutureWatcher<FileMetadata>::finished,
+                watcher_, &QObject::deleteLater);
+        watcher_ = nullptr;
+    }
+
+    running_ = false;
+    emit cancelled();
+}
+
+void MetadataScanner::handleFinished()
+{
+    auto watcher = watcher_;
+    watcher_ = nullptr;
+
+    const auto results = watcher->future().results();
+    watcher->deleteLater();
+
+    buildPeriods(results.toVector());
+
+    // the archives listed for the first time are kept for the next scans
+    ZipArchiveCache::flush(appEnvPath_);
+
+    running_ = false;
+
+    qDebug() << "metadata periods" << periods_.size() << "unreadable" << unreadableCount_;
+
+    emit finished();
+}
+
+void MetadataScanner::buildPeriods(QVector<FileMetadata> files)
+{
+    std::sort(files.begin(), files.end(), fileLessThan);
+
+    // files without metadata do not split a period
+    QHash<QByteArray, QString> firstFileOfHash;
+    for (const auto& file : files)
+    {
+        if (file.hash.isEmpty())
+        {
+            ++unreadableCount_;
+            continue;
+        }
+
+        if (periods_.isEmpty() || periods_.last().hash != file.hash)
+        {
+            Period period;
+            period.start = FilenamePrototype::keyToDateTime(file.timestamp);
+            period.firstFile = file.path;
+            period.hash = file.hash;
+            periods_.append(period);
+
+            if (!firstFileOfHash.contains(file.hash))
+            {
+                firstFileOfHash.insert(file.hash, file.path);
+            }
+        }
+
+        auto& period = periods_.last();
+        period.end = FilenamePrototype::keyToDateTime(file.timestamp);
+        period.lastFile = file.path;
+        ++period.fileCount;
+    }
+
+    // read again only one file per distinct metadata, to list the changes
+    QHash<QByteArray, QMap<QString, QString>> metadataOfHash;
+    for (auto it = firstFileOfHash.constBegin(); it != firstFileOfHash.constEnd(); ++it)
+    {
+        QByteArray data;
+        if (readRawMetadata(appEnvPath_, it.value(), &data))
+        {
+            metadataOfHash.insert(it.key(), normalizedMetadata(data));
+        }
+    }
+
+    for (auto i = 1; i < periods_.size(); ++i)
+    {
+        periods_[i].changedKeys = changedKeys(metadataOfHash.value(periods_.at(i - 1).hash),
+                                              metadataOfHash.value(periods_.at(i).hash));
+    }
+}
+
+QMap<QString, QString> MetadataScanner::normalizedMetadata(const QByteArray& data)
+{
+    const QString projectPrefix = DlIni::INIGROUP_PROJECT + QLatin1Char('/');
+    const QString dataPathKey = DlIni::INIGROUP_FILES + QLatin1Char('/') + DlIni::INI_FILE_DATA_PATH;
+
+    const IniFile ini(data);
+
+    QMap<QString, QString> metadata;
+    foreach (const QString& key, ini.allKeys())
+    {
+        // fields changing at each file
+        if (key.startsWith(projectPrefix) || key == dataPathKey)
+        {
+            continue;
+        }
+
+        const auto value = ini.value(key);
+        if (value.type() == QVariant::StringList)
+        {
+            metadata.insert(key, value.toStringList().join(QLatin1Char(',')));
+        }
+        else
+        {
+            metadata.insert(key, value.toString());
+        }
+    }
+    return metadata;
+}
+
+QByteArray MetadataScanner::metadataHash(const QMap<QString, QString>& metadata)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (auto it = metadata.constBegin(); it != metadata.constEnd(); ++it)
+    {
+        hash.addData(it.key().toUtf8());
+        hash.addData("=", 1);
+        hash.addData(it.value().toUtf8());
+        hash.addData("\n", 1);
+    }
+    return hash.result().toHex();
+}
+
+bool MetadataScanner::exportTable(const QString& fileName) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qWarning() << "Error: Cannot write" << fileName << file.errorString();
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "period,start,end,files,first_file,last_file,metadata_hash,changed_keys\n";
+
+    for (auto i = 0; i < periods_.size(); ++i)
+    {
+        const auto& period = periods_.at(i);
+        out << (i + 1) << ','
+            << period.start.toString(Qt::ISODate) << ','
+            << period.end.toString(Qt::ISODate) << ','
+            << period.fileCount << ','
+            << csvField(period.firstFile) << ','
+            << csvField(period.lastFile) << ','
+            << QString::fromLatin1(period.hash) << ','
+            << csvField(period.changedKeys.join(QLatin1Char(' '))) << '\n';
+    }
+
+    return file.commit();
+}
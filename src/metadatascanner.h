@@ -0,0 +1,116 @@
+/***************************************************************************
+  metadatascanner.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef METADATASCANNER_H
+#define METADATASCANNER_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFutureWatcher>
+#include <QMap>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/metadatascanner.h
+/// \brief Consistency check of the metadata embedded in a GHG dataset
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note The embedded metadata of every GHG file are read in memory in the
+/// global thread pool, through the archive entry cache. Each one is hashed
+/// without the per-file fields ([Project] group and data path), then the
+/// files sorted by timestamp are grouped in contiguous periods of
+/// identical metadata.
+/// \sa ZipArchiveCache, FileUtils::zipReadEntry
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \class MetadataScanner
+/// \brief Asynchronous grouping of GHG files by embedded metadata
+class MetadataScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct FileMetadata
+    {
+        QString path;
+        qint64 timestamp = -1;  // FilenamePrototype key
+        QByteArray hash;        // empty if the metadata are not readable
+    };
+
+    struct Period
+    {
+        QDateTime start;
+        QDateTime end;
+        int fileCount = 0;
+        QString firstFile;
+        QString lastFile;
+        QByteArray hash;
+        QStringList changedKeys;  // against the previous period
+    };
+
+    explicit MetadataScanner(QObject* parent = nullptr);
+    ~MetadataScanner();
+
+    void start(const QString& appEnvPath,
+               const QStringList& fileList,
+               const QString& filenamePrototype);
+
+    inline bool isRunning() const { return running_; }
+    inline QVector<Period> periods() const { return periods_; }
+    inline int unreadableCount() const { return unreadableCount_; }
+
+    // one row per period, comma separated
+    bool exportTable(const QString& fileName) const;
+
+    // metadata without the per-file fields, as "group/key" -> value
+    static QMap<QString, QString> normalizedMetadata(const QByteArray& data);
+    static QByteArray metadataHash(const QMap<QString, QString>& metadata);
+
+public slots:
+    void cancel();
+
+signals:
+    void progressChanged(int done, int total);
+    void finished();
+    void cancelled();
+
+private slots:
+    void handleFinished();
+
+private:
+    void buildPeriods(QVector<FileMetadata> files);
+
+    QFutureWatcher<FileMetadata>* watcher_;
+    QString appEnvPath_;
+    QVector<Period> periods_;
+    int unreadableCount_;
+    bool running_;
+};
+
+#endif // METADATASCANNER_H
@@ -27,14 +27,55 @@
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
+#include <QSocketNotifier>
 #include <QTimer>
 
 #if defined(Q_OS_WIN)
 #include <windows.h>
 #include <psapi.h>
+#elif defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
 #endif
 
 #include "dbghelper.h"
+#include "engineprogress.h"
+
+namespace
+{
+/// \class EngineProcess
+/// \brief QProcess starting the child in a process group of its own
+class EngineProcess : public QProcess
+{
+public:
+    explicit EngineProcess(QObject* parent) : QProcess(parent) {}
+
+    // write end of the progress pipe, -1 if none
+    int progressFd = -1;
+
+protected:
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+    // so that pausing the engine reaches its children and never the gui
+    void setupChildProcess() override
+    {
+        ::setpgid(0, 0);
+
+        // the write end of the progress pipe becomes the channel descriptor,
+        // surviving exec()
+        if (progressFd == EngineProgress::CHANNEL_FD)
+        {
+            ::fcntl(progressFd, F_SETFD, 0);
+        }
+        else if (progressFd >= 0)
+        {
+            ::dup2(progressFd, EngineProgress::CHANNEL_FD);
+        }
+    }
+#endif
+};
+} // namespace
 
 Process::Process(QWidget* parent, const QString &fullPath) :
     QObject(parent),
@@ -44,9 +85,19 @@ Process::Process(QWidget* parent, const QString &fullPath) :
     processPid_(0),
     winPid_(QString()),
     freezerUtility_(0),
-    rxBuffer_(QByteArray())
+    rxBuffer_(QByteArray()),
+    progressChannel_(false),
+    progressFd_(-1),
+    progressNotifier_(nullptr)
 {
-    process_ = new QProcess(this);
+    pauseTimer_ = new QTimer(this);
+    pauseTimer_->setTimerType(Qt::PreciseTimer);
+    pauseTimer_->setInterval(1);
+    pauseTimeoutMSec_ = 0;
+    connect(pauseTimer_, &QTimer::timeout,
+            this, &Process::pollPause);
+
+    process_ = new EngineProcess(this);
     connect(process_, &QProcess::readyReadStandardOutput,
              this, &Process::readyReadStdOut);
     connect(process_, &QProcess::readyReadStandardError,
@@ -58,6 +109,7 @@ Process::Process(QWidget* parent, const QString &fullPath) :
 Process::~Process()
 {
     DEBUG_FUNC_NAME
+    closeProgressChannel();
 }
 
 bool Process::engineProcessStart(const QString& fullPath, const QString& workingDir, const QStringList& argList)
@@ -71,13 +123,139 @@ bool Process::engineProcessStart(const QString& fullPath, const QString& working
 
     process_->setWorkingDirectory(workingDir);
 
+    // the engine writes its progress events only where it finds the variable
+    auto env = process_->processEnvironment();
+    if (env.isEmpty())
+    {
+        env = QProcessEnvironment::systemEnvironment();
+    }
+    env.remove(EngineProgress::CHANNEL_ENV);
+    closeProgressChannel();
+    if (progressChannel_ && openProgressChannel())
+    {
+        env.insert(EngineProgress::CHANNEL_ENV, QString::number(EngineProgress::CHANNEL_FD));
+    }
+    process_->setProcessEnvironment(env);
+
     // NOTE: start() function without args not parse correctly filepath with spaces, Qt bug?
     process_->start(fullPath, argList, QProcess::Unbuffered | QProcess::ReadOnly);
     processPid_ = process_->processId();
 
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+    // the engine owns the write end now, its exit closes the channel
+    auto engineProcess = static_cast<EngineProcess*>(process_);
+    if (engineProcess->progressFd >= 0)
+    {
+        ::close(engineProcess->progressFd);
+        engineProcess->progressFd = -1;
+    }
+#endif
+
     return true;
 }
 
+void Process::setProgressChannel(bool enabled)
+{
+    progressChannel_ = enabled;
+}
+
+QByteArray Process::readAllProgress()
+{
+    QByteArray data;
+    data.swap(progressData_);
+    return data;
+}
+
+bool Process::openProgressChannel()
+{
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+    int fds[2];
+    if (::pipe(fds) != 0)
+    {
+        qWarning() << "Error: Cannot open the progress channel" << qt_error_string(errno);
+        return false;
+    }
+
+    // neither end leaks into other children, the read end never blocks
+    ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    ::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+
+    progressFd_ = fds[0];
+    static_cast<EngineProcess*>(process_)->progressFd = fds[1];
+
+    progressNotifier_ = new QSocketNotifier(progressFd_, QSocketNotifier::Read, this);
+    connect(progressNotifier_, &QSocketNotifier::activated,
+            this, &Process::readProgressChannel);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Process::closeProgressChannel()
+{
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+    if (progressNotifier_)
+    {
+        progressNotifier_->setEnabled(false);
+        progressNotifier_->deleteLater();
+        progressNotifier_ = nullptr;
+    }
+    if (progressFd_ >= 0)
+    {
+        ::close(progressFd_);
+        progressFd_ = -1;
+    }
+
+    auto engineProcess = static_cast<EngineProcess*>(process_);
+    if (engineProcess->progressFd >= 0)
+    {
+        ::close(engineProcess->progressFd);
+        engineProcess->progressFd = -1;
+    }
+#endif
+}
+
+void Process::readProgressChannel()
+{
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+    if (progressFd_ < 0)
+    {
+        return;
+    }
+
+    const auto previousSize = progressData_.size();
+    char buffer[4096];
+    forever
+    {
+        const auto count = ::read(progressFd_, buffer, sizeof(buffer));
+        if (count > 0)
+        {
+            progressData_.append(buffer, static_cast<int>(count));
+        }
+        else if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            // end of the channel, or nothing more to read now
+            if (count == 0)
+            {
+                closeProgressChannel();
+            }
+            break;
+        }
+    }
+
+    if (progressData_.size() > previousSize)
+    {
+        emit readyReadProgress();
+    }
+#endif
+}
+
 // add file to an archive fileName
 // using an external helper (7z)
 // NOTE: never used
@@ -225,35 +403,26 @@ void Process::processPause(Defs::CurrRunStatus mode)
     DEBUG_FUNC_NAME
     Q_UNUSED(mode)
 
-    // file path of the utility to pause the engine
-    QString fp;
-
-    // arguments
-    QStringList args;
+    pauseClock_.start();
 
 #if defined(Q_OS_WIN)
     // On Windows we pause using a third-party utility, namely 'pausep.exe'.
     // Pausing the engine requires two runs of it,
     // one for detecting the pid with no args and one for tha actual pausing.
 
-    fp = qApp->applicationDirPath() + QLatin1Char('/') + Defs::BIN_FILE_DIR + QLatin1Char('/') + Defs::FREEZER_BIN;
+    QString fp = qApp->applicationDirPath() + QLatin1Char('/') + Defs::BIN_FILE_DIR + QLatin1Char('/') + Defs::FREEZER_BIN;
     connect(freezerUtility_, &QProcess::readyReadStandardOutput,
              this, &Process::bufferFreezerOutput);
 
-#elif defined(Q_OS_MAC) || defined(Q_OS_LINUX)
-    // on mac anc linux we use the standard kill
-    // calling, 'kill -STOP processPid_'
+    qDebug() << "fp" << fp;
 
-    fp = QStringLiteral("kill");
+    freezerUtility_->setWorkingDirectory(qApp->applicationDirPath() + QLatin1Char('/') + Defs::BIN_FILE_DIR);
+    freezerUtility_->start(fp, QStringList());
 
-    args << QStringLiteral("-STOP");
-    args << QString::number(processPid_);
+#elif defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+    // on mac and linux we stop the process group of the engine directly
+    signalProcessGroup(SIGSTOP);
 #endif
-
-    qDebug() << "fp" << fp << "args" << args;
-
-    freezerUtility_->setWorkingDirectory(qApp->applicationDirPath() + QLatin1Char('/') + Defs::BIN_FILE_DIR);
-    freezerUtility_->start(fp, args);
 }
 
 void Process::processResume(Defs::CurrRunStatus mode)
@@ -261,49 +430,209 @@ void Process::processResume(Defs::CurrRunStatus mode)
     DEBUG_FUNC_NAME
     Q_UNUSED(mode)
 
-    // file path of the utility to resume the engine
-    QString fp;
-
-    // arguments
-    QStringList args;
+    pauseTimer_->stop();
 
 #if defined(Q_OS_WIN)
     // file path of the utility to resume the engine
-    fp = qApp->applicationDirPath() + QLatin1Char('/') + Defs::BIN_FILE_DIR + QLatin1Char('/') + Defs::FREEZER_BIN;
+    QString fp = qApp->applicationDirPath() + QLatin1Char('/') + Defs::BIN_FILE_DIR + QLatin1Char('/') + Defs::FREEZER_BIN;
 
+    QStringList args;
     args << winPid_;
     args << QStringLiteral("/r");
 
+    qDebug() << "fp" << fp << "args" << args;
+
+    freezerUtility_->setWorkingDirectory(qApp->applicationDirPath() + QLatin1Char('/') + Defs::BIN_FILE_DIR);
+    freezerUtility_->start(fp, args);
+
 #elif defined(Q_OS_MAC) || defined(Q_OS_LINUX)
-    // on mac anc linux we use the standard kill
-    // calling, 'kill -CONT processPid_'
+    signalProcessGroup(SIGCONT);
+#endif
+}
 
-    fp = QStringLiteral("kill");
+qint64 Process::pauseLatency() const
+{
+    if (!pauseClock_.isValid())
+    {
+        return -1;
+    }
 
-    args << QStringLiteral("-CONT");
-    args << QString::number(processPid_);
+#if defined(Q_OS_LINUX)
+    // the state field follows the command name in parentheses
+    QFile file(QStringLiteral("/proc/") + QString::number(processPid_) + QStringLiteral("/stat"));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return -1;
+    }
+    const auto stat = file.readAll();
+    const auto stateIndex = stat.lastIndexOf(')') + 2;
+    if (stateIndex > 1 && stateIndex < stat.size()
+        && (stat.at(stateIndex) == 'T' || stat.at(stateIndex) == 't'))
+    {
+        return pauseClock_.nsecsElapsed() / 1000;
+    }
+    return -1;
+#elif defined(Q_OS_MAC)
+    // the signal is delivered on return from kill(), nothing to poll
+    return pauseClock_.nsecsElapsed() / 1000;
+#else
+    // the freezer utility pauses the engine asynchronously
+    return -1;
 #endif
+}
 
-    qDebug() << "fp" << fp << "args" << args;
+bool Process::canConfirmPause()
+{
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+    return true;
+#else
+    return false;
+#endif
+}
 
-    freezerUtility_->setWorkingDirectory(qApp->applicationDirPath() + QLatin1Char('/') + Defs::BIN_FILE_DIR);
-    freezerUtility_->start(fp, args);
+void Process::confirmPause(int msecs)
+{
+    pauseTimeoutMSec_ = msecs;
+    pauseTimer_->start();
+    pollPause();
+}
+
+void Process::pollPause()
+{
+    const auto latency = pauseLatency();
+    if (latency < 0 && canConfirmPause() && isRunning()
+        && pauseClock_.isValid() && pauseClock_.elapsed() < pauseTimeoutMSec_)
+    {
+        return;
+    }
+
+    pauseTimer_->stop();
+    emit processPaused(latency);
+}
+
+// signal the engine and the processes it started, or the engine alone if
+// it has no process group of its own
+bool Process::signalProcessGroup(int signal)
+{
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+    if (processPid_ <= 0)
+    {
+        return false;
+    }
+
+    const auto pid = static_cast<pid_t>(processPid_);
+    if (::kill(-pid, signal) == 0 || ::kill(pid, signal) == 0)
+    {
+        return true;
+    }
+
+    qWarning() << "Error: Cannot signal process" << processPid_ << qt_error_string(errno);
+    return false;
+#else
+    Q_UNUSED(signal)
+    return false;
+#endif
 }
 
 void Process::processStop()
 {
     DEBUG_FUNC_NAME
 
+    pauseTimer_->stop();
+
     // to avoid crash message error in windows
     disconnect(process_, SIGNAL(finished(int, QProcess::ExitStatus)),
              this, SLOT(processFinished(int, QProcess::ExitStatus)));
     disconnect(process_, SIGNAL(error(QProcess::ProcessError)),
              this, SLOT(processError(QProcess::ProcessError)));
 
+#if defined(Q_OS_MAC) || defined(Q_OS_LINUX)
+    // the processes started by the engine share its group, kill them all
+    // before QProcess reaps the engine
+    if (process_->state() != QProcess::NotRunning)
+    {
+        signalProcessGroup(SIGKILL);
+    }
+#endif
     process_->kill();
     processExit_ = ExitStatus::Stopped;
 }
 
+#if defined(Q_OS_LINUX)
+namespace
+{
+// value in kB of the "key: value kB" line of a /proc file, -1 if missing
+qint64 procValue(const QByteArray& content, const QByteArray& key)
+{
+    const auto start = content.indexOf(key);
+    if (start < 0)
+    {
+        return -1;
+    }
+    const auto end = content.indexOf('\n', start);
+    const auto fields = content.mid(start + key.size(), end - start - key.size())
+                               .simplified().split(' ');
+
+    bool ok = false;
+    const auto value = fields.value(0).toLongLong(&ok);
+    return ok ? value : -1;
+}
+
+QByteArray readProcFile(const QString& fileName)
+{
+    // /proc files have no size, read them to the end
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+} // namespace
+#endif
+
+bool Process::resourceUsage(qint64* rssBytes, qint64* ioBytes) const
+{
+#if defined(Q_OS_LINUX)
+    if (!isRunning() || processPid_ <= 0)
+    {
+        return false;
+    }
+
+    const auto procDir = QStringLiteral("/proc/") + QString::number(processPid_);
+
+    const auto rssKb = procValue(readProcFile(procDir + QStringLiteral("/status")),
+                                 "VmRSS:");
+    if (rssKb < 0)
+    {
+        return false;
+    }
+    *rssBytes = rssKb * 1024;
+
+    // bytes actually fetched from and sent to the storage layer
+    const auto io = readProcFile(procDir + QStringLiteral("/io"));
+    const auto readBytes = procValue(io, "read_bytes:");
+    const auto writeBytes = procValue(io, "write_bytes:");
+    *ioBytes = (readBytes < 0 || writeBytes < 0) ? -1 : readBytes + writeBytes;
+    return true;
+#else
+    Q_UNUSED(rssBytes)
+    Q_UNUSED(ioBytes)
+    return false;
+#endif
+}
+
+qint64 Process::availableMemory()
+{
+#if defined(Q_OS_LINUX)
+    const auto availableKb = procValue(readProcFile(QStringLiteral("/proc/meminfo")),
+                                       "MemAvailable:");
+    return (availableKb < 0) ? -1 : availableKb * 1024;
+#else
+    return -1;
+#endif
+}
+
 void Process::processError(QProcess::ProcessError error)
 {
     DEBUG_FUNC_NAME
@@ -325,6 +654,9 @@ void Process::processError(QProcess::ProcessError error)
 void Process::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     DEBUG_FUNC_NAME
+    // the last events before the end of the run
+    readProgressChannel();
+
     // to avoid multiple call
     disconnect(process_, SIGNAL(finished(int, QProcess::ExitStatus)),
              this, SLOT(processFinished(int, QProcess::ExitStatus)));
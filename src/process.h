@@ -26,6 +26,7 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
+#include <QElapsedTimer>
 #include <QProcess>
 
 #include "defs.h"
@@ -45,6 +46,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 class QByteArray;
+class QSocketNotifier;
+class QTimer;
 
 /// \class Process
 /// \brief Class representing external processes
@@ -93,12 +96,34 @@ public:
 
     void setEnv(const QStringList &envList);
 
+    // open a structured progress channel to each engine started from now
+    // on (mac and linux only), see EngineProgress
+    void setProgressChannel(bool enabled);
+    QByteArray readAllProgress();
+
     void processPause(Defs::CurrRunStatus mode);
     void processResume(Defs::CurrRunStatus mode);
+
+    // without blocking, the time since the processPause() request in
+    // microseconds if the system stopped the process, -1 if it did not yet
+    // or if unknown
+    qint64 pauseLatency() const;
+    // whether pauseLatency() can confirm a pause on this system
+    static bool canConfirmPause();
+    // poll pauseLatency() for up to msecs after processPause(), then emit
+    // processPaused() with it, -1 if not confirmed
+    void confirmPause(int msecs = 1000);
     void processStop();
     inline ExitStatus processExit() const { return processExit_; }
     bool isRunning() const { return (process_->state() == QProcess::Running); }
 
+    // resident memory and bytes read and written on disk so far by the
+    // running process. false where /proc is not available
+    bool resourceUsage(qint64* rssBytes, qint64* ioBytes) const;
+
+    // memory available to new processes without swapping, -1 if unknown
+    static qint64 availableMemory();
+
 #if 0
     static unsigned int getProcessIdsByProcessName(const QString &processName, QStringList &listOfPids);
 #endif
@@ -108,6 +133,8 @@ private slots:
     void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void processPause_2();
     void bufferFreezerOutput();
+    void readProgressChannel();
+    void pollPause();
 
 private:
     QProcess* process_;
@@ -117,14 +144,26 @@ private:
     QString winPid_;
     QProcess* freezerUtility_;
     QByteArray rxBuffer_;
+    QElapsedTimer pauseClock_;
+    QTimer* pauseTimer_;
+    int pauseTimeoutMSec_;
+    bool progressChannel_;
+    int progressFd_;
+    QSocketNotifier* progressNotifier_;
+    QByteArray progressData_;
 
     void parseFreezerPid(const QByteArray& data);
+    bool signalProcessGroup(int signal);
+    bool openProgressChannel();
+    void closeProgressChannel();
 
 signals:
     void readyReadStdOut();
     void readyReadStdErr();
+    void readyReadProgress();
     void processSuccess();
     void processFailure();
+    void processPaused(qint64 latency);
 };
 
 #endif // PROCESS_H
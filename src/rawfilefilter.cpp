@@ -0,0 +1,122 @@
+/***************************************************************************
+  rawfilefilter.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "rawfilefilter.h"
+
+#include <QDebug>
+#include <QPair>
+#include <QRegularExpression>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrentMap>
+
+namespace
+{
+// below this size the thread pool overhead is not worth it
+const int MIN_CHUNK_SIZE = 8192;
+
+// map functor for QtConcurrent, the result_type typedef is required
+struct ChunkFilter
+{
+    typedef QStringList result_type;
+
+    const QStringList* fileList;
+    QRegularExpression re;
+
+    QStringList operator()(const QPair<int, int>& chunk) const
+    {
+        QStringList matches;
+        for (auto i = chunk.first; i < chunk.second; ++i)
+        {
+            const auto& filename = fileList->at(i);
+
+            // search from the base name start, without extracting it
+            const auto nameStart = filename.lastIndexOf(QLatin1Char('/')) + 1;
+            if (re.match(filename, nameStart).hasMatch())
+            {
+                matches.append(filename);
+            }
+        }
+        return matches;
+    }
+};
+
+void appendMatches(QStringList& result, const QStringList& matches)
+{
+    result.append(matches);
+}
+} // namespace
+
+QString RawFileFilter::prototypeToRegExp(const QString& prototype)
+{
+    auto pattern = prototype;
+
+    pattern.replace(QLatin1String("."), QLatin1String("[.]"));  // dot
+    pattern.replace(QLatin1String("?"), QLatin1String("."));    // single char
+    pattern.replace(QLatin1String("yyyy"), QLatin1String("(19[89][0-9]|20[0-9][0-9]|2100)")); // year 4 digits
+    pattern.replace(QLatin1String("yy"), QLatin1String("([0-9][0-9])"));         // year 2 digits
+    pattern.replace(QLatin1String("mm"), QLatin1String("(0[1-9]|1[012])"));    // month 2 digits
+    pattern.replace(QLatin1String("ddd"), QLatin1String("(00[1-9]|0[1-9][0-9]|[12][0-9][0-9]|3[0-5][0-9]|36[0-6])"));      // day of year 3 digits
+    pattern.replace(QLatin1String("dd"), QLatin1String("(0[1-9]|[1-2][0-9]|3[01])")); // day 2 digits
+    pattern.replace(QLatin1String("HH"), QLatin1String("([01][0-9]|2[0-4])")); // hours 2 digits
+    pattern.replace(QLatin1String("MM"), QLatin1String("([0-5][0-9])"));       // minutes 2 digits
+
+    return pattern;
+}
+
+QStringList RawFileFilter::filterWithPrototype(const QStringList& fileList,
+                                               const QString& prototype)
+{
+    // the groups are only for alternation, no capture needed
+    QRegularExpression re(prototypeToRegExp(prototype),
+                          QRegularExpression::DontCaptureOption);
+    if (!re.isValid())
+    {
+        qDebug() << "invalid prototype pattern" << re.pattern() << re.errorString();
+        return fileList;
+    }
+    re.optimize();
+
+    ChunkFilter chunkFilter;
+    chunkFilter.fileList = &fileList;
+    chunkFilter.re = re;
+
+    const auto size = fileList.size();
+    const auto threads = qMax(1, QThread::idealThreadCount());
+    const auto chunkSize = qMax(MIN_CHUNK_SIZE, (size + threads - 1) / threads);
+    if (size <= chunkSize)
+    {
+        return chunkFilter(qMakePair(0, size));
+    }
+
+    QVector<QPair<int, int>> chunks;
+    for (auto begin = 0; begin < size; begin += chunkSize)
+    {
+        chunks.append(qMakePair(begin, qMin(begin + chunkSize, size)));
+    }
+
+    // ordered reduce, the result keeps the order of fileList
+    return QtConcurrent::blockingMappedReduced<QStringList>(chunks,
+                                                            chunkFilter,
+                                                            appendMatches,
+                                                            QtConcurrent::OrderedReduce);
+}
@@ -0,0 +1,59 @@
+/***************************************************************************
+  rawfilefilter.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef RAWFILEFILTER_H
+#define RAWFILEFILTER_H
+
+#include <QString>
+#include <QStringList>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/rawfilefilter.h
+/// \brief Raw file list filtering by file name prototype
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note The prototype is translated and compiled to a regular expression
+/// once, then only the base name of each file is matched. The list is split
+/// in chunks matched in parallel and the result keeps the input order.
+/// \sa BasicSettingsPage::filterRawDataWithPrototype
+/// \bug
+/// \deprecated
+/// \test tests/unit_tests/tst_rawfilefilter.cpp
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \namespace RawFileFilter
+/// \brief Linear time filter of raw file lists
+namespace RawFileFilter
+{
+    // transform the prototype to a regular expression pattern
+    QString prototypeToRegExp(const QString& prototype);
+
+    // files whose base name contains a match of the prototype.
+    // an invalid pattern returns the list unfiltered
+    QStringList filterWithPrototype(const QStringList& fileList,
+                                    const QString& prototype);
+
+} // RawFileFilter
+
+#endif // RAWFILEFILTER_H
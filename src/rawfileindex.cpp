@@ -0,0 +1,625 @@
+/***************************************************************************
+  rawfileindex.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "rawfileindex.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QSharedPointer>
+#include <QtConcurrentRun>
+
+#include "dbghelper.h"
+#include "defs.h"
+#include "dirscanner.h"
+#include "filenameprototype.h"
+
+namespace
+{
+const quint32 INDEX_MAGIC = 0x45504958; // "EPIX"
+// 2: timestamps stored as FilenamePrototype keys
+const quint16 INDEX_VERSION = 2;
+
+// a directory modified less than this before being listed is listed again
+// at the next refresh, to not miss files created within the same mtime tick
+const qint64 MTIME_GUARD_MSEC = 2000;
+
+struct FileRecord
+{
+    QString name;
+    qint64 size = 0;
+    qint64 modified = 0;
+    qint64 timestamp = -1; // FilenamePrototype key
+    QString ghgSuffix;
+};
+
+struct DirRecord
+{
+    qint64 modified = -1;
+    QStringList subdirs;
+    QVector<FileRecord> files;
+};
+
+// index of a single raw data directory tree,
+// dirs are keyed by their path relative to the root
+struct DirIndex
+{
+    QString root;
+    QString prototype;
+    QHash<QString, DirRecord> dirs;
+    bool dirty = false;
+};
+
+QDataStream& operator<<(QDataStream& out, const FileRecord& f)
+{
+    out << f.name << f.size << f.modified << f.timestamp << f.ghgSuffix;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, FileRecord& f)
+{
+    in >> f.name >> f.size >> f.modified >> f.timestamp >> f.ghgSuffix;
+    return in;
+}
+
+QDataStream& operator<<(QDataStream& out, const DirRecord& d)
+{
+    out << d.modified << d.subdirs << d.files;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, DirRecord& d)
+{
+    in >> d.modified >> d.subdirs >> d.files;
+    return in;
+}
+
+// in-memory index of a root, refreshed by one query at a time
+struct IndexSlot
+{
+    QMutex mutex;
+    bool loaded = false;
+    DirIndex index;
+};
+
+// protects indexCache, keyed by index file path, and the index files.
+// held only to look up a slot and to save or remove an index file, the
+// roots are refreshed in parallel
+QMutex indexMutex;
+QHash<QString, QSharedPointer<IndexSlot>> indexCache;
+
+QString rootPath(const QString& dir)
+{
+    auto root = QDir(dir).canonicalPath();
+    if (root.isEmpty())
+    {
+        root = QDir::cleanPath(dir);
+    }
+    return root;
+}
+
+QString indexFilePath(const QString& appEnvPath, const QString& root)
+{
+    if (appEnvPath.isEmpty())
+    {
+        return QString();
+    }
+
+    auto hash = QCryptographicHash::hash(root.toUtf8(), QCryptographicHash::Md5);
+    return appEnvPath
+           + QLatin1Char('/')
+           + Defs::IDX_FILE_DIR
+           + QLatin1Char('/')
+           + QString::fromLatin1(hash.toHex())
+           + QStringLiteral(".idx");
+}
+
+QString joinPath(const QString& parent, const QString& child)
+{
+    if (parent.isEmpty())
+    {
+        return child;
+    }
+    return parent + QLatin1Char('/') + child;
+}
+
+QString absolutePath(const DirIndex& index, const QString& rel)
+{
+    return joinPath(index.root, rel);
+}
+
+bool loadIndex(const QString& fileName, DirIndex* index)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_2);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != INDEX_MAGIC || version != INDEX_VERSION)
+    {
+        qDebug() << "Discarding index" << fileName;
+        return false;
+    }
+
+    in >> index->root >> index->prototype >> index->dirs;
+
+    return (in.status() == QDataStream::Ok);
+}
+
+bool saveIndex(const QString& fileName, const DirIndex& index)
+{
+    if (fileName.isEmpty())
+    {
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Error: Cannot write index" << fileName << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_2);
+    out << INDEX_MAGIC << INDEX_VERSION;
+    out << index.root << index.prototype << index.dirs;
+
+    return file.commit();
+}
+
+void parseTimestamps(DirRecord* record, const FilenamePrototype& prototype)
+{
+    const auto emptyPrototype = prototype.prototype().isEmpty();
+    for (auto& f : record->files)
+    {
+        if (emptyPrototype)
+        {
+            f.timestamp = -1;
+        }
+        else
+        {
+            f.timestamp = prototype.timestampKey(f.name);
+        }
+    }
+}
+
+void setPrototype(DirIndex* index, const QString& prototype)
+{
+    if (index->prototype == prototype)
+    {
+        return;
+    }
+
+    index->prototype = prototype;
+
+    const FilenamePrototype compiled(prototype);
+    for (auto& record : index->dirs)
+    {
+        parseTimestamps(&record, compiled);
+    }
+    index->dirty = true;
+}
+
+DirRecord makeDirRecord(const DirScanner::Listing& listing, const FilenamePrototype& prototype)
+{
+    DirRecord record;
+    record.subdirs = listing.subdirs;
+    record.files.reserve(listing.files.size());
+
+    const QString ghgExt = QLatin1Char('.') + Defs::GHG_NATIVE_DATA_FILE_EXT;
+    for (const auto& file : listing.files)
+    {
+        FileRecord f;
+        f.name = file.name;
+        f.size = file.size;
+        f.modified = file.modified;
+        if (f.name.endsWith(ghgExt, Qt::CaseInsensitive))
+        {
+            f.ghgSuffix = FileUtils::getGhgSuffixFromFilename(f.name);
+        }
+        record.files.append(f);
+    }
+
+    parseTimestamps(&record, prototype);
+
+    return record;
+}
+
+// remove rel and all its descendants
+void removeDirRecords(DirIndex* index, const QString& rel)
+{
+    if (rel.isEmpty())
+    {
+        index->dirs.clear();
+        index->dirty = true;
+        return;
+    }
+
+    const QString prefix = rel + QLatin1Char('/');
+    auto it = index->dirs.begin();
+    while (it != index->dirs.end())
+    {
+        if (it.key() == rel || it.key().startsWith(prefix))
+        {
+            it = index->dirs.erase(it);
+            index->dirty = true;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+// same filtering of FileUtils::getDirContent()
+bool matchesExtension(const QString& name, const QString& extension)
+{
+    if (!QDir::match(extension, name))
+    {
+        return false;
+    }
+
+    const auto dot = name.indexOf(QLatin1Char('.'));
+    if (dot < 0)
+    {
+        return false;
+    }
+
+    return name.midRef(dot + 1).contains(extension.mid(2), Qt::CaseInsensitive);
+}
+
+// list again, in parallel, the dirs whose modification time changed and
+// pass the matching files of each visited dir to the callback.
+// return false if the callback cancelled the refresh
+bool refreshTree(DirIndex* index,
+                 const QString& extension,
+                 bool recurse,
+                 const RawFileIndex::BatchCallback& callback)
+{
+    if (!QFileInfo(index->root).isDir())
+    {
+        removeDirRecords(index, QString());
+        return true;
+    }
+
+    const FilenamePrototype prototype(index->prototype);
+    const auto rootSize = index->root.size();
+
+    // guards the records and the callback
+    QMutex recordsMutex;
+    DirScanner scanner;
+
+    scanner.visit(index->root, [&](const QString& absPath) -> QStringList
+    {
+        const auto rel = (absPath.size() > rootSize) ? absPath.mid(rootSize + 1)
+                                                     : QString();
+        const QFileInfo info(absPath);
+        if (!info.isDir())
+        {
+            QMutexLocker locker(&recordsMutex);
+            removeDirRecords(index, rel);
+            return QStringList();
+        }
+
+        const auto modified = info.lastModified().toMSecsSinceEpoch();
+
+        DirRecord record;
+        auto upToDate = false;
+        {
+            QMutexLocker locker(&recordsMutex);
+            const auto it = index->dirs.constFind(rel);
+            if (it != index->dirs.constEnd() && it.value().modified == modified)
+            {
+                record = it.value();
+                upToDate = true;
+            }
+        }
+
+        if (!upToDate)
+        {
+            DirScanner::Listing listing;
+            if (!DirScanner::listDir(absPath, true, &listing))
+            {
+                QMutexLocker locker(&recordsMutex);
+                removeDirRecords(index, rel);
+                return QStringList();
+            }
+
+            record = makeDirRecord(listing, prototype);
+            if (QDateTime::currentMSecsSinceEpoch() - modified > MTIME_GUARD_MSEC)
+            {
+                record.modified = modified;
+            }
+
+            QMutexLocker locker(&recordsMutex);
+
+            // forget the subdirs that disappeared
+            const auto it = index->dirs.constFind(rel);
+            if (it != index->dirs.constEnd())
+            {
+                const auto previousSubdirs = it.value().subdirs;
+                for (const auto& sub : previousSubdirs)
+                {
+                    if (!record.subdirs.contains(sub))
+                    {
+                        removeDirRecords(index, joinPath(rel, sub));
+                    }
+                }
+            }
+
+            index->dirs.insert(rel, record);
+            index->dirty = true;
+        }
+
+        // called for every dir, so that the refresh can be cancelled
+        // even when no files are found
+        if (callback)
+        {
+            QStringList batch;
+            for (const auto& f : record.files)
+            {
+                if (matchesExtension(f.name, extension))
+                {
+                    batch.append(absPath + QLatin1Char('/') + f.name);
+                }
+            }
+
+            QMutexLocker locker(&recordsMutex);
+            if (!scanner.isCancelled() && !callback(batch))
+            {
+                scanner.cancel();
+            }
+        }
+
+        return recurse ? record.subdirs : QStringList();
+    });
+
+    return !scanner.isCancelled();
+}
+
+// the indexed files of rel, then of its subdirs if required, in the order
+// of a depth-first walk by name
+void collectEntries(const DirIndex& index,
+                    const QString& rel,
+                    const QString& extension,
+                    bool recurse,
+                    QVector<RawFileIndex::Entry>* entries)
+{
+    const auto it = index.dirs.constFind(rel);
+    if (it == index.dirs.constEnd())
+    {
+        return;
+    }
+
+    const auto& record = it.value();
+    const auto absPath = absolutePath(index, rel);
+
+    for (const auto& f : record.files)
+    {
+        if (!matchesExtension(f.name, extension))
+        {
+            continue;
+        }
+
+        RawFileIndex::Entry entry;
+        entry.path = absPath + QLatin1Char('/') + f.name;
+        entry.size = f.size;
+        entry.modified = QDateTime::fromMSecsSinceEpoch(f.modified);
+        entry.timestamp = FilenamePrototype::keyToDateTime(f.timestamp);
+        entry.ghgSuffix = f.ghgSuffix;
+        entries->append(entry);
+    }
+
+    if (recurse)
+    {
+        for (const auto& sub : record.subdirs)
+        {
+            collectEntries(index, joinPath(rel, sub), extension, recurse, entries);
+        }
+    }
+}
+
+} // namespace
+
+QVector<RawFileIndex::Entry> RawFileIndex::queryEntries(const QString& appEnvPath,
+                                                        const QString& dir,
+                                                        const QString& extension,
+                                                        bool recurse,
+                                                        const QString& filenamePrototype,
+                                                        const BatchCallback& callback)
+{
+    QVector<Entry> entries;
+
+    if (dir.isEmpty() || extension.isEmpty())
+    {
+        return entries;
+    }
+
+    const auto root = rootPath(dir);
+    const auto fileName = indexFilePath(appEnvPath, root);
+    const auto key = fileName.isEmpty() ? root : fileName;
+
+    QSharedPointer<IndexSlot> slot;
+    {
+        QMutexLocker locker(&indexMutex);
+        slot = indexCache.value(key);
+        if (!slot)
+        {
+            slot = QSharedPointer<IndexSlot>::create();
+            indexCache.insert(key, slot);
+        }
+    }
+
+    QMutexLocker slotLocker(&slot->mutex);
+
+    auto& index = slot->index;
+    if (!slot->loaded)
+    {
+        if (!loadIndex(fileName, &index) || index.root != root)
+        {
+            index = DirIndex();
+            index.root = root;
+        }
+        slot->loaded = true;
+    }
+
+    if (!filenamePrototype.isEmpty())
+    {
+        setPrototype(&index, filenamePrototype);
+    }
+
+    const auto completed = refreshTree(&index, extension, recurse, callback);
+    if (completed)
+    {
+        collectEntries(index, QString(), extension, recurse, &entries);
+    }
+
+    // what was refreshed so far is valid even if the visit was cancelled,
+    // unless the index was invalidated in the meantime
+    if (index.dirty)
+    {
+        QMutexLocker locker(&indexMutex);
+        if (indexCache.value(key) == slot)
+        {
+            saveIndex(fileName, index);
+        }
+        index.dirty = false;
+    }
+
+    qDebug() << "indexed files" << root << entries.size() << "completed" << completed;
+
+    return entries;
+}
+
+QVector<RawFileIndex::Entry> RawFileIndex::getEntries(const QString& appEnvPath,
+                                                      const QString& dir,
+                                                      const QString& extension,
+                                                      bool recurse,
+                                                      const QString& filenamePrototype)
+{
+    DEBUG_FUNC_NAME
+
+    qDebug() << "params:" << dir << extension << recurse << filenamePrototype;
+
+    // as in FileUtils::getFiles(), keep the refresh off the GUI thread
+    auto future = QtConcurrent::run([=]() {
+        return queryEntries(appEnvPath, dir, extension, recurse, filenamePrototype);
+    });
+
+    return FileUtils::waitForFuture(future);
+}
+
+QStringList RawFileIndex::getFiles(const QString& appEnvPath,
+                                   const QString& dir,
+                                   const QString& extension,
+                                   bool recurse)
+{
+    const auto entries = getEntries(appEnvPath, dir, extension, recurse);
+
+    QStringList fileList;
+    fileList.reserve(entries.size());
+    for (const auto& entry : entries)
+    {
+        fileList.append(entry.path);
+    }
+
+    return fileList;
+}
+
+FileUtils::DateRange RawFileIndex::getDateRange(const QString& appEnvPath,
+                                                const QString& dir,
+                                                const QString& extension,
+                                                bool recurse,
+                                                const QString& filenamePrototype)
+{
+    return getDataAvailability(appEnvPath, dir, extension, recurse, filenamePrototype).range;
+}
+
+FileUtils::DataAvailability RawFileIndex::getDataAvailability(const QString& appEnvPath,
+                                                              const QString& dir,
+                                                              const QString& extension,
+                                                              bool recurse,
+                                                              const QString& filenamePrototype)
+{
+    const auto entries = getEntries(appEnvPath, dir, extension, recurse, filenamePrototype);
+
+    QVector<qint64> keyList;
+    keyList.reserve(entries.size());
+    for (const auto& entry : entries)
+    {
+        keyList.append(FilenamePrototype::dateTimeToKey(entry.timestamp));
+    }
+
+    return FileUtils::getDataAvailabilityFromKeys(keyList);
+}
+
+QStringList RawFileIndex::getGhgSuffixList(const QString& appEnvPath,
+                                           const QString& dir,
+                                           bool recurse)
+{
+    const QString ghgFormat = QStringLiteral("*.") + Defs::GHG_NATIVE_DATA_FILE_EXT;
+    const auto entries = getEntries(appEnvPath, dir, ghgFormat, recurse);
+
+    QStringList suffixList;
+    for (const auto& entry : entries)
+    {
+        if (!entry.ghgSuffix.isEmpty())
+        {
+            suffixList.append(entry.ghgSuffix);
+        }
+    }
+
+    suffixList.removeDuplicates();
+    return suffixList;
+}
+
+// a query still refreshing dir completes on the dropped index, without
+// saving it
+void RawFileIndex::invalidate(const QString& appEnvPath, const QString& dir)
+{
+    QMutexLocker locker(&indexMutex);
+
+    const auto root = rootPath(dir);
+    const auto fileName = indexFilePath(appEnvPath, root);
+
+    indexCache.remove(fileName.isEmpty() ? root : fileName);
+    if (!fileName.isEmpty())
+    {
+        QFile::remove(fileName);
+    }
+}
@@ -0,0 +1,118 @@
+/***************************************************************************
+  rawfileindex.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef RAWFILEINDEX_H
+#define RAWFILEINDEX_H
+
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+#include "fileutils.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/rawfileindex.h
+/// \brief Persistent index of the raw data directories
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note The index of each data directory is stored in the 'idx'
+/// subdirectory of the application environment and it is refreshed
+/// incrementally: a directory is listed again only when its modification
+/// time changed since the last visit, otherwise its cached content is used.
+/// The directories are visited in parallel by DirScanner, and the queries
+/// of different data directories run in parallel.
+/// Files modified in place (same name, unchanged directory) are not
+/// detected until the data directory is selected again.
+/// \sa FileUtils::getFiles, DirScanner
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \namespace RawFileIndex
+/// \brief Cached replacement of the FileUtils::getFiles directory walks
+namespace RawFileIndex
+{
+    struct Entry
+    {
+        QString path;
+        qint64 size;
+        QDateTime modified;
+        QDateTime timestamp;
+        QString ghgSuffix;
+    };
+
+    // called with the matching files of each visited dir, one dir at a
+    // time in no particular order. return false to cancel the visit
+    using BatchCallback = std::function<bool (const QStringList& files)>;
+
+    // blocking query, callable from any thread. empty if cancelled
+    QVector<Entry> queryEntries(const QString& appEnvPath,
+                                const QString& dir,
+                                const QString& extension,
+                                bool recurse,
+                                const QString& filenamePrototype = QString(),
+                                const BatchCallback& callback = BatchCallback());
+
+    // extension = "*.ext", same convention of FileUtils::getFiles()
+    QStringList getFiles(const QString& appEnvPath,
+                         const QString& dir,
+                         const QString& extension,
+                         bool recurse = false);
+
+    // timestamps are parsed only if filenamePrototype is not empty
+    QVector<Entry> getEntries(const QString& appEnvPath,
+                              const QString& dir,
+                              const QString& extension,
+                              bool recurse,
+                              const QString& filenamePrototype = QString());
+
+    FileUtils::DateRange getDateRange(const QString& appEnvPath,
+                                      const QString& dir,
+                                      const QString& extension,
+                                      bool recurse,
+                                      const QString& filenamePrototype);
+
+    // date range, per-day file counts and gaps of the indexed timestamps
+    FileUtils::DataAvailability getDataAvailability(const QString& appEnvPath,
+                                                    const QString& dir,
+                                                    const QString& extension,
+                                                    bool recurse,
+                                                    const QString& filenamePrototype);
+
+    QStringList getGhgSuffixList(const QString& appEnvPath,
+                                 const QString& dir,
+                                 bool recurse);
+
+    // drop both the in-memory and the on-disk index of dir, so that the
+    // next query lists it again in full. does not wait for the queries
+    // in progress
+    void invalidate(const QString& appEnvPath, const QString& dir);
+
+} // RawFileIndex
+
+#endif // RAWFILEINDEX_H
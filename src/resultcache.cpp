@@ -0,0 +1,519 @@
+/***************************************************************************
+  resultcache.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "resultcache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#include "defs.h"
+
+namespace ResultCache
+{
+// last full output file produced with a results fingerprint
+struct Record
+{
+    QString outputFile;
+    qint64 size = -1;
+    qint64 modified = -1;
+    QByteArray header;
+    int avrgLen = 0;
+    QVector<Period> periods;
+};
+
+QDataStream& operator<<(QDataStream& out, const Period& p)
+{
+    out << p.end << p.inputDigest << p.rowOffset << p.rowLength;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, Period& p)
+{
+    in >> p.end >> p.inputDigest >> p.rowOffset >> p.rowLength;
+    return in;
+}
+
+QDataStream& operator<<(QDataStream& out, const Record& r)
+{
+    out << r.outputFile << r.size << r.modified
+        << r.header << r.avrgLen << r.periods;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, Record& r)
+{
+    in >> r.outputFile >> r.size >> r.modified
+       >> r.header >> r.avrgLen >> r.periods;
+    return in;
+}
+} // ResultCache
+
+namespace
+{
+const quint32 CACHE_MAGIC = 0x45505244; // "EPRD"
+const quint16 CACHE_VERSION = 1;
+
+// full output columns of the averaging period end
+const int DATE_COLUMN = 1;
+const int TIME_COLUMN = 2;
+
+// records keyed by results fingerprint, loaded from the env of the last query
+QMutex cacheMutex;
+QHash<QString, ResultCache::Record> resultCache;
+QString cacheEnvPath;
+
+QString cacheFilePath(const QString& appEnvPath)
+{
+    return appEnvPath
+           + QLatin1Char('/')
+           + Defs::IDX_FILE_DIR
+           + QStringLiteral("/results.idx");
+}
+
+void loadCache(const QString& appEnvPath)
+{
+    resultCache.clear();
+    cacheEnvPath = appEnvPath;
+
+    if (appEnvPath.isEmpty())
+    {
+        return;
+    }
+
+    QFile file(cacheFilePath(appEnvPath));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_2);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION)
+    {
+        qDebug() << "Discarding result cache" << file.fileName();
+        return;
+    }
+
+    QHash<QString, ResultCache::Record> records;
+    in >> records;
+    if (in.status() == QDataStream::Ok)
+    {
+        resultCache = records;
+    }
+}
+
+bool saveCache(const QString& appEnvPath)
+{
+    const auto fileName = cacheFilePath(appEnvPath);
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Error: Cannot write result cache" << fileName << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_2);
+    out << CACHE_MAGIC << CACHE_VERSION;
+    out << resultCache;
+
+    return file.commit();
+}
+
+void useEnv(const QString& appEnvPath)
+{
+    if (appEnvPath != cacheEnvPath)
+    {
+        loadCache(appEnvPath);
+    }
+}
+
+bool isUnchanged(const ResultCache::Record& record)
+{
+    const QFileInfo info(record.outputFile);
+    return info.isFile()
+           && info.size() == record.size
+           && info.lastModified().toMSecsSinceEpoch() == record.modified;
+}
+
+struct FullOutput
+{
+    QByteArray data;
+    QByteArray header;
+    QByteArray eol;
+    QMap<QDateTime, QByteArray> rows;
+};
+
+bool readFullOutput(const QString& fileName, FullOutput* output, QString* errorString)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        *errorString = file.errorString();
+        return false;
+    }
+
+    output->data = file.readAll();
+    const auto& data = output->data;
+    output->eol = (data.indexOf("\r\n") >= 0) ? QByteArray("\r\n") : QByteArray("\n");
+
+    auto inHeader = true;
+    int from = 0;
+    while (from < data.size())
+    {
+        auto to = data.indexOf('\n', from);
+        if (to < 0)
+        {
+            to = data.size();
+        }
+
+        auto line = data.mid(from, to - from);
+        if (line.endsWith('\r'))
+        {
+            line.chop(1);
+        }
+
+        const auto end = ResultCache::rowPeriodEnd(line);
+        if (inHeader && !end.isValid())
+        {
+            output->header.append(data.mid(from, to + 1 - from));
+        }
+        else if (end.isValid())
+        {
+            inHeader = false;
+            output->rows.insert(end, line);
+        }
+        from = to + 1;
+    }
+    return true;
+}
+
+bool isInRerunSpan(const ResultCache::Plan& plan, const QDateTime& end)
+{
+    return plan.rerunTo.isValid() && end > plan.rerunFrom && end <= plan.rerunTo;
+}
+} // namespace
+
+QVector<ResultCache::Period> ResultCache::inputPeriods(const QVector<RawFileIndex::Entry>& files,
+                                                       int fileDuration,
+                                                       int avrgLen,
+                                                       bool timestampEnd)
+{
+    const qint64 fileSecs = qMax(fileDuration, 1) * 60;
+    const qint64 avrgSecs = (avrgLen > 0) ? avrgLen * 60 : fileSecs;
+    const auto filePeriods = (avrgSecs == fileSecs);
+
+    // file descriptions of each period, by period end
+    QMap<QDateTime, QStringList> periodFiles;
+    foreach (const RawFileIndex::Entry& entry, files)
+    {
+        if (!entry.timestamp.isValid())
+        {
+            continue;
+        }
+
+        const auto fileStart = timestampEnd ? entry.timestamp.addSecs(-fileSecs)
+                                            : entry.timestamp;
+        const auto fileEnd = fileStart.addSecs(fileSecs);
+
+        // the index is refreshed on the directory changes only, a file
+        // rewritten in place keeps its indexed size and time
+        const QFileInfo fileInfo(entry.path);
+        const QString description = fileInfo.fileName()
+                                 + QLatin1Char('|')
+                                 + QString::number(fileInfo.size())
+                                 + QLatin1Char('|')
+                                 + QString::number(fileInfo.lastModified().toMSecsSinceEpoch());
+
+        if (filePeriods)
+        {
+            periodFiles[fileEnd].append(description);
+            continue;
+        }
+
+        const QDateTime midnight(fileStart.date());
+        auto periodStart = midnight.addSecs((midnight.secsTo(fileStart) / avrgSecs) * avrgSecs);
+        while (periodStart < fileEnd)
+        {
+            const auto periodEnd = periodStart.addSecs(avrgSecs);
+            periodFiles[periodEnd].append(description);
+            periodStart = periodEnd;
+        }
+    }
+
+    QVector<Period> periods;
+    periods.reserve(periodFiles.size());
+    for (auto it = periodFiles.begin(); it != periodFiles.end(); ++it)
+    {
+        it.value().sort();
+
+        Period period;
+        period.end = it.key();
+        period.inputDigest = QCryptographicHash::hash(it.value().join(QLatin1Char('\n')).toUtf8(),
+                                                      QCryptographicHash::Sha1);
+        periods.append(period);
+    }
+    return periods;
+}
+
+ResultCache::Plan ResultCache::plan(const QString& appEnvPath,
+                                    const QString& fingerprint,
+                                    int avrgLen,
+                                    const QVector<Period>& periods)
+{
+    Plan plan;
+    plan.fingerprint = fingerprint;
+    plan.avrgLen = avrgLen;
+    plan.periods = periods;
+
+    if (fingerprint.isEmpty() || periods.isEmpty())
+    {
+        return plan;
+    }
+
+    QHash<QDateTime, Period> cachedPeriods;
+    {
+        QMutexLocker locker(&cacheMutex);
+        useEnv(appEnvPath);
+
+        const auto it = resultCache.constFind(fingerprint);
+        if (it != resultCache.constEnd()
+            && it->avrgLen == avrgLen
+            && isUnchanged(*it))
+        {
+            plan.outputFile = it->outputFile;
+            cachedPeriods.reserve(it->periods.size());
+            foreach (const Period& period, it->periods)
+            {
+                cachedPeriods.insert(period.end, period);
+            }
+        }
+    }
+
+    QDateTime firstStale;
+    QDateTime lastStale;
+    for (auto& period : plan.periods)
+    {
+        const auto it = cachedPeriods.constFind(period.end);
+        if (it != cachedPeriods.constEnd() && it->inputDigest == period.inputDigest)
+        {
+            period.rowOffset = it->rowOffset;
+            period.rowLength = it->rowLength;
+            ++plan.cachedCount;
+            continue;
+        }
+
+        if (!firstStale.isValid())
+        {
+            firstStale = period.end;
+        }
+        lastStale = period.end;
+    }
+
+    if (firstStale.isValid())
+    {
+        plan.rerunFrom = firstStale.addSecs(-avrgLen * 60);
+        plan.rerunTo = lastStale;
+    }
+
+    qDebug() << "result cache" << plan.cachedCount << "of" << plan.periods.size()
+             << "periods, rerun" << plan.rerunFrom << plan.rerunTo;
+    return plan;
+}
+
+QString ResultCache::runFullOutputFile(const QString& essentialsFile)
+{
+    const QFileInfo essentials(essentialsFile);
+    auto name = essentials.fileName();
+    if (!name.contains(QLatin1String("_essentials_")))
+    {
+        return QString();
+    }
+
+    name.replace(QLatin1String("_essentials_"), QLatin1String("_full_output_"));
+    const QFileInfo fullOutput(essentials.dir(), name);
+    return fullOutput.isFile() ? fullOutput.absoluteFilePath() : QString();
+}
+
+bool ResultCache::mergeFullOutput(const QString& appEnvPath,
+                                  const Plan& plan,
+                                  const QString& fullOutputFile,
+                                  QString* errorString)
+{
+    QString error;
+
+    FullOutput output;
+    if (!readFullOutput(fullOutputFile, &output, &error))
+    {
+        if (errorString) { *errorString = error; }
+        return false;
+    }
+
+    // the previous output, as recorded when the plan was made
+    Record previous;
+    if (plan.cachedCount > 0)
+    {
+        QMutexLocker locker(&cacheMutex);
+        useEnv(appEnvPath);
+        previous = resultCache.value(plan.fingerprint);
+    }
+
+    auto merged = 0;
+    if (plan.cachedCount > 0)
+    {
+        QFile previousFile(previous.outputFile);
+        if (!isUnchanged(previous) || !previousFile.open(QIODevice::ReadOnly))
+        {
+            error = QObject::tr("The previous results %1 changed during the run.")
+                    .arg(previous.outputFile);
+        }
+        else if (previous.header != output.header)
+        {
+            error = QObject::tr("The columns of %1 and %2 do not match.")
+                    .arg(previous.outputFile, fullOutputFile);
+        }
+        else
+        {
+            foreach (const Period& period, plan.periods)
+            {
+                if (period.rowOffset < 0
+                    || isInRerunSpan(plan, period.end)
+                    || output.rows.contains(period.end))
+                {
+                    continue;
+                }
+
+                previousFile.seek(period.rowOffset);
+                output.rows.insert(period.end, previousFile.read(period.rowLength));
+                ++merged;
+            }
+        }
+    }
+
+    // chronological rewrite, with the row positions for the next plan
+    Record record;
+    record.outputFile = QFileInfo(fullOutputFile).absoluteFilePath();
+    record.header = output.header;
+    record.avrgLen = plan.avrgLen;
+
+    QHash<QDateTime, qint64> rowOffsets;
+    QByteArray data(output.header);
+    for (auto it = output.rows.constBegin(); it != output.rows.constEnd(); ++it)
+    {
+        rowOffsets.insert(it.key(), data.size());
+        data.append(it.value());
+        data.append(output.eol);
+    }
+
+    if (data != output.data)
+    {
+        QSaveFile file(fullOutputFile);
+        if (!file.open(QIODevice::WriteOnly)
+            || file.write(data) != data.size()
+            || !file.commit())
+        {
+            if (errorString) { *errorString = file.errorString(); }
+            return false;
+        }
+    }
+
+    foreach (const Period& period, plan.periods)
+    {
+        Period recorded(period);
+        if (output.rows.contains(period.end))
+        {
+            recorded.rowOffset = rowOffsets.value(period.end);
+            recorded.rowLength = output.rows.value(period.end).size();
+        }
+        else if (isInRerunSpan(plan, period.end) || period.rowOffset < 0)
+        {
+            // processed, the engine did not output the period
+            recorded.rowOffset = -1;
+            recorded.rowLength = 0;
+        }
+        else
+        {
+            continue;
+        }
+        record.periods.append(recorded);
+    }
+
+    const QFileInfo info(fullOutputFile);
+    record.size = info.size();
+    record.modified = info.lastModified().toMSecsSinceEpoch();
+
+    qDebug() << "result cache: merged" << merged << "cached rows in" << fullOutputFile;
+
+    QMutexLocker locker(&cacheMutex);
+    useEnv(appEnvPath);
+    resultCache.insert(plan.fingerprint, record);
+    saveCache(appEnvPath);
+
+    if (!error.isEmpty())
+    {
+        qWarning() << "Error: result cache" << error;
+        if (errorString) { *errorString = error; }
+        return false;
+    }
+    return true;
+}
+
+QDateTime ResultCache::rowPeriodEnd(const QByteArray& line)
+{
+    const auto fields = line.split(',');
+    if (fields.size() <= TIME_COLUMN)
+    {
+        return QDateTime();
+    }
+
+    const auto date = QDate::fromString(QString::fromLatin1(fields.at(DATE_COLUMN)),
+                                        QStringLiteral("yyyy-MM-dd"));
+    const auto time = QTime::fromString(QString::fromLatin1(fields.at(TIME_COLUMN)),
+                                        QStringLiteral("HH:mm"));
+    if (!date.isValid() || !time.isValid())
+    {
+        return QDateTime();
+    }
+    return QDateTime(date, time);
+}
+
+void ResultCache::clear()
+{
+    QMutexLocker locker(&cacheMutex);
+    resultCache.clear();
+    cacheEnvPath.clear();
+}
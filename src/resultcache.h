@@ -0,0 +1,119 @@
+/***************************************************************************
+  resultcache.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+
+#include "rawfileindex.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/resultcache.h
+/// \brief Cache of the full output rows already produced by the engine
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note For each results fingerprint, the settings without the processing
+/// date range, the cache records the last full output file and, for each
+/// averaging period, a digest of name, size and modification time of the
+/// raw files it reads together with the position of its row in the file.
+/// Before a run, the periods whose digest did not change are skipped and
+/// the engine processes only the span from the first missing or changed
+/// period to the last one. After the run, the cached rows of the other
+/// periods are merged in the new full output file in chronological order.
+/// The cache is stored in the 'idx' subdirectory of the application
+/// environment and a record is valid until its output file changes.
+/// Only the full output is cached, so the runs that write other outputs
+/// process all their periods.
+/// \sa EcProject::resultsFingerprint, RawFileIndex
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \namespace ResultCache
+/// \brief Averaging periods already processed with the same settings
+namespace ResultCache
+{
+    struct Period
+    {
+        QDateTime end;
+        QByteArray inputDigest;
+        qint64 rowOffset = -1;  // -1 if processed without output row
+        int rowLength = 0;
+    };
+
+    struct Plan
+    {
+        QString fingerprint;
+        QString outputFile;         // full output of the cached periods
+        int avrgLen = 0;            // minutes
+        QVector<Period> periods;    // all the input periods, sorted by end
+        int cachedCount = 0;
+        QDateTime rerunFrom;        // start of the first period to process
+        QDateTime rerunTo;          // end of the last period to process
+
+        inline bool isValid() const { return !fingerprint.isEmpty() && !periods.isEmpty(); }
+        inline bool isComplete() const { return cachedCount == periods.size(); }
+    };
+
+    // averaging periods covered by the raw files, sorted by their end.
+    // when the averaging length is the file duration, each file is a period,
+    // otherwise the periods are aligned to midnight. the files are stat'ed
+    // again, the size and time in the index may be stale
+    QVector<Period> inputPeriods(const QVector<RawFileIndex::Entry>& files,
+                                 int fileDuration,
+                                 int avrgLen,
+                                 bool timestampEnd);
+
+    // compare the input periods with the cached ones
+    Plan plan(const QString& appEnvPath,
+              const QString& fingerprint,
+              int avrgLen,
+              const QVector<Period>& periods);
+
+    // add to fullOutputFile, produced by the run of the plan, the cached rows
+    // of the periods outside the rerun span, then record it as the output
+    // of the plan fingerprint
+    bool mergeFullOutput(const QString& appEnvPath,
+                         const Plan& plan,
+                         const QString& fullOutputFile,
+                         QString* errorString = nullptr);
+
+    // full output written by the run of essentialsFile, the engine names
+    // them after the same run timestamp. empty if there is none
+    QString runFullOutputFile(const QString& essentialsFile);
+
+    // end of the averaging period of a full output row,
+    // invalid for the header rows
+    QDateTime rowPeriodEnd(const QByteArray& line);
+
+    void clear();
+
+} // ResultCache
+
+#endif // RESULTCACHE_H
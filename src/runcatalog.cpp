@@ -0,0 +1,279 @@
+/***************************************************************************
+  runcatalog.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "runcatalog.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#include <algorithm>
+
+#include "defs.h"
+
+namespace RunCatalog
+{
+QDataStream& operator<<(QDataStream& out, const Run& r)
+{
+    out << r.projectFile << r.essentialsFile
+        << r.size << r.modified << r.runMode << r.settingsKey
+        << r.settingsFingerprint;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, Run& r)
+{
+    in >> r.projectFile >> r.essentialsFile
+       >> r.size >> r.modified >> r.runMode >> r.settingsKey
+       >> r.settingsFingerprint;
+    return in;
+}
+} // RunCatalog
+
+namespace
+{
+const quint32 CATALOG_MAGIC = 0x45505243; // "EPRC"
+const quint16 CATALOG_VERSION = 2;
+
+// runs keyed by absolute project path, loaded from the env of the last query
+QMutex catalogMutex;
+QHash<QString, RunCatalog::Run> runCatalog;
+QMultiHash<QByteArray, QString> runsByKey;
+QString catalogEnvPath;
+bool catalogDirty = false;
+
+QString catalogFilePath(const QString& appEnvPath)
+{
+    return appEnvPath
+           + QLatin1Char('/')
+           + Defs::IDX_FILE_DIR
+           + QStringLiteral("/runs.idx");
+}
+
+void insertRun(const RunCatalog::Run& run)
+{
+    const auto it = runCatalog.constFind(run.projectFile);
+    if (it != runCatalog.constEnd())
+    {
+        runsByKey.remove(it->settingsKey, run.projectFile);
+    }
+    runCatalog.insert(run.projectFile, run);
+    runsByKey.insert(run.settingsKey, run.projectFile);
+}
+
+void removeRun(const QString& projectFile)
+{
+    const auto it = runCatalog.constFind(projectFile);
+    if (it != runCatalog.constEnd())
+    {
+        runsByKey.remove(it->settingsKey, projectFile);
+        runCatalog.remove(projectFile);
+        catalogDirty = true;
+    }
+}
+
+void loadCatalog(const QString& appEnvPath)
+{
+    runCatalog.clear();
+    runsByKey.clear();
+    catalogDirty = false;
+    catalogEnvPath = appEnvPath;
+
+    if (appEnvPath.isEmpty())
+    {
+        return;
+    }
+
+    QFile file(catalogFilePath(appEnvPath));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_2);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != CATALOG_MAGIC || version != CATALOG_VERSION)
+    {
+        qDebug() << "Discarding run catalog" << file.fileName();
+        return;
+    }
+
+    QVector<RunCatalog::Run> runs;
+    in >> runs;
+    if (in.status() != QDataStream::Ok)
+    {
+        return;
+    }
+
+    foreach (const RunCatalog::Run& run, runs)
+    {
+        insertRun(run);
+    }
+}
+
+bool saveCatalog(const QString& appEnvPath)
+{
+    const auto fileName = catalogFilePath(appEnvPath);
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Error: Cannot write run catalog" << fileName << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_2);
+    out << CATALOG_MAGIC << CATALOG_VERSION;
+    out << runCatalog.values().toVector();
+
+    return file.commit();
+}
+
+void useEnv(const QString& appEnvPath)
+{
+    if (appEnvPath != catalogEnvPath)
+    {
+        loadCatalog(appEnvPath);
+    }
+}
+
+bool isUnchanged(const RunCatalog::Run& run)
+{
+    const QFileInfo info(run.projectFile);
+    return info.isFile()
+           && info.size() == run.size
+           && info.lastModified().toMSecsSinceEpoch() == run.modified
+           && QFileInfo::exists(run.essentialsFile);
+}
+} // namespace
+
+bool RunCatalog::contains(const QString& appEnvPath, const QString& projectFile)
+{
+    const auto path = QFileInfo(projectFile).absoluteFilePath();
+
+    QMutexLocker locker(&catalogMutex);
+    useEnv(appEnvPath);
+
+    const auto it = runCatalog.constFind(path);
+    return (it != runCatalog.constEnd() && isUnchanged(*it));
+}
+
+void RunCatalog::addRun(const QString& appEnvPath, const Run& run)
+{
+    const QFileInfo info(run.projectFile);
+    if (!info.isFile())
+    {
+        return;
+    }
+
+    Run record(run);
+    record.projectFile = info.absoluteFilePath();
+    record.essentialsFile = QFileInfo(run.essentialsFile).absoluteFilePath();
+    record.size = info.size();
+    record.modified = info.lastModified().toMSecsSinceEpoch();
+
+    QMutexLocker locker(&catalogMutex);
+    useEnv(appEnvPath);
+
+    insertRun(record);
+    catalogDirty = true;
+}
+
+QVector<RunCatalog::Run> RunCatalog::findRuns(const QString& appEnvPath,
+                                              const QString& dir,
+                                              const QByteArray& settingsKey)
+{
+    auto prefix = QDir(dir).absolutePath();
+    if (!prefix.endsWith(QLatin1Char('/')))
+    {
+        prefix += QLatin1Char('/');
+    }
+
+    QMutexLocker locker(&catalogMutex);
+    useEnv(appEnvPath);
+
+    QVector<Run> runs;
+    QStringList staleRuns;
+    foreach (const QString& projectFile, runsByKey.values(settingsKey))
+    {
+        if (!projectFile.startsWith(prefix))
+        {
+            continue;
+        }
+
+        const auto& run = runCatalog[projectFile];
+        if (isUnchanged(run))
+        {
+            runs.append(run);
+        }
+        else
+        {
+            staleRuns.append(projectFile);
+        }
+    }
+
+    foreach (const QString& projectFile, staleRuns)
+    {
+        removeRun(projectFile);
+    }
+
+    std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) {
+        return a.projectFile < b.projectFile;
+    });
+    return runs;
+}
+
+void RunCatalog::flush(const QString& appEnvPath)
+{
+    QMutexLocker locker(&catalogMutex);
+
+    if (!catalogDirty || appEnvPath.isEmpty() || appEnvPath != catalogEnvPath)
+    {
+        return;
+    }
+
+    if (saveCatalog(appEnvPath))
+    {
+        catalogDirty = false;
+    }
+}
+
+void RunCatalog::clear()
+{
+    QMutexLocker locker(&catalogMutex);
+
+    runCatalog.clear();
+    runsByKey.clear();
+    catalogEnvPath.clear();
+    catalogDirty = false;
+}
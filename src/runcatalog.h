@@ -0,0 +1,87 @@
+/***************************************************************************
+  runcatalog.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef RUNCATALOG_H
+#define RUNCATALOG_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/runcatalog.h
+/// \brief Persistent catalog of the completed processing runs
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note Each run is recorded with the project copied in its output
+/// directory, the matching essentials file, the run mode and the key of
+/// the settings checked by EcProject::fuzzyCompare(). The search of
+/// previous results is then a query by key, only the few projects with
+/// the same key need to be loaded and compared in full, unless one of them
+/// has the same settings fingerprint of the current project. A record is
+/// valid until its project file size or modification time change.
+/// The catalog is stored in the 'idx' subdirectory of the application
+/// environment.
+/// \sa EcProject::previousDataKey, EcProject::settingsFingerprint,
+/// MainWindow::testForPreviousData
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \namespace RunCatalog
+/// \brief Previous runs keyed by their processing settings
+namespace RunCatalog
+{
+    struct Run
+    {
+        QString projectFile;
+        QString essentialsFile;
+        qint64 size = -1;
+        qint64 modified = -1;
+        int runMode = -1;
+        QByteArray settingsKey;
+        QString settingsFingerprint;
+    };
+
+    // true if projectFile is catalogued and unchanged since
+    bool contains(const QString& appEnvPath, const QString& projectFile);
+
+    // size and modification time are taken from the project file
+    void addRun(const QString& appEnvPath, const Run& run);
+
+    // unchanged runs below dir with the given settings key,
+    // sorted by project file name
+    QVector<Run> findRuns(const QString& appEnvPath,
+                          const QString& dir,
+                          const QByteArray& settingsKey);
+
+    // store the runs added since the last flush
+    void flush(const QString& appEnvPath);
+
+    void clear();
+
+} // RunCatalog
+
+#endif // RUNCATALOG_H
@@ -0,0 +1,216 @@
+/***************************************************************************
+  runchecks.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "runchecks.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QScopedPointer>
+
+#include "configstate.h"
+#include "dbghelper.h"
+#include "defs.h"
+#include "ecproject.h"
+#include "rawfileindex.h"
+#include "runcatalog.h"
+#include "stringutils.h"
+
+void RunChecks::updateRunCatalog(const QString& appEnvPath, const QString& dir)
+{
+    DEBUG_FUNC_NAME
+
+    if (dir.isEmpty())
+    {
+        return;
+    }
+
+    const QString epFormat = QStringLiteral("*.") + Defs::APP_NAME_LCASE;
+    const QString csvFormat = QStringLiteral("*.") + Defs::CSV_NATIVE_DATA_FILE_EXT;
+
+    auto recurse = true;
+    const auto previousRunList = RawFileIndex::getFiles(appEnvPath, dir, epFormat, recurse);
+    const auto previousEssentialList = RawFileIndex::getFiles(appEnvPath, dir, csvFormat, recurse)
+                                       .filter(QStringLiteral("essentials"));
+
+    ConfigState runConfigState;
+    QScopedPointer<EcProject> runEcProject(new EcProject(nullptr, runConfigState.project));
+
+    foreach (const QString& processingFile, previousRunList)
+    {
+        if (RunCatalog::contains(appEnvPath, processingFile))
+        {
+            continue;
+        }
+
+        // the run timestamp follows 'processing_' in the file name
+        const auto filenameDate = QFileInfo(processingFile).fileName().mid(11, 17);
+        if (!StringUtils::isISODateTimeString(filenameDate))
+        {
+            continue;
+        }
+
+        const auto essentialsFiles = previousEssentialList.filter(filenameDate);
+        if (essentialsFiles.isEmpty())
+        {
+            continue;
+        }
+
+        bool modified; // not necessary in this case
+        if (!runEcProject->loadEcProject(processingFile, false, &modified))
+        {
+            continue;
+        }
+
+        RunCatalog::Run run;
+        run.projectFile = processingFile;
+        run.essentialsFile = essentialsFiles.first();
+        run.runMode = static_cast<int>(runEcProject->generalRunMode());
+        run.settingsKey = runEcProject->previousDataKey();
+        run.settingsFingerprint = runEcProject->settingsFingerprint();
+        RunCatalog::addRun(appEnvPath, run);
+    }
+
+    RunCatalog::flush(appEnvPath);
+}
+
+QString RunChecks::findPreviousRun(const QString& appEnvPath, const EcProject& project)
+{
+    DEBUG_FUNC_NAME
+
+    // first preliminary test
+    if ((project.generalHfMethod() == 2 || project.generalHfMethod() == 3)
+        && (project.spectraMode() == 1 && project.generalBinSpectraAvail() == 0))
+    {
+        qDebug() << "failed first preliminary test";
+        return QString();
+    }
+
+    // second preliminary test
+    if (project.generalHfMethod() == 4
+        && ((project.spectraMode() == 1 && project.generalBinSpectraAvail() == 0)
+        || project.generalFullSpectraAvail() == 0))
+    {
+        qDebug() << "second first preliminary test";
+        return QString();
+    }
+
+    // catalogue the runs of the previous output dir not seen yet
+    updateRunCatalog(appEnvPath, project.spectraExDir());
+
+    ConfigState currConfigState;
+
+    QScopedPointer<EcProject> currEcProject(new EcProject(nullptr, currConfigState.project));
+    bool modified; // not necessary in this case
+    if (!currEcProject->loadEcProject(project.generalFileName(), false, &modified))
+    {
+        qDebug() << "loading FAIL";
+        return QString();
+    }
+
+    // only the runs with the same key can pass the fuzzy comparison
+    const auto candidateRuns = RunCatalog::findRuns(appEnvPath,
+                                                    project.spectraExDir(),
+                                                    currEcProject->previousDataKey());
+    qDebug() << "candidate runs" << candidateRuns.size();
+
+    // a run with the same settings fingerprint passes without loading it
+    const auto currFingerprint = currEcProject->settingsFingerprint();
+    foreach (const RunCatalog::Run& run, candidateRuns)
+    {
+        if (run.runMode == static_cast<int>(Defs::CurrRunMode::Advanced)
+            && !currFingerprint.isEmpty()
+            && run.settingsFingerprint == currFingerprint)
+        {
+            qDebug() << "same settings fingerprint" << run.projectFile;
+            qDebug() << "exFilePath" << run.essentialsFile;
+            return run.essentialsFile;
+        }
+    }
+
+    QScopedPointer<EcProject> prevEcProject(new EcProject(nullptr, currConfigState.project));
+    foreach (const RunCatalog::Run& run, candidateRuns)
+    {
+        if (run.runMode != static_cast<int>(Defs::CurrRunMode::Advanced))
+        {
+            continue;
+        }
+
+        qDebug() << "compare with" << run.projectFile;
+        if (prevEcProject->loadEcProject(run.projectFile, false, &modified)
+            && currEcProject->fuzzyCompare(*prevEcProject))
+        {
+            qDebug() << "fuzzyCompare: OK";
+            qDebug() << "exFilePath" << run.essentialsFile;
+            return run.essentialsFile;
+        }
+        qDebug() << "fuzzyCompare: FAIL";
+    }
+
+    return QString();
+}
+
+void RunChecks::usePreviousRun(EcProject* project, const QString& essentialsFile)
+{
+    DEBUG_FUNC_NAME
+
+    qDebug() << essentialsFile;
+    project->setSpectraExFile(essentialsFile);
+
+    if (project->generalHfMethod() == 2
+        || project->generalHfMethod() == 3
+        || project->generalHfMethod() == 4)
+    {
+        if (project->generalBinSpectraAvail())
+        {
+            project->setSpectraBinSpectra(project->spectraBinSpectra());
+        }
+
+        if (project->generalHfMethod() == 4)
+        {
+            if (project->generalFullSpectraAvail())
+            {
+                project->setSpectraFullSpectra(project->spectraFullSpectra());
+            }
+        }
+    }
+}
+
+void RunChecks::useRawProcessingSpectra(EcProject* project)
+{
+    if (project->generalBinSpectraAvail())
+    {
+        project->setSpectraBinSpectra(project->spectraBinSpectra());
+    }
+    else
+    {
+        project->setSpectraBinSpectra(project->generalOutPath() + Defs::OUT_BINNED_COSPECTRA_DIR);
+    }
+
+    if (project->generalFullSpectraAvail())
+    {
+        project->setSpectraFullSpectra(project->spectraFullSpectra());
+    }
+    else
+    {
+        project->setSpectraFullSpectra(project->generalOutPath() + QStringLiteral("/eddypro_full_cospectra"));
+    }
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+  runchecks.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef RUNCHECKS_H
+#define RUNCHECKS_H
+
+#include <QString>
+
+class EcProject;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/runchecks.h
+/// \brief Checks and project updates done before running the engines
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note Shared by the runs started from the main window, the batch queue
+/// and the command line, so all of them take the same decisions without
+/// any user interface.
+/// \sa RunCatalog, MainWindow::testBeforeRunningPassed, HeadlessRunner
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \namespace RunChecks
+/// \brief Pre-run checks independent of the user interface
+namespace RunChecks
+{
+    // add to the run catalog the processing projects of dir not catalogued
+    // yet, each one is loaded only the first time it is seen
+    void updateRunCatalog(const QString& appEnvPath, const QString& dir);
+
+    // essentials file of a previous run in the previous output directory
+    // of project with equivalent settings, empty if there is none
+    QString findPreviousRun(const QString& appEnvPath, const EcProject& project);
+
+    // use the results of a previous run for the spectral corrections
+    void usePreviousRun(EcProject* project, const QString& essentialsFile);
+
+    // spectra paths for the spectral corrections step, after the raw
+    // processing step wrote its outputs
+    void useRawProcessingSpectra(EcProject* project);
+
+} // RunChecks
+
+#endif // RUNCHECKS_H
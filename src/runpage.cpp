@@ -22,10 +22,11 @@
 
 #include "runpage.h"
 
+#include <QDateTime>
 #include <QDebug>
 #include <QDesktopServices>
+#include <QDir>
 #include <QElapsedTimer>
-#include <QFile>
 #include <QGridLayout>
 #include <QProgressBar>
 #include <QPushButton>
@@ -77,9 +78,10 @@ RunPage::RunPage(QWidget *parent, EcProject *ecProject, ConfigState* config)
     fileProgressLabel_->setObjectName(QStringLiteral("fileLabel"));
 
     timeEstimateLabels_ = new QLabel;
-    timeEstimateLabels_->setText(QStringLiteral("Total elapsed time: 00:00:00 - Estimated time "
-                                                "to completion: --:--:--.---"));
     timeEstimateLabels_->setObjectName(QStringLiteral("fileLabel"));
+    elapsedTimeStr_ = QStringLiteral("00:00:00");
+    timeToCompletionStr_ = QStringLiteral("--:--:--");
+    showTimeEstimates();
 
     pauseResumeLabel_ = new QLabel;
     pauseResumeLabel_->setObjectName(QStringLiteral("fileLabel"));
@@ -361,6 +363,7 @@ bool RunPage::pauseRun(Defs::CurrRunStatus mode)
         WidgetUtils::updatePropertyListAndStyle(runModeIcon_, iconModeProp);
         runModeIcon_->setVisible(true);
         pauseResumeLabel_->setText(tr("Pausing computations..."));
+        profiler_.suspend();
         progressWidget_->setDisplayedWhenStopped(true);
         progressWidget_->stopAnimation();
         total_elapsed_update_timer_->stop();
@@ -426,6 +429,7 @@ bool RunPage::resumeRun(Defs::CurrRunStatus mode)
         WidgetUtils::updatePropertyListAndStyle(runModeIcon_, iconModeProp);
         runModeIcon_->setVisible(true);
         pauseResumeLabel_->setText(tr("Resuming computations..."));
+        profiler_.resume();
         progressWidget_->setDisplayedWhenStopped(true);
         progressWidget_->startAnimation();
         total_elapsed_update_timer_->start();
@@ -449,6 +453,7 @@ void RunPage::stopRun()
     resetProgressHard();
     total_elapsed_update_timer_->stop();
     main_progress_timer_.invalidate();
+    profiler_.clear();
 }
 
 void RunPage::pauseLabel()
@@ -467,7 +472,9 @@ void RunPage::resumeLabel()
 
 void RunPage::resetBuffer()
 {
-    rxBuffer_.resize(0);
+    rxBuffer_.clear();
+    progressBuffer_.clear();
+    structuredProgress_ = false;
 }
 
 void RunPage::resetProgressSoft()
@@ -523,74 +530,245 @@ void RunPage::resetLabels()
     resetTimeEstimateLabels();
 }
 
-bool RunPage::filterData(const QByteArray& data)
+namespace
+{
+// hh:mm:ss, with the hours past one day
+QString formatDuration(qint64 msec)
+{
+    const auto secs = qMax(Q_INT64_C(0), msec) / 1000;
+    return QStringLiteral("%1:%2:%3")
+            .arg(secs / 3600, 2, 10, QLatin1Char('0'))
+            .arg((secs / 60) % 60, 2, 10, QLatin1Char('0'))
+            .arg(secs % 60, 2, 10, QLatin1Char('0'));
+}
+
+/// \struct PeriodStage
+/// \brief Stage of the processing of an averaging period, shown by the
+/// mini progress bar
+struct PeriodStage
+{
+    EngineOutput::Message message;
+    const char* key;    // name in the progress events
+    int miniProgress;
+    bool mainStep;      // also a step of the main progress bar
+    const char* label;
+};
+
+const PeriodStage PERIOD_STAGES[] = {
+    { EngineOutput::Message::Statistics, "statistics", 3, false, QT_TRANSLATE_NOOP("RunPage", "Calculating statistics") },
+    { EngineOutput::Message::StatisticalScreening, "screening", 4, false, QT_TRANSLATE_NOOP("RunPage", "Raw level statistical screening") },
+    { EngineOutput::Message::SpikeTest, "despiking", 5, false, QT_TRANSLATE_NOOP("RunPage", "Spike detection/removal") },
+    { EngineOutput::Message::AbsoluteLimits, "absolute_limits", 7, false, QT_TRANSLATE_NOOP("RunPage", "Absolute limits test") },
+    { EngineOutput::Message::SkewnessKurtosis, "skewness_kurtosis", 8, true, QT_TRANSLATE_NOOP("RunPage", "Skewness & kurtosis test") },
+    { EngineOutput::Message::DespikingUserSet, "despiking_user_set", 9, false, QT_TRANSLATE_NOOP("RunPage", "Despiking user set") },
+    { EngineOutput::Message::CrossWind, "cross_wind", 10, false, QT_TRANSLATE_NOOP("RunPage", "Cross-wind correction") },
+    { EngineOutput::Message::MixingRatio, "mixing_ratio", 11, false, QT_TRANSLATE_NOOP("RunPage", "Converting into mixing ratio") },
+    { EngineOutput::Message::TiltCorrection, "tilt_correction", 12, false, QT_TRANSLATE_NOOP("RunPage", "Performing tilt correction") },
+    { EngineOutput::Message::TimeLags, "time_lags", 13, false, QT_TRANSLATE_NOOP("RunPage", "Compensating time lags") },
+    { EngineOutput::Message::UserVariables, "user_variables", 14, false, QT_TRANSLATE_NOOP("RunPage", "Compensating user variables") },
+    { EngineOutput::Message::Stationarity, "stationarity", 15, false, QT_TRANSLATE_NOOP("RunPage", "Performing stationarity test") },
+    { EngineOutput::Message::Detrending, "detrending", 16, true, QT_TRANSLATE_NOOP("RunPage", "Detrending") },
+    { EngineOutput::Message::Spectra, "spectra", 17, false, QT_TRANSLATE_NOOP("RunPage", "Calculating (co)spectra") },
+    { EngineOutput::Message::Tapering, "tapering", 18, false, QT_TRANSLATE_NOOP("RunPage", "Tapering timeseries") },
+    { EngineOutput::Message::Fft, "fft", 19, false, QT_TRANSLATE_NOOP("RunPage", "FFT-ing") },
+    { EngineOutput::Message::CospectralDensities, "cospectral_densities", 20, false, QT_TRANSLATE_NOOP("RunPage", "Cospectral densities") },
+    { EngineOutput::Message::FluxesLevel0, "fluxes_level_0", 21, false, QT_TRANSLATE_NOOP("RunPage", "Calculating fluxes Level 0") },
+    { EngineOutput::Message::FluxesLevel1, "fluxes_level_1", 22, false, QT_TRANSLATE_NOOP("RunPage", "Calculating fluxes Level 1") },
+    { EngineOutput::Message::FluxesLevel2, "fluxes_level_2", 23, false, QT_TRANSLATE_NOOP("RunPage", "Calculating fluxes Level 2 and 3") },
+    { EngineOutput::Message::Footprint, "footprint", 24, false, QT_TRANSLATE_NOOP("RunPage", "Estimating footprint") }
+};
+
+const PeriodStage* findPeriodStage(EngineOutput::Message message)
+{
+    for (const auto& stage : PERIOD_STAGES)
+    {
+        if (stage.message == message)
+        {
+            return &stage;
+        }
+    }
+    return nullptr;
+}
+
+const PeriodStage* findPeriodStage(const QString& key)
+{
+    for (const auto& stage : PERIOD_STAGES)
+    {
+        if (key == QLatin1String(stage.key))
+        {
+            return &stage;
+        }
+    }
+    return nullptr;
+}
+
+// messages superseded by the structured progress events, when available
+bool isPeriodProgress(EngineOutput::Message message)
+{
+    using EngineOutput::Message;
+
+    switch (message)
+    {
+    case Message::MaxAveragingPeriods:
+    case Message::PlanarFitStep:
+    case Message::TimeLagStep:
+    case Message::From:
+    case Message::To:
+    case Message::TotalAveragingPeriods:
+    case Message::NewAveragingPeriod:
+    case Message::FileList:
+    case Message::SkippingPeriod:
+    case Message::FileContinuation:
+    case Message::NumberOfSamples:
+    case Message::QualityFlags:
+    case Message::PeriodProcessingTime:
+        return true;
+    default:
+        return findPeriodStage(message) != nullptr;
+    }
+}
+} // namespace
+
+bool RunPage::filterData(const EngineOutput::Line& line)
 {
     if (inPlanarFit_ or inTimeLag_)
     {
-        return data.contains(QByteArrayLiteral("another small step"));
+        return (line.flags & EngineOutput::SmallStep);
     }
     return false;
 }
 
 void RunPage::bufferData(QByteArray &data)
 {
-    qDebug() << "data" << data;
-
     rxBuffer_.append(data);
-    QByteArray line(rxBuffer_);
-    QByteArrayList lineList(line.split('\n'));
-
-    qDebug() << "rxBuffer_" << rxBuffer_;
-    qDebug() << "lineList.at(0)" << lineList.at(0);
 
-    // newline found
-    if (lineList.at(0) != rxBuffer_)
+    // complete lines only, the rest waits for the next data
+    QByteArray rawLine;
+    while (rxBuffer_.readLine(&rawLine))
     {
-        for (int i = 0; i < lineList.size(); ++i)
+        auto line = EngineOutput::classify(rawLine);
+        data = cleanupEngineOutput(rawLine, &line);
+        if (!data.isEmpty())
         {
-            qDebug() << "lineList.at(i)" << i << lineList.at(i);
-            QByteArray tempData(lineList.at(i));
-            data = cleanupEngineOutput(tempData);
-            qDebug() << "data after cleanup" << data;
-            if (!data.isEmpty())
+            parseEngineOutput(data, line);
+            if (!filterData(line))
             {
-                parseEngineOutput(data);
-                if (!filterData(data))
-                {
-                    emit updateConsoleLineRequest(data);
-                }
+                emit updateConsoleLineRequest(data);
             }
         }
+    }
+}
+
+void RunPage::bufferProgress(QByteArray &data)
+{
+    progressBuffer_.append(data);
+
+    QByteArray line;
+    EngineProgress::Event event;
+    while (progressBuffer_.readLine(&line))
+    {
+        if (EngineProgress::parse(line, &event))
+        {
+            structuredProgress_ = true;
+            applyProgressEvent(event);
+        }
+    }
+}
 
-        if (lineList.last().endsWith('\n'))
-            resetBuffer();
+void RunPage::applyProgressEvent(const EngineProgress::Event& event)
+{
+    switch (event.type)
+    {
+    case EngineProgress::Type::Totals:
+        totalAveragingPeriods_ = event.total;
+        etc_.setTotal(totalAveragingPeriods_);
+        main_progress_bar->setMaximum(totalAveragingPeriods_);
+        break;
+    case EngineProgress::Type::Period:
+        profiler_.startPeriod(event.index);
+        averagingPeriodIndex_ = event.index;
+        periodStartTime_ = main_progress_timer_.elapsed();
+        fromStr_ = event.from;
+        toStr_ = event.to;
+        showAveragingInterval(true);
+
+        mini_progress_bar_->reset();
+        mini_progress_bar_->setValue(0);
+
+        currentFileList_ = event.files;
+        if (!currentFileList_.isEmpty())
+        {
+            fileProgressLabel_->setText(tr("Parsing file"));
+            fileListLabel_->setText(QStringLiteral("File(s): %1")
+                                    .arg(currentFileList_.join(QLatin1Char('\n'))));
+        }
+        break;
+    case EngineProgress::Type::Stage:
+        profiler_.enterStage(event.stage, event.msec);
+        if (const auto stage = findPeriodStage(event.stage))
+        {
+            mini_progress_bar_->setValue(stage->miniProgress);
+            fileProgressLabel_->setText(tr(stage->label));
+        }
+        else if (event.stage == QLatin1String("quality_flags"))
+        {
+            mini_progress_bar_->setValue(mini_progress_bar_->maximum());
+            fileProgressLabel_->setText(tr("Calculating quality flags"));
+        }
         else
-            rxBuffer_ = lineList.last();
+        {
+            fileProgressLabel_->setText(event.stage);
+        }
+        break;
+    case EngineProgress::Type::PeriodEnd:
+    {
+        profiler_.endPeriod();
+        averagingPeriodIndex_ = qMax(event.index, 1);
+
+        // the engine timing if given, the time since the previous period if not
+        const auto currentStepElapsedTime = main_progress_timer_.elapsed();
+        const auto processingTime = (event.msec >= 0)
+                                    ? event.msec
+                                    : currentStepElapsedTime - previousElapsedTime_;
+        previousElapsedTime_ = currentStepElapsedTime;
+
+        if (event.skipped)
+        {
+            etc_.skipPeriod(processingTime);
+        }
+        else
+        {
+            etc_.addPeriod(processingTime);
+        }
+        showTimeToCompletion();
+
+        // the two channels are not in sync, a phase restart may have reset
+        // the maximum after the totals event
+        progressValue_ = averagingPeriodIndex_;
+        main_progress_bar->setMaximum(qMax(totalAveragingPeriods_, progressValue_));
+        main_progress_bar->setValue(progressValue_);
+        mini_progress_bar_->reset();
+        mini_progress_bar_->setValue(0);
+        resetFileLabels();
+        break;
+    }
+    default:
+        break;
     }
-//    else
-//    {
-//        if (!data.isEmpty())
-//        {
-//            parseEngineOutput(data);
-//            emit updateConsoleCharRequest(data);
-//        }
-////        rxBuffer_ = data;
-//    }
 }
 
-QByteArray RunPage::cleanupEngineOutput(QByteArray data)
+QByteArray RunPage::cleanupEngineOutput(QByteArray data, EngineOutput::Line* line)
 {
-    DEBUG_FUNC_NAME
-    if (data.contains(QByteArrayLiteral("of file Z:")))
+    if (line->flags & EngineOutput::WindowsSourcePath)
     {
         // cleanup file path in case of fortan runtime error
         qDebug() << "data before" << data;
         data = data.mid(0, data.indexOf("Z:")) + data.mid(data.lastIndexOf("\\") + 1);
         qDebug() << "data after" << data;
+        *line = EngineOutput::classify(data);
     }
     else if (data == QByteArrayLiteral(" ")
-             || data.contains(QByteArrayLiteral("STOP"))
-             || data.contains(QByteArrayLiteral("Note: The following floating-point exceptions")))
+             || (line->flags & (EngineOutput::Stop | EngineOutput::FpExceptions)))
     {
         data = QByteArray();
     }
@@ -598,721 +776,296 @@ QByteArray RunPage::cleanupEngineOutput(QByteArray data)
     return data;
 }
 
-void RunPage::parseEngineOutput(const QByteArray &data)
+// back to the start of the progress of a run phase
+void RunPage::restartProgress(EtcEstimator::Phase phase)
 {
-    DEBUG_FUNC_NAME
-
-    QByteArray cleanLine;
-    cleanLine.append(data);
+    averagingPeriodIndex_ = 0;
+    // the totals event may come before the message on the console
+    if (!structuredProgress_)
+    {
+        totalAveragingPeriods_ = 0;
+    }
+    previousElapsedTime_ = 0;
+    periodStartTime_ = 0;
+    etc_.start(phase);
+    etc_.setTotal(totalAveragingPeriods_);
+    resetProgressSoft();
+    stepProgress();
+    fromStr_.clear();
+    toStr_.clear();
+}
 
-    static int averagingPeriodIndex = 0;
-    static int totalAveragingPeriods = 0;
-    static int processingTimeMSec = 0;
-    static int meanProcessingTimeMSec = 0;
-    static int elapsedTimeMSec = 0;
-    static int estimatedTimeToCompletionMSec = 0;
+void RunPage::stepProgress()
+{
+    main_progress_bar->setValue(++progressValue_);
+    qDebug() << "progressValue_" << progressValue_;
+}
 
-    static qint64 previous_elapsed_time = 0;
-    qint64 current_step_elapsed_time = 0;
+void RunPage::showAveragingInterval(bool toErrorEdit)
+{
+    avgPeriodLabel_->setText(tr("Averaging interval, From: %1, To: %2")
+                        .arg(fromStr_)
+                        .arg(toStr_));
+    if (toErrorEdit)
+    {
+        auto avgPeriod = avgPeriodLabel_->text();
+        errorEdit_->append(avgPeriod.prepend(QStringLiteral("<font color=\"#A6D7F2\">"))
+                                    .append(QStringLiteral("</font>")));
+    }
+}
 
-    static QString fromStr;
-    static QString toStr;
+// time to completion of the current phase, with its 95% band
+void RunPage::showTimeToCompletion()
+{
+    const auto estimate = etc_.estimate();
+    if (!estimate.valid)
+    {
+        return;
+    }
 
-    QString elapsedTimeMSecStr; // just for debug
+    timeToCompletionStr_ = formatDuration(estimate.msec);
+    if (estimate.highMSec > estimate.lowMSec)
+    {
+        timeToCompletionStr_ += QStringLiteral(" (%1 - %2)")
+                                .arg(formatDuration(estimate.lowMSec))
+                                .arg(formatDuration(estimate.highMSec));
+    }
+    showTimeEstimates();
+}
 
-    QStringList currentFileList;
+void RunPage::showTimeEstimates()
+{
+    timeEstimateLabels_->setText(QStringLiteral("Total elapsed time: %1 - "
+                                                "Estimated time to completion: %2")
+                                 .arg(elapsedTimeStr_)
+                                 .arg(timeToCompletionStr_));
+}
 
-    static QDate currentPlanarFitDate;
-    static QDate currentTimeLagDate;
+// step of the planar fit or of the time lag optimization, "... hh:mm"
+void RunPage::parseSmallStep(const QByteArray& cleanLine, const QDate& date)
+{
+    auto timeStr = QLatin1String(cleanLine.trimmed().split(' ')
+                                 .last().trimmed().constData());
+    auto currentTime = QTime::fromString(timeStr, QStringLiteral("hh:mm"));
 
-    // NOTE: flag set but not used yet
-    bool inCycle = false;
+    QDateTime fromDate(date, currentTime.addSecs(-ecProject_->screenAvrgLen() * 60));
+    fromStr_ = fromDate.toString(Qt::ISODate).replace(QLatin1String("T"), QLatin1String(" "));
+    QDateTime toDate(date, currentTime);
+    toStr_ = toDate.toString(Qt::ISODate);
 
-#ifdef QT_DEBUG
-    QFile outfile(QStringLiteral("parse-engine-output.txt"));
-    outfile.open(QIODevice::WriteOnly | QIODevice::Append);
-    QTextStream out(&outfile);
-#endif
+    showAveragingInterval(true);
 
-    // start preamble
-    if (cleanLine.contains(QByteArrayLiteral("Executing EddyPro")))
-    {
-        total_elapsed_update_timer_->start();
+    ++averagingPeriodIndex_;
 
-        timeEstimateLabels_->setText(timeEstimateLabels_->text()
-                                     .replace(20, 8, QStringLiteral("00:00:00")));
-        timeEstimateLabels_->setText(timeEstimateLabels_->text()
-                                     .replace(61, 12, QStringLiteral("--:--:--.---")));
+    mini_progress_bar_->setValue(0);
+    mini_progress_bar_->reset();
+    stepProgress();
 
-        overall_progress_timer_.restart();
-        main_progress_timer_.restart();
+    // ETC computation
+    const auto currentStepElapsedTime = main_progress_timer_.elapsed();
+    etc_.addPeriod(currentStepElapsedTime - previousElapsedTime_);
+    previousElapsedTime_ = currentStepElapsedTime;
 
-        // re-init numerical values
-        averagingPeriodIndex = 0;
-        totalAveragingPeriods = 0;
-        processingTimeMSec = 0;
-        meanProcessingTimeMSec = 0;
-        elapsedTimeMSec = 0;
-        estimatedTimeToCompletionMSec = 0;
+    showTimeToCompletion();
+}
 
-        resetProgressSoft();
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
+void RunPage::parseEngineOutput(const QByteArray &data, const EngineOutput::Line& line)
+{
+    using EngineOutput::Message;
 
-        fromStr.clear();
-        toStr.clear();
+    QByteArray cleanLine(data);
 
-        inCycle = false;
-        inPlanarFit_ = false;
-        inTimeLag_ = false;
-        currentFileList.clear();
-
-#ifdef QT_DEBUG
-        out << "file #, "
-            << "procTimeMSec, " <<"meanProcTimeMSec, "
-            << "elapsedMSec, " << "elapsedMSec_Str, "
-            << "ETC, " << "ETC_Str";
-        endl(out);
-        out << "Executing EddyPro";
-        endl(out);
-        elapsedTimeMSecStr = QTime(0, 0).addMSecs(static_cast<int>(overall_progress_timer_.elapsed()))
-                                    .toString(QStringLiteral("hh:mm:ss.zzz"));
-        out << averagingPeriodIndex << " "
-            << processingTimeMSec << " "
-            << meanProcessingTimeMSec << " "
-            << overall_progress_timer_.elapsed() << " "
-            << elapsedTimeMSecStr << " "
-            << "x "
-            << "x ";
-        endl(out);
-#endif
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Reading EddyPro project file")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Retrieving file")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("names from directory")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Retrieving timestamps")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("from file names")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Arranging raw files")))
+    if (structuredProgress_ && isPeriodProgress(line.message))
     {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
         return;
     }
-    if (cleanLine.contains(QByteArrayLiteral("in chronological order")))
+
+    if (const auto stage = findPeriodStage(line.message))
     {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
+        profiler_.enterStage(QLatin1String(stage->key));
+        if (stage->mainStep)
+        {
+            stepProgress();
+        }
+        mini_progress_bar_->setValue(stage->miniProgress);
+        fileProgressLabel_->setText(tr(stage->label));
         return;
     }
-    if (cleanLine.contains(QByteArrayLiteral("Creating master time series")))
+
+    switch (line.message)
     {
+    // start preamble
+    case Message::Executing:
+        total_elapsed_update_timer_->start();
+
+        elapsedTimeStr_ = QStringLiteral("00:00:00");
+        timeToCompletionStr_ = QStringLiteral("--:--:--");
+        showTimeEstimates();
+
+        overall_progress_timer_.restart();
+        main_progress_timer_.restart();
+
+        restartProgress(EtcEstimator::Phase::RawProcessing);
+
+        inPlanarFit_ = false;
+        inTimeLag_ = false;
+        currentFileList_.clear();
+        profiler_.clear();
+        return;
+    case Message::ReadingProject:
+    case Message::RetrievingFile:
+    case Message::NamesFromDirectory:
+    case Message::RetrievingTimestamps:
+    case Message::FromFileNames:
+    case Message::ArrangingRawFiles:
+    case Message::ChronologicalOrder:
+        stepProgress();
+        return;
+    case Message::MasterTimeSeries:
         main_progress_bar->setValue(main_progress_bar->maximum());
-        qDebug() << "progressValue_" << progressValue_;
-
-#ifdef QT_DEBUG
-        out << "Creating master time series";
-        endl(out);
-        elapsedTimeMSecStr = QTime(0, 0).addMSecs(static_cast<int>(overall_progress_timer_.elapsed()))
-                                    .toString(QStringLiteral("hh:mm:ss.zzz"));
-        out << averagingPeriodIndex << " "
-            << "x "
-            << "x "
-            << overall_progress_timer_.elapsed() << " "
-            << elapsedTimeMSecStr << " "
-            << "x "
-            << "x ";
-        endl(out);
-#endif
         return;
-    }
     // end preamble
 
     // start planar fit
-    if (cleanLine.contains(QByteArrayLiteral("Performing planar-fit assessment")))
-    {
+    case Message::PlanarFitStart:
         inPlanarFit_ = true;
         progressLabel_->setText(tr("Performing planar-fit assessment..."));
-
-        // re-init
-        averagingPeriodIndex = 0;
-        totalAveragingPeriods = 0;
-        processingTimeMSec = 0;
-        meanProcessingTimeMSec = 0;
-        elapsedTimeMSec = 0;
-        estimatedTimeToCompletionMSec = 0;
-        resetProgressSoft();
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        fromStr.clear();
-        toStr.clear();
-
+        restartProgress(EtcEstimator::Phase::PlanarFit);
         main_progress_timer_.restart(); // restart to measure planar fit run time
-
         errorEdit_->append(QStringLiteral("Performing planar-fit assessment"));
-
         return;
-    }
     // valid for both planar fit and time lag
-    if (cleanLine.contains(QByteArrayLiteral("Maximum number of flux averaging periods available")))
+    case Message::MaxAveragingPeriods:
     {
         QString numStr = QLatin1String(cleanLine.trimmed().split(':').last().trimmed().constData());
-        qDebug() << "numStr: " << numStr;
-        totalAveragingPeriods = numStr.toInt();
-        main_progress_bar->setMaximum(totalAveragingPeriods);
+        totalAveragingPeriods_ = numStr.toInt();
+        etc_.setTotal(totalAveragingPeriods_);
+        main_progress_bar->setMaximum(totalAveragingPeriods_);
         return;
     }
-    if (cleanLine.contains(QByteArrayLiteral("Importing wind data for")))
+    case Message::ImportingWindData:
     {
         QString dateStr = QLatin1String(cleanLine.mid(25).constData());
-        currentPlanarFitDate = QDate::fromString(dateStr.trimmed(),
-                                                 QStringLiteral("dd MMMM yyyy"));
-        qDebug() << "currentPlanarFitDate: " << currentPlanarFitDate;
-
+        currentPlanarFitDate_ = QDate::fromString(dateStr.trimmed(),
+                                                  QStringLiteral("dd MMMM yyyy"));
         fileProgressLabel_->setText(QStringLiteral("Importing wind data"));
         return;
     }
-    if (cleanLine.contains(QByteArrayLiteral("another small step to the planar-fit")))
-    {
-        auto timeStr = QLatin1String(cleanLine.trimmed().split(' ')
-                                     .last().trimmed().constData());
-        qDebug() << "timeStr: " << timeStr;
-
-        auto currentPlanarFitTime = QTime::fromString(timeStr, QStringLiteral("hh:mm"));
-        qDebug() << "currentPlanarFitTime: " << currentPlanarFitTime;
-
-        QDateTime fromDate(currentPlanarFitDate, currentPlanarFitTime
-                           .addSecs(-ecProject_->screenAvrgLen() * 60));
-        fromStr = fromDate.toString(Qt::ISODate).replace(QLatin1String("T"), QLatin1String(" "));
-        QDateTime toDate(currentPlanarFitDate, currentPlanarFitTime);
-        toStr = toDate.toString(Qt::ISODate);
-        qDebug() << "fromStr: " << fromStr;
-        qDebug() << "toStr: " << toStr;
-
-        avgPeriodLabel_->setText(tr("Averaging interval, From: %1, To: %2")
-                            .arg(fromStr)
-                            .arg(toStr));
-        auto avgPeriod = avgPeriodLabel_->text();
-        errorEdit_->append(avgPeriod.prepend(QStringLiteral("<font color=\"#A6D7F2\">"))
-                                    .append(QStringLiteral("</font>")));
-
-        ++averagingPeriodIndex;
-
-        mini_progress_bar_->setValue(0);
-        mini_progress_bar_->reset();
-        main_progress_bar->setValue(++progressValue_);
-
-        // ETC computation
-        current_step_elapsed_time = main_progress_timer_.elapsed();
-        processingTimeMSec = static_cast<int>(current_step_elapsed_time - previous_elapsed_time);
-
-        estimatedTimeToCompletionMSec = updateETC(&meanProcessingTimeMSec, processingTimeMSec,
-                                                  averagingPeriodIndex, totalAveragingPeriods);
-
-        auto estimatedTimeToCompletionMSecStr = QTime(0, 0)
-                                .addMSecs(estimatedTimeToCompletionMSec)
-                                .toString(QStringLiteral("hh:mm:ss.zzz"));
-#ifdef QT_DEBUG
-        out << "Planar-fit ETC computation";
-        endl(out);
-        out << "averagingPeriodIndex " << averagingPeriodIndex << " totalRuns " << totalAveragingPeriods;
-        endl(out);
-        out << "current_step_elapsed_time " << current_step_elapsed_time;
-        out << " processingTimeMSec " << processingTimeMSec;
-        out << " previous_elapsed_time " << previous_elapsed_time;
-        endl(out);
-        out << "estimatedTimeToCompletionMSec " << estimatedTimeToCompletionMSec;
-        out << " estimatedTimeToCompletionMSecStr " << estimatedTimeToCompletionMSecStr;
-        endl(out);
-#endif
-        previous_elapsed_time = current_step_elapsed_time;
-
-        timeEstimateLabels_->setText(timeEstimateLabels_->text()
-                                    .replace(61, 12, estimatedTimeToCompletionMSecStr));
+    case Message::PlanarFitStep:
+        parseSmallStep(cleanLine, currentPlanarFitDate_);
         return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Sorting wind data by sector")))
-    {
+    case Message::SortingWindData:
         fileProgressLabel_->setText(QStringLiteral("Sorting wind data by sector"));
         return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Calculating planar fit rotation matrices")))
-    {
+    case Message::PlanarFitMatrices:
         fileProgressLabel_->setText(QStringLiteral("Calculating planar fit rotation matrices"));
         return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Planar Fit session terminated")))
-    {
+    case Message::PlanarFitEnd:
         inPlanarFit_ = false;
         main_progress_bar->setValue(main_progress_bar->maximum());
-        qDebug() << "progressValue_" << progressValue_;
-        previous_elapsed_time = 0;
+        previousElapsedTime_ = 0;
         return;
-    }
     // end planar fit
 
     // start time lag
-    if (cleanLine.contains(QByteArrayLiteral("Performing time-lag optimization")))
-    {
+    case Message::TimeLagStart:
         inTimeLag_ = true;
         progressLabel_->setText(tr("Performing time-lag optimization..."));
-
-        // re-init
-        averagingPeriodIndex = 0;
-        totalAveragingPeriods = 0;
-        processingTimeMSec = 0;
-        meanProcessingTimeMSec = 0;
-        elapsedTimeMSec = 0;
-        estimatedTimeToCompletionMSec = 0;
-        resetProgressSoft();
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        fromStr.clear();
-        toStr.clear();
-
+        restartProgress(EtcEstimator::Phase::TimeLag);
         main_progress_timer_.restart(); // restart to measure time lag run time
-
         errorEdit_->append(QStringLiteral("Performing time-lag optimization"));
-
         return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Importing data for")))
+    case Message::ImportingData:
     {
         QString dateStr = QLatin1String(cleanLine.mid(21).constData());
-        currentTimeLagDate = QDate::fromString(dateStr.trimmed(),
-                                                 QStringLiteral("dd MMMM yyyy"));
-        qDebug() << "currentTimeLagDate: " << currentTimeLagDate;
-
+        currentTimeLagDate_ = QDate::fromString(dateStr.trimmed(),
+                                                QStringLiteral("dd MMMM yyyy"));
         fileProgressLabel_->setText(QStringLiteral("Importing data"));
         return;
     }
-    if (cleanLine.contains(QByteArrayLiteral("another small step to the time-lag")))
-    {
-        auto timeStr = QLatin1String(cleanLine.trimmed().split(' ')
-                                     .last().trimmed().constData());
-        qDebug() << "timeStr: " << timeStr;
-
-        auto currentTimeLagTime = QTime::fromString(timeStr, QStringLiteral("hh:mm"));
-        qDebug() << "currentTimeLagTime: " << currentTimeLagTime;
-
-        QDateTime fromDate(currentTimeLagDate, currentTimeLagTime
-                           .addSecs(-ecProject_->screenAvrgLen() * 60));
-        fromStr = fromDate.toString(Qt::ISODate).replace(QLatin1String("T"), QLatin1String(" "));
-        QDateTime toDate(currentTimeLagDate, currentTimeLagTime);
-        toStr = toDate.toString(Qt::ISODate);
-        qDebug() << "fromStr: " << fromStr;
-        qDebug() << "toStr: " << toStr;
-
-        avgPeriodLabel_->setText(tr("Averaging interval, From: %1, To: %2")
-                            .arg(fromStr)
-                            .arg(toStr));
-        auto avgPeriod = avgPeriodLabel_->text();
-        errorEdit_->append(avgPeriod.prepend(QStringLiteral("<font color=\"#A6D7F2\">"))
-                                    .append(QStringLiteral("</font>")));
-
-        ++averagingPeriodIndex;
-
-        mini_progress_bar_->setValue(0);
-        mini_progress_bar_->reset();
-        main_progress_bar->setValue(++progressValue_);
-
-        // ETC computation
-        current_step_elapsed_time = main_progress_timer_.elapsed();
-        processingTimeMSec = static_cast<int>(current_step_elapsed_time - previous_elapsed_time);
-
-        estimatedTimeToCompletionMSec = updateETC(&meanProcessingTimeMSec, processingTimeMSec,
-                                                  averagingPeriodIndex, totalAveragingPeriods);
-
-        auto estimatedTimeToCompletionMSecStr = QTime(0, 0)
-                            .addMSecs(estimatedTimeToCompletionMSec)
-                            .toString(QStringLiteral("hh:mm:ss.zzz"));
-#ifdef QT_DEBUG
-        out << "Time-lag ETC computation";
-        endl(out);
-        out << "averagingPeriodIndex " << averagingPeriodIndex << " totalRuns " << totalAveragingPeriods;
-        endl(out);
-        out << "current_step_elapsed_time " << current_step_elapsed_time;
-        out << " processingTimeMSec " << processingTimeMSec;
-        out << " previous_elapsed_time " << previous_elapsed_time;
-        endl(out);
-        out << "estimatedTimeToCompletionMSec " << estimatedTimeToCompletionMSec;
-        out << " estimatedTimeToCompletionMSecStr " << estimatedTimeToCompletionMSecStr;
-        endl(out);
-#endif
-        previous_elapsed_time = current_step_elapsed_time;
-
-        timeEstimateLabels_->setText(timeEstimateLabels_->text()
-                                    .replace(61, 12, estimatedTimeToCompletionMSecStr));
+    case Message::TimeLagStep:
+        parseSmallStep(cleanLine, currentTimeLagDate_);
         return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Time lag optimization session terminated")))
-    {
+    case Message::TimeLagEnd:
         inTimeLag_ = false;
         main_progress_bar->setValue(main_progress_bar->maximum());
-        qDebug() << "progressValue_" << progressValue_;
-        previous_elapsed_time = 0;
+        previousElapsedTime_ = 0;
         return;
-    }
     // end time lag
 
     // start raw data processing
-    if (cleanLine.contains(QByteArrayLiteral("Start raw data processing")))
-    {
-        inCycle = true;
+    case Message::RawProcessingStart:
         progressLabel_->setText(tr("Processing raw data..."));
-
         main_progress_timer_.restart(); // restart to measure main cycle run time
-
         errorEdit_->append(QStringLiteral("Start raw data processing"));
-
-        // re-init
-        averagingPeriodIndex = 0;
-        totalAveragingPeriods = 0;
-        processingTimeMSec = 0;
-        meanProcessingTimeMSec = 0;
-        elapsedTimeMSec = 0;
-        estimatedTimeToCompletionMSec = 0;
-        resetProgressSoft();
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        fromStr.clear();
-        toStr.clear();
-
-#ifdef QT_DEBUG
-        out << "Start raw data processing";
-        endl(out);
-        elapsedTimeMSecStr = QTime(0, 0).addMSecs(static_cast<int>(overall_progress_timer_.elapsed()))
-                                    .toString(QStringLiteral("hh:mm:ss.zzz"));
-        out << averagingPeriodIndex << " "
-            << "x "
-            << "x "
-            << overall_progress_timer_.elapsed() << " "
-            << elapsedTimeMSecStr << " "
-            << "x "
-            << "x ";
-        endl(out);
-#endif
+        restartProgress(EtcEstimator::Phase::RawProcessing);
         return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("From:")))
-    {
-        fromStr = QLatin1String(cleanLine.mid(7, 16).constData());
-        qDebug() << "fromStr: " << fromStr;
+    case Message::From:
+        fromStr_ = QLatin1String(cleanLine.mid(7, 16).constData());
         return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("To:")))
-    {
-        toStr = QLatin1String(cleanLine.mid(7, 16).constData());
-        qDebug() << "toStr: " << toStr;
-
-        avgPeriodLabel_->setText(tr("Averaging interval, From: %1, To: %2")
-                            .arg(fromStr)
-                            .arg(toStr));
-        auto avgPeriod = avgPeriodLabel_->text();
-        errorEdit_->append(avgPeriod.prepend(QStringLiteral("<font color=\"#A6D7F2\">"))
-                                    .append(QStringLiteral("</font>")));
-
+    case Message::To:
+        toStr_ = QLatin1String(cleanLine.mid(7, 16).constData());
+        showAveragingInterval(true);
         return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Total number of flux averaging periods")))
-    {
-        totalAveragingPeriods = cleanLine.trimmed().trimmed().split(':').last().trimmed().toInt();
-        qDebug() << "totalRuns" << totalAveragingPeriods;
-        main_progress_bar->setMaximum(totalAveragingPeriods * 8 + 1);
+    case Message::TotalAveragingPeriods:
+        totalAveragingPeriods_ = cleanLine.trimmed().split(':').last().trimmed().toInt();
+        qDebug() << "totalRuns" << totalAveragingPeriods_;
+        etc_.setTotal(totalAveragingPeriods_);
+        main_progress_bar->setMaximum(totalAveragingPeriods_ * 8 + 1);
         return;
-    }
     // start processing cycle
-    if (cleanLine.contains(QByteArrayLiteral("processing new flux averaging period")))
-    {
-        ++averagingPeriodIndex;
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-
-#ifdef QT_DEBUG
-        out << ">> Processing new flux averaging period";
-        endl(out);
-        elapsedTimeMSecStr = QTime(0, 0).addMSecs(static_cast<int>(overall_progress_timer_.elapsed()))
-                                    .toString(QStringLiteral("hh:mm:ss.zzz"));
-        out << averagingPeriodIndex << " "
-            << "x "
-            << "x "
-            << overall_progress_timer_.elapsed() << " "
-            << elapsedTimeMSecStr << " "
-            << "x "
-            << "x ";
-        endl(out);
-#endif
-
-        currentFileList.clear();
-
-        return;
-    }
-
-    if (cleanLine.contains(QByteArrayLiteral("File(s): ..")))
-    {
-        qDebug() << "fromToStr: " << fromStr << toStr;
-        qDebug() << "averagingPeriodIndex: " << averagingPeriodIndex;
+    case Message::NewAveragingPeriod:
+        ++averagingPeriodIndex_;
+        profiler_.startPeriod(averagingPeriodIndex_);
+        periodStartTime_ = main_progress_timer_.elapsed();
+        stepProgress();
+        currentFileList_.clear();
+        return;
+    case Message::FileList:
         mini_progress_bar_->setValue(1);
-        avgPeriodLabel_->setText(tr("Averaging interval, From: %1, To: %2")
-                            .arg(fromStr)
-                            .arg(toStr));
+        showAveragingInterval(false);
 
         fileProgressLabel_->setText(tr("Parsing file"));
 
-        currentFileList.append(QLatin1String(cleanLine.trimmed().split('\\')
-                                             .last().trimmed().constData()));
+        currentFileList_.append(QLatin1String(cleanLine.trimmed().split('\\')
+                                              .last().trimmed().constData()));
         fileListLabel_->setText(QStringLiteral("File(s): %1")
-                                .arg(currentFileList.join(QLatin1Char('\n'))));
+                                .arg(currentFileList_.join(QLatin1Char('\n'))));
         return;
-    }
-
-    if (cleanLine.contains((QByteArrayLiteral("Skipping to next averaging period"))))
-    {
-        qDebug() << "fromToStr: " << fromStr << toStr;
-        qDebug() << "averagingPeriodIndex: " << averagingPeriodIndex;
-        main_progress_bar->setValue(++progressValue_);
-        avgPeriodLabel_->setText(tr("Averaging interval, From: %1, To: %2")
-                            .arg(fromStr)
-                            .arg(toStr));
-
-#ifdef QT_DEBUG
-        out << "Skipping to next averaging period";
-        endl(out);
-#endif
+    case Message::SkippingPeriod:
+        profiler_.endPeriod();
+        etc_.skipPeriod(main_progress_timer_.elapsed() - periodStartTime_);
+        showTimeToCompletion();
+        stepProgress();
+        showAveragingInterval(false);
         return;
-    }
-
-    if (cleanLine.contains(QByteArrayLiteral("..\\")))
-    {
-        currentFileList.append(QLatin1String(cleanLine.trimmed().split('\\')
-                                             .last().trimmed().constData()));
+    case Message::FileContinuation:
+        currentFileList_.append(QLatin1String(cleanLine.trimmed().split('\\')
+                                              .last().trimmed().constData()));
         return;
-    }
-
-    if (cleanLine.contains(QByteArrayLiteral("Number of samples")))
-    {
-        qDebug() << "progressValue_" << progressValue_;
+    case Message::NumberOfSamples:
         mini_progress_bar_->setValue(2);
-
         fileListLabel_->setText(QStringLiteral("File(s): %1")
-                                .arg(currentFileList.join(QLatin1Char('\n'))));
-        return;
-    }
-
-    if (cleanLine.contains(QByteArrayLiteral("Calculating statistics..")))
-    {
-        mini_progress_bar_->setValue(3);
-        fileProgressLabel_->setText(tr("Calculating statistics"));
-
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Raw level statistical screening")))
-    {
-        mini_progress_bar_->setValue(4);
-        fileProgressLabel_->setText(tr("Raw level statistical screening"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Spike detection/removal test")))
-    {
-        mini_progress_bar_->setValue(5);
-        fileProgressLabel_->setText(tr("Spike detection/removal"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Spike detection/removal test")))
-    {
-        mini_progress_bar_->setValue(6);
-        fileProgressLabel_->setText(tr("Spike detection/removal test"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Absolute limits test")))
-    {
-        mini_progress_bar_->setValue(7);
-        fileProgressLabel_->setText(tr("Absolute limits test"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Skewness & kurtosis test")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-
-        mini_progress_bar_->setValue(8);
-        fileProgressLabel_->setText(tr("Skewness & kurtosis test"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Despiking user set")))
-    {
-        mini_progress_bar_->setValue(9);
-        fileProgressLabel_->setText(tr("Despiking user set"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Cross-wind correction")))
-    {
-        mini_progress_bar_->setValue(10);
-        fileProgressLabel_->setText(tr("Cross-wind correction"));
+                                .arg(currentFileList_.join(QLatin1Char('\n'))));
         return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Converting into mixing ratio")))
-    {
-        mini_progress_bar_->setValue(11);
-        fileProgressLabel_->setText(tr("Converting into mixing ratio"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Performing tilt correction")))
-    {
-        mini_progress_bar_->setValue(12);
-        fileProgressLabel_->setText(tr("Performing tilt correction"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Compensating time lags")))
-    {
-        mini_progress_bar_->setValue(13);
-        fileProgressLabel_->setText(tr("Compensating time lags"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Compensating user variables")))
-    {
-        mini_progress_bar_->setValue(14);
-        fileProgressLabel_->setText(tr("Compensating user variables"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Performing stationarity test")))
-    {
-        mini_progress_bar_->setValue(15);
-        fileProgressLabel_->setText(tr("Performing stationarity test"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Detrending")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-
-        mini_progress_bar_->setValue(16);
-        fileProgressLabel_->setText(tr("Detrending"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Calculating (co)spectra")))
-    {
-        mini_progress_bar_->setValue(17);
-        fileProgressLabel_->setText(tr("Calculating (co)spectra"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Tapering timeseries")))
-    {
-        mini_progress_bar_->setValue(18);
-        fileProgressLabel_->setText(tr("Tapering timeseries"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("FFT-ing")))
-    {
-        mini_progress_bar_->setValue(19);
-        fileProgressLabel_->setText(tr("FFT-ing"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Cospectral densities")))
-    {
-        mini_progress_bar_->setValue(20);
-        fileProgressLabel_->setText(tr("Cospectral densities"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Calculating fluxes Level 0")))
-    {
-        mini_progress_bar_->setValue(21);
-        fileProgressLabel_->setText(tr("Calculating fluxes Level 0"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Calculating fluxes Level 1")))
-    {
-        mini_progress_bar_->setValue(22);
-        fileProgressLabel_->setText(tr("Calculating fluxes Level 1"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Calculating fluxes Level 2")))
-    {
-        mini_progress_bar_->setValue(23);
-        fileProgressLabel_->setText(tr("Calculating fluxes Level 2 and 3"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Estimating footprint")))
-    {
-        mini_progress_bar_->setValue(24);
-        fileProgressLabel_->setText(tr("Estimating footprint"));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Calculating quality flags")))
-    {
+    case Message::QualityFlags:
+        profiler_.enterStage(QStringLiteral("quality_flags"));
         mini_progress_bar_->setValue(mini_progress_bar_->maximum());
         fileProgressLabel_->setText(tr("Calculating quality flags"));
         return;
-    }
-
     // end processing cycle
-    if (cleanLine.contains(QByteArrayLiteral("Flux averaging period processing time")))
+    case Message::PeriodProcessingTime:
     {
+        profiler_.endPeriod();
+
         // ETC computation
         auto procTimeString = QLatin1String(cleanLine.trimmed().split(' ')
                                             .last().trimmed().constData());
-        qDebug() << "procTimeString" << procTimeString;
         auto procTime = QTime::fromString(procTimeString, QStringLiteral("h:mm:ss.zzz"));
-        processingTimeMSec = QTime(0, 0).msecsTo(procTime);
-
-        // prevent division by zero
-        if (averagingPeriodIndex == 0) ++averagingPeriodIndex;
-
-        estimatedTimeToCompletionMSec = updateETC(&meanProcessingTimeMSec,
-                                                  processingTimeMSec,
-                                                  averagingPeriodIndex,
-                                                  totalAveragingPeriods);
-
-        auto estimatedTimeToCompletionMSecStr = QTime(0, 0)
-                            .addMSecs(estimatedTimeToCompletionMSec)
-                            .toString(QStringLiteral("hh:mm:ss.zzz"));
-
-        timeEstimateLabels_->setText(timeEstimateLabels_->text()
-                                    .replace(61, 12, estimatedTimeToCompletionMSecStr));
-
-#ifdef QT_DEBUG
-        out << "Flux averaging period processing time";
-        endl(out);
-        elapsedTimeMSec = averagingPeriodIndex * meanProcessingTimeMSec;
-        elapsedTimeMSecStr = QTime(0, 0).addMSecs(elapsedTimeMSec)
-                                .toString(QStringLiteral("hh:mm:ss.zzz"));
-        out << averagingPeriodIndex << " "
-            << processingTimeMSec << " "
-            << meanProcessingTimeMSec << " "
-            << elapsedTimeMSec << " "
-            << elapsedTimeMSecStr << " "
-            << estimatedTimeToCompletionMSec << " "
-            << estimatedTimeToCompletionMSecStr;
-        endl(out);
-#endif
-
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
+        etc_.addPeriod(QTime(0, 0).msecsTo(procTime));
+        showTimeToCompletion();
+
+        stepProgress();
 
         mini_progress_bar_->reset();
         mini_progress_bar_->setValue(0);
@@ -1320,16 +1073,11 @@ void RunPage::parseEngineOutput(const QByteArray &data)
         return;
     }
     // end raw data processing
-    if (cleanLine.contains(QByteArrayLiteral("Raw data processing terminated")))
-    {
-        inCycle = false;
-
+    case Message::RawProcessingEnd:
         errorEdit_->append(QStringLiteral("Raw data processing terminated"));
-
         return;
-    }
     // get essential file path
-    if (cleanLine.contains(QByteArrayLiteral("Essentials file path:")))
+    case Message::EssentialsFile:
     {
         auto ex_file_path_ = QString();
         QByteArrayList path_components = cleanLine.trimmed().split(':');
@@ -1346,91 +1094,55 @@ void RunPage::parseEngineOutput(const QByteArray &data)
             auto full_path_ = path_components.mid(1).join(':');
             ex_file_path_ = QLatin1String(full_path_.trimmed().constData());
         }
-        ecProject_->setSpectraExFile(ex_file_path_);
+        emit essentialsFileReported(ex_file_path_);
         return;
     }
 
     // start flux computation
-    if (cleanLine.contains(QByteArrayLiteral("Starting flux computation and correction")))
-    {
+    case Message::FluxComputationStart:
         progressLabel_->setText(tr("Starting flux computation and correction..."));
         resetProgressSoft();
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Initializing retrieval of EddyPro-RP results")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
+        stepProgress();
         return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("File found, importing content")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
+    case Message::RetrievingRpResults:
+    case Message::FileFound:
+        stepProgress();
         return;
-    }
     // end flux computation
 
     // start spectral corrections
-    if (cleanLine.contains(QByteArrayLiteral("Starting Spectral Assessment")))
+    case Message::SpectralAssessmentStart:
     {
-//        resetTimeEstimateLabels();
         progressLabel_->setText(tr("Performing spectral assessment..."));
 
         QDate dStart(QDate::fromString(ecProject_->spectraStartDate(), Qt::ISODate));
         QDate dEnd(QDate::fromString(ecProject_->spectraEndDate(), Qt::ISODate));
         resetProgressSoft();
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
+        stepProgress();
         main_progress_bar->setMaximum(static_cast<int>(dStart.daysTo(dEnd)) + 1);
         return;
     }
-    if (cleanLine.contains(QByteArrayLiteral("Importing binned (co)spectra for")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        avgPeriodLabel_->setText(QLatin1String(cleanLine.trimmed().constData()));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Fitting model")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        avgPeriodLabel_->setText(QLatin1String(cleanLine.trimmed().constData()));
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Sorting")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
+    case Message::ImportingBinnedSpectra:
+    case Message::FittingModel:
+    case Message::Sorting:
+        stepProgress();
         avgPeriodLabel_->setText(QLatin1String(cleanLine.trimmed().constData()));
         return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Spectral Assessment session terminated")))
-    {
+    case Message::SpectralAssessmentEnd:
         main_progress_bar->setValue(main_progress_bar->maximum());
-        qDebug() << "progressValue_" << progressValue_;
         return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Calculating fluxes for:")))
-    {
+    case Message::CalculatingFluxesFor:
         resetProgressSoft();
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
+        stepProgress();
         return;
-    }
-    // start spectral corrections
+    // end spectral corrections
 
     // start finalizing output files
-    if (cleanLine.contains(QByteArrayLiteral("Raw data processing terminated. "
-                                      "Creating continuous datasets if necessary")))
+    case Message::FinalizingOutputs:
     {
-//        resetTimeEstimateLabels();
         progressLabel_->setText(tr("Finalizing output files..."));
         resetProgressSoft();
-        main_progress_bar->setValue(++progressValue_);
+        stepProgress();
 
         int maxSteps = 0;
 
@@ -1459,174 +1171,129 @@ void RunPage::parseEngineOutput(const QByteArray &data)
                         + ecProject_->screenOutDetails();
         }
         main_progress_bar->setMaximum(maxSteps);
-        qDebug() << "progressValue_" << progressValue_;
-
-#ifdef QT_DEBUG
-        out << "Raw data processing terminated";
-        endl(out);
-        elapsedTimeMSecStr = QTime(0, 0).addMSecs(static_cast<int>(overall_progress_timer_.elapsed()))
-                                    .toString(QStringLiteral("hh:mm:ss.zzz"));
-        out << averagingPeriodIndex << " "
-            << "x "
-            << "x "
-            << overall_progress_timer_.elapsed() << " "
-            << elapsedTimeMSecStr << " "
-            << "x "
-            << "x ";
-        endl(out);
-#endif
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Creating Full Output dataset")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Creating GHG-EUROPE-style dataset")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Creating Metadata dataset")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Creating Level")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Creating Biomet dataset")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-        return;
-    }
-    if (cleanLine.contains(QByteArrayLiteral("Closing COMMON output files")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
         return;
     }
-    if (cleanLine.contains(QByteArrayLiteral("Closing RP output files")))
-    {
-        main_progress_bar->setValue(++progressValue_);
-        qDebug() << "progressValue_" << progressValue_;
-
-#ifdef QT_DEBUG
-        out << "Closing RP output files";
-        endl(out);
-        elapsedTimeMSecStr = QTime(0, 0).addMSecs(static_cast<int>(overall_progress_timer_.elapsed()))
-                                    .toString(QStringLiteral("hh:mm:ss.zzz"));
-        out << averagingPeriodIndex << " "
-            << "x "
-            << "x "
-            << overall_progress_timer_.elapsed() << " "
-            << elapsedTimeMSecStr << " "
-            << "x "
-            << "x ";
-        endl(out);
-#endif
+    case Message::FullOutputDataset:
+    case Message::GhgEuropeDataset:
+    case Message::MetadataDataset:
+    case Message::LevelDataset:
+    case Message::BiometDataset:
+    case Message::ClosingCommonFiles:
+    case Message::ClosingRpFiles:
+        stepProgress();
         return;
-    }
     // end finalizing output files
 
     // engine run possible endings
-    if (cleanLine.contains(QByteArrayLiteral("gracefully")))
-    {
+    case Message::Gracefully:
+        saveStageProfile();
         main_progress_bar->setValue(main_progress_bar->maximum());
         progressWidget_->stopAnimation();
-        averagingPeriodIndex = 0;
+        averagingPeriodIndex_ = 0;
         total_elapsed_update_timer_->stop();
         main_progress_timer_.invalidate();
         return;
+
+    default:
+        break;
     }
 
-    if (cleanLine.contains(QByteArrayLiteral("At line"))
-        || cleanLine.contains(QByteArrayLiteral("Fortran runtime error")))
+    auto flags = line.flags;
+    if (flags & (EngineOutput::AtLine | EngineOutput::FortranRuntimeError))
     {
         cleanLine.prepend("Critical> ");
+        flags |= EngineOutput::Critical;
+    }
+
+    const quint32 severityFlags = EngineOutput::Alert
+                                  | EngineOutput::Warning
+                                  | EngineOutput::Error
+                                  | EngineOutput::Critical
+                                  | EngineOutput::FatalError;
+    if (!(flags & severityFlags))
+    {
+        return;
     }
 
-    qDebug() << "cleanline" << cleanLine.trimmed().constData();
-    if (cleanLine.contains(QByteArrayLiteral("Alert"))
-        || cleanLine.contains(QByteArrayLiteral("Warning"))
-        || cleanLine.contains(QByteArrayLiteral("Error"))
-        // runtime errors
-        || cleanLine.contains(QByteArrayLiteral("Critical"))
-        || cleanLine.contains(QByteArrayLiteral("Fatal error")))
+    // warnings not shown
+    if ((flags & EngineOutput::Warning) && (flags & EngineOutput::SuppressedWarning))
     {
-        // color the labels
-        auto tag = cleanLine.mid(0, cleanLine.indexOf('>') + 1);
-        qDebug() << "tag" << tag;
+        return;
+    }
 
-        auto htmlTag = tag;
-        htmlTag.append(QByteArrayLiteral("</font>"));
-        qDebug() << "htmlTag" << htmlTag;
+    // color the labels
+    auto tag = cleanLine.mid(0, cleanLine.indexOf('>') + 1);
 
-        if (cleanLine.contains(QByteArrayLiteral("Alert"))
-            && cleanLine.contains(QByteArrayLiteral("Error")))
-        {
-            // blue
-            cleanLine.replace(tag, htmlTag.prepend(QByteArrayLiteral("<font color=\"#0066FF\">")));
+    auto htmlTag = tag;
+    htmlTag.append(QByteArrayLiteral("</font>"));
 
-            goto SKIP;
-        }
-        if (cleanLine.contains(QByteArrayLiteral("Alert")))
+    if ((flags & EngineOutput::Alert) && (flags & EngineOutput::Error))
+    {
+        // blue
+        cleanLine.replace(tag, htmlTag.prepend(QByteArrayLiteral("<font color=\"#0066FF\">")));
+    }
+    else
+    {
+        if (flags & EngineOutput::Alert)
         {
             // blue
             cleanLine.replace(tag, htmlTag.prepend(QByteArrayLiteral("<font color=\"#0066FF\">")));
         }
-        if (cleanLine.contains(QByteArrayLiteral("Warning")))
+        if (flags & EngineOutput::Warning)
         {
-            if (cleanLine.contains(QByteArrayLiteral("(80)"))
-                || cleanLine.contains(QByteArrayLiteral("(81)"))
-                || cleanLine.contains(QByteArrayLiteral("(82)"))
-                || cleanLine.contains(QByteArrayLiteral("(83)"))
-                || cleanLine.contains(QByteArrayLiteral("(84)"))
-                || cleanLine.contains(QByteArrayLiteral("(85)")))
-            {
-                cleanLine.clear();
-            }
-
             // yellow
             cleanLine.replace(tag, htmlTag.prepend(QByteArrayLiteral("<font color=\"#FFFF00\">")));
         }
-        if (cleanLine.contains(QByteArrayLiteral("Error")))
+        if (flags & EngineOutput::Error)
         {
             // orange
             cleanLine.replace(tag, htmlTag.prepend(QByteArrayLiteral("<font color=\"#FF9900\">")));
         }
-        if (cleanLine.contains(QByteArrayLiteral("Critical"))
-            || cleanLine.contains(QByteArrayLiteral("Fatal error"))
-            || cleanLine.contains(QByteArrayLiteral("At line"))
-            || cleanLine.contains(QByteArrayLiteral("Fortran runtime error")))
+        if (flags & (EngineOutput::Critical | EngineOutput::FatalError))
         {
             // red
             cleanLine.replace(tag, htmlTag.prepend(QByteArrayLiteral("<font color=\"#FF3300\">")));
-            qDebug() << "replace tag" << tag;
-        }
-SKIP:
-        QString clearedStr = QLatin1String(cleanLine.trimmed().constData());
-        if (!clearedStr.isEmpty())
-        {
-            errorEdit_->append(clearedStr);
         }
+    }
 
-        if (cleanLine.contains(QByteArrayLiteral("Fatal"))
-            || cleanLine.contains(QByteArrayLiteral("aborted")))
-        {
-            stopRun();
-            averagingPeriodIndex = 0;
-        }
+    QString clearedStr = QLatin1String(cleanLine.trimmed().constData());
+    if (!clearedStr.isEmpty())
+    {
+        errorEdit_->append(clearedStr);
+    }
+
+    if (flags & (EngineOutput::Fatal | EngineOutput::Aborted))
+    {
+        stopRun();
+        averagingPeriodIndex_ = 0;
+    }
+}
 
+// next to the outputs of the run, if the engine processed any period
+void RunPage::saveStageProfile()
+{
+    if (profiler_.periodCount() == 0)
+    {
         return;
     }
+
+    const auto outPath = ecProject_->generalOutPath();
+    if (!outPath.isEmpty() && QDir(outPath).exists())
+    {
+        const auto prefix = outPath
+                            + QStringLiteral("/eddypro_")
+                            + ecProject_->generalId()
+                            + QStringLiteral("_stage_");
+        const auto timestamp = QDateTime::currentDateTime()
+                               .toString(QStringLiteral("yyyy-MM-ddThhmmss"));
+        if (profiler_.writeReport(prefix + QStringLiteral("profile_") + timestamp + QStringLiteral(".txt"),
+                                  prefix + QStringLiteral("timings_") + timestamp + QStringLiteral(".csv"),
+                                  ecProject_->generalId()))
+        {
+            errorEdit_->append(tr("Stage timing profile saved in %1").arg(QDir::toNativeSeparators(outPath)));
+        }
+    }
+    profiler_.clear();
 }
 
 void RunPage::runModeIconClicked()
@@ -1642,9 +1309,8 @@ void RunPage::updateSmartfluxBar()
 void RunPage::updateElapsedTime()
 {
     DEBUG_FUNC_NAME
-    QString elapsedTimeStr = QTime(0, 0).addMSecs(static_cast<int>(overall_progress_timer_.elapsed()))
-                                        .toString(QStringLiteral("hh:mm:ss"));
-    timeEstimateLabels_->setText(timeEstimateLabels_->text().replace(20, 8, elapsedTimeStr));
+    elapsedTimeStr_ = formatDuration(overall_progress_timer_.elapsed());
+    showTimeEstimates();
 }
 
 // Update mini progress bar every second, scaling the speed of progress in respect of the
@@ -1665,32 +1331,6 @@ void RunPage::updateMiniProgress()
     }
 }
 
-// Return ETC (Estimated Time to Completion) in msec and update the running average
-// of the processing time using a Simple Moving Average
-int RunPage::updateETC(int* mean_processing_time,
-                       const int current_processing_time,
-                       const int index,
-                       const int num_steps)
-{
-    qDebug() << "mean_processing_time" << *mean_processing_time
-             << "current_processing_time" << current_processing_time
-             << "index" << index
-             << "num_steps" << num_steps;
-
-    Q_ASSERT(index != 0);
-
-    if (index == 1)
-    {
-        *mean_processing_time = current_processing_time;
-    }
-    else
-    {
-        *mean_processing_time = (*mean_processing_time * (index - 1) + current_processing_time)
-                                / index;
-    }
-    return (num_steps - index + 1) * (*mean_processing_time);
-}
-
 void RunPage::openOutputDir()
 {
     QDesktopServices::openUrl(QUrl::fromLocalFile(ecProject_->generalOutPath()));
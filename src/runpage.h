@@ -23,11 +23,17 @@
 #ifndef RUNPAGE_H
 #define RUNPAGE_H
 
+#include <QDate>
 #include <QElapsedTimer>
+#include <QStringList>
 #include <QWidget>
 
 #include "configstate.h"
 #include "defs.h"
+#include "engineoutput.h"
+#include "engineprogress.h"
+#include "etcestimator.h"
+#include "stageprofiler.h"
 
 class QLabel;
 class QProgressBar;
@@ -57,11 +63,13 @@ public:
 public slots:
     void resetBuffer();
     void bufferData(QByteArray &data);
+    void bufferProgress(QByteArray &data);
 
 signals:
     void updateConsoleLineRequest(QByteArray &data);
     void updateConsoleCharRequest(QByteArray &data);
     void pauseRequest(Defs::CurrRunStatus mode);
+    void essentialsFileReported(const QString& path);
 
 private slots:
     void pauseLabel();
@@ -72,19 +80,23 @@ private slots:
     void openOutputDir();
 
 private:
-    bool filterData(const QByteArray &data);
-    QByteArray cleanupEngineOutput(QByteArray data);
-    void parseEngineOutput(const QByteArray& data);
+    bool filterData(const EngineOutput::Line& line);
+    QByteArray cleanupEngineOutput(QByteArray data, EngineOutput::Line* line);
+    void parseEngineOutput(const QByteArray& data, const EngineOutput::Line& line);
+    void applyProgressEvent(const EngineProgress::Event& event);
+    void parseSmallStep(const QByteArray& cleanLine, const QDate& date);
+    void restartProgress(EtcEstimator::Phase phase);
+    void stepProgress();
+    void showAveragingInterval(bool toErrorEdit);
+    void showTimeToCompletion();
+    void showTimeEstimates();
+    void saveStageProfile();
     void resetProgressSoft();
     void resetProgressHard();
     void doneLabel();
     void resetLabels();
     void resetFileLabels();
     void resetTimeEstimateLabels();
-    int updateETC(int *mean_processing_time,
-                  const int current_processing_time,
-                  const int index,
-                  const int num_steps);
 
     Defs::CurrRunStatus runMode_;
     QProgressIndicator* progressWidget_;
@@ -103,7 +115,8 @@ private:
     EcProject* ecProject_;
     ConfigState* configState_;
     int progressValue_;
-    QByteArray rxBuffer_;
+    EngineOutput::LineSplitter rxBuffer_;
+    EngineOutput::LineSplitter progressBuffer_;
     QTextEdit* errorEdit_;
 
     QTimer* pauseResumeDelayTimer_;        // delay and control the pause/resume operations
@@ -115,6 +128,28 @@ private:
 
     bool inPlanarFit_ = false;
     bool inTimeLag_ = false;
+
+    // engine output parsing state
+    int averagingPeriodIndex_ = 0;
+    int totalAveragingPeriods_ = 0;
+    qint64 previousElapsedTime_ = 0;
+    qint64 periodStartTime_ = 0;
+    QString fromStr_;
+    QString toStr_;
+    QStringList currentFileList_;
+    QDate currentPlanarFitDate_;
+    QDate currentTimeLagDate_;
+
+    // the engine sends structured progress events, see EngineProgress
+    bool structuredProgress_ = false;
+
+    // estimated time to completion of the current phase
+    EtcEstimator etc_;
+    QString elapsedTimeStr_;
+    QString timeToCompletionStr_;
+
+    // time of the processing stages of each averaging period
+    StageProfiler profiler_;
 };
 
 #endif // RUNPAGE_H
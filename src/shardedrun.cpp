@@ -0,0 +1,176 @@
+/***************************************************************************
+  shardedrun.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "shardedrun.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+
+#include "incrementalrun.h"
+
+namespace
+{
+const auto SHARD_DIR_PREFIX = QStringLiteral(".eddypro_shard_");
+
+// move the content of srcDir in dstDir. the files of a series, with a run
+// timestamp in the name, are appended to the file of the same series
+// already merged, if any
+void mergeDir(const QString& srcDir,
+              const QString& dstDir,
+              const QString& relativeDir,
+              QHash<QString, QString>* series,
+              QStringList* failedFiles)
+{
+    QDir().mkpath(dstDir);
+
+    const auto entries = QDir(srcDir).entryInfoList(QDir::Files
+                                                    | QDir::Dirs
+                                                    | QDir::NoDotAndDotDot,
+                                                    QDir::Name);
+    foreach (const QFileInfo& entry, entries)
+    {
+        const auto name = entry.fileName();
+        const QString relativeName = relativeDir + QLatin1Char('/') + name;
+        const QString target = dstDir + QLatin1Char('/') + name;
+
+        if (entry.isDir())
+        {
+            mergeDir(entry.absoluteFilePath(), target, relativeName, series, failedFiles);
+            continue;
+        }
+
+        const auto pattern = IncrementalRun::outputNamePattern(name);
+        const QString key = relativeDir + QLatin1Char('/') + pattern;
+        const auto isSeries = (pattern != name);
+
+        if (isSeries && series->contains(key))
+        {
+            if (IncrementalRun::appendOutputRows(series->value(key), entry.absoluteFilePath()))
+            {
+                QFile::remove(entry.absoluteFilePath());
+            }
+            else
+            {
+                failedFiles->append(relativeName);
+            }
+            continue;
+        }
+
+        // same behavior of the engine, which overwrites its files
+        if (QFile::exists(target))
+        {
+            QFile::remove(target);
+        }
+        if (!QFile::rename(entry.absoluteFilePath(), target))
+        {
+            failedFiles->append(relativeName);
+            continue;
+        }
+
+        if (isSeries)
+        {
+            series->insert(key, target);
+        }
+    }
+}
+} // namespace
+
+QVector<FileUtils::DateRange> ShardedRun::split(const QDateTime& from,
+                                                const QDateTime& to,
+                                                int n,
+                                                int avrgLen)
+{
+    QVector<FileUtils::DateRange> shards;
+    if (!from.isValid() || !to.isValid() || from >= to || n < 1 || avrgLen <= 0)
+    {
+        return shards;
+    }
+
+    // start of the averaging period containing 'from'
+    const auto periodSecs = static_cast<qint64>(avrgLen) * 60;
+    const QDateTime midnight(from.date(), QTime(0, 0));
+    const auto firstStart = midnight.addSecs((midnight.secsTo(from) / periodSecs) * periodSecs);
+
+    const auto periodCount = (firstStart.secsTo(to) + periodSecs - 1) / periodSecs;
+    const auto perShard = (periodCount + n - 1) / n;
+
+    auto shardFrom = from;
+    for (auto i = 1; shardFrom < to; ++i)
+    {
+        auto shardTo = firstStart.addSecs(i * perShard * periodSecs);
+        if (shardTo > to)
+        {
+            shardTo = to;
+        }
+        shards.append(qMakePair(shardFrom, shardTo));
+        shardFrom = shardTo;
+    }
+
+    qDebug() << "shards" << shards;
+    return shards;
+}
+
+QString ShardedRun::shardDir(const QString& outPath, int shard)
+{
+    return outPath + QLatin1Char('/') + SHARD_DIR_PREFIX + QString::number(shard);
+}
+
+bool ShardedRun::mergeOutputs(const QStringList& shardDirs,
+                              const QString& outPath,
+                              QString* errorString)
+{
+    QHash<QString, QString> series;
+    QStringList failedFiles;
+
+    foreach (const QString& dir, shardDirs)
+    {
+        if (QFileInfo(dir).isDir())
+        {
+            mergeDir(dir, outPath, QString(), &series, &failedFiles);
+        }
+        FileUtils::removeDirRecursively(dir);
+    }
+
+    qDebug() << "merged" << shardDirs.size() << "shards, failed" << failedFiles;
+
+    if (errorString)
+    {
+        *errorString = failedFiles.join(QStringLiteral(", "));
+    }
+    return failedFiles.isEmpty();
+}
+
+void ShardedRun::removeShardDirs(const QString& outPath)
+{
+    const QStringList nameFilter(SHARD_DIR_PREFIX + QLatin1Char('*'));
+    const auto dirs = QDir(outPath).entryInfoList(nameFilter,
+                                                  QDir::Dirs
+                                                  | QDir::Hidden
+                                                  | QDir::NoDotAndDotDot);
+    foreach (const QFileInfo& dir, dirs)
+    {
+        FileUtils::removeDirRecursively(dir.absoluteFilePath());
+    }
+}
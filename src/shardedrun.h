@@ -0,0 +1,78 @@
+/***************************************************************************
+  shardedrun.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef SHARDEDRUN_H
+#define SHARDEDRUN_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "fileutils.h"
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/shardedrun.h
+/// \brief Split of a run in date shards processed in parallel
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note The processing date range is split in contiguous shards made of
+/// whole averaging periods. Each shard is processed by its own engine in a
+/// private output directory. At the end the shard outputs are merged in the
+/// output directory in chronological order: the rows of the files of the
+/// following shards are appended to the files of the first one, the other
+/// files are moved. Valid only for settings whose results do not depend on
+/// the whole dataset.
+/// \sa EngineScheduler, IncrementalRun, EcProject::hasPeriodIndependentResults
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \namespace ShardedRun
+/// \brief Date shards of a run
+namespace ShardedRun
+{
+    // split [from, to] in at most n contiguous ranges of whole averaging
+    // periods of avrgLen minutes, aligned to midnight. less than n ranges
+    // when the periods are not enough
+    QVector<FileUtils::DateRange> split(const QDateTime& from,
+                                        const QDateTime& to,
+                                        int n,
+                                        int avrgLen);
+
+    // private output directory of a shard
+    QString shardDir(const QString& outPath, int shard);
+
+    // merge the shard directories, in chronological order, in outPath and
+    // remove them. errorString lists the files that could not be merged
+    bool mergeOutputs(const QStringList& shardDirs,
+                      const QString& outPath,
+                      QString* errorString = nullptr);
+
+    // remove the shard directories left in outPath
+    void removeShardDirs(const QString& outPath);
+
+} // ShardedRun
+
+#endif // SHARDEDRUN_H
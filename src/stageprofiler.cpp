@@ -0,0 +1,287 @@
+/***************************************************************************
+  stageprofiler.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "stageprofiler.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <numeric>
+
+#include "defs.h"
+
+void StageProfiler::Stats::add(qint64 msec)
+{
+    minMSec = (count == 0) ? msec : qMin(minMSec, msec);
+    maxMSec = qMax(maxMSec, msec);
+    totalMSec += msec;
+    ++count;
+    ++histogram[StageProfiler::bucket(msec)];
+}
+
+StageProfiler::StageProfiler() :
+    suspendedMSec_(0),
+    suspendStart_(-1),
+    period_(0),
+    stage_(-1),
+    stageStart_(0),
+    periodStart_(-1)
+{
+    periodStats_.name = QStringLiteral("period");
+}
+
+void StageProfiler::clear()
+{
+    *this = StageProfiler();
+}
+
+qint64 StageProfiler::now() const
+{
+    return clock_.isValid() ? clock_.elapsed() - suspendedMSec_ : 0;
+}
+
+void StageProfiler::suspend()
+{
+    if (clock_.isValid() && suspendStart_ < 0)
+    {
+        suspendStart_ = clock_.elapsed();
+    }
+}
+
+void StageProfiler::resume()
+{
+    if (suspendStart_ >= 0)
+    {
+        suspendedMSec_ += clock_.elapsed() - suspendStart_;
+        suspendStart_ = -1;
+    }
+}
+
+void StageProfiler::startPeriod(int index)
+{
+    if (!clock_.isValid())
+    {
+        clock_.start();
+    }
+    if (periodStart_ >= 0)
+    {
+        endPeriod();
+    }
+
+    period_ = index;
+    periodStart_ = now();
+    stage_ = stageIndex(QStringLiteral("import"));
+    stageStart_ = periodStart_;
+}
+
+void StageProfiler::enterStage(const QString& stage, int msec)
+{
+    if (periodStart_ < 0)
+    {
+        return;
+    }
+
+    const auto time = now();
+    closeStage(time);
+
+    const auto index = stageIndex(stage);
+    if (msec >= 0)
+    {
+        record(index, time - msec, msec);
+    }
+    else
+    {
+        stage_ = index;
+        stageStart_ = time;
+    }
+}
+
+void StageProfiler::endPeriod()
+{
+    if (periodStart_ < 0)
+    {
+        return;
+    }
+
+    const auto time = now();
+    closeStage(time);
+    periodStats_.add(time - periodStart_);
+    periodStart_ = -1;
+}
+
+int StageProfiler::stageIndex(const QString& stage)
+{
+    auto it = stageIndexes_.constFind(stage);
+    if (it != stageIndexes_.constEnd())
+    {
+        return it.value();
+    }
+
+    Stats stats;
+    stats.name = stage;
+    stages_.append(stats);
+    stageIndexes_.insert(stage, stages_.size() - 1);
+    return stages_.size() - 1;
+}
+
+void StageProfiler::closeStage(qint64 time)
+{
+    if (stage_ >= 0)
+    {
+        record(stage_, stageStart_, time - stageStart_);
+        stage_ = -1;
+    }
+}
+
+void StageProfiler::record(int stage, qint64 start, qint64 duration)
+{
+    stages_[stage].add(duration);
+    const Sample sample = { period_, stage, start, duration };
+    samples_.append(sample);
+}
+
+int StageProfiler::bucket(qint64 msec)
+{
+    auto index = 0;
+    while (msec > 0 && index < HISTOGRAM_SIZE - 1)
+    {
+        msec >>= 1;
+        ++index;
+    }
+    return index;
+}
+
+QString StageProfiler::bucketLabel(int bucket)
+{
+    if (bucket == 0)
+    {
+        return QStringLiteral("< 1");
+    }
+    const auto low = Q_INT64_C(1) << (bucket - 1);
+    if (bucket == HISTOGRAM_SIZE - 1)
+    {
+        return QStringLiteral(">= %1").arg(low);
+    }
+    return QStringLiteral("%1-%2").arg(low).arg(2 * low - 1);
+}
+
+bool StageProfiler::writeReport(const QString& reportFile,
+                                const QString& timingsFile,
+                                const QString& projectId) const
+{
+    QFile report(reportFile);
+    if (!report.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qWarning() << "Unable to write" << reportFile;
+        return false;
+    }
+
+    // the stages in decreasing total time
+    QVector<int> order(stages_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b)
+    {
+        return stages_.at(a).totalMSec > stages_.at(b).totalMSec;
+    });
+
+    const auto runMSec = qMax(Q_INT64_C(1), periodStats_.totalMSec);
+
+    QTextStream out(&report);
+    out << Defs::APP_NAME << " stage timing profile\n"
+        << "Project: " << projectId << "\n"
+        << "Created: " << QDateTime::currentDateTime().toString(Qt::ISODate) << "\n"
+        << "Averaging periods: " << periodStats_.count
+        << ", processing time: " << QString::number(periodStats_.totalMSec / 1000.0, 'f', 1)
+        << " s\n\n";
+
+    const auto column = [](const QString& text) { return text.rightJustified(10); };
+
+    out << QStringLiteral("stage").leftJustified(24)
+        << column(QStringLiteral("count")) << column(QStringLiteral("total(s)"))
+        << column(QStringLiteral("share(%)")) << column(QStringLiteral("mean(ms)"))
+        << column(QStringLiteral("min(ms)")) << column(QStringLiteral("max(ms)")) << "\n";
+    const auto writeStats = [&out, &column, runMSec](const Stats& stats)
+    {
+        const auto mean = stats.count ? double(stats.totalMSec) / stats.count : 0.0;
+        out << stats.name.leftJustified(24)
+            << column(QString::number(stats.count))
+            << column(QString::number(stats.totalMSec / 1000.0, 'f', 1))
+            << column(QString::number(100.0 * stats.totalMSec / runMSec, 'f', 1))
+            << column(QString::number(mean, 'f', 1))
+            << column(QString::number(stats.minMSec))
+            << column(QString::number(stats.maxMSec)) << "\n";
+    };
+    foreach (int index, order)
+    {
+        writeStats(stages_.at(index));
+    }
+    writeStats(periodStats_);
+
+    // bars scaled on the largest bucket of each stage
+    out << "\nHistograms (ms)\n";
+    const auto writeHistogram = [&out](const Stats& stats)
+    {
+        out << "\n" << stats.name << "\n";
+        const auto first = std::find_if(stats.histogram.begin(), stats.histogram.end(),
+                                         [](qint64 n) { return n > 0; }) - stats.histogram.begin();
+        const auto last = std::find_if(stats.histogram.rbegin(), stats.histogram.rend(),
+                                       [](qint64 n) { return n > 0; }) - stats.histogram.rbegin();
+        const auto peak = qMax(Q_INT64_C(1), *std::max_element(stats.histogram.begin(),
+                                                               stats.histogram.end()));
+        for (auto i = static_cast<int>(first); i < HISTOGRAM_SIZE - last; ++i)
+        {
+            const auto n = stats.histogram.at(i);
+            out << bucketLabel(i).rightJustified(16) << " |"
+                << QString(static_cast<int>(50 * n / peak), QLatin1Char('#'))
+                << " " << n << "\n";
+        }
+    };
+    foreach (int index, order)
+    {
+        writeHistogram(stages_.at(index));
+    }
+    writeHistogram(periodStats_);
+
+    if (timingsFile.isEmpty())
+    {
+        return true;
+    }
+
+    QFile timings(timingsFile);
+    if (!timings.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        qWarning() << "Unable to write" << timingsFile;
+        return false;
+    }
+
+    QTextStream csv(&timings);
+    csv << "period,stage,start_ms,duration_ms\n";
+    foreach (const auto& sample, samples_)
+    {
+        csv << sample.period << ',' << stages_.at(sample.stage).name << ','
+            << sample.startMSec << ',' << sample.durationMSec << '\n';
+    }
+    return true;
+}
@@ -0,0 +1,122 @@
+/***************************************************************************
+  stageprofiler.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef STAGEPROFILER_H
+#define STAGEPROFILER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/stageprofiler.h
+/// \brief Time spent by the engine in each processing stage
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note A stage lasts from its marker to the next one, or to the end of
+/// the averaging period, unless the engine gives its duration. The time
+/// from the start of a period to its first marker is the "import" stage.
+/// The report gives the totals of each stage over the run and their
+/// histograms, a companion file the timings of each period.
+/// \sa RunPage
+/// \bug
+/// \deprecated
+/// \test tests/unit_tests/tst_stageprofiler.cpp
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \class StageProfiler
+/// \brief Timing profile of the processing stages of the averaging periods
+class StageProfiler
+{
+public:
+    StageProfiler();
+
+    void clear();
+
+    void startPeriod(int index);
+    // close the current stage and start the named one, or record its
+    // duration if given
+    void enterStage(const QString& stage, int msec = -1);
+    void endPeriod();
+
+    // the time in between is not charged to any stage
+    void suspend();
+    void resume();
+
+    int periodCount() const { return periodStats_.count; }
+
+    // summary with histograms and the per-period timings (csv)
+    bool writeReport(const QString& reportFile,
+                     const QString& timingsFile,
+                     const QString& projectId) const;
+
+private:
+    // log2 buckets of milliseconds, from < 1 ms to >= 2^(HISTOGRAM_SIZE - 2) ms
+    static const int HISTOGRAM_SIZE = 22;
+
+    struct Stats
+    {
+        QString name;
+        qint64 count = 0;
+        qint64 totalMSec = 0;
+        qint64 minMSec = 0;
+        qint64 maxMSec = 0;
+        QVector<qint64> histogram = QVector<qint64>(HISTOGRAM_SIZE, 0);
+
+        void add(qint64 msec);
+    };
+
+    struct Sample
+    {
+        int period;
+        int stage;
+        qint64 startMSec;   // since the start of the run
+        qint64 durationMSec;
+    };
+
+    static int bucket(qint64 msec);
+    static QString bucketLabel(int bucket);
+
+    qint64 now() const;
+    int stageIndex(const QString& stage);
+    void closeStage(qint64 time);
+    void record(int stage, qint64 start, qint64 duration);
+
+    QElapsedTimer clock_;
+    qint64 suspendedMSec_;
+    qint64 suspendStart_;
+
+    QVector<Stats> stages_;
+    QHash<QString, int> stageIndexes_;
+    QVector<Sample> samples_;
+    Stats periodStats_;
+
+    int period_;
+    int stage_;             // current stage, -1 if none
+    qint64 stageStart_;
+    qint64 periodStart_;    // -1 out of a period
+};
+
+#endif // STAGEPROFILER_H
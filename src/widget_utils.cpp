@@ -25,6 +25,7 @@
 
 #include <limits>
 
+#include <QApplication>
 #include <QCalendarWidget>
 #include <QComboBox>
 #include <QCoreApplication>
@@ -103,6 +104,19 @@ void updateStyle(QWidget* widget)
 //    updateStyle(widget);
 //}
 
+// without a QApplication, e.g. in the command line mode, the messages
+// cannot be shown and go to the log
+bool isHeadless(const QString& title, const QString& text, const QString& infoText)
+{
+    if (qobject_cast<QApplication*>(QCoreApplication::instance()))
+    {
+        return false;
+    }
+
+    qWarning() << title << text << infoText;
+    return true;
+}
+
 }  // unnamed namespace
 
 void WidgetUtils::updatePropertyListAndStyle(QWidget* widget,
@@ -309,6 +323,8 @@ bool WidgetUtils::information(QWidget* parent,
                               const QString& text,
                               const QString& infoText)
 {
+    if (isHeadless(title, text, infoText)) { return true; }
+
 //    QScopedPointer<QMessageBox> messageBox(new QMessageBox(parent));
     auto messageBox = std::make_unique<QMessageBox>(parent);
 
@@ -343,6 +359,8 @@ void WidgetUtils::warning(QWidget* parent,
                           const QString& infoText,
                           const QString& objectName)
 {
+    if (isHeadless(title, text, infoText)) { return; }
+
     auto messageBox = std::make_unique<QMessageBox>(parent);
     messageBox.get()->setObjectName(objectName);
 
@@ -375,6 +393,8 @@ void WidgetUtils::critical(QWidget* parent,
                            const QString& text,
                            const QString& infoText)
 {
+    if (isHeadless(title, text, infoText)) { return; }
+
     auto messageBox = std::make_unique<QMessageBox>(parent);
 
     // Mac OS X compatibility (to look like a sheet)
@@ -0,0 +1,236 @@
+/***************************************************************************
+  ziparchivecache.cpp
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#include "ziparchivecache.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+
+#include "JlCompress.h"
+
+#include "defs.h"
+
+namespace
+{
+const quint32 CACHE_MAGIC = 0x45505a43; // "EPZC"
+const quint16 CACHE_VERSION = 1;
+
+// beyond this the cache is restarted, to bound its file
+const int MAX_ARCHIVES = 200000;
+
+struct ArchiveRecord
+{
+    qint64 size = -1;
+    qint64 modified = -1;
+    QStringList entries;
+};
+
+QDataStream& operator<<(QDataStream& out, const ArchiveRecord& a)
+{
+    out << a.size << a.modified << a.entries;
+    return out;
+}
+
+QDataStream& operator>>(QDataStream& in, ArchiveRecord& a)
+{
+    in >> a.size >> a.modified >> a.entries;
+    return in;
+}
+
+// archives keyed by absolute path, loaded from the env of the last query
+QMutex cacheMutex;
+QHash<QString, ArchiveRecord> archiveCache;
+QString cacheEnvPath;
+bool cacheDirty = false;
+
+QString cacheFilePath(const QString& appEnvPath)
+{
+    return appEnvPath
+           + QLatin1Char('/')
+           + Defs::IDX_FILE_DIR
+           + QStringLiteral("/archives.idx");
+}
+
+bool saveCache(const QString& appEnvPath)
+{
+    const auto fileName = cacheFilePath(appEnvPath);
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        qWarning() << "Error: Cannot write archive cache" << fileName << file.errorString();
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_2);
+    out << CACHE_MAGIC << CACHE_VERSION;
+    out << archiveCache;
+
+    return file.commit();
+}
+
+// the entries added for the previous env are stored before switching
+void loadCache(const QString& appEnvPath)
+{
+    if (cacheDirty && !cacheEnvPath.isEmpty())
+    {
+        saveCache(cacheEnvPath);
+    }
+
+    archiveCache.clear();
+    cacheDirty = false;
+    cacheEnvPath = appEnvPath;
+
+    if (appEnvPath.isEmpty())
+    {
+        return;
+    }
+
+    QFile file(cacheFilePath(appEnvPath));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_2);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != CACHE_MAGIC || version != CACHE_VERSION)
+    {
+        qDebug() << "Discarding archive cache" << file.fileName();
+        return;
+    }
+
+    in >> archiveCache;
+    if (in.status() != QDataStream::Ok)
+    {
+        archiveCache.clear();
+    }
+}
+} // namespace
+
+QStringList ZipArchiveCache::getFileList(const QString& appEnvPath, const QString& fileName)
+{
+    const QFileInfo info(fileName);
+    if (!info.isFile())
+    {
+        return QStringList();
+    }
+
+    const auto path = info.absoluteFilePath();
+    const auto size = info.size();
+    const auto modified = info.lastModified().toMSecsSinceEpoch();
+
+    {
+        QMutexLocker locker(&cacheMutex);
+
+        // an empty env path uses the cache already loaded
+        if (!appEnvPath.isEmpty() && appEnvPath != cacheEnvPath)
+        {
+            loadCache(appEnvPath);
+        }
+
+        const auto it = archiveCache.constFind(path);
+        if (it != archiveCache.constEnd()
+            && it->size == size
+            && it->modified == modified)
+        {
+            return it->entries;
+        }
+    }
+
+    // read the central directory without holding the lock
+    ArchiveRecord record;
+    record.size = size;
+    record.modified = modified;
+    record.entries = JlCompress::getFileList(path);
+
+    // an unreadable archive is read again at the next query
+    if (record.entries.isEmpty())
+    {
+        qDebug() << "Archive entries not cached" << path;
+        return record.entries;
+    }
+
+    QMutexLocker locker(&cacheMutex);
+
+    if (archiveCache.size() >= MAX_ARCHIVES)
+    {
+        archiveCache.clear();
+    }
+    archiveCache.insert(path, record);
+    cacheDirty = true;
+
+    return record.entries;
+}
+
+bool ZipArchiveCache::containsFiletype(const QString& appEnvPath,
+                                       const QString& fileName,
+                                       const QString& filePattern)
+{
+    const auto suffix = filePattern.mid(1);
+    const auto entries = getFileList(appEnvPath, fileName);
+
+    foreach (const QString& item, entries)
+    {
+        if (item.contains(suffix))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ZipArchiveCache::flush(const QString& appEnvPath)
+{
+    QMutexLocker locker(&cacheMutex);
+
+    if (!cacheDirty || appEnvPath.isEmpty() || appEnvPath != cacheEnvPath)
+    {
+        return;
+    }
+
+    if (saveCache(appEnvPath))
+    {
+        cacheDirty = false;
+    }
+}
+
+void ZipArchiveCache::clear()
+{
+    QMutexLocker locker(&cacheMutex);
+
+    archiveCache.clear();
+    cacheEnvPath.clear();
+    cacheDirty = false;
+}
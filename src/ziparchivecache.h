@@ -0,0 +1,67 @@
+/***************************************************************************
+  ziparchivecache.h
+  -------------------
+  Copyright (C) 2011-2016, LI-COR Biosciences
+  Author: Antonio Forgione
+
+  This file is part of EddyPro (R).
+
+  EddyPro (R) is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  EddyPro (R) is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with EddyPro (R). If not, see <http://www.gnu.org/licenses/>.
+****************************************************************************/
+
+#ifndef ZIPARCHIVECACHE_H
+#define ZIPARCHIVECACHE_H
+
+#include <QString>
+#include <QStringList>
+
+////////////////////////////////////////////////////////////////////////////////
+/// \file src/ziparchivecache.h
+/// \brief Cache of the entry lists of zip archives
+/// \version
+/// \date
+/// \author      Antonio Forgione
+/// \note The entry list of each archive (e.g. GHG files) is read from its
+/// central directory once and kept until the archive size or modification
+/// time change. With a non empty application environment path the cache is
+/// also stored in its 'idx' subdirectory, to be reused in the next sessions.
+/// Archives without entries, e.g. unreadable, are not cached.
+/// \sa FileUtils::zipContainsFiletype
+/// \bug
+/// \deprecated
+/// \test
+/// \todo
+////////////////////////////////////////////////////////////////////////////////
+
+/// \namespace ZipArchiveCache
+/// \brief Archive entry lists keyed by (path, size, modification time)
+namespace ZipArchiveCache
+{
+    // callable from any thread. with an empty appEnvPath
+    // the cache currently loaded is used and nothing is stored
+    QStringList getFileList(const QString& appEnvPath, const QString& fileName);
+
+    // same matching of FileUtils::zipContainsFiletype()
+    bool containsFiletype(const QString& appEnvPath,
+                          const QString& fileName,
+                          const QString& filePattern);
+
+    // store the entries added since the last flush
+    void flush(const QString& appEnvPath);
+
+    void clear();
+
+} // ZipArchiveCache
+
+#endif // ZIPARCHIVECACHE_H
@@ -1,4 +1,4 @@
-QT += core gui widgets testlib
+QT += core gui widgets testlib concurrent
 
 TARGET = unit_tests
 
@@ -13,12 +13,32 @@ include(../QtTestUtil/QtTestUtil.pri)
 HEADERS += \
     tst_advspectraloptions.h \
 #    testrunner.h \
-    tst_aboutdialog.h
+    tst_aboutdialog.h \
+    tst_engineoutput.h \
+    tst_etcestimator.h \
+    tst_filenameprototype.h \
+    tst_inifile.h \
+    tst_rawfilefilter.h \
+    tst_stageprofiler.h
 
 SOURCES += \
     tst_advspectraloptions.cpp \
     main.cpp \
-    tst_aboutdialog.cpp
+    tst_aboutdialog.cpp \
+    tst_engineoutput.cpp \
+    tst_etcestimator.cpp \
+    tst_filenameprototype.cpp \
+    tst_inifile.cpp \
+    tst_rawfilefilter.cpp \
+    tst_stageprofiler.cpp \
+    $$top_srcdir/src/engineoutput.cpp \
+    $$top_srcdir/src/engineprogress.cpp \
+    $$top_srcdir/src/enginerunprogress.cpp \
+    $$top_srcdir/src/etcestimator.cpp \
+    $$top_srcdir/src/filenameprototype.cpp \
+    $$top_srcdir/src/inifile.cpp \
+    $$top_srcdir/src/rawfilefilter.cpp \
+    $$top_srcdir/src/stageprofiler.cpp
 #    tst_aboutdialog_s.cpp
 
 INCLUDEPATH += $$top_srcdir/src
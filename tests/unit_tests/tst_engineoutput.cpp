@@ -0,0 +1,236 @@
+#include "tst_engineoutput.h"
+
+#include "engineoutput.h"
+#include "engineprogress.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QTest>
+
+Q_DECLARE_METATYPE(EngineOutput::Message)
+
+using EngineOutput::Message;
+
+// the log of a project of some years of half-hourly raw files, or the one
+// given in EDDYPRO_ENGINE_LOG
+QByteArray Test_EngineOutput_Class::engineLog()
+{
+    const auto logPath = qgetenv("EDDYPRO_ENGINE_LOG");
+    if (!logPath.isEmpty())
+    {
+        QFile logFile(QString::fromLocal8Bit(logPath));
+        if (logFile.open(QIODevice::ReadOnly))
+        {
+            return logFile.readAll();
+        }
+        qWarning() << "Unable to read" << logFile.fileName();
+    }
+
+    const QByteArray period =
+        " processing new flux averaging period\n"
+        "  File(s): ..\\raw\\%1_AIU-0001.ghg\n"
+        "  Number of samples: 18000\n"
+        "  Calculating statistics..\n"
+        "  Raw level statistical screening..\n"
+        "  Spike detection/removal test..\n"
+        "  Absolute limits test..\n"
+        "  Skewness & kurtosis test..\n"
+        "  Performing tilt correction..\n"
+        "  Compensating time lags..\n"
+        "  Detrending..\n"
+        "  Calculating (co)spectra..\n"
+        "  Calculating fluxes Level 0..\n"
+        "  Calculating fluxes Level 1..\n"
+        "  Calculating fluxes Level 2 and 3..\n"
+        "  Estimating footprint..\n"
+        "  Calculating quality flags..\n"
+        " Warning(81)> Not enough valid data in the averaging period.\n"
+        " Flux averaging period processing time: 0:00:00.412\n";
+
+    QByteArray log(" Executing EddyPro-RP\n Start raw data processing\n");
+    const auto start = QDateTime(QDate(2010, 1, 1), QTime(0, 0));
+    const auto periods = 3 * 365 * 48;
+    log.reserve(periods * (period.size() + 64));
+    for (auto i = 0; i < periods; ++i)
+    {
+        const auto time = start.addSecs(i * 1800);
+        log += "  From: " + time.toString(QStringLiteral("yyyy-MM-dd HH:mm")).toLatin1()
+               + "\n  To:   " + time.addSecs(1800).toString(QStringLiteral("yyyy-MM-dd HH:mm")).toLatin1()
+               + "\n";
+        log += QByteArray(period).replace("%1", time.toString(QStringLiteral("yyyy-MM-ddTHHmm")).toLatin1());
+    }
+    log += " Raw data processing terminated. Creating continuous datasets if necessary\n"
+           " EddyPro-RP executed gracefully.\n";
+    return log;
+}
+
+void Test_EngineOutput_Class::initTestCase()
+{
+}
+
+void Test_EngineOutput_Class::testClassify_data()
+{
+    QTest::addColumn<QByteArray>("line");
+    QTest::addColumn<Message>("message");
+
+    QTest::newRow("executing") << QByteArray(" Executing EddyPro-RP") << Message::Executing;
+    QTest::newRow("file list") << QByteArray("  File(s): ..\\raw\\2016-03-01T0000.ghg")
+                               << Message::FileList;
+    QTest::newRow("continuation") << QByteArray("  ..\\raw\\2016-03-01T0030.ghg")
+                                  << Message::FileContinuation;
+    QTest::newRow("level 2") << QByteArray("  Calculating fluxes Level 2 and 3..")
+                             << Message::FluxesLevel2;
+    QTest::newRow("none") << QByteArray("  Nothing to see here") << Message::None;
+    QTest::newRow("empty") << QByteArray() << Message::None;
+
+    // the first message of the table wins
+    QTest::newRow("sorting wind") << QByteArray(" Sorting wind data by sector")
+                                  << Message::SortingWindData;
+    QTest::newRow("sorting") << QByteArray(" Sorting (co)spectra") << Message::Sorting;
+    QTest::newRow("from to") << QByteArray(" From: To:") << Message::From;
+    QTest::newRow("to") << QByteArray("  To:   2016-03-01 00:30") << Message::To;
+    QTest::newRow("terminated") << QByteArray(" Raw data processing terminated. "
+                                              "Creating continuous datasets if necessary")
+                                << Message::RawProcessingEnd;
+    QTest::newRow("small step") << QByteArray(" another small step to the time-lag 12:30")
+                                << Message::TimeLagStep;
+}
+
+void Test_EngineOutput_Class::testClassify()
+{
+    QFETCH(QByteArray, line);
+    QFETCH(Message, message);
+
+    QCOMPARE(EngineOutput::classify(line).message, message);
+}
+
+void Test_EngineOutput_Class::testFlags()
+{
+    auto line = EngineOutput::classify(" Warning(82)> Fatal error, run aborted");
+    QCOMPARE(line.message, Message::None);
+    QCOMPARE(line.flags, quint32(EngineOutput::Warning | EngineOutput::SuppressedWarning
+                                 | EngineOutput::FatalError | EngineOutput::Fatal
+                                 | EngineOutput::Aborted));
+
+    // overlapping tokens are all found
+    line = EngineOutput::classify("At line 12 of file Z:\\src\\main.f90");
+    QCOMPARE(line.flags, quint32(EngineOutput::AtLine | EngineOutput::WindowsSourcePath));
+
+    line = EngineOutput::classify(" another small step to the planar-fit 00:30");
+    QCOMPARE(line.message, Message::PlanarFitStep);
+    QCOMPARE(line.flags, quint32(EngineOutput::SmallStep));
+}
+
+void Test_EngineOutput_Class::testLineSplitter()
+{
+    EngineOutput::LineSplitter splitter;
+    QByteArray line;
+
+    splitter.append("first\nsec");
+    QVERIFY(splitter.readLine(&line));
+    QCOMPARE(line, QByteArray("first"));
+    QVERIFY(!splitter.readLine(&line));
+    QCOMPARE(splitter.remainder(), QByteArray("sec"));
+
+    splitter.append("ond\n\nthird");
+    QVERIFY(splitter.readLine(&line));
+    QCOMPARE(line, QByteArray("second"));
+    QVERIFY(splitter.readLine(&line));
+    QCOMPARE(line, QByteArray());
+    QVERIFY(!splitter.readLine(&line));
+
+    splitter.clear();
+    QCOMPARE(splitter.remainder(), QByteArray());
+}
+
+// the lines do not depend on how the stream is chunked
+void Test_EngineOutput_Class::testLineSplitterChunks()
+{
+    const auto log = engineLog().left(100000);
+    const auto expected = log.left(log.lastIndexOf('\n')).split('\n');
+
+    for (auto chunkSize : { 1, 7, 64, 4096 })
+    {
+        EngineOutput::LineSplitter splitter;
+        QList<QByteArray> lines;
+        QByteArray line;
+        for (auto pos = 0; pos < log.size(); pos += chunkSize)
+        {
+            splitter.append(log.mid(pos, chunkSize));
+            while (splitter.readLine(&line))
+            {
+                lines.append(line);
+            }
+        }
+        QCOMPARE(lines, expected);
+    }
+}
+
+void Test_EngineOutput_Class::testProgressEvents()
+{
+    EngineProgress::Event event;
+
+    QVERIFY(EngineProgress::parse("{\"event\":\"totals\",\"periods\":17520}", &event));
+    QCOMPARE(event.type, EngineProgress::Type::Totals);
+    QCOMPARE(event.total, 17520);
+
+    QVERIFY(EngineProgress::parse("{\"event\":\"period\",\"index\":3,"
+                                  "\"from\":\"2016-03-01 01:00\",\"to\":\"2016-03-01 01:30\","
+                                  "\"files\":[\"a.ghg\",\"b.ghg\"]}\r", &event));
+    QCOMPARE(event.type, EngineProgress::Type::Period);
+    QCOMPARE(event.index, 3);
+    QCOMPARE(event.from, QStringLiteral("2016-03-01 01:00"));
+    QCOMPARE(event.to, QStringLiteral("2016-03-01 01:30"));
+    QCOMPARE(event.files, QStringList({ QStringLiteral("a.ghg"), QStringLiteral("b.ghg") }));
+    QCOMPARE(event.msec, -1);
+
+    QVERIFY(EngineProgress::parse("{\"event\":\"stage\",\"index\":3,\"stage\":\"fft\",\"msec\":12}", &event));
+    QCOMPARE(event.type, EngineProgress::Type::Stage);
+    QCOMPARE(event.stage, QStringLiteral("fft"));
+    QCOMPARE(event.msec, 12);
+
+    QVERIFY(EngineProgress::parse("{\"event\":\"period_end\",\"index\":3,\"msec\":412,\"skipped\":true}", &event));
+    QCOMPARE(event.type, EngineProgress::Type::PeriodEnd);
+    QCOMPARE(event.msec, 412);
+    QVERIFY(event.skipped);
+}
+
+void Test_EngineOutput_Class::testProgressInvalid()
+{
+    EngineProgress::Event event;
+
+    QVERIFY(!EngineProgress::parse(" processing new flux averaging period", &event));
+    QVERIFY(!EngineProgress::parse("{\"event\":\"period\"", &event));
+    QVERIFY(!EngineProgress::parse("{\"event\":\"unknown\"}", &event));
+    QVERIFY(!EngineProgress::parse("[1, 2]", &event));
+}
+
+void Test_EngineOutput_Class::benchmarkReplay()
+{
+    const auto log = engineLog();
+    auto periods = 0;
+
+    QBENCHMARK {
+        periods = 0;
+        EngineOutput::LineSplitter splitter;
+        splitter.append(log);
+
+        QByteArray line;
+        while (splitter.readLine(&line))
+        {
+            if (EngineOutput::classify(line).message == Message::NewAveragingPeriod)
+            {
+                ++periods;
+            }
+        }
+    }
+
+    QVERIFY(periods > 0);
+}
+
+void Test_EngineOutput_Class::cleanupTestCase()
+{
+}
+
+QTTESTUTIL_REGISTER_TEST(Test_EngineOutput_Class);
@@ -0,0 +1,32 @@
+#ifndef TST_ENGINEOUTPUT_H
+#define TST_ENGINEOUTPUT_H
+
+#include <QByteArray>
+#include <QObject>
+
+#include "QtTestUtil/QtTestUtil.h"
+
+class Test_EngineOutput_Class : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testClassify_data();
+    void testClassify();
+    void testFlags();
+    void testLineSplitter();
+    void testLineSplitterChunks();
+    void testProgressEvents();
+    void testProgressInvalid();
+
+    void benchmarkReplay();
+
+    void cleanupTestCase();
+
+private:
+    static QByteArray engineLog();
+};
+
+#endif // TST_ENGINEOUTPUT_H
@@ -0,0 +1,367 @@
+#include "tst_etcestimator.h"
+
+#include "engineoutput.h"
+#include "enginerunprogress.h"
+#include "etcestimator.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTest>
+#include <QTime>
+
+#include <cmath>
+
+namespace
+{
+// skipped periods in the logs
+const qint64 SKIPPED = -1;
+
+// reproducible noise in [-1, 1)
+class Noise
+{
+public:
+    double next()
+    {
+        state_ = state_ * 1664525u + 1013904223u;
+        return (state_ >> 8) / double(1 << 23) - 1.0;
+    }
+
+private:
+    quint32 state_ = 12345u;
+};
+} // namespace
+
+// the console output of the raw data processing of the given periods,
+// in msec, SKIPPED if skipped
+QByteArray Test_EtcEstimator_Class::makeLog(const QVector<qint64>& periods)
+{
+    QByteArray log(" Executing EddyPro-RP\n Start raw data processing\n");
+    log += "  Total number of flux averaging periods: "
+           + QByteArray::number(periods.size()) + "\n";
+    for (const auto msec : periods)
+    {
+        log += " processing new flux averaging period\n"
+               "  File(s): ..\\raw\\2010-01-01T0000_AIU-0001.ghg\n";
+        if (msec == SKIPPED)
+        {
+            log += " Warning(81)> Not enough valid data in the averaging period.\n"
+                   " Skipping to next averaging period.\n";
+            continue;
+        }
+        log += "  Number of samples: 18000\n"
+               "  Calculating quality flags..\n"
+               " Flux averaging period processing time: "
+               + QTime(0, 0).addMSecs(static_cast<int>(msec))
+                            .toString(QStringLiteral("h:mm:ss.zzz")).toLatin1()
+               + "\n";
+    }
+    log += " EddyPro-RP executed gracefully.\n";
+    return log;
+}
+
+// the periods of the console output, as RunPage reads them
+QVector<qint64> Test_EtcEstimator_Class::periodTimes(const QByteArray& log)
+{
+    using EngineOutput::Message;
+
+    QVector<qint64> periods;
+    EngineOutput::LineSplitter splitter;
+    splitter.append(log);
+
+    QByteArray line;
+    while (splitter.readLine(&line))
+    {
+        switch (EngineOutput::classify(line).message)
+        {
+        case Message::SkippingPeriod:
+            periods.append(SKIPPED);
+            break;
+        case Message::PeriodProcessingTime:
+        {
+            const auto time = QTime::fromString(QLatin1String(line.trimmed().split(' ')
+                                                              .last().constData()),
+                                                QStringLiteral("h:mm:ss.zzz"));
+            periods.append(QTime(0, 0).msecsTo(time));
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return periods;
+}
+
+// compare the estimates to the actual remaining time, and to the cumulative
+// mean RunPage used before, which counted the skipped periods in the mean
+Test_EtcEstimator_Class::ReplayError
+Test_EtcEstimator_Class::replay(const QVector<qint64>& periods)
+{
+    const auto total = periods.size();
+    QVector<qint64> remaining(total + 1, 0);
+    for (auto i = total - 1; i >= 0; --i)
+    {
+        remaining[i] = remaining.at(i + 1) + qMax(Q_INT64_C(0), periods.at(i));
+    }
+
+    EtcEstimator etc;
+    etc.start(EtcEstimator::Phase::RawProcessing);
+    etc.setTotal(total);
+
+    double mean = 0.0;
+    ReplayError error;
+    auto checks = 0;
+    for (auto i = 0; i < total; ++i)
+    {
+        const auto index = i + 1;
+        if (periods.at(i) == SKIPPED)
+        {
+            etc.skipPeriod();
+        }
+        else
+        {
+            etc.addPeriod(periods.at(i));
+            mean = (mean * (index - 1) + periods.at(i)) / index;
+        }
+
+        const auto truth = static_cast<double>(remaining.at(index));
+        if (index < total / 10 || index > total * 9 / 10 || truth <= 0.0)
+        {
+            continue;
+        }
+
+        const auto estimate = etc.estimate();
+        if (!estimate.valid)
+        {
+            continue;
+        }
+        error.estimator += std::fabs(estimate.msec - truth) / truth;
+        error.cumulativeMean += std::fabs((total - index) * mean - truth) / truth;
+        if (estimate.lowMSec <= truth && truth <= estimate.highMSec)
+        {
+            error.bandCoverage += 1.0;
+        }
+        ++checks;
+    }
+
+    if (checks > 0)
+    {
+        error.estimator /= checks;
+        error.cumulativeMean /= checks;
+        error.bandCoverage /= checks;
+    }
+    return error;
+}
+
+void Test_EtcEstimator_Class::initTestCase()
+{
+}
+
+void Test_EtcEstimator_Class::testEmpty()
+{
+    EtcEstimator etc;
+    etc.start(EtcEstimator::Phase::RawProcessing);
+    QVERIFY(!etc.estimate().valid);
+
+    etc.setTotal(10);
+    etc.skipPeriod(5);
+    QVERIFY(!etc.estimate().valid);
+    QCOMPARE(etc.periodsDone(), 1);
+
+    // the skipped periods to come cost less than the processed ones
+    etc.addPeriod(1000);
+    const auto estimate = etc.estimate();
+    QVERIFY(estimate.valid);
+    QVERIFY(estimate.msec > 8 * 5 && estimate.msec < 8 * 1000);
+    QCOMPARE(estimate.lowMSec, estimate.msec);
+    QCOMPARE(estimate.highMSec, estimate.msec);
+}
+
+void Test_EtcEstimator_Class::testSteadyRate()
+{
+    Noise noise;
+    QVector<qint64> periods;
+    for (auto i = 0; i < 2000; ++i)
+    {
+        periods.append(static_cast<qint64>(1000.0 * (1.0 + 0.2 * noise.next())));
+    }
+
+    const auto error = replay(periodTimes(makeLog(periods)));
+    QVERIFY(error.estimator < 0.05);
+    QVERIFY(error.bandCoverage > 0.9);
+}
+
+void Test_EtcEstimator_Class::testSkippedEarlyPeriods()
+{
+    // a month of missing data at the start of the dataset
+    Noise noise;
+    QVector<qint64> periods(600, SKIPPED);
+    for (auto i = 0; i < 1400; ++i)
+    {
+        periods.append(static_cast<qint64>(2000.0 * (1.0 + 0.1 * noise.next())));
+    }
+
+    const auto error = replay(periodTimes(makeLog(periods)));
+    QVERIFY(error.estimator < 0.05);
+    QVERIFY(error.estimator < error.cumulativeMean / 4.0);
+}
+
+void Test_EtcEstimator_Class::testDrift()
+{
+    // longer periods as the dataset goes on
+    Noise noise;
+    QVector<qint64> periods;
+    for (auto i = 0; i < 2000; ++i)
+    {
+        periods.append(static_cast<qint64>((1000.0 + i) * (1.0 + 0.1 * noise.next())));
+    }
+
+    const auto error = replay(periodTimes(makeLog(periods)));
+    QVERIFY(error.estimator < error.cumulativeMean);
+
+    // the rate of the periods close ahead follows the drift
+    EtcEstimator etc;
+    etc.start(EtcEstimator::Phase::RawProcessing);
+    for (const auto msec : periods)
+    {
+        etc.addPeriod(msec);
+    }
+    QVERIFY(std::fabs(etc.smoothedRate(EtcEstimator::Phase::RawProcessing) / 3000.0 - 1.0) < 0.05);
+}
+
+void Test_EtcEstimator_Class::testOutlier()
+{
+    EtcEstimator etc;
+    etc.start(EtcEstimator::Phase::RawProcessing);
+    etc.setTotal(1000);
+
+    Noise noise;
+    for (auto i = 0; i < 100; ++i)
+    {
+        etc.addPeriod(static_cast<qint64>(1000.0 * (1.0 + 0.1 * noise.next())));
+    }
+    const auto before = etc.estimate();
+
+    // a period stalled on a network share
+    etc.addPeriod(10 * 60 * 1000);
+    const auto after = etc.estimate();
+
+    QVERIFY(after.valid);
+    QVERIFY(std::fabs(double(after.msec) / before.msec - 1.0) < 0.05);
+    QVERIFY(before.lowMSec <= before.msec && before.msec <= before.highMSec);
+}
+
+void Test_EtcEstimator_Class::testPhases()
+{
+    EtcEstimator etc;
+    etc.start(EtcEstimator::Phase::PlanarFit);
+    etc.setTotal(100);
+    for (auto i = 0; i < 100; ++i)
+    {
+        etc.addPeriod(50);
+    }
+    QCOMPARE(etc.estimate().msec, Q_INT64_C(0));
+
+    // the main loop does not inherit the rate of the pre-step
+    etc.start(EtcEstimator::Phase::RawProcessing);
+    etc.setTotal(100);
+    QVERIFY(!etc.estimate().valid);
+    etc.addPeriod(2000);
+    QCOMPARE(etc.estimate().msec, Q_INT64_C(99) * 2000);
+
+    QCOMPARE(etc.smoothedRate(EtcEstimator::Phase::PlanarFit), 50.0);
+    QCOMPARE(etc.medianRate(EtcEstimator::Phase::RawProcessing), 2000.0);
+    QCOMPARE(etc.smoothedRate(EtcEstimator::Phase::TimeLag), -1.0);
+}
+
+// the periods and the estimate as the batch queue and the headless runs get them
+void Test_EtcEstimator_Class::testRunProgress()
+{
+    const auto log = makeLog({ 1000, 1000, SKIPPED, 1000, 1000, 1000 });
+
+    EngineRunProgress progress;
+    auto periodsStarted = 0;
+    auto messages = 0;
+    qint64 etcAfterFour = -1;
+    foreach (const QByteArray& line, log.split('\n'))
+    {
+        switch (progress.addLine(line))
+        {
+        case EngineRunProgress::Update::PeriodStarted:
+            ++periodsStarted;
+            break;
+        case EngineRunProgress::Update::PeriodEnded:
+            if (progress.periodIndex() == 4)
+            {
+                etcAfterFour = progress.etcMSec();
+            }
+            break;
+        case EngineRunProgress::Update::Message:
+            ++messages;
+            break;
+        default:
+            break;
+        }
+    }
+
+    QCOMPARE(progress.phase(), EtcEstimator::Phase::RawProcessing);
+    QCOMPARE(periodsStarted, 6);
+    QCOMPARE(progress.periodIndex(), 6);
+    QCOMPARE(progress.periodCount(), 6);
+    QCOMPARE(messages, 1);
+    // two periods left, the skipped share of the gaps lowers the estimate
+    QVERIFY(etcAfterFour > 0 && etcAfterFour <= 2000);
+    QCOMPARE(progress.etcMSec(), Q_INT64_C(0));
+    QCOMPARE(EngineRunProgress::phaseName(progress.phase()),
+             QStringLiteral("raw_processing"));
+}
+
+// replay the log given in EDDYPRO_ENGINE_LOG, or a synthesized one of some
+// years with gaps and a seasonal cycle of the processing time
+void Test_EtcEstimator_Class::testReplayEngineLog()
+{
+    QVector<qint64> periods;
+
+    const auto logPath = qgetenv("EDDYPRO_ENGINE_LOG");
+    if (!logPath.isEmpty())
+    {
+        QFile logFile(QString::fromLocal8Bit(logPath));
+        QVERIFY(logFile.open(QIODevice::ReadOnly));
+        periods = periodTimes(logFile.readAll());
+        if (periods.isEmpty())
+        {
+            QSKIP("No averaging periods in the engine log");
+        }
+
+        const auto error = replay(periods);
+        qDebug() << "periods" << periods.size()
+                 << "estimator error" << error.estimator
+                 << "cumulative mean error" << error.cumulativeMean
+                 << "band coverage" << error.bandCoverage;
+        return;
+    }
+
+    Noise noise;
+    const auto periodsPerDay = 48;
+    for (auto i = 0; i < 3 * 365 * periodsPerDay; ++i)
+    {
+        const auto day = i / periodsPerDay;
+        // a week of instrument failure every few months
+        if ((day % 100) < 7)
+        {
+            periods.append(SKIPPED);
+            continue;
+        }
+        const auto season = std::sin(2.0 * M_PI * day / 365.0);
+        periods.append(static_cast<qint64>(400.0 * (1.0 + 0.3 * season)
+                                           * (1.0 + 0.1 * noise.next())));
+    }
+
+    const auto error = replay(periodTimes(makeLog(periods)));
+    QVERIFY(error.estimator < error.cumulativeMean);
+}
+
+void Test_EtcEstimator_Class::cleanupTestCase()
+{
+}
+
+QTTESTUTIL_REGISTER_TEST(Test_EtcEstimator_Class);
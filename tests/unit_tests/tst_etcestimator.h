@@ -0,0 +1,42 @@
+#ifndef TST_ETCESTIMATOR_H
+#define TST_ETCESTIMATOR_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QVector>
+
+#include "QtTestUtil/QtTestUtil.h"
+
+class Test_EtcEstimator_Class : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testEmpty();
+    void testSteadyRate();
+    void testSkippedEarlyPeriods();
+    void testDrift();
+    void testOutlier();
+    void testPhases();
+    void testRunProgress();
+    void testReplayEngineLog();
+
+    void cleanupTestCase();
+
+private:
+    // mean relative error of the estimates from 10% to 90% of the periods
+    struct ReplayError
+    {
+        double estimator = 0.0;
+        double cumulativeMean = 0.0;
+        double bandCoverage = 0.0;
+    };
+
+    static QByteArray makeLog(const QVector<qint64>& periods);
+    static QVector<qint64> periodTimes(const QByteArray& log);
+    static ReplayError replay(const QVector<qint64>& periods);
+};
+
+#endif // TST_ETCESTIMATOR_H
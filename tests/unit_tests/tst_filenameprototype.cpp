@@ -0,0 +1,152 @@
+#include "tst_filenameprototype.h"
+
+#include "filenameprototype.h"
+
+#include <QDateTime>
+#include <QTest>
+
+void Test_FilenamePrototype_Class::initTestCase()
+{
+}
+
+void Test_FilenamePrototype_Class::testHasDate()
+{
+    QVERIFY(FilenamePrototype(QStringLiteral("yyyy-mm-ddTHHMM_xxx.ghg")).hasDate());
+    QVERIFY(FilenamePrototype(QStringLiteral("xxx_yymmdd.dat")).hasDate());
+    QVERIFY(!FilenamePrototype(QStringLiteral("xxx_HHMM.dat")).hasDate());
+    QVERIFY(!FilenamePrototype().hasDate());
+}
+
+void Test_FilenamePrototype_Class::testTimestamp_data()
+{
+    QTest::addColumn<QString>("prototype");
+    QTest::addColumn<QString>("filename");
+    QTest::addColumn<QDateTime>("timestamp");
+
+    const auto ghg = QStringLiteral("yyyy-mm-ddTHHMM_xxx.ghg");
+    const auto doy = QStringLiteral("yyyy_ddd_HHMM.dat");
+
+    QTest::newRow("yyyy-mm-dd HHMM")
+        << ghg << QStringLiteral("2016-03-01T1230_AIU.ghg")
+        << QDateTime(QDate(2016, 3, 1), QTime(12, 30));
+    QTest::newRow("yymmdd HHMM")
+        << QStringLiteral("xxx_yymmddHHMM.dat") << QStringLiteral("CPH_1603011230.dat")
+        << QDateTime(QDate(2016, 3, 1), QTime(12, 30));
+    QTest::newRow("ddd")
+        << doy << QStringLiteral("2015_032_0000.dat")
+        << QDateTime(QDate(2015, 2, 1), QTime(0, 0));
+    QTest::newRow("ddd leap year")
+        << doy << QStringLiteral("2016_366_2330.dat")
+        << QDateTime(QDate(2016, 12, 31), QTime(23, 30));
+    QTest::newRow("no time fields")
+        << QStringLiteral("xxx_yyyy-mm-dd.dat") << QStringLiteral("AIU_2016-03-01.dat")
+        << QDateTime(QDate(2016, 3, 1), QTime(0, 0));
+
+    // the missing digits read as the available ones, or as 0
+    QTest::newRow("short in the minutes")
+        << ghg << QStringLiteral("2016-03-01T12")
+        << QDateTime(QDate(2016, 3, 1), QTime(12, 0));
+    QTest::newRow("short in the hours")
+        << ghg << QStringLiteral("2016-03-01T1")
+        << QDateTime(QDate(2016, 3, 1), QTime(1, 0));
+    QTest::newRow("short in the date")
+        << ghg << QStringLiteral("2016-03")
+        << QDateTime();
+    QTest::newRow("empty")
+        << ghg << QString()
+        << QDateTime();
+
+    // a non digit zeroes its field
+    QTest::newRow("letters in the year")
+        << ghg << QStringLiteral("20x6-03-01T1230_AIU.ghg")
+        << QDateTime();
+    QTest::newRow("invalid month")
+        << ghg << QStringLiteral("2016-13-01T1230_AIU.ghg")
+        << QDateTime();
+    QTest::newRow("invalid day")
+        << ghg << QStringLiteral("2015-02-29T1230_AIU.ghg")
+        << QDateTime();
+    QTest::newRow("day of year 0")
+        << doy << QStringLiteral("2015_000_0000.dat")
+        << QDateTime(QDate(2014, 12, 31), QTime(0, 0));
+
+    // as QDateTime, an invalid time is midnight
+    QTest::newRow("invalid time")
+        << ghg << QStringLiteral("2016-03-01T2561_AIU.ghg")
+        << QDateTime(QDate(2016, 3, 1), QTime(0, 0));
+    QTest::newRow("letters in the time")
+        << ghg << QStringLiteral("2016-03-01T12x0_AIU.ghg")
+        << QDateTime(QDate(2016, 3, 1), QTime(12, 0));
+}
+
+void Test_FilenamePrototype_Class::testTimestamp()
+{
+    QFETCH(QString, prototype);
+    QFETCH(QString, filename);
+    QFETCH(QDateTime, timestamp);
+
+    const FilenamePrototype filenamePrototype(prototype);
+    QCOMPARE(filenamePrototype.timestamp(filename), timestamp);
+
+    const auto key = filenamePrototype.timestampKey(filename);
+    QCOMPARE(key < 0, !timestamp.isValid());
+}
+
+// 2-digit years above 70 are of the 20th century
+void Test_FilenamePrototype_Class::testCenturyBoundary()
+{
+    const FilenamePrototype prototype(QStringLiteral("yymmdd.dat"));
+
+    QCOMPARE(prototype.timestamp(QStringLiteral("991231.dat")).date(), QDate(1999, 12, 31));
+    QCOMPARE(prototype.timestamp(QStringLiteral("710101.dat")).date(), QDate(1971, 1, 1));
+    QCOMPARE(prototype.timestamp(QStringLiteral("700101.dat")).date(), QDate(2070, 1, 1));
+    QCOMPARE(prototype.timestamp(QStringLiteral("000101.dat")).date(), QDate(2000, 1, 1));
+
+    // so 1999 sorts before 2000
+    QVERIFY(prototype.timestampKey(QStringLiteral("991231.dat"))
+            < prototype.timestampKey(QStringLiteral("000101.dat")));
+}
+
+void Test_FilenamePrototype_Class::testKeyOrder()
+{
+    const FilenamePrototype prototype(QStringLiteral("yyyy-mm-ddTHHMM_xxx.ghg"));
+
+    const auto first = prototype.timestampKey(QStringLiteral("2016-02-29T2330_AIU.ghg"));
+    const auto second = prototype.timestampKey(QStringLiteral("2016-02-29T2359_AIU.ghg"));
+    const auto third = prototype.timestampKey(QStringLiteral("2016-03-01T0000_AIU.ghg"));
+
+    QVERIFY(first >= 0);
+    QCOMPARE(second - first, Q_INT64_C(29));
+    QCOMPARE(third - second, Q_INT64_C(1));
+}
+
+void Test_FilenamePrototype_Class::testKeyConversion()
+{
+    const QDateTime dateTime(QDate(1999, 12, 31), QTime(23, 59));
+    const auto key = FilenamePrototype::dateTimeToKey(dateTime);
+
+    QCOMPARE(FilenamePrototype::keyToDateTime(key), dateTime);
+    QCOMPARE(FilenamePrototype::dateTimeToKey(QDateTime()), Q_INT64_C(-1));
+    QVERIFY(!FilenamePrototype::keyToDateTime(-1).isValid());
+
+    // seconds are dropped
+    QCOMPARE(FilenamePrototype::dateTimeToKey(dateTime.addSecs(30)), key);
+}
+
+// only the given size of the name is read
+void Test_FilenamePrototype_Class::testSubstring()
+{
+    const FilenamePrototype prototype(QStringLiteral("yyyy-mm-ddTHHMM"));
+    const auto path = QStringLiteral("2016-03-01T1230_AIU.ghg");
+
+    QCOMPARE(prototype.timestampKey(path.constData(), 13),
+             prototype.timestampKey(QStringLiteral("2016-03-01T12")));
+    QCOMPARE(prototype.timestampKey(path.constData(), path.size()),
+             prototype.timestampKey(path));
+}
+
+void Test_FilenamePrototype_Class::cleanupTestCase()
+{
+}
+
+QTTESTUTIL_REGISTER_TEST(Test_FilenamePrototype_Class);
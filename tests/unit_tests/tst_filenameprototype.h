@@ -0,0 +1,26 @@
+#ifndef TST_FILENAMEPROTOTYPE_H
+#define TST_FILENAMEPROTOTYPE_H
+
+#include <QObject>
+
+#include "QtTestUtil/QtTestUtil.h"
+
+class Test_FilenamePrototype_Class : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testHasDate();
+    void testTimestamp_data();
+    void testTimestamp();
+    void testCenturyBoundary();
+    void testKeyOrder();
+    void testKeyConversion();
+    void testSubstring();
+
+    void cleanupTestCase();
+};
+
+#endif // TST_FILENAMEPROTOTYPE_H
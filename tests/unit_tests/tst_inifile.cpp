@@ -0,0 +1,338 @@
+#include "tst_inifile.h"
+
+#include "inifile.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSettings>
+#include <QTest>
+
+namespace
+{
+// about the size of an .eddypro project
+const int GROUP_COUNT = 22;
+const int KEYS_PER_GROUP = 20;
+
+QString groupName(int g)
+{
+    return QStringLiteral("Group_") + QString::number(g);
+}
+
+QString keyName(int k)
+{
+    return QStringLiteral("key_") + QString::number(k);
+}
+
+// mix of the value types stored in the projects
+QVariant keyValue(int g, int k)
+{
+    switch (k % 4)
+    {
+        case 0:
+            return g * 100 + k;
+        case 1:
+            return QString::number((g + 1) * 0.125 + k, 'f', 3);
+        case 2:
+            return QStringLiteral("C:/data/site %1/raw/file_%2.ghg").arg(g).arg(k);
+        default:
+            return QStringLiteral("2016-03-01T00:%1").arg(k, 2, 10, QLatin1Char('0'));
+    }
+}
+
+template <typename Settings>
+void writeKeys(Settings& ini)
+{
+    for (auto g = 0; g < GROUP_COUNT; ++g)
+    {
+        ini.beginGroup(groupName(g));
+        for (auto k = 0; k < KEYS_PER_GROUP; ++k)
+        {
+            ini.setValue(keyName(k), keyValue(g, k));
+        }
+        ini.endGroup();
+    }
+}
+
+template <typename Settings>
+int readKeys(Settings& ini)
+{
+    auto found = 0;
+    for (auto g = 0; g < GROUP_COUNT; ++g)
+    {
+        ini.beginGroup(groupName(g));
+        for (auto k = 0; k < KEYS_PER_GROUP; ++k)
+        {
+            if (ini.value(keyName(k), QString()).toString() == keyValue(g, k).toString())
+            {
+                ++found;
+            }
+        }
+        ini.endGroup();
+    }
+    return found;
+}
+
+void saveWithQSettings(const QString& fileName)
+{
+    // as the former EcProject::saveEcProject(), on a truncated file
+    QFile::remove(fileName);
+    QSettings ini(fileName, QSettings::IniFormat);
+    writeKeys(ini);
+    ini.sync();
+}
+
+void saveWithIniFile(const QString& fileName)
+{
+    IniFile ini;
+    writeKeys(ini);
+    ini.save(fileName);
+}
+
+void loadWithQSettings(const QString& fileName)
+{
+    QSettings ini(fileName, QSettings::IniFormat);
+    readKeys(ini);
+}
+
+void loadWithIniFile(const QString& fileName)
+{
+    IniFile ini;
+    ini.load(fileName);
+    readKeys(ini);
+}
+
+} // namespace
+
+QString Test_IniFile_Class::filePath(const QString& name) const
+{
+    return dir_.path() + QLatin1Char('/') + name;
+}
+
+void Test_IniFile_Class::initTestCase()
+{
+    QVERIFY(dir_.isValid());
+}
+
+void Test_IniFile_Class::testRoundTrip()
+{
+    const auto fileName = filePath(QStringLiteral("roundtrip.ini"));
+
+    const QStringList list { QStringLiteral("a"), QStringLiteral(" b c "), QStringLiteral("@d") };
+
+    IniFile out;
+    out.setValue(QStringLiteral("root"), 1);
+    out.beginGroup(QStringLiteral("Project"));
+        out.setValue(QStringLiteral("plain"), QStringLiteral("C:/data/raw"));
+        out.setValue(QStringLiteral("spaces"), QStringLiteral("  padded  "));
+        out.setValue(QStringLiteral("separators"), QStringLiteral("a;b,c=d"));
+        out.setValue(QStringLiteral("escapes"), QStringLiteral("tab\there \"quoted\" back\\slash"));
+        out.setValue(QStringLiteral("unicode"), QStringLiteral("\u00e8\u00b0C \u03bcmol 12"));
+        out.setValue(QStringLiteral("at"), QStringLiteral("@home"));
+        out.setValue(QStringLiteral("list"), list);
+        out.setValue(QStringLiteral("empty_list"), QStringList());
+        out.setValue(QStringLiteral("flag"), true);
+        out.setValue(QStringLiteral("number"), 0.25);
+        out.setValue(QStringLiteral("key with/slash"), QStringLiteral("x"));
+    out.endGroup();
+    out.setValue(QStringLiteral("General/key"), QStringLiteral("general group"));
+    QVERIFY(out.save(fileName));
+
+    IniFile in;
+    QVERIFY(in.load(fileName));
+    QCOMPARE(in.value(QStringLiteral("root")).toInt(), 1);
+    in.beginGroup(QStringLiteral("Project"));
+        QCOMPARE(in.value(QStringLiteral("plain")).toString(), QStringLiteral("C:/data/raw"));
+        QCOMPARE(in.value(QStringLiteral("spaces")).toString(), QStringLiteral("  padded  "));
+        QCOMPARE(in.value(QStringLiteral("separators")).toString(), QStringLiteral("a;b,c=d"));
+        QCOMPARE(in.value(QStringLiteral("escapes")).toString(),
+                 QStringLiteral("tab\there \"quoted\" back\\slash"));
+        QCOMPARE(in.value(QStringLiteral("unicode")).toString(), QStringLiteral("\u00e8\u00b0C \u03bcmol 12"));
+        QCOMPARE(in.value(QStringLiteral("at")).toString(), QStringLiteral("@home"));
+        QCOMPARE(in.value(QStringLiteral("list")).toStringList(), list);
+        QVERIFY(in.value(QStringLiteral("empty_list")).toStringList().isEmpty());
+        QCOMPARE(in.value(QStringLiteral("flag")).toBool(), true);
+        QCOMPARE(in.value(QStringLiteral("number")).toDouble(), 0.25);
+        QCOMPARE(in.value(QStringLiteral("key with/slash")).toString(), QStringLiteral("x"));
+    in.endGroup();
+    QCOMPARE(in.value(QStringLiteral("General/key")).toString(), QStringLiteral("general group"));
+
+    // untouched values are written back as they were read
+    QCOMPARE(in.toByteArray(), out.toByteArray());
+}
+
+void Test_IniFile_Class::testReadQSettingsFile()
+{
+    const auto fileName = filePath(QStringLiteral("qsettings.ini"));
+    QFile::remove(fileName);
+    {
+        QSettings ini(fileName, QSettings::IniFormat);
+        writeKeys(ini);
+        ini.setValue(QStringLiteral("Extra/text"), QStringLiteral("a, \"b\"; \u00e8"));
+        ini.setValue(QStringLiteral("Extra/list"), QStringList { QStringLiteral("1"), QStringLiteral("2") });
+        ini.sync();
+    }
+
+    IniFile ini;
+    QVERIFY(ini.load(fileName));
+    QCOMPARE(readKeys(ini), GROUP_COUNT * KEYS_PER_GROUP);
+    QCOMPARE(ini.value(QStringLiteral("Extra/text")).toString(), QStringLiteral("a, \"b\"; \u00e8"));
+    QCOMPARE(ini.value(QStringLiteral("Extra/list")).toStringList(),
+             QStringList({ QStringLiteral("1"), QStringLiteral("2") }));
+}
+
+// the comment rules of QSettings: from a ';' out of quotes, '#' is a key char
+void Test_IniFile_Class::testComments()
+{
+    const QByteArray data("; comment\n"
+                          "[Group]\n"
+                          "a=1 ; comment\n"
+                          "b=\"x;y\" ;comment\n"
+                          "#c=2\n");
+
+    const auto fileName = filePath(QStringLiteral("comments.ini"));
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(file.write(data), static_cast<qint64>(data.size()));
+    file.close();
+
+    IniFile ini(data);
+    QSettings settings(fileName, QSettings::IniFormat);
+    const auto keys = ini.allKeys();
+    QCOMPARE(keys, settings.allKeys());
+    QCOMPARE(keys.size(), 3);
+    for (const auto& key : keys)
+    {
+        QCOMPARE(ini.value(key), settings.value(key));
+    }
+    QCOMPARE(ini.value(QStringLiteral("Group/a")).toString(), QStringLiteral("1"));
+    QCOMPARE(ini.value(QStringLiteral("Group/b")).toString(), QStringLiteral("x;y"));
+}
+
+void Test_IniFile_Class::testWrittenFileReadByQSettings()
+{
+    const auto fileName = filePath(QStringLiteral("inifile.ini"));
+
+    IniFile out;
+    writeKeys(out);
+    out.setValue(QStringLiteral("Extra/text"), QStringLiteral("a, \"b\"; \u00e8"));
+    out.setValue(QStringLiteral("Extra/list"), QStringList { QStringLiteral("1"), QStringLiteral("2") });
+    QVERIFY(out.save(fileName));
+
+    QSettings ini(fileName, QSettings::IniFormat);
+    QCOMPARE(readKeys(ini), GROUP_COUNT * KEYS_PER_GROUP);
+    QCOMPARE(ini.value(QStringLiteral("Extra/text")).toString(), QStringLiteral("a, \"b\"; \u00e8"));
+    QCOMPARE(ini.value(QStringLiteral("Extra/list")).toStringList(),
+             QStringList({ QStringLiteral("1"), QStringLiteral("2") }));
+}
+
+void Test_IniFile_Class::testGroupsAndRemove()
+{
+    IniFile ini(QByteArrayLiteral("[General]\nroot=1\n\n"
+                                  "[Instruments]\ninstr_1_model=a\ninstr_2_model=b\n"
+                                  "[Sub]\nchild\\key=c\nkey=d\n"));
+
+    QCOMPARE(ini.allKeys().size(), 5);
+    QCOMPARE(ini.childGroups(), QStringList({ QStringLiteral("Instruments"), QStringLiteral("Sub") }));
+    QCOMPARE(ini.childKeys(), QStringList { QStringLiteral("root") });
+
+    ini.beginGroup(QStringLiteral("Sub"));
+        QCOMPARE(ini.childGroups(), QStringList { QStringLiteral("child") });
+        QCOMPARE(ini.value(QStringLiteral("child/key")).toString(), QStringLiteral("c"));
+    ini.endGroup();
+
+    ini.beginGroup(QStringLiteral("Instruments"));
+        ini.remove(QString());
+        QVERIFY(ini.allKeys().isEmpty());
+        ini.setValue(QStringLiteral("instr_1_model"), QStringLiteral("e"));
+    ini.endGroup();
+
+    ini.remove(QStringLiteral("Sub/child"));
+    QVERIFY(!ini.contains(QStringLiteral("Sub/child/key")));
+    QVERIFY(ini.contains(QStringLiteral("Sub/key")));
+
+    QCOMPARE(ini.toByteArray(),
+             IniFile(QByteArrayLiteral("[General]\nroot=1\n\n"
+                                       "[Instruments]\ninstr_1_model=e\n\n"
+                                       "[Sub]\nkey=d\n")).toByteArray());
+}
+
+void Test_IniFile_Class::testSaveReplacesFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const auto fileName = dir.path() + QStringLiteral("/tagged.eddypro");
+
+    const auto tag = QStringLiteral(";EDDYPRO_PROCESSING");
+
+    IniFile out;
+    out.setValue(QStringLiteral("Project/title"), QStringLiteral("first"));
+    QVERIFY(out.save(fileName, tag));
+
+    // the loaded file is mapped while it is replaced
+    IniFile in;
+    QVERIFY(in.load(fileName));
+    in.setValue(QStringLiteral("Project/title"), QStringLiteral("second"));
+    QVERIFY(in.save(fileName, tag));
+
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+    QCOMPARE(QString::fromUtf8(file.readLine()).trimmed(), tag);
+    file.close();
+
+    IniFile reloaded;
+    QVERIFY(reloaded.load(fileName));
+    QCOMPARE(reloaded.value(QStringLiteral("Project/title")).toString(), QStringLiteral("second"));
+    QCOMPARE(reloaded.allKeys().size(), 1);
+
+    // no temporary file left behind
+    QCOMPARE(QDir(dir.path()).entryList(QDir::Files), QStringList { QStringLiteral("tagged.eddypro") });
+}
+
+void Test_IniFile_Class::benchmarkSave_data()
+{
+    QTest::addColumn<bool>("qsettings");
+
+    QTest::newRow("QSettings") << true;
+    QTest::newRow("IniFile") << false;
+}
+
+void Test_IniFile_Class::benchmarkSave()
+{
+    QFETCH(bool, qsettings);
+
+    const auto fileName = filePath(QStringLiteral("benchmark_save.ini"));
+
+    QBENCHMARK {
+        if (qsettings)
+            saveWithQSettings(fileName);
+        else
+            saveWithIniFile(fileName);
+    }
+}
+
+void Test_IniFile_Class::benchmarkLoad_data()
+{
+    benchmarkSave_data();
+}
+
+void Test_IniFile_Class::benchmarkLoad()
+{
+    QFETCH(bool, qsettings);
+
+    const auto fileName = filePath(QStringLiteral("benchmark_load.ini"));
+    saveWithIniFile(fileName);
+
+    QBENCHMARK {
+        if (qsettings)
+            loadWithQSettings(fileName);
+        else
+            loadWithIniFile(fileName);
+    }
+}
+
+void Test_IniFile_Class::cleanupTestCase()
+{
+}
+
+QTTESTUTIL_REGISTER_TEST(Test_IniFile_Class);
@@ -0,0 +1,36 @@
+#ifndef TST_INIFILE_H
+#define TST_INIFILE_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+#include "QtTestUtil/QtTestUtil.h"
+
+class Test_IniFile_Class : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testRoundTrip();
+    void testReadQSettingsFile();
+    void testComments();
+    void testWrittenFileReadByQSettings();
+    void testGroupsAndRemove();
+    void testSaveReplacesFile();
+
+    void benchmarkSave_data();
+    void benchmarkSave();
+    void benchmarkLoad_data();
+    void benchmarkLoad();
+
+    void cleanupTestCase();
+
+private:
+    QString filePath(const QString& name) const;
+
+    QTemporaryDir dir_;
+};
+
+#endif // TST_INIFILE_H
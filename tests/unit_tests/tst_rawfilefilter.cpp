@@ -0,0 +1,104 @@
+#include "tst_rawfilefilter.h"
+
+#include "rawfilefilter.h"
+
+#include <QDateTime>
+#include <QTest>
+
+namespace
+{
+const auto PROTOTYPE = QStringLiteral("yyyy-mm-ddTHHMM_AIU-0001.ghg");
+} // namespace
+
+// one file every half hour, one out of ten with a non matching extension
+QStringList Test_RawFileFilter_Class::makeFileList(int size)
+{
+    QStringList fileList;
+    fileList.reserve(size);
+
+    const auto start = QDateTime(QDate(2010, 1, 1), QTime(0, 0));
+    for (auto i = 0; i < size; ++i)
+    {
+        const QString name = start.addSecs(i * 1800).toString(QStringLiteral("yyyy-MM-ddTHHmm"))
+                             + QStringLiteral("_AIU-0001")
+                             + ((i % 10 == 9) ? QStringLiteral(".txt") : QStringLiteral(".ghg"));
+        fileList.append(QStringLiteral("/data/site/raw/") + name);
+    }
+    return fileList;
+}
+
+void Test_RawFileFilter_Class::initTestCase()
+{
+}
+
+void Test_RawFileFilter_Class::testPrototypeToRegExp()
+{
+    QCOMPARE(RawFileFilter::prototypeToRegExp(QStringLiteral("??HHMM.csv")),
+             QStringLiteral("..([01][0-9]|2[0-4])([0-5][0-9])[.]csv"));
+}
+
+void Test_RawFileFilter_Class::testFilterBaseName()
+{
+    // the date in the directory name must not match
+    const QStringList fileList {
+        QStringLiteral("/data/2016-03-01T0000_AIU-0001.ghg/notes.ghg"),
+        QStringLiteral("/data/raw/2016-03-01T0030_AIU-0001.ghg")
+    };
+
+    const auto filtered = RawFileFilter::filterWithPrototype(fileList, PROTOTYPE);
+    QCOMPARE(filtered.size(), 1);
+    QCOMPARE(filtered.first(), fileList.last());
+}
+
+void Test_RawFileFilter_Class::testFilterKeepsOrder()
+{
+    // large enough to be split in chunks
+    const auto fileList = makeFileList(100000);
+    const auto filtered = RawFileFilter::filterWithPrototype(fileList, PROTOTYPE);
+
+    QCOMPARE(filtered.size(), 90000);
+    for (auto i = 0, j = 0; i < fileList.size(); ++i)
+    {
+        if (i % 10 != 9)
+        {
+            QCOMPARE(filtered.at(j++), fileList.at(i));
+        }
+    }
+}
+
+void Test_RawFileFilter_Class::testInvalidPattern()
+{
+    const auto fileList = makeFileList(10);
+    QCOMPARE(RawFileFilter::filterWithPrototype(fileList, QStringLiteral("(yyyy")), fileList);
+}
+
+// the rows grow tenfold and so must the times, the former removeAll()
+// loop grew about a hundredfold
+void Test_RawFileFilter_Class::benchmarkFilter_data()
+{
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("10k") << 10000;
+    QTest::newRow("100k") << 100000;
+    QTest::newRow("1M") << 1000000;
+}
+
+void Test_RawFileFilter_Class::benchmarkFilter()
+{
+    QFETCH(int, size);
+
+    const auto fileList = makeFileList(size);
+    QStringList filtered;
+
+    QBENCHMARK {
+        filtered = RawFileFilter::filterWithPrototype(fileList, PROTOTYPE);
+    }
+
+    QCOMPARE(filtered.size(), size - size / 10);
+}
+
+void Test_RawFileFilter_Class::cleanupTestCase()
+{
+}
+
+QTTESTUTIL_REGISTER_TEST(Test_RawFileFilter_Class);
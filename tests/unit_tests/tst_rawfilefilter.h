@@ -0,0 +1,30 @@
+#ifndef TST_RAWFILEFILTER_H
+#define TST_RAWFILEFILTER_H
+
+#include <QObject>
+#include <QStringList>
+
+#include "QtTestUtil/QtTestUtil.h"
+
+class Test_RawFileFilter_Class : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testPrototypeToRegExp();
+    void testFilterBaseName();
+    void testFilterKeepsOrder();
+    void testInvalidPattern();
+
+    void benchmarkFilter_data();
+    void benchmarkFilter();
+
+    void cleanupTestCase();
+
+private:
+    static QStringList makeFileList(int size);
+};
+
+#endif // TST_RAWFILEFILTER_H
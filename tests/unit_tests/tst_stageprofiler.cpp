@@ -0,0 +1,166 @@
+#include "tst_stageprofiler.h"
+
+#include "stageprofiler.h"
+
+#include <QFile>
+#include <QTest>
+
+namespace
+{
+// two periods with the durations given by the engine, as the run page
+// gets them from the processing time lines
+void profileTwoPeriods(StageProfiler& profiler)
+{
+    profiler.startPeriod(1);
+    profiler.enterStage(QStringLiteral("spectra"), 120);
+    profiler.enterStage(QStringLiteral("footprint"), 30);
+    profiler.endPeriod();
+
+    profiler.startPeriod(2);
+    profiler.enterStage(QStringLiteral("spectra"), 80);
+    profiler.endPeriod();
+}
+
+// the row of a stage in the summary, split in its columns
+QStringList statsRow(const QStringList& report, const QString& stage)
+{
+    foreach (const auto& line, report)
+    {
+        const auto columns = line.simplified().split(QLatin1Char(' '));
+        if (columns.size() == 7 && columns.first() == stage)
+        {
+            return columns;
+        }
+    }
+    return QStringList();
+}
+} // namespace
+
+QString Test_StageProfiler_Class::filePath(const QString& name) const
+{
+    return dir_.path() + QLatin1Char('/') + name;
+}
+
+QStringList Test_StageProfiler_Class::readLines(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return QStringList();
+    }
+    return QString::fromUtf8(file.readAll()).split(QLatin1Char('\n'),
+                                                   QString::SkipEmptyParts);
+}
+
+void Test_StageProfiler_Class::initTestCase()
+{
+    QVERIFY(dir_.isValid());
+}
+
+void Test_StageProfiler_Class::testStageTotals()
+{
+    StageProfiler profiler;
+    profileTwoPeriods(profiler);
+    QCOMPARE(profiler.periodCount(), 2);
+
+    const auto reportFile = filePath(QStringLiteral("totals.txt"));
+    QVERIFY(profiler.writeReport(reportFile, QString(), QStringLiteral("site")));
+    const auto report = readLines(reportFile);
+
+    // count, total(s), share(%), mean(ms), min(ms), max(ms)
+    const auto spectra = statsRow(report, QStringLiteral("spectra"));
+    QCOMPARE(spectra.size(), 7);
+    QCOMPARE(spectra.at(1), QStringLiteral("2"));
+    QCOMPARE(spectra.at(2), QStringLiteral("0.2"));
+    QCOMPARE(spectra.at(4), QStringLiteral("100.0"));
+    QCOMPARE(spectra.at(5), QStringLiteral("80"));
+    QCOMPARE(spectra.at(6), QStringLiteral("120"));
+
+    const auto footprint = statsRow(report, QStringLiteral("footprint"));
+    QCOMPARE(footprint.size(), 7);
+    QCOMPARE(footprint.at(1), QStringLiteral("1"));
+    QCOMPARE(footprint.at(5), QStringLiteral("30"));
+
+    // the time to the first marker of each period
+    const auto importRow = statsRow(report, QStringLiteral("import"));
+    QCOMPARE(importRow.size(), 7);
+    QCOMPARE(importRow.at(1), QStringLiteral("2"));
+
+    const auto periods = statsRow(report, QStringLiteral("period"));
+    QCOMPARE(periods.size(), 7);
+    QCOMPARE(periods.at(1), QStringLiteral("2"));
+}
+
+void Test_StageProfiler_Class::testTimingRows()
+{
+    StageProfiler profiler;
+    profileTwoPeriods(profiler);
+
+    // a stage timed by the profiler, closed by the end of the period
+    profiler.startPeriod(3);
+    profiler.enterStage(QStringLiteral("fft"));
+    profiler.endPeriod();
+
+    const auto timingsFile = filePath(QStringLiteral("timings.csv"));
+    QVERIFY(profiler.writeReport(filePath(QStringLiteral("report.txt")),
+                                 timingsFile,
+                                 QStringLiteral("site")));
+    const auto rows = readLines(timingsFile);
+
+    QCOMPARE(rows.size(), 8);
+    QCOMPARE(rows.at(0), QStringLiteral("period,stage,start_ms,duration_ms"));
+
+    const QStringList expected {
+        QStringLiteral("1,import"),
+        QStringLiteral("1,spectra"),
+        QStringLiteral("1,footprint"),
+        QStringLiteral("2,import"),
+        QStringLiteral("2,spectra"),
+        QStringLiteral("3,import"),
+        QStringLiteral("3,fft")
+    };
+    for (auto i = 0; i < expected.size(); ++i)
+    {
+        const auto columns = rows.at(i + 1).split(QLatin1Char(','));
+        QCOMPARE(columns.size(), 4);
+        QCOMPARE(columns.mid(0, 2).join(QLatin1Char(',')), expected.at(i));
+
+        auto ok = false;
+        QVERIFY(columns.at(3).toLongLong(&ok) >= 0);
+        QVERIFY(ok);
+    }
+    QVERIFY(rows.at(2).endsWith(QLatin1String(",120")));
+    QVERIFY(rows.at(3).endsWith(QLatin1String(",30")));
+    QVERIFY(rows.at(5).endsWith(QLatin1String(",80")));
+}
+
+void Test_StageProfiler_Class::testSuspendResume()
+{
+    const auto pauseMSec = 500;
+
+    StageProfiler profiler;
+    profiler.startPeriod(1);
+    profiler.suspend();
+    QTest::qSleep(pauseMSec);
+    profiler.resume();
+    profiler.endPeriod();
+
+    const auto timingsFile = filePath(QStringLiteral("suspended.csv"));
+    QVERIFY(profiler.writeReport(filePath(QStringLiteral("suspended.txt")),
+                                 timingsFile,
+                                 QStringLiteral("site")));
+    const auto rows = readLines(timingsFile);
+
+    // the pause is charged neither to the stage nor to the period
+    QCOMPARE(rows.size(), 2);
+    const auto columns = rows.at(1).split(QLatin1Char(','));
+    QCOMPARE(columns.size(), 4);
+    QCOMPARE(columns.at(1), QStringLiteral("import"));
+    QVERIFY(columns.at(3).toLongLong() < pauseMSec);
+}
+
+void Test_StageProfiler_Class::cleanupTestCase()
+{
+}
+
+QTTESTUTIL_REGISTER_TEST(Test_StageProfiler_Class);
@@ -0,0 +1,30 @@
+#ifndef TST_STAGEPROFILER_H
+#define TST_STAGEPROFILER_H
+
+#include <QObject>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include "QtTestUtil/QtTestUtil.h"
+
+class Test_StageProfiler_Class : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testStageTotals();
+    void testTimingRows();
+    void testSuspendResume();
+
+    void cleanupTestCase();
+
+private:
+    QString filePath(const QString& name) const;
+    static QStringList readLines(const QString& fileName);
+
+    QTemporaryDir dir_;
+};
+
+#endif // TST_STAGEPROFILER_H